@@ -97,6 +97,31 @@ function(gnc_add_test _TARGET _SOURCE_FILES TEST_INCLUDE_VAR_NAME TEST_LIBS_VAR_
   add_dependencies(check ${_TARGET})
 endfunction()
 
+# Benchmarks are built only on demand by the "benchmark" target, which
+# runs each of them and writes its results as JSON to
+# ${CMAKE_BINARY_DIR}/benchmark/<target>.json.
+function(gnc_add_benchmark _TARGET _SOURCE_FILES BENCH_INCLUDE_VAR_NAME BENCH_LIBS_VAR_NAME)
+  if (NOT BENCHMARK_FOUND)
+    return()
+  endif()
+  set(BENCH_INCLUDE_DIRS ${${BENCH_INCLUDE_VAR_NAME}})
+  set(BENCH_LIBS ${${BENCH_LIBS_VAR_NAME}})
+  set_source_files_properties (${_SOURCE_FILES} PROPERTIES OBJECT_DEPENDS ${CONFIG_H})
+  add_executable(${_TARGET} EXCLUDE_FROM_ALL ${_SOURCE_FILES})
+  target_link_libraries(${_TARGET} ${BENCH_LIBS} benchmark::benchmark)
+  target_include_directories(${_TARGET} PRIVATE ${BENCH_INCLUDE_DIRS})
+  add_custom_target(run-${_TARGET}
+    COMMAND ${CMAKE_COMMAND} -E make_directory ${CMAKE_BINARY_DIR}/benchmark
+    COMMAND ${CMAKE_COMMAND} -E env GNC_UNINSTALLED=YES GNC_BUILDDIR=${CMAKE_BINARY_DIR} ${ARGN}
+      $<TARGET_FILE:${_TARGET}>
+      --benchmark_out=${CMAKE_BINARY_DIR}/benchmark/${_TARGET}.json
+      --benchmark_out_format=json
+    DEPENDS ${_TARGET}
+    USES_TERMINAL
+  )
+  add_dependencies(benchmark run-${_TARGET})
+endfunction()
+
 function(gnc_add_test_with_guile _TARGET _SOURCE_FILES TEST_INCLUDE_VAR_NAME TEST_LIBS_VAR_NAME)
   get_guile_env()
   gnc_add_test(${_TARGET} "${_SOURCE_FILES}" "${TEST_INCLUDE_VAR_NAME}" "${TEST_LIBS_VAR_NAME}"
@@ -211,3 +236,14 @@ function(gnc_gtest_configure)
   endif()
   set(GMOCK_FOUND YES PARENT_SCOPE)
 endfunction()
+
+function(gnc_benchmark_configure)
+  message(STATUS "Checking for Google Benchmark")
+  find_package(benchmark QUIET)
+  if (benchmark_FOUND)
+    set(BENCHMARK_FOUND YES CACHE INTERNAL "Found Google Benchmark")
+  else()
+    message(STATUS "Google Benchmark not found, the benchmark target will do nothing")
+    set(BENCHMARK_FOUND NO CACHE INTERNAL "Found Google Benchmark")
+  endif()
+endfunction()
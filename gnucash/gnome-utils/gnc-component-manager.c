@@ -55,6 +55,10 @@ typedef struct
     char *component_class;
     gint component_id;
     gpointer session;
+
+    /* Set when the watches change during a refresh, so that the
+     * component is matched against the changes directly. */
+    gboolean watches_changed;
 } ComponentInfo;
 
 
@@ -67,6 +71,15 @@ static GList *components = NULL;
 static ComponentEventInfo changes = { NULL, NULL, FALSE };
 static ComponentEventInfo changes_backup = { NULL, NULL, FALSE };
 
+/* component id --> ComponentInfo */
+static GHashTable *components_by_id = NULL;
+
+/* Inverted watch indexes, from a watched GncGUID or entity type to the
+ * set of ids of the components watching it, so that a refresh only
+ * looks at the components whose watches intersect the changes. */
+static GHashTable *watchers_by_guid = NULL;
+static GHashTable *watchers_by_type = NULL;
+
 
 /* This static indicates the debugging module that this .o belongs to.  */
 static QofLogModule log_module = GNC_MOD_GUI;
@@ -177,6 +190,69 @@ clear_event_info (ComponentEventInfo *cei)
     clear_event_hash (cei->entity_events);
 }
 
+static void
+init_watch_indexes (void)
+{
+    watchers_by_guid = g_hash_table_new_full (guid_hash_to_guint,
+                                              guid_g_hash_table_equal,
+                                              (GDestroyNotify) guid_free,
+                                              (GDestroyNotify) g_hash_table_destroy);
+    watchers_by_type = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                              (GDestroyNotify) g_hash_table_destroy);
+}
+
+static void
+destroy_watch_indexes (void)
+{
+    g_hash_table_destroy (watchers_by_guid);
+    watchers_by_guid = NULL;
+
+    g_hash_table_destroy (watchers_by_type);
+    watchers_by_type = NULL;
+}
+
+/* add component_id to the set for key, a GncGUID or an entity type
+ * depending on the index */
+static void
+watch_index_add (GHashTable *index, gconstpointer key, gint component_id)
+{
+    GHashTable *ids;
+
+    /* not initialized or already shut down */
+    if (!index)
+        return;
+
+    ids = g_hash_table_lookup (index, key);
+
+    if (!ids)
+    {
+        gpointer key_copy = (index == watchers_by_guid) ?
+                            (gpointer) guid_copy (key) : g_strdup (key);
+
+        ids = g_hash_table_new (g_direct_hash, g_direct_equal);
+        g_hash_table_insert (index, key_copy, ids);
+    }
+
+    g_hash_table_add (ids, GINT_TO_POINTER (component_id));
+}
+
+static void
+watch_index_remove (GHashTable *index, gconstpointer key, gint component_id)
+{
+    GHashTable *ids;
+
+    if (!index)
+        return;
+
+    ids = g_hash_table_lookup (index, key);
+    if (!ids)
+        return;
+
+    g_hash_table_remove (ids, GINT_TO_POINTER (component_id));
+    if (g_hash_table_size (ids) == 0)
+        g_hash_table_remove (index, key);
+}
+
 static void
 add_event (ComponentEventInfo *cei, const GncGUID *entity,
            QofEventId event_mask, gboolean or_in)
@@ -288,6 +364,8 @@ static gint handler_id;
 void
 gnc_component_manager_init (void)
 {
+    GList *node;
+
     if (changes.entity_events)
     {
         PERR ("component manager already initialized");
@@ -300,6 +378,24 @@ gnc_component_manager_init (void)
     changes_backup.event_masks = g_hash_table_new (g_str_hash, g_str_equal);
     changes_backup.entity_events = guid_hash_table_new ();
 
+    /* Index the watches of any component registered before. */
+    init_watch_indexes ();
+    for (node = components; node; node = node->next)
+    {
+        ComponentInfo *ci = node->data;
+        GHashTableIter iter;
+        gpointer key, value;
+
+        g_hash_table_iter_init (&iter, ci->watch_info.entity_events);
+        while (g_hash_table_iter_next (&iter, &key, &value))
+            watch_index_add (watchers_by_guid, key, ci->component_id);
+
+        g_hash_table_iter_init (&iter, ci->watch_info.event_masks);
+        while (g_hash_table_iter_next (&iter, &key, &value))
+            if (*(QofEventId *) value)
+                watch_index_add (watchers_by_type, key, ci->component_id);
+    }
+
     handler_id = qof_event_register_handler (gnc_cm_event_handler, NULL);
 }
 
@@ -324,23 +420,21 @@ gnc_component_manager_shutdown (void)
     destroy_event_hash (changes_backup.entity_events);
     changes_backup.entity_events = NULL;
 
+    /* The watched entities go with the session. Components closed
+     * after this drop their watches without the indexes. */
+    destroy_watch_indexes ();
+
     qof_event_unregister_handler (handler_id);
 }
 
 static ComponentInfo *
 find_component (gint component_id)
 {
-    GList *node;
-
-    for (node = components; node; node = node->next)
-    {
-        ComponentInfo *ci = node->data;
-
-        if (ci->component_id == component_id)
-            return ci;
-    }
+    if (!components_by_id)
+        return NULL;
 
-    return NULL;
+    return g_hash_table_lookup (components_by_id,
+                                GINT_TO_POINTER (component_id));
 }
 
 static GList *
@@ -410,6 +504,9 @@ gnc_register_gui_component_internal (const char * component_class)
     ci->session = NULL;
 
     components = g_list_prepend (components, ci);
+    if (!components_by_id)
+        components_by_id = g_hash_table_new (g_direct_hash, g_direct_equal);
+    g_hash_table_insert (components_by_id, GINT_TO_POINTER (component_id), ci);
 
     /* update id for next registration */
     next_component_id = component_id + 1;
@@ -466,6 +563,12 @@ gnc_gui_component_watch_entity (gint component_id,
     }
 
     add_event (&ci->watch_info, entity, event_mask, FALSE);
+
+    if (event_mask)
+        watch_index_add (watchers_by_guid, entity, component_id);
+    else
+        watch_index_remove (watchers_by_guid, entity, component_id);
+    ci->watches_changed = TRUE;
 }
 
 void
@@ -483,6 +586,14 @@ gnc_gui_component_watch_entity_type (gint component_id,
     }
 
     add_event_type (&ci->watch_info, entity_type, event_mask, FALSE);
+    if (!entity_type)
+        return;
+
+    if (event_mask)
+        watch_index_add (watchers_by_type, entity_type, component_id);
+    else
+        watch_index_remove (watchers_by_type, entity_type, component_id);
+    ci->watches_changed = TRUE;
 }
 
 const EventInfo *
@@ -498,6 +609,8 @@ void
 gnc_gui_component_clear_watches (gint component_id)
 {
     ComponentInfo *ci;
+    GHashTableIter iter;
+    gpointer key;
 
     ci = find_component (component_id);
     if (!ci)
@@ -506,7 +619,16 @@ gnc_gui_component_clear_watches (gint component_id)
         return;
     }
 
+    g_hash_table_iter_init (&iter, ci->watch_info.entity_events);
+    while (g_hash_table_iter_next (&iter, &key, NULL))
+        watch_index_remove (watchers_by_guid, key, component_id);
+
+    g_hash_table_iter_init (&iter, ci->watch_info.event_masks);
+    while (g_hash_table_iter_next (&iter, &key, NULL))
+        watch_index_remove (watchers_by_type, key, component_id);
+
     clear_event_info (&ci->watch_info);
+    ci->watches_changed = TRUE;
 }
 
 void
@@ -530,6 +652,12 @@ gnc_unregister_gui_component (gint component_id)
     gnc_gui_component_clear_watches (component_id);
 
     components = g_list_remove (components, ci);
+    g_hash_table_remove (components_by_id, GINT_TO_POINTER (component_id));
+    if (!components)
+    {
+        g_hash_table_destroy (components_by_id);
+        components_by_id = NULL;
+    }
 
     destroy_mask_hash (ci->watch_info.event_masks);
     ci->watch_info.event_masks = NULL;
@@ -662,9 +790,82 @@ changes_match (ComponentEventInfo *cei, ComponentEventInfo *changes)
     return big_cei->match;
 }
 
+/* Add to matches the ids of the components in ids whose own watch for
+ * key, a GncGUID if by_guid and an entity type otherwise, shares a bit
+ * with event_mask. */
+static void
+collect_matches (GHashTable *ids, gconstpointer key, QofEventId event_mask,
+                 gboolean by_guid, GHashTable *matches)
+{
+    GHashTableIter iter;
+    gpointer id;
+
+    g_hash_table_iter_init (&iter, ids);
+    while (g_hash_table_iter_next (&iter, &id, NULL))
+    {
+        ComponentInfo *ci = find_component (GPOINTER_TO_INT (id));
+        QofEventId watched = 0;
+
+        if (!ci)
+            continue;
+
+        if (by_guid)
+        {
+            EventInfo *ei = g_hash_table_lookup (ci->watch_info.entity_events,
+                                                 key);
+            if (ei)
+                watched = ei->event_mask;
+        }
+        else
+        {
+            QofEventId *mask = g_hash_table_lookup (ci->watch_info.event_masks,
+                                                    key);
+            if (mask)
+                watched = *mask;
+        }
+
+        if (watched & event_mask)
+            g_hash_table_add (matches, id);
+    }
+}
+
+/* Return the set of ids of the components whose watches match
+ * changes, as changes_match would decide for each of them, by looking
+ * up each change in the watch indexes. */
+static GHashTable *
+find_matching_components (ComponentEventInfo *changes)
+{
+    GHashTable *matches = g_hash_table_new (g_direct_hash, g_direct_equal);
+    GHashTableIter iter;
+    gpointer key, value;
+
+    if (!watchers_by_guid)
+        return matches;
+
+    g_hash_table_iter_init (&iter, changes->event_masks);
+    while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+        GHashTable *ids = g_hash_table_lookup (watchers_by_type, key);
+        if (ids)
+            collect_matches (ids, key, *(QofEventId *) value, FALSE, matches);
+    }
+
+    g_hash_table_iter_init (&iter, changes->entity_events);
+    while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+        GHashTable *ids = g_hash_table_lookup (watchers_by_guid, key);
+        if (ids)
+            collect_matches (ids, key, ((EventInfo *) value)->event_mask, TRUE,
+                             matches);
+    }
+
+    return matches;
+}
+
 static void
 gnc_gui_refresh_internal (gboolean force)
 {
+    GHashTable *matches = NULL;
     GList *list;
     GList *node;
 
@@ -693,6 +894,12 @@ gnc_gui_refresh_internal (gboolean force)
     // reverse the list so class GncPluginPageRegister is before register-single
     list = g_list_reverse (list);
 
+    for (node = components; node; node = node->next)
+        ((ComponentInfo *) node->data)->watches_changed = FALSE;
+
+    if (!force && components)
+        matches = find_matching_components (&changes_backup);
+
     for (node = list; node; node = node->next)
     {
         ComponentInfo *ci = find_component (GPOINTER_TO_INT (node->data));
@@ -718,7 +925,10 @@ gnc_gui_refresh_internal (gboolean force)
                 ci->refresh_handler (NULL, ci->user_data);
             }
         }
-        else if (changes_match (&ci->watch_info, &changes_backup))
+        else if (ci->watches_changed ?
+                 changes_match (&ci->watch_info, &changes_backup) :
+                 g_hash_table_contains (matches,
+                                        GINT_TO_POINTER (ci->component_id)))
         {
             if (ci->refresh_handler)
             {
@@ -740,6 +950,8 @@ gnc_gui_refresh_internal (gboolean force)
     got_events = FALSE;
 
     g_list_free (list);
+    if (matches)
+        g_hash_table_destroy (matches);
 
     gnc_resume_gui_refresh ();
 }
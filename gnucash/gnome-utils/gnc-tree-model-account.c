@@ -91,6 +91,45 @@ static void gnc_tree_model_account_event_handler (QofInstance *entity,
         QofEventId event_type,
         GncTreeModelAccount *model,
         GncEventData *ed);
+static void gnc_tree_model_account_balance_handler (QofInstance *entity,
+        QofEventId event_type,
+        GncTreeModelAccount *model,
+        gpointer event_data);
+static void gnc_tree_model_account_price_handler (QofInstance *entity,
+        QofEventId event_type,
+        GncTreeModelAccount *model,
+        gpointer event_data);
+
+/** The balances that the model keeps up to date itself. The totals of
+ *  an account's ancestors are adjusted by the change in its own balances
+ *  instead of being summed over their subtrees again. */
+typedef enum
+{
+    TRACKED_BALANCE_CURRENT,
+    TRACKED_BALANCE_PERIOD_START,
+    TRACKED_BALANCE_PERIOD_END,
+    NUM_TRACKED_BALANCES
+} TrackedBalance;
+
+/** The tracked balances of one account. The own balances are in the
+ *  account's commodity, and so are the totals, which also hold the
+ *  descendants' balances converted the way the engine converts them.
+ *
+ *  The own balances as they were added to the totals of the account and
+ *  each of its ancestors, converted at the prices of the time, are kept
+ *  in contrib, NUM_TRACKED_BALANCES per level starting with the account
+ *  itself. Taking them away again leaves the totals exact whatever the
+ *  prices are now. */
+typedef struct
+{
+    gnc_commodity *commodity;
+    gnc_numeric own[NUM_TRACKED_BALANCES];
+    gnc_numeric total[NUM_TRACKED_BALANCES];
+    gint n_levels;
+    gnc_numeric *contrib;
+} AccountBalances;
+
+static void account_balances_free (gpointer data);
 
 /** The instance private data for an account tree model. */
 typedef struct GncTreeModelAccountPrivate
@@ -98,10 +137,19 @@ typedef struct GncTreeModelAccountPrivate
     QofBook *book;
     Account *root;
     gint event_handler_id;
+    gint balance_handler_id;
+    gint price_handler_id;
+    gint commodity_handler_id;
     gchar *negative_color;
 
     GHashTable *account_values_hash;
 
+    /* Account -> AccountBalances, filled on first use */
+    GHashTable *balances_hash;
+    gboolean balances_valid;
+    time64 period_start;
+    time64 period_end;
+
 } GncTreeModelAccountPrivate;
 
 G_DEFINE_TYPE_WITH_CODE (GncTreeModelAccount,
@@ -203,6 +251,10 @@ gnc_tree_model_account_init (GncTreeModelAccount *model)
     priv->account_values_hash = g_hash_table_new_full (g_str_hash, g_str_equal,
                                                        g_free, g_free);
 
+    priv->balances_hash = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                                 NULL, account_balances_free);
+    priv->balances_valid = FALSE;
+
     gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_NEGATIVE_IN_RED,
                            gnc_tree_model_account_update_color,
                            model);
@@ -251,11 +303,30 @@ gnc_tree_model_account_dispose (GObject *object)
         priv->event_handler_id = 0;
     }
 
+    if (priv->balance_handler_id)
+    {
+        qof_event_unregister_handler (priv->balance_handler_id);
+        priv->balance_handler_id = 0;
+    }
+
+    if (priv->price_handler_id)
+    {
+        qof_event_unregister_handler (priv->price_handler_id);
+        priv->price_handler_id = 0;
+    }
+
+    if (priv->commodity_handler_id)
+    {
+        qof_event_unregister_handler (priv->commodity_handler_id);
+        priv->commodity_handler_id = 0;
+    }
+
     if (priv->negative_color)
         g_free (priv->negative_color);
 
     // destroy the cached account values
     g_hash_table_destroy (priv->account_values_hash);
+    g_hash_table_destroy (priv->balances_hash);
 
     gnc_prefs_remove_cb_by_func (GNC_PREFS_GROUP_GENERAL, GNC_PREF_NEGATIVE_IN_RED,
                                  gnc_tree_model_account_update_color,
@@ -301,6 +372,28 @@ gnc_tree_model_account_new (Account *root)
     priv->event_handler_id = qof_event_register_handler
                              ((QofEventHandler)gnc_tree_model_account_event_handler, model);
 
+    /* Balance changes only need the accounts' totals updated, so take
+     * them coalesced per account, once per transaction commit. */
+    priv->balance_handler_id = qof_event_register_typed_handler
+                               (GNC_ID_ACCOUNT,
+                                QOF_EVENT_MODIFY | GNC_EVENT_ITEM_ADDED |
+                                GNC_EVENT_ITEM_REMOVED | GNC_EVENT_ITEM_CHANGED,
+                                QOF_EVENT_DELIVER_BATCHED,
+                                (QofEventHandler)gnc_tree_model_account_balance_handler,
+                                model);
+
+    /* The totals hold converted balances, which a new price or a
+     * commodity's new fraction makes stale. */
+    priv->price_handler_id = qof_event_register_typed_handler
+                             (GNC_ID_PRICE, QOF_EVENT_ALL, QOF_EVENT_DELIVER_BATCHED,
+                              (QofEventHandler)gnc_tree_model_account_price_handler,
+                              model);
+    priv->commodity_handler_id = qof_event_register_typed_handler
+                                 (GNC_ID_COMMODITY, QOF_EVENT_MODIFY,
+                                  QOF_EVENT_DELIVER_BATCHED,
+                                  (QofEventHandler)gnc_tree_model_account_price_handler,
+                                  model);
+
     LEAVE("model %p", model);
     return GTK_TREE_MODEL(model);
 }
@@ -557,6 +650,249 @@ gnc_tree_model_account_set_color (GncTreeModelAccount *model,
         g_value_set_static_string (value, NULL);
 }
 
+static gnc_numeric
+convert_tracked_balance (GncTreeModelAccountPrivate *priv, Account *account,
+                         TrackedBalance which, gnc_numeric balance,
+                         const gnc_commodity *from, const gnc_commodity *to)
+{
+    switch (which)
+    {
+    case TRACKED_BALANCE_PERIOD_START:
+        return xaccAccountConvertBalanceToCurrencyAsOfDate (account, balance, from,
+                                                            to, priv->period_start);
+    case TRACKED_BALANCE_PERIOD_END:
+        return xaccAccountConvertBalanceToCurrencyAsOfDate (account, balance, from,
+                                                            to, priv->period_end);
+    default:
+        return xaccAccountConvertBalanceToCurrency (account, balance, from, to);
+    }
+}
+
+/* Add the own balances of an account to its totals and to those of its
+ * ancestors, recording what was added to each. */
+static void
+add_account_balances (GncTreeModelAccount *model, Account *account,
+                      AccountBalances *account_balances)
+{
+    GncTreeModelAccountPrivate *priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
+    gnc_commodity *commodity = xaccAccountGetCommodity (account);
+    const gnc_numeric *own = account_balances->own;
+    Account *acct;
+    gint level = 0;
+
+    for (acct = account; acct && acct != priv->root;
+         acct = gnc_account_get_parent (acct))
+        level++;
+    g_free (account_balances->contrib);
+    account_balances->n_levels = level;
+    account_balances->contrib = g_new0 (gnc_numeric, level * NUM_TRACKED_BALANCES);
+
+    level = 0;
+    for (acct = account; acct && acct != priv->root;
+         acct = gnc_account_get_parent (acct), level++)
+    {
+        AccountBalances *balances = g_hash_table_lookup (priv->balances_hash, acct);
+        gnc_numeric *contrib = account_balances->contrib + level * NUM_TRACKED_BALANCES;
+        gint fraction;
+
+        if (!balances || !balances->commodity)
+            continue;
+
+        fraction = gnc_commodity_get_fraction (balances->commodity);
+        for (gint which = 0; which < NUM_TRACKED_BALANCES; which++)
+        {
+            gnc_numeric value = own[which];
+
+            if (acct != account)
+                value = convert_tracked_balance (priv, account, which, value,
+                                                 commodity, balances->commodity);
+            contrib[which] = value;
+            balances->total[which] = gnc_numeric_add (balances->total[which], value,
+                                                      fraction, GNC_HOW_RND_ROUND_HALF_UP);
+        }
+    }
+}
+
+/* Take away what add_account_balances() added to the totals. */
+static void
+remove_account_balances (GncTreeModelAccount *model, Account *account,
+                         AccountBalances *account_balances)
+{
+    GncTreeModelAccountPrivate *priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
+    Account *acct;
+    gint level = 0;
+
+    for (acct = account; acct && acct != priv->root &&
+             level < account_balances->n_levels;
+         acct = gnc_account_get_parent (acct), level++)
+    {
+        AccountBalances *balances = g_hash_table_lookup (priv->balances_hash, acct);
+        const gnc_numeric *contrib = account_balances->contrib + level * NUM_TRACKED_BALANCES;
+        gint fraction;
+
+        if (!balances || !balances->commodity)
+            continue;
+
+        fraction = gnc_commodity_get_fraction (balances->commodity);
+        for (gint which = 0; which < NUM_TRACKED_BALANCES; which++)
+            balances->total[which] = gnc_numeric_sub (balances->total[which], contrib[which],
+                                                      fraction, GNC_HOW_RND_ROUND_HALF_UP);
+    }
+    g_free (account_balances->contrib);
+    account_balances->contrib = NULL;
+    account_balances->n_levels = 0;
+}
+
+static void
+account_balances_free (gpointer data)
+{
+    AccountBalances *balances = data;
+
+    g_free (balances->contrib);
+    g_free (balances);
+}
+
+static void
+get_own_balances (GncTreeModelAccountPrivate *priv, Account *account,
+                  gnc_numeric *own)
+{
+    own[TRACKED_BALANCE_CURRENT] = xaccAccountGetBalance (account);
+    own[TRACKED_BALANCE_PERIOD_START] =
+        xaccAccountGetBalanceAsOfDate (account, priv->period_start);
+    own[TRACKED_BALANCE_PERIOD_END] =
+        xaccAccountGetBalanceAsOfDate (account, priv->period_end);
+}
+
+static void
+invalidate_balances (GncTreeModelAccount *model)
+{
+    GncTreeModelAccountPrivate *priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
+
+    g_hash_table_remove_all (priv->balances_hash);
+    priv->balances_valid = FALSE;
+}
+
+/* Compute the tracked balances of every account in one pass over the
+ * tree. */
+static void
+build_balances (GncTreeModelAccount *model)
+{
+    GncTreeModelAccountPrivate *priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
+    GList *accounts, *node;
+
+    ENTER("model %p", model);
+    g_hash_table_remove_all (priv->balances_hash);
+    priv->period_start = gnc_accounting_period_fiscal_start ();
+    priv->period_end = gnc_accounting_period_fiscal_end ();
+
+    accounts = gnc_account_get_descendants (priv->root);
+    for (node = accounts; node; node = g_list_next (node))
+    {
+        AccountBalances *balances = g_new0 (AccountBalances, 1);
+
+        balances->commodity = xaccAccountGetCommodity (node->data);
+        get_own_balances (priv, node->data, balances->own);
+        for (gint which = 0; which < NUM_TRACKED_BALANCES; which++)
+            balances->total[which] = gnc_numeric_zero ();
+        g_hash_table_insert (priv->balances_hash, node->data, balances);
+    }
+
+    for (node = accounts; node; node = g_list_next (node))
+    {
+        AccountBalances *balances = g_hash_table_lookup (priv->balances_hash,
+                                                         node->data);
+        add_account_balances (model, node->data, balances);
+    }
+    g_list_free (accounts);
+
+    priv->balances_valid = TRUE;
+    LEAVE("%d accounts", g_hash_table_size (priv->balances_hash));
+}
+
+static AccountBalances *
+gnc_tree_model_account_get_balances (GncTreeModelAccount *model, Account *account)
+{
+    GncTreeModelAccountPrivate *priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
+    AccountBalances *balances;
+
+    if (priv->balances_valid &&
+        (priv->period_start != gnc_accounting_period_fiscal_start () ||
+         priv->period_end != gnc_accounting_period_fiscal_end ()))
+        priv->balances_valid = FALSE;
+
+    if (!priv->balances_valid)
+        build_balances (model);
+
+    balances = g_hash_table_lookup (priv->balances_hash, account);
+    if (!balances && account != priv->root)
+    {
+        /* An account the last pass didn't see */
+        build_balances (model);
+        balances = g_hash_table_lookup (priv->balances_hash, account);
+    }
+    return balances;
+}
+
+/* Bring the tracked balances up to date after the balances of an account
+ * changed. Only the account and its ancestors are touched.
+ *
+ * Returns FALSE if they had to be dropped instead, so that every total
+ * may have changed. */
+static gboolean
+gnc_tree_model_account_update_balances (GncTreeModelAccount *model, Account *account)
+{
+    GncTreeModelAccountPrivate *priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
+    AccountBalances *balances;
+
+    /* Nothing to update; the next use builds them */
+    if (!priv->balances_valid)
+        return TRUE;
+
+    balances = g_hash_table_lookup (priv->balances_hash, account);
+    if (!balances || balances->commodity != xaccAccountGetCommodity (account))
+    {
+        invalidate_balances (model);
+        return FALSE;
+    }
+
+    remove_account_balances (model, account, balances);
+    get_own_balances (priv, account, balances->own);
+    add_account_balances (model, account, balances);
+    return TRUE;
+}
+
+static gchar *
+print_tracked_balance (Account *acct, gnc_numeric balance, gboolean *negative)
+{
+    GNCPrintAmountInfo print_info;
+
+    if (gnc_reverse_balance (acct))
+        balance = gnc_numeric_neg (balance);
+
+    if (negative)
+        *negative = gnc_numeric_negative_p (balance);
+
+    print_info = gnc_account_print_info (acct, TRUE);
+
+    return g_strdup (gnc_print_amount_with_bidi_ltr_isolate (balance, print_info));
+}
+
+static gchar *
+gnc_tree_model_account_compute_total (GncTreeModelAccount *model,
+                                      Account *acct,
+                                      gboolean *negative)
+{
+    AccountBalances *balances;
+
+    balances = gnc_tree_model_account_get_balances (model, acct);
+    if (!balances)
+        return gnc_ui_account_get_print_balance (xaccAccountGetBalanceInCurrency,
+                                                 acct, TRUE, negative);
+
+    return print_tracked_balance (acct, balances->total[TRACKED_BALANCE_CURRENT],
+                                  negative);
+}
+
 static gchar *
 gnc_tree_model_account_compute_period_balance (GncTreeModelAccount *model,
                                                Account *acct,
@@ -564,7 +900,8 @@ gnc_tree_model_account_compute_period_balance (GncTreeModelAccount *model,
                                                gboolean *negative)
 {
     GncTreeModelAccountPrivate *priv;
-    GNCPrintAmountInfo print_info;
+    AccountBalances *balances;
+    const gnc_numeric *b;
     time64 t1, t2;
     gnc_numeric b3;
 
@@ -581,16 +918,16 @@ gnc_tree_model_account_compute_period_balance (GncTreeModelAccount *model,
     if (t1 > t2)
         return g_strdup ("");
 
-    b3 = xaccAccountGetBalanceChangeForPeriod (acct, t1, t2, recurse);
-    if (gnc_reverse_balance (acct))
-        b3 = gnc_numeric_neg (b3);
-
-    if (negative)
-        *negative = gnc_numeric_negative_p (b3);
+    balances = gnc_tree_model_account_get_balances (model, acct);
+    if (!balances)
+        return g_strdup ("");
 
-    print_info = gnc_account_print_info (acct, TRUE);
+    b = recurse ? balances->total : balances->own;
+    b3 = gnc_numeric_sub (b[TRACKED_BALANCE_PERIOD_END],
+                          b[TRACKED_BALANCE_PERIOD_START],
+                          GNC_DENOM_AUTO, GNC_HOW_DENOM_FIXED);
 
-    return g_strdup (gnc_print_amount_with_bidi_ltr_isolate (b3, print_info));
+    return print_tracked_balance (acct, b3, negative);
 }
 
 static gboolean
@@ -613,6 +950,9 @@ gnc_tree_model_account_clear_cache (GncTreeModelAccount *model)
         priv->account_values_hash = g_hash_table_new_full (g_str_hash, g_str_equal,
                                                            g_free, g_free);
 
+        // prices may have changed, so convert the totals again
+        invalidate_balances (model);
+
         gtk_tree_model_foreach (GTK_TREE_MODEL(model), row_changed_foreach_func, NULL);
     }
 }
@@ -912,8 +1252,7 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
 
     case GNC_TREE_MODEL_ACCOUNT_COL_TOTAL:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance (xaccAccountGetBalanceInCurrency,
-                 account, TRUE, &negative);
+        string = gnc_tree_model_account_compute_total (model, account, &negative);
         g_value_take_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_TOTAL_REPORT:
@@ -924,8 +1263,7 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_TOTAL:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance (xaccAccountGetBalanceInCurrency,
-                 account, TRUE, &negative);
+        string = gnc_tree_model_account_compute_total (model, account, &negative);
         gnc_tree_model_account_set_color (model, negative, value);
         g_free (string);
         break;
@@ -1477,6 +1815,20 @@ gnc_tree_model_account_event_handler (QofInstance *entity,
         return;
     }
 
+    /* Balance changes are left to gnc_tree_model_account_balance_handler,
+     * which gets them once per account and transaction commit. */
+    if (event_type & (GNC_EVENT_ITEM_ADDED | GNC_EVENT_ITEM_REMOVED |
+                      GNC_EVENT_ITEM_CHANGED))
+    {
+        LEAVE("balance change");
+        return;
+    }
+
+    /* The tree changed, so the totals have to be summed up again */
+    if (event_type == QOF_EVENT_ADD || event_type == QOF_EVENT_REMOVE ||
+        event_type == QOF_EVENT_DESTROY)
+        invalidate_balances (model);
+
     /* clear the cached model values for account */
     if (event_type != QOF_EVENT_ADD)
         gnc_tree_model_account_clear_cached_values (model, account);
@@ -1548,3 +1900,89 @@ gnc_tree_model_account_event_handler (QofInstance *entity,
     LEAVE(" ");
     return;
 }
+
+/** This function is the handler for the balance changing events of the
+ *  accounts, delivered once per account at the end of a transaction
+ *  commit.  It replaces the account's contribution to the tracked
+ *  balances of the account and its ancestors and tells the views that
+ *  those rows changed.
+ *
+ *  @internal
+ *
+ *  @param entity The affected account.
+ *
+ *  @param event_type The events that were generated for the account.
+ *
+ *  @param model A pointer to the account tree model.
+ *
+ *  @param event_data Unused.
+ */
+static void
+gnc_tree_model_account_balance_handler (QofInstance *entity,
+                                        QofEventId event_type,
+                                        GncTreeModelAccount *model,
+                                        gpointer event_data)
+{
+    GncTreeModelAccountPrivate *priv;
+    Account *account;
+
+    g_return_if_fail (model);    /* Required */
+
+    if (!GNC_IS_ACCOUNT(entity) || qof_instance_get_destroying (entity))
+        return;
+
+    ENTER("entity %p, events %x, model %p", entity, event_type, model);
+    priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
+    account = GNC_ACCOUNT(entity);
+
+    if (gnc_account_get_book (account) != priv->book ||
+        gnc_account_get_root (account) != priv->root)
+    {
+        LEAVE("not in this model");
+        return;
+    }
+
+    /* Tell the views which rows changed: the account and its ancestors,
+     * or all of them if the totals had to be dropped. */
+    if (gnc_tree_model_account_update_balances (model, account))
+        gnc_tree_model_account_clear_cached_values (model, account);
+    else
+        gnc_tree_model_account_clear_cache (model);
+    LEAVE(" ");
+}
+
+/** This function is the handler for the events of prices and
+ *  commodities.  The totals hold balances converted at the prices and
+ *  commodity fractions of the time, so any change to those drops the
+ *  tracked balances and tells the views that every row changed.
+ *
+ *  @internal
+ *
+ *  @param entity The affected price or commodity.
+ *
+ *  @param event_type The events that were generated for it.
+ *
+ *  @param model A pointer to the account tree model.
+ *
+ *  @param event_data Unused.
+ */
+static void
+gnc_tree_model_account_price_handler (QofInstance *entity,
+                                      QofEventId event_type,
+                                      GncTreeModelAccount *model,
+                                      gpointer event_data)
+{
+    GncTreeModelAccountPrivate *priv;
+
+    g_return_if_fail (model);    /* Required */
+
+    priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
+
+    /* Already dropped: the next use converts at the new prices. */
+    if (!priv->balances_valid || qof_instance_get_book (entity) != priv->book)
+        return;
+
+    ENTER("entity %p, events %x, model %p", entity, event_type, model);
+    gnc_tree_model_account_clear_cache (model);
+    LEAVE(" ");
+}
@@ -0,0 +1,162 @@
+/********************************************************************
+ * test-component-manager.cpp: test suite for the component manager *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, you can retrieve it from        *
+ * https://www.gnu.org/licenses/old-licenses/gpl-2.0.html            *
+ * or contact:                                                      *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+#include "config.h"
+#include <glib.h>
+// GoogleTest is written in C++, however, the functions we test in C.
+#include "../gnc-component-manager.h"
+#include <Account.h>
+#include <Transaction.h>
+#include <gtest/gtest.h>
+#include <vector>
+
+static void
+count_refresh (GHashTable *changes, gpointer user_data)
+{
+    ++*static_cast<int*>(user_data);
+}
+
+class ComponentManagerTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        gnc_component_manager_init();
+        m_book = qof_book_new();
+        m_account = xaccMallocAccount(m_book);
+        m_trans = xaccMallocTransaction(m_book);
+    }
+
+    void TearDown() override
+    {
+        for (auto id : m_ids)
+            gnc_unregister_gui_component(id);
+        gnc_component_manager_shutdown();
+        qof_book_destroy(m_book);
+    }
+
+    gint add_component(int *refreshes)
+    {
+        auto id = gnc_register_gui_component("test-component", count_refresh,
+                                             nullptr, refreshes);
+        m_ids.push_back(id);
+        return id;
+    }
+
+    void modify(gpointer entity)
+    {
+        qof_event_gen(QOF_INSTANCE(entity), QOF_EVENT_MODIFY, nullptr);
+    }
+
+    QofBook *m_book;
+    Account *m_account; // owned by m_book
+    Transaction *m_trans; // owned by m_book
+    std::vector<gint> m_ids;
+};
+
+TEST_F(ComponentManagerTest, RefreshesMatchingWatches) {
+    auto guid = xaccAccountGetGUID(m_account);
+    int by_entity = 0, by_type = 0, other_event = 0, unwatched = 0;
+
+    auto entity_id = add_component(&by_entity);
+    gnc_gui_component_watch_entity(entity_id, guid, QOF_EVENT_MODIFY);
+    auto type_id = add_component(&by_type);
+    gnc_gui_component_watch_entity_type(type_id, GNC_ID_TRANS,
+                                        QOF_EVENT_MODIFY | QOF_EVENT_DESTROY);
+    auto other_id = add_component(&other_event);
+    gnc_gui_component_watch_entity(other_id, guid, QOF_EVENT_DESTROY);
+    add_component(&unwatched);
+
+    modify(m_account);
+    EXPECT_EQ(by_entity, 1);
+    EXPECT_EQ(by_type, 0);
+    EXPECT_EQ(other_event, 0);
+
+    modify(m_trans);
+    EXPECT_EQ(by_entity, 1);
+    EXPECT_EQ(by_type, 1);
+
+    // Changed and cleared watches are followed.
+    gnc_gui_component_clear_watches(entity_id);
+    gnc_gui_component_watch_entity(other_id, guid, QOF_EVENT_MODIFY);
+    modify(m_account);
+    EXPECT_EQ(by_entity, 1);
+    EXPECT_EQ(other_event, 1);
+
+    gnc_gui_component_watch_entity_type(type_id, GNC_ID_TRANS, 0);
+    modify(m_trans);
+    EXPECT_EQ(by_type, 1);
+    EXPECT_EQ(unwatched, 0);
+
+    // A forced refresh reaches every component.
+    gnc_gui_refresh_all();
+    EXPECT_EQ(by_entity, 2);
+    EXPECT_EQ(by_type, 2);
+    EXPECT_EQ(other_event, 2);
+    EXPECT_EQ(unwatched, 1);
+}
+
+TEST_F(ComponentManagerTest, UnregisteredComponentsAreDropped) {
+    int first = 0, second = 0;
+    auto first_id = add_component(&first);
+    gnc_gui_component_watch_entity_type(first_id, GNC_ID_ACCOUNT,
+                                        QOF_EVENT_MODIFY);
+    auto second_id = add_component(&second);
+    gnc_gui_component_watch_entity_type(second_id, GNC_ID_ACCOUNT,
+                                        QOF_EVENT_MODIFY);
+
+    gnc_unregister_gui_component(first_id);
+    m_ids.erase(m_ids.begin());
+    modify(m_account);
+    EXPECT_EQ(first, 0);
+    EXPECT_EQ(second, 1);
+}
+
+/* The watch indexes go at shutdown. A component still open then can
+ * drop its watches and be unregistered, and if the manager starts
+ * again, its watches are indexed anew. */
+TEST_F(ComponentManagerTest, WatchesOutliveShutdown) {
+    int refreshes = 0;
+    auto id = add_component(&refreshes);
+    gnc_gui_component_watch_entity(id, xaccAccountGetGUID(m_account),
+                                   QOF_EVENT_MODIFY);
+
+    gnc_component_manager_shutdown();
+    gnc_gui_component_watch_entity_type(id, GNC_ID_TRANS, QOF_EVENT_MODIFY);
+    modify(m_account);
+    EXPECT_EQ(refreshes, 0);
+
+    gnc_component_manager_init();
+    modify(m_account);
+    EXPECT_EQ(refreshes, 1);
+    modify(m_trans);
+    EXPECT_EQ(refreshes, 2);
+
+    gnc_component_manager_shutdown();
+    gnc_gui_component_clear_watches(id);
+    gnc_unregister_gui_component(id);
+    m_ids.clear();
+    gnc_component_manager_init();
+
+    modify(m_account);
+    modify(m_trans);
+    EXPECT_EQ(refreshes, 2);
+}
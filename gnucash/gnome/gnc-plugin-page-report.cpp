@@ -1502,6 +1502,9 @@ gnc_plugin_page_report_stop_cb (GSimpleAction *simple,
 
     priv = GNC_PLUGIN_PAGE_REPORT_GET_PRIVATE(report);
     gnc_html_cancel(priv->html);
+    /* The report is rendered from within the main loop, which the
+     * progress bar runs; this makes its next progress update stop it. */
+    gnc_report_cancel();
 }
 
 /* Returns SCM_BOOL_F if cancel. Returns SCM_BOOL_T if html.
@@ -164,7 +164,16 @@ gnc_report_system_report_stream_cb (const char *location, char ** data, int *len
          gnc_run_report_id_string_with_error_handling (location, data,
                                                        &captured_str);
 
-    if (!ok)
+    if (!ok && gnc_report_cancelled ())
+    {
+        *data = g_strdup_printf ("<html><body><h3>%s</h3>"
+                                 "<p>%s</p></body></html>",
+                                 _("Report cancelled"),
+                                 _("Reload the report to run it again."));
+        g_free (captured_str);
+        scm_c_eval_string ("(gnc:report-finished)");
+    }
+    else if (!ok)
     {
         char *sanitized = html_sanitize (captured_str);
         *data = g_strdup_printf ("<html><body><h3>%s</h3>"
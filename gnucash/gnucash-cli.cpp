@@ -66,6 +66,19 @@ namespace Gnucash {
         boost::optional <std::string> m_report_name;
         boost::optional <std::string> m_export_type;
         boost::optional <std::string> m_output_file;
+
+        boost::optional <std::string> m_import_file;
+        boost::optional <std::string> m_import_preset;
+        boost::optional <int> m_add_threshold;
+        boost::optional <int> m_clear_threshold;
+        boost::optional <int> m_match_threshold;
+        boost::optional <int> m_date_limit;
+
+        std::vector<std::string> m_replay_logs;
+
+        boost::optional <std::string> m_export_format;
+
+        boost::optional <std::string> m_trace_file;
     };
 
 }
@@ -85,6 +98,9 @@ Gnucash::GnucashCli::parse_command_line (int argc, char **argv)
 
     if (m_namespace)
         gnc_prefs_set_namespace_regexp (m_namespace->c_str());
+
+    if (m_trace_file)
+        qof_trace_init (m_trace_file->c_str());
 }
 
 // Define command line options specific to gnucash-cli.
@@ -124,6 +140,59 @@ may be specified to describe some saved options.\n"
     m_opt_desc_display->add (report_options);
     m_opt_desc_all.add (report_options);
 
+    bpo::options_description import_options(_("Transaction Import Options"));
+    import_options.add_options()
+    ("import,I", bpo::value (&m_import_file),
+     _("Import the transactions in the given CSV file into the given GnuCash "
+       "datafile without user interaction, using the import preset named with "
+       "--preset. Each transaction gets the action the import matcher would "
+       "propose, based on its preferences unless overridden by the options below, "
+       "and the datafile is saved afterwards.\n"))
+    ("preset", bpo::value (&m_import_preset),
+     _("Name of the saved CSV transaction import preset to use\n"))
+    ("add-threshold", bpo::value (&m_add_threshold),
+     _("Add imported transactions whose best match scores this or less as new ones\n"))
+    ("clear-threshold", bpo::value (&m_clear_threshold),
+     _("Reconcile the best match of imported transactions for which it scores this or more\n"))
+    ("match-threshold", bpo::value (&m_match_threshold),
+     _("Ignore matches scoring less than this\n"))
+    ("date-limit", bpo::value (&m_date_limit),
+     _("Ignore matches posted more than this many days from the imported transactions\n"));
+    m_opt_desc_display->add (import_options);
+    m_opt_desc_all.add (import_options);
+
+    bpo::options_description replay_options(_("Transaction Log Options"));
+    replay_options.add_options()
+    ("replay-log", bpo::value (&m_replay_logs)->composing(),
+     _("Replay the transactions in the given .log file into the given GnuCash "
+       "datafile and save it, for example to recover the changes made after the "
+       "last save before a crash. May be given several times; the files are "
+       "read in the order given, which should be the order they were written.\n"));
+    m_opt_desc_display->add (replay_options);
+    m_opt_desc_all.add (replay_options);
+
+    bpo::options_description export_options(_("Transaction Export Options"));
+    export_options.add_options()
+    ("export", bpo::value (&m_export_format),
+     _("Export the given GnuCash datafile to --output-file, in the given format:\n"
+       "  csv    all transactions, as the transaction export assistant does with "
+       "its default settings.\n"
+       "  arrow  accounts, commodities, prices, transactions and splits as typed "
+       "Apache Arrow files, in the directory named with --output-file.\n"));
+    m_opt_desc_display->add (export_options);
+    m_opt_desc_all.add (export_options);
+
+    bpo::options_description trace_options(_("Tracing Options"));
+    trace_options.add_options()
+    ("trace", bpo::value (&m_trace_file),
+     _("Record timings of book loading and saving, queries, balance computation, "
+       "event dispatch and report runs and write them on exit. A file name ending "
+       "in \".json\" receives Chrome trace events, \"stderr\" or any other file "
+       "name a summary table. Setting the GNC_TRACE environment variable to the "
+       "same values has the same effect.\n"));
+    m_opt_desc_display->add (trace_options);
+    m_opt_desc_all.add (trace_options);
+
 }
 
 int
@@ -217,6 +286,53 @@ Gnucash::GnucashCli::start ([[maybe_unused]] int argc, [[maybe_unused]] char **a
         }
     }
 
+    if (m_import_file)
+    {
+        if (!m_file_to_load || m_file_to_load->empty())
+        {
+            std::cerr << _("Missing data file parameter") << "\n\n"
+                      << *m_opt_desc_display.get() << std::endl;
+            return 1;
+        }
+        if (!m_import_preset || m_import_preset->empty())
+        {
+            std::cerr << _("Missing --preset parameter") << "\n\n"
+                      << *m_opt_desc_display.get() << std::endl;
+            return 1;
+        }
+        return Gnucash::run_import (m_file_to_load, m_import_file, m_import_preset,
+                                    m_add_threshold, m_clear_threshold,
+                                    m_match_threshold, m_date_limit);
+    }
+
+    if (!m_replay_logs.empty())
+    {
+        if (!m_file_to_load || m_file_to_load->empty())
+        {
+            std::cerr << _("Missing data file parameter") << "\n\n"
+                      << *m_opt_desc_display.get() << std::endl;
+            return 1;
+        }
+        return Gnucash::replay_logs (m_file_to_load, m_replay_logs);
+    }
+
+    if (m_export_format)
+    {
+        if (!m_file_to_load || m_file_to_load->empty())
+        {
+            std::cerr << _("Missing data file parameter") << "\n\n"
+                      << *m_opt_desc_display.get() << std::endl;
+            return 1;
+        }
+        if (!m_output_file || m_output_file->empty())
+        {
+            std::cerr << _("Missing --output-file parameter") << "\n\n"
+                      << *m_opt_desc_display.get() << std::endl;
+            return 1;
+        }
+        return Gnucash::run_export (m_file_to_load, m_export_format, m_output_file);
+    }
+
     std::cerr << _("Missing command or option") << "\n\n"
               << *m_opt_desc_display.get() << std::endl;
 
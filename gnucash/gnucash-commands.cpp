@@ -41,11 +41,23 @@
 #include <qoflog.h>
 
 #include <boost/locale.hpp>
+#include <chrono>
+#include <functional>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <utility>
+#include <vector>
 #include <gnc-report.h>
 #include <gnc-quotes.hpp>
+#include <gnc-state.h>
+#include <import-auto-matcher.h>
+#include <import-settings.h>
+#include <gnc-import-tx.hpp>
+#include <gnc-imp-settings-csv-tx.hpp>
+#include <gnc-translog-replay.hpp>
+#include <csv-transactions-export.h>
+#include <gnc-arrow-export.hpp>
 
 namespace bl = boost::locale;
 
@@ -426,3 +438,279 @@ Gnucash::report_list (void)
     scm_boot_guile (0, nullptr, scm_report_list, NULL);
     return 0;
 }
+
+static const CsvTransImpSettings*
+find_import_preset (const std::string& name)
+{
+    for (const auto& preset : get_import_presets_trans ())
+        if (preset->m_name == name || _(preset->m_name.c_str()) == name)
+            return preset.get();
+    return nullptr;
+}
+
+static double
+elapsed_ms (std::chrono::steady_clock::time_point start)
+{
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+/* The steps of a command with how long each took, in milliseconds */
+using Timings = std::vector<std::pair<std::string, double>>;
+
+/* Open file_to_load, hand its session to run and save the book unless it
+ * was opened read only, then print how long loading, each step run added
+ * to the timings and saving took. run prints why it failed if it returns
+ * false. */
+static int
+run_on_book (const std::string& file_to_load, SessionOpenMode mode,
+             const std::function<bool(QofSession*, Timings&)>& run)
+{
+    gnc_prefs_init ();
+    qof_event_suspend();
+
+    auto session = gnc_get_current_session();
+    if (!session)
+        return 1;
+
+    auto start = std::chrono::steady_clock::now();
+    qof_session_begin(session, file_to_load.c_str(), mode);
+    if (qof_session_get_error(session) != ERR_BACKEND_NO_ERR)
+        return cleanup_and_exit_with_failure (session);
+
+    qof_session_load(session, NULL);
+    if (qof_session_get_error(session) != ERR_BACKEND_NO_ERR)
+        return cleanup_and_exit_with_failure (session);
+    Timings timings {{_("load"), elapsed_ms (start)}};
+
+    if (!run (session, timings))
+        return cleanup_and_exit_with_failure (session);
+
+    if (mode != SESSION_READ_ONLY)
+    {
+        start = std::chrono::steady_clock::now();
+        qof_session_save(session, NULL);
+        if (qof_session_get_error(session) != ERR_BACKEND_NO_ERR)
+            return cleanup_and_exit_with_failure (session);
+        timings.emplace_back (_("save"), elapsed_ms (start));
+    }
+
+    auto separator = " ";
+    std::cout << bl::translate ("Timings (ms):") << std::fixed << std::setprecision (1);
+    for (const auto& [step, ms] : timings)
+    {
+        std::cout << separator << step << " " << ms;
+        separator = ", ";
+    }
+    std::cout << std::endl;
+
+    qof_session_destroy(session);
+    qof_event_resume();
+    return 0;
+}
+
+int
+Gnucash::run_import (const bo_str& file_to_load,
+                     const bo_str& import_file,
+                     const bo_str& preset_name,
+                     const bo_int& add_threshold,
+                     const bo_int& clear_threshold,
+                     const bo_int& match_threshold,
+                     const bo_int& date_limit)
+{
+    return run_on_book (*file_to_load, SESSION_NORMAL_OPEN,
+                        [&](QofSession *session, Timings& timings)
+    {
+        /* The presets are kept in the book's state file. */
+        gnc_state_load (session);
+        auto preset = find_import_preset (*preset_name);
+        if (!preset)
+        {
+            std::cerr << bl::format (bl::translate ("Unknown import preset '{1}'. Available presets:")) % *preset_name << "\n";
+            for (const auto& p : get_import_presets_trans ())
+                std::cerr << "  " << _(p->m_name.c_str()) << "\n";
+            return false;
+        }
+        if (preset->m_load_error)
+        {
+            std::cerr << bl::format (bl::translate ("Import preset '{1}' could not be loaded completely.")) % *preset_name << std::endl;
+            return false;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        GncTxImport tx_imp;
+        try
+        {
+            tx_imp.file_format (GncImpFileFormat::CSV);
+            tx_imp.load_file (*import_file);
+            tx_imp.tokenize (true);
+            tx_imp.settings (*preset);
+            tx_imp.create_transactions ();
+        }
+        catch (const std::ifstream::failure& err)
+        {
+            std::cerr << err.what() << std::endl;
+            return false;
+        }
+        catch (const std::range_error& err)
+        {
+            std::cerr << _(err.what()) << std::endl;
+            return false;
+        }
+        catch (const std::invalid_argument& err)
+        {
+            std::cerr << bl::translate ("The import file doesn't match the preset:") << "\n"
+                      << err.what() << std::endl;
+            return false;
+        }
+        catch (const GncCsvImpParseError& err)
+        {
+            std::cerr << err.what() << std::endl;
+            for (const auto& [prop, msg] : err.errors())
+                std::cerr << "• " << msg << "\n";
+            return false;
+        }
+        timings.emplace_back (_("parse"), elapsed_ms (start));
+
+        start = std::chrono::steady_clock::now();
+        auto settings = gnc_import_Settings_new ();
+        if (add_threshold)
+            gnc_import_Settings_set_add_threshold (settings, *add_threshold);
+        if (clear_threshold)
+            gnc_import_Settings_set_clear_threshold (settings, *clear_threshold);
+        if (match_threshold)
+            gnc_import_Settings_set_display_threshold (settings, *match_threshold);
+        if (date_limit)
+            gnc_import_Settings_set_match_date_hardlimit (settings, *date_limit);
+
+        auto matcher = gnc_import_auto_matcher_new (settings);
+        auto num_trans = 0u;
+        for (auto& [date, draft_trans] : tx_imp.m_transactions)
+        {
+            if (!draft_trans->trans)
+                continue;
+            auto lsplit = draft_trans->last_split_info ();
+            gnc_import_auto_matcher_add_trans (matcher, draft_trans->trans, &lsplit);
+            draft_trans->trans = nullptr;
+            ++num_trans;
+        }
+
+        GNCImportAutoMatcherCounts counts;
+        gnc_import_auto_matcher_run (matcher, &counts);
+        gnc_import_auto_matcher_delete (matcher);
+        gnc_import_Settings_delete (settings);
+        timings.emplace_back (_("match and commit"), elapsed_ms (start));
+
+        std::cout << bl::format (bl::translate ("Read {1} transactions from {2}.")) % num_trans % *import_file << "\n"
+                  << bl::format (bl::translate ("  Already imported: {1}")) % counts.duplicates << "\n"
+                  << bl::format (bl::translate ("  Added:            {1} ({2} without a transfer account)")) % counts.added % counts.unbalanced << "\n"
+                  << bl::format (bl::translate ("  Reconciled:       {1}")) % counts.cleared << "\n"
+                  << bl::format (bl::translate ("  Updated:          {1}")) % counts.updated << "\n"
+                  << bl::format (bl::translate ("  Skipped:          {1}")) % counts.skipped << std::endl;
+        return true;
+    });
+}
+
+int
+Gnucash::replay_logs (const bo_str& file_to_load, const StrVec& log_files)
+{
+    return run_on_book (*file_to_load, SESSION_NORMAL_OPEN,
+                        [&](QofSession *session, Timings& timings)
+    {
+        auto start = std::chrono::steady_clock::now();
+        GncTransLogReplay replay {qof_session_get_book (session)};
+        for (const auto& log_file : log_files)
+        {
+            try
+            {
+                replay.read (log_file);
+            }
+            catch (const std::runtime_error& err)
+            {
+                std::cerr << log_file << ": " << err.what() << std::endl;
+                return false;
+            }
+        }
+        timings.emplace_back (_("read"), elapsed_ms (start));
+
+        start = std::chrono::steady_clock::now();
+        auto num_trans = replay.size();
+        auto counts = replay.apply();
+        timings.emplace_back (_("apply"), elapsed_ms (start));
+
+        std::cout << bl::format (bl::translate ("Read {1} records about {2} transactions.")) % replay.records() % num_trans << "\n";
+        if (replay.incomplete())
+            std::cout << bl::format (bl::translate ("Dropped {1} records cut short.")) % replay.incomplete() << "\n";
+        std::cout << bl::format (bl::translate ("  Created:   {1}")) % counts.created << "\n"
+                  << bl::format (bl::translate ("  Changed:   {1}")) % counts.changed << "\n"
+                  << bl::format (bl::translate ("  Deleted:   {1}")) % counts.deleted << "\n"
+                  << bl::format (bl::translate ("  Not found: {1}")) % counts.not_found << std::endl;
+        return true;
+    });
+}
+
+/* The transactions of every account, in the layout with a line per
+ * split, as the export assistant does with its defaults. */
+static bool
+export_csv (QofBook *book, const std::string& output_file)
+{
+    auto root = gnc_book_get_root_account (book);
+    CsvExportInfo info {};
+    info.export_type = XML_EXPORT_TRANS;
+    info.csvd.start_time = MINTIME;
+    info.csvd.end_time = MAXTIME;
+    info.csva.account_list = gnc_account_get_descendants_sorted (root);
+    info.file_name = g_strdup (output_file.c_str());
+    info.separator_str = g_strdup (",");
+    csv_transactions_export (&info);
+    g_list_free (info.csva.account_list);
+    g_free (info.file_name);
+    g_free (info.separator_str);
+
+    if (info.failed)
+        std::cerr << bl::format (bl::translate ("Failed to write {1}.")) % output_file << std::endl;
+    return !info.failed;
+}
+
+static bool
+export_arrow (QofBook *book, const std::string& output_dir)
+{
+    try
+    {
+        auto counts = gnc_arrow_export_book (book, output_dir);
+        std::cout << bl::format (bl::translate ("Exported {1} accounts, {2} commodities, "
+                                                "{3} prices, {4} transactions and {5} splits."))
+            % counts.accounts % counts.commodities % counts.prices
+            % counts.transactions % counts.splits << std::endl;
+        return true;
+    }
+    catch (const std::runtime_error& err)
+    {
+        std::cerr << err.what() << std::endl;
+        return false;
+    }
+}
+
+int
+Gnucash::run_export (const bo_str& file_to_load,
+                     const bo_str& export_format,
+                     const bo_str& output_file)
+{
+    if (*export_format != "csv" && *export_format != "arrow")
+    {
+        std::cerr << bl::format (bl::translate ("Unknown export format '{1}'")) % *export_format << std::endl;
+        return 1;
+    }
+
+    return run_on_book (*file_to_load, SESSION_READ_ONLY,
+                        [&](QofSession *session, Timings& timings)
+    {
+        auto start = std::chrono::steady_clock::now();
+        auto book = qof_session_get_book (session);
+        auto exported = *export_format == "csv" ? export_csv (book, *output_file) :
+            export_arrow (book, *output_file);
+        timings.emplace_back (_("export"), elapsed_ms (start));
+        return exported;
+    });
+}
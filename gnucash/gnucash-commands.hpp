@@ -30,6 +30,7 @@
 #include <boost/optional.hpp>
 
 using bo_str = boost::optional <std::string>;
+using bo_int = boost::optional <int>;
 using StrVec = std::vector<std::string>;
 
 namespace Gnucash {
@@ -46,5 +47,17 @@ namespace Gnucash {
     int report_list (void);
     int report_show (const bo_str& file_to_load,
                      const bo_str& run_report);
+    int run_import (const bo_str& file_to_load,
+                    const bo_str& import_file,
+                    const bo_str& preset_name,
+                    const bo_int& add_threshold,
+                    const bo_int& clear_threshold,
+                    const bo_int& match_threshold,
+                    const bo_int& date_limit);
+    int replay_logs (const bo_str& file_to_load,
+                     const StrVec& log_files);
+    int run_export (const bo_str& file_to_load,
+                    const bo_str& export_format,
+                    const bo_str& output_file);
 }
 #endif
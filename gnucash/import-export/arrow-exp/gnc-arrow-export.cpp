@@ -0,0 +1,361 @@
+/********************************************************************\
+ * gnc-arrow-export.cpp -- Export a book as Arrow files.            *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+/** @addtogroup Import_Export
+    @{ */
+/** @file gnc-arrow-export.cpp
+ *  @brief Export the general ledger of a book as Arrow files.
+ */
+
+#include <config.h>
+
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+
+#include "gnc-arrow-export.hpp"
+#include "gnc-arrow-writer.hpp"
+
+#include "Account.h"
+#include "Split.h"
+#include "Transaction.h"
+#include "gnc-commodity.h"
+#include "gnc-pricedb.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+static QofLogModule log_module = "gnc.export.arrow";
+
+namespace
+{
+
+class GuidString
+{
+public:
+    explicit GuidString (const QofInstance *inst)
+    {
+        guid_to_string_buff (qof_instance_get_guid (inst), m_buf);
+    }
+    std::string_view view () const noexcept { return {m_buf, GUID_ENCODING_LENGTH}; }
+
+private:
+    char m_buf[GUID_ENCODING_LENGTH + 1];
+};
+
+/* What the splits need of their account, found once per account. */
+struct AccountInfo
+{
+    std::string guid;
+    std::string full_name;
+};
+
+using AccountMap = std::unordered_map<const Account*, AccountInfo>;
+
+void
+append_string_or_null (GncArrowTable& table, size_t col, const char *str)
+{
+    if (str)
+        table.append_string (col, str);
+    else
+        table.append_null (col);
+}
+
+void
+append_commodity (GncArrowTable& table, size_t col, const gnc_commodity *comm)
+{
+    append_string_or_null (table, col, comm ? gnc_commodity_get_unique_name (comm) : nullptr);
+}
+
+std::string
+file_path (const std::string& directory, const char *name)
+{
+    auto path = g_build_filename (directory.c_str (), name, nullptr);
+    std::string rv {path};
+    g_free (path);
+    return rv;
+}
+
+size_t
+export_accounts (QofBook *book, const std::string& directory, AccountMap& accounts)
+{
+    GncArrowTable table;
+    auto guid = table.add_column ("guid", GncArrowType::STRING);
+    auto name = table.add_column ("name", GncArrowType::STRING);
+    auto full_name = table.add_column ("full_name", GncArrowType::STRING);
+    auto parent_guid = table.add_column ("parent_guid", GncArrowType::STRING, true);
+    auto type = table.add_column ("type", GncArrowType::DICTIONARY);
+    auto commodity = table.add_column ("commodity", GncArrowType::DICTIONARY, true);
+    auto code = table.add_column ("code", GncArrowType::STRING, true);
+    auto description = table.add_column ("description", GncArrowType::STRING, true);
+    auto placeholder = table.add_column ("placeholder", GncArrowType::BOOL);
+    auto hidden = table.add_column ("hidden", GncArrowType::BOOL);
+
+    auto root = gnc_book_get_root_account (book);
+    auto descendants = gnc_account_get_descendants_sorted (root);
+    for (auto node = descendants; node; node = g_list_next (node))
+    {
+        auto acc = static_cast<Account*>(node->data);
+        auto acc_full_name = gnc_account_get_full_name (acc);
+        auto& info = accounts[acc];
+        info.guid = GuidString {QOF_INSTANCE (acc)}.view ();
+        info.full_name = acc_full_name;
+        g_free (acc_full_name);
+
+        table.append_string (guid, info.guid);
+        table.append_string (name, xaccAccountGetName (acc));
+        table.append_string (full_name, info.full_name);
+        auto parent = gnc_account_get_parent (acc);
+        if (parent != root)
+            table.append_string (parent_guid, GuidString {QOF_INSTANCE (parent)}.view ());
+        table.append_string (type, xaccAccountTypeEnumAsString (xaccAccountGetType (acc)));
+        append_commodity (table, commodity, xaccAccountGetCommodity (acc));
+        append_string_or_null (table, code, xaccAccountGetCode (acc));
+        append_string_or_null (table, description, xaccAccountGetDescription (acc));
+        table.append_bool (placeholder, xaccAccountGetPlaceholder (acc));
+        table.append_bool (hidden, xaccAccountGetHidden (acc));
+        table.end_row ();
+    }
+    g_list_free (descendants);
+
+    table.write (file_path (directory, "accounts.arrow"));
+    return table.rows ();
+}
+
+size_t
+export_commodities (QofBook *book, const std::string& directory)
+{
+    GncArrowTable table;
+    auto unique_name = table.add_column ("unique_name", GncArrowType::STRING);
+    auto name_space = table.add_column ("namespace", GncArrowType::DICTIONARY);
+    auto mnemonic = table.add_column ("mnemonic", GncArrowType::STRING);
+    auto fullname = table.add_column ("fullname", GncArrowType::STRING, true);
+    auto cusip = table.add_column ("cusip", GncArrowType::STRING, true);
+    auto fraction = table.add_column ("fraction", GncArrowType::INT64);
+
+    auto comm_table = gnc_commodity_table_get_table (book);
+    std::vector<gnc_commodity*> commodities;
+    auto namespaces = gnc_commodity_table_get_namespaces (comm_table);
+    for (auto ns = namespaces; ns; ns = g_list_next (ns))
+    {
+        auto ns_name = static_cast<const char*>(ns->data);
+        if (g_strcmp0 (ns_name, GNC_COMMODITY_NS_TEMPLATE) == 0)
+            continue;
+        auto list = gnc_commodity_table_get_commodities (comm_table, ns_name);
+        for (auto node = list; node; node = g_list_next (node))
+            commodities.push_back (static_cast<gnc_commodity*>(node->data));
+        g_list_free (list);
+    }
+    g_list_free (namespaces);
+    std::sort (commodities.begin (), commodities.end (),
+               [](auto a, auto b)
+               {
+                   return g_strcmp0 (gnc_commodity_get_unique_name (a),
+                                     gnc_commodity_get_unique_name (b)) < 0;
+               });
+
+    for (auto comm : commodities)
+    {
+        table.append_string (unique_name, gnc_commodity_get_unique_name (comm));
+        table.append_string (name_space, gnc_commodity_get_namespace (comm));
+        table.append_string (mnemonic, gnc_commodity_get_mnemonic (comm));
+        append_string_or_null (table, fullname, gnc_commodity_get_fullname (comm));
+        append_string_or_null (table, cusip, gnc_commodity_get_cusip (comm));
+        table.append_int64 (fraction, gnc_commodity_get_fraction (comm));
+        table.end_row ();
+    }
+
+    table.write (file_path (directory, "commodities.arrow"));
+    return table.rows ();
+}
+
+struct PriceColumns
+{
+    GncArrowTable table;
+    size_t guid = table.add_column ("guid", GncArrowType::STRING);
+    size_t commodity = table.add_column ("commodity", GncArrowType::DICTIONARY);
+    size_t currency = table.add_column ("currency", GncArrowType::DICTIONARY);
+    size_t date = table.add_column ("date", GncArrowType::TIMESTAMP);
+    size_t source = table.add_column ("source", GncArrowType::DICTIONARY);
+    size_t type = table.add_column ("type", GncArrowType::DICTIONARY, true);
+    size_t value_num = table.add_column ("value_num", GncArrowType::INT64);
+    size_t value_denom = table.add_column ("value_denom", GncArrowType::INT64);
+};
+
+gboolean
+add_price (GNCPrice *price, gpointer data)
+{
+    auto cols = static_cast<PriceColumns*>(data);
+    auto& table = cols->table;
+    auto value = gnc_price_get_value (price);
+    table.append_string (cols->guid, GuidString {QOF_INSTANCE (price)}.view ());
+    append_commodity (table, cols->commodity, gnc_price_get_commodity (price));
+    append_commodity (table, cols->currency, gnc_price_get_currency (price));
+    table.append_int64 (cols->date, gnc_price_get_time64 (price));
+    table.append_string (cols->source, gnc_price_get_source_string (price));
+    append_string_or_null (table, cols->type, gnc_price_get_typestr (price));
+    table.append_int64 (cols->value_num, value.num);
+    table.append_int64 (cols->value_denom, value.denom);
+    table.end_row ();
+    return TRUE;
+}
+
+size_t
+export_prices (QofBook *book, const std::string& directory)
+{
+    PriceColumns cols;
+    gnc_pricedb_foreach_price (gnc_pricedb_get_db (book), add_price, &cols, TRUE);
+    cols.table.write (file_path (directory, "prices.arrow"));
+    return cols.table.rows ();
+}
+
+std::pair<size_t, size_t>
+export_transactions (QofBook *book, const std::string& directory,
+                     const AccountMap& accounts)
+{
+    GncArrowTable trans_table;
+    auto t_guid = trans_table.add_column ("guid", GncArrowType::STRING);
+    auto t_currency = trans_table.add_column ("currency", GncArrowType::DICTIONARY, true);
+    auto t_num = trans_table.add_column ("num", GncArrowType::STRING);
+    auto t_description = trans_table.add_column ("description", GncArrowType::STRING);
+    auto t_notes = trans_table.add_column ("notes", GncArrowType::STRING, true);
+    auto t_date_posted = trans_table.add_column ("date_posted", GncArrowType::TIMESTAMP);
+    auto t_date_entered = trans_table.add_column ("date_entered", GncArrowType::TIMESTAMP);
+    auto t_voided = trans_table.add_column ("voided", GncArrowType::BOOL);
+
+    GncArrowTable split_table;
+    auto s_guid = split_table.add_column ("guid", GncArrowType::STRING);
+    auto s_trans_guid = split_table.add_column ("transaction_guid", GncArrowType::STRING);
+    auto s_account_guid = split_table.add_column ("account_guid", GncArrowType::DICTIONARY, true);
+    auto s_account = split_table.add_column ("account", GncArrowType::DICTIONARY, true);
+    auto s_memo = split_table.add_column ("memo", GncArrowType::STRING);
+    auto s_action = split_table.add_column ("action", GncArrowType::STRING);
+    auto s_reconcile = split_table.add_column ("reconcile", GncArrowType::DICTIONARY);
+    auto s_reconcile_date = split_table.add_column ("reconcile_date", GncArrowType::TIMESTAMP, true);
+    auto s_amount_num = split_table.add_column ("amount_num", GncArrowType::INT64);
+    auto s_amount_denom = split_table.add_column ("amount_denom", GncArrowType::INT64);
+    auto s_value_num = split_table.add_column ("value_num", GncArrowType::INT64);
+    auto s_value_denom = split_table.add_column ("value_denom", GncArrowType::INT64);
+
+    /* Transactions in the usual register order, so that exports of the
+     * same book are the same. */
+    std::vector<Transaction*> transactions;
+    qof_collection_foreach (qof_book_get_collection (book, GNC_ID_TRANS),
+                            [](QofInstance *inst, gpointer data)
+                            {
+                                static_cast<std::vector<Transaction*>*>(data)->push_back
+                                    (GNC_TRANSACTION (inst));
+                            }, &transactions);
+    std::sort (transactions.begin (), transactions.end (),
+               [](auto a, auto b) { return xaccTransOrder (a, b) < 0; });
+
+    for (auto trans : transactions)
+    {
+        auto splits = xaccTransGetSplitList (trans);
+        /* Template transactions have their splits in the template
+         * accounts, which aren't in the book's account tree. */
+        bool in_book = !splits;
+        for (auto node = splits; node && !in_book; node = g_list_next (node))
+            in_book = accounts.count (xaccSplitGetAccount (static_cast<Split*>(node->data)));
+        if (!in_book)
+            continue;
+
+        GuidString trans_guid {QOF_INSTANCE (trans)};
+        auto notes = xaccTransGetNotes (trans);
+        trans_table.append_string (t_guid, trans_guid.view ());
+        append_commodity (trans_table, t_currency, xaccTransGetCurrency (trans));
+        trans_table.append_string (t_num, xaccTransGetNum (trans));
+        trans_table.append_string (t_description, xaccTransGetDescription (trans));
+        append_string_or_null (trans_table, t_notes, notes && *notes ? notes : nullptr);
+        trans_table.append_int64 (t_date_posted, xaccTransGetDate (trans));
+        trans_table.append_int64 (t_date_entered, xaccTransGetDateEntered (trans));
+        trans_table.append_bool (t_voided, xaccTransGetVoidStatus (trans));
+        trans_table.end_row ();
+
+        for (auto node = splits; node; node = g_list_next (node))
+        {
+            auto split = static_cast<Split*>(node->data);
+            auto acc = accounts.find (xaccSplitGetAccount (split));
+            if (acc != accounts.end ())
+            {
+                split_table.append_string (s_account_guid, acc->second.guid);
+                split_table.append_string (s_account, acc->second.full_name);
+            }
+            auto reconcile = xaccSplitGetReconcile (split);
+            auto amount = xaccSplitGetAmount (split);
+            auto value = xaccSplitGetValue (split);
+            split_table.append_string (s_guid, GuidString {QOF_INSTANCE (split)}.view ());
+            split_table.append_string (s_trans_guid, trans_guid.view ());
+            split_table.append_string (s_memo, xaccSplitGetMemo (split));
+            split_table.append_string (s_action, xaccSplitGetAction (split));
+            split_table.append_string (s_reconcile, std::string (1, reconcile));
+            if (reconcile == YREC)
+                split_table.append_int64 (s_reconcile_date, xaccSplitGetDateReconciled (split));
+            split_table.append_int64 (s_amount_num, amount.num);
+            split_table.append_int64 (s_amount_denom, amount.denom);
+            split_table.append_int64 (s_value_num, value.num);
+            split_table.append_int64 (s_value_denom, value.denom);
+            split_table.end_row ();
+        }
+    }
+
+    trans_table.write (file_path (directory, "transactions.arrow"));
+    split_table.write (file_path (directory, "splits.arrow"));
+    return {trans_table.rows (), split_table.rows ()};
+}
+
+} // anonymous namespace
+
+GncArrowExportCounts
+gnc_arrow_export_book (QofBook *book, const std::string& directory)
+{
+    g_return_val_if_fail (book, GncArrowExportCounts {});
+    ENTER ("book %p, directory %s", book, directory.c_str ());
+
+    if (g_mkdir_with_parents (directory.c_str (), 0755) != 0)
+    {
+        auto msg = g_strdup_printf (_("Could not create directory %s: %s"),
+                                    directory.c_str (), strerror (errno));
+        std::runtime_error err {msg};
+        g_free (msg);
+        LEAVE ("%s", err.what ());
+        throw err;
+    }
+
+    GncArrowExportCounts counts;
+    AccountMap accounts;
+    counts.accounts = export_accounts (book, directory, accounts);
+    counts.commodities = export_commodities (book, directory);
+    counts.prices = export_prices (book, directory);
+    std::tie (counts.transactions, counts.splits) =
+        export_transactions (book, directory, accounts);
+
+    LEAVE ("%zu accounts, %zu commodities, %zu prices, %zu transactions, %zu splits",
+           counts.accounts, counts.commodities, counts.prices,
+           counts.transactions, counts.splits);
+    return counts;
+}
+
+/** @} */
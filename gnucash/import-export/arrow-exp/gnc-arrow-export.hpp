@@ -0,0 +1,80 @@
+/********************************************************************\
+ * gnc-arrow-export.hpp -- Export a book as Arrow files.            *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+/** @addtogroup Import_Export
+    @{ */
+/** @file gnc-arrow-export.hpp
+ *  @brief Export the general ledger of a book for analytics tools.
+ *
+ *  The book is written as five Arrow IPC files in a directory, one per
+ *  kind of object, each with its own typed columns:
+ *
+ *  - accounts.arrow: guid, name, full_name, parent_guid, type,
+ *    commodity, code, description, placeholder, hidden.
+ *  - commodities.arrow: unique_name, namespace, mnemonic, fullname,
+ *    cusip, fraction.
+ *  - prices.arrow: guid, commodity, currency, date, source, type,
+ *    value_num, value_denom.
+ *  - transactions.arrow: guid, currency, num, description, notes,
+ *    date_posted, date_entered, voided.
+ *  - splits.arrow: guid, transaction_guid, account_guid, account,
+ *    memo, action, reconcile, reconcile_date, amount_num,
+ *    amount_denom, value_num, value_denom.
+ *
+ *  The files join on the guid columns, and commodities are referred to
+ *  by their unique name, as "CURRENCY::USD". Amounts, values and prices
+ *  are exact, as numerator and denominator. Dates are timestamps in
+ *  seconds, UTC. Account, commodity, type and reconcile columns are
+ *  dictionary encoded.
+ *
+ *  Template transactions of scheduled transactions are left out.
+ */
+
+#ifndef GNC_ARROW_EXPORT_HPP
+#define GNC_ARROW_EXPORT_HPP
+
+#include "qof.h"
+
+#include <string>
+
+/** What gnc_arrow_export_book() wrote. */
+struct GncArrowExportCounts
+{
+    size_t accounts = 0;
+    size_t commodities = 0;
+    size_t prices = 0;
+    size_t transactions = 0;
+    size_t splits = 0;
+};
+
+/** Write the book's accounts, commodities, prices, transactions and
+ *  splits to Arrow files in a directory, in one pass over each. The
+ *  directory is created if it doesn't exist and files of the same name
+ *  in it are replaced.
+ *
+ *  @exception std::runtime_error with a translated message if the
+ *  directory or a file can't be written.
+ */
+GncArrowExportCounts gnc_arrow_export_book (QofBook *book,
+                                            const std::string& directory);
+
+#endif /* GNC_ARROW_EXPORT_HPP */
+/** @} */
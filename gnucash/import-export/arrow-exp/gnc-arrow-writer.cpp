@@ -0,0 +1,649 @@
+/********************************************************************\
+ * gnc-arrow-writer.cpp -- Write typed columns as Arrow IPC files.  *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+/** @addtogroup Import_Export
+    @{ */
+/** @file gnc-arrow-writer.cpp
+ *  @brief Arrow IPC file writer.
+ *
+ *  The file format is described at
+ *  https://arrow.apache.org/docs/format/Columnar.html. A file is
+ *
+ *      "ARROW1" padding
+ *      schema message
+ *      a dictionary batch message per dictionary column
+ *      record batch messages
+ *      end of stream marker
+ *      footer, footer length, "ARROW1"
+ *
+ *  Each message is a FlatBuffers encoded table followed by a body with
+ *  the column buffers, each padded to 8 bytes. The footer repeats the
+ *  schema and lists where the batches are.
+ */
+
+#include <config.h>
+
+#include <glib/gi18n.h>
+
+#include "gnc-arrow-writer.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+
+/* Just enough of a FlatBuffers builder for the Arrow metadata. Like the
+ * real one it builds back to front, children before their parents, so
+ * that every offset points forwards. The bytes are kept in reverse and
+ * objects are known by their distance from the end of the buffer. */
+class FlatBuilder
+{
+public:
+    using Offset = uint32_t;
+
+    template <typename T> void push (T value)
+    {
+        auto bits = static_cast<uint64_t>(value);
+        for (auto i = sizeof (T); i-- > 0;)
+            m_rev.push_back (static_cast<uint8_t>(bits >> (8 * i)));
+    }
+
+    /* Pad so that len more bytes end aligned. */
+    void pad (size_t len, size_t alignment)
+    {
+        m_minalign = std::max (m_minalign, alignment);
+        while ((m_rev.size () + len) % alignment)
+            m_rev.push_back (0);
+    }
+
+    template <typename T> void add_scalar (T value)
+    {
+        pad (sizeof (T), sizeof (T));
+        push (value);
+    }
+
+    void add_offset (Offset off)
+    {
+        pad (4, 4);
+        push<uint32_t>(m_rev.size () + 4 - off);
+    }
+
+    Offset add_string (std::string_view str)
+    {
+        pad (str.size () + 1, 4);
+        m_rev.push_back (0);
+        for (auto it = str.rbegin (); it != str.rend (); ++it)
+            m_rev.push_back (static_cast<uint8_t>(*it));
+        push<uint32_t>(str.size ());
+        return size ();
+    }
+
+    Offset add_offset_vector (const std::vector<Offset>& offsets)
+    {
+        pad (offsets.size () * 4, 4);
+        for (auto it = offsets.rbegin (); it != offsets.rend (); ++it)
+            add_offset (*it);
+        push<uint32_t>(offsets.size ());
+        return size ();
+    }
+
+    /* A vector of structs of two longs, as FieldNode and Buffer are. */
+    Offset add_pair_vector (const std::vector<std::pair<int64_t, int64_t>>& pairs)
+    {
+        pad (pairs.size () * 16, 4);
+        pad (pairs.size () * 16, 8);
+        for (auto it = pairs.rbegin (); it != pairs.rend (); ++it)
+        {
+            push (it->second);
+            push (it->first);
+        }
+        push<uint32_t>(pairs.size ());
+        return size ();
+    }
+
+    void start_table ()
+    {
+        m_fields.clear ();
+        m_table_end = size ();
+    }
+
+    template <typename T> void add_field (uint16_t id, T value)
+    {
+        add_scalar (value);
+        m_fields.emplace_back (id, size ());
+    }
+
+    void add_offset_field (uint16_t id, Offset off)
+    {
+        add_offset (off);
+        m_fields.emplace_back (id, size ());
+    }
+
+    Offset end_table ()
+    {
+        add_scalar<int32_t>(0);
+        auto table_start = size ();
+        uint16_t num_fields = 0;
+        for (const auto& [id, pos] : m_fields)
+            num_fields = std::max<uint16_t>(num_fields, id + 1);
+        std::vector<uint16_t> vtable (num_fields, 0);
+        for (const auto& [id, pos] : m_fields)
+            vtable[id] = table_start - pos;
+        for (auto it = vtable.rbegin (); it != vtable.rend (); ++it)
+            push (*it);
+        push<uint16_t>(table_start - m_table_end);
+        push<uint16_t>(4 + 2 * num_fields);
+
+        /* The table starts with the distance back to its vtable. */
+        auto vtable_dist = static_cast<uint32_t>(size () - table_start);
+        for (size_t i = 0; i < 4; ++i)
+            m_rev[table_start - 1 - i] = static_cast<uint8_t>(vtable_dist >> (8 * i));
+        return table_start;
+    }
+
+    std::string finish (Offset root)
+    {
+        pad (4, std::max<size_t>(m_minalign, 4));
+        add_offset (root);
+        return std::string (m_rev.rbegin (), m_rev.rend ());
+    }
+
+    Offset size () const noexcept { return m_rev.size (); }
+
+private:
+    std::vector<uint8_t> m_rev;
+    size_t m_minalign = 1;
+    std::vector<std::pair<uint16_t, Offset>> m_fields;
+    Offset m_table_end = 0;
+};
+
+/* From the Arrow format's Schema.fbs and Message.fbs. */
+constexpr int16_t metadata_v5 = 4;
+
+enum MessageHeader : uint8_t
+{
+    HEADER_SCHEMA = 1,
+    HEADER_DICTIONARY_BATCH = 2,
+    HEADER_RECORD_BATCH = 3,
+};
+
+enum TypeId : uint8_t
+{
+    TYPE_INT = 2,
+    TYPE_UTF8 = 5,
+    TYPE_BOOL = 6,
+    TYPE_TIMESTAMP = 10,
+};
+
+constexpr uint8_t padding[8] {};
+
+/* Where a message is in the file, for the footer. */
+struct Block
+{
+    int64_t offset;
+    int32_t metadata_length;
+    int64_t body_length;
+};
+
+using Pairs = std::vector<std::pair<int64_t, int64_t>>;
+
+class FileWriter
+{
+public:
+    explicit FileWriter (std::ostream& out) : m_out {out} {}
+
+    void write (const void *data, size_t len)
+    {
+        m_out.write (static_cast<const char*>(data), len);
+        m_pos += len;
+    }
+
+    void align ()
+    {
+        write (padding, (8 - m_pos % 8) % 8);
+    }
+
+    /* A column's buffers for a record batch, added to the body. */
+    void add_buffer (const void *data, size_t len)
+    {
+        m_buffers.emplace_back (m_body.size (), len);
+        if (len)
+            m_body.append (static_cast<const char*>(data), len);
+        m_body.append (reinterpret_cast<const char*>(padding), (8 - len % 8) % 8);
+    }
+
+    void add_node (int64_t length, int64_t null_count)
+    {
+        m_nodes.emplace_back (length, null_count);
+    }
+
+    /* A RecordBatch table for the nodes and buffers added, which it
+     * clears. */
+    FlatBuilder::Offset add_record_batch (FlatBuilder& fbb, int64_t length)
+    {
+        auto nodes = fbb.add_pair_vector (m_nodes);
+        auto buffers = fbb.add_pair_vector (m_buffers);
+        m_nodes.clear ();
+        m_buffers.clear ();
+        fbb.start_table ();
+        fbb.add_field<int64_t>(0, length);
+        fbb.add_offset_field (1, nodes);
+        fbb.add_offset_field (2, buffers);
+        return fbb.end_table ();
+    }
+
+    /* Write a message with the body added, which it clears. */
+    Block write_message (FlatBuilder& fbb, MessageHeader type,
+                         FlatBuilder::Offset header)
+    {
+        fbb.start_table ();
+        fbb.add_field<int64_t>(3, m_body.size ());
+        fbb.add_offset_field (2, header);
+        fbb.add_field<int16_t>(0, metadata_v5);
+        fbb.add_field<uint8_t>(1, type);
+        auto metadata = fbb.finish (fbb.end_table ());
+        metadata.append ((8 - metadata.size () % 8) % 8, '\0');
+
+        Block block {static_cast<int64_t>(m_pos),
+                     static_cast<int32_t>(8 + metadata.size ()),
+                     static_cast<int64_t>(m_body.size ())};
+        write_int32 (-1);
+        write_int32 (metadata.size ());
+        write (metadata.data (), metadata.size ());
+        write (m_body.data (), m_body.size ());
+        m_body.clear ();
+        return block;
+    }
+
+    void write_int32 (int32_t value)
+    {
+        uint8_t bytes[4];
+        for (size_t i = 0; i < 4; ++i)
+            bytes[i] = static_cast<uint8_t>(static_cast<uint32_t>(value) >> (8 * i));
+        write (bytes, 4);
+    }
+
+    size_t pos () const noexcept { return m_pos; }
+
+private:
+    std::ostream& m_out;
+    size_t m_pos = 0;
+    std::string m_body;
+    Pairs m_nodes;
+    Pairs m_buffers;
+};
+
+FlatBuilder::Offset
+add_int_type (FlatBuilder& fbb, int32_t bit_width)
+{
+    fbb.start_table ();
+    fbb.add_field<int32_t>(0, bit_width);
+    fbb.add_field<uint8_t>(1, true);
+    return fbb.end_table ();
+}
+
+FlatBuilder::Offset
+add_field (FlatBuilder& fbb, const GncArrowTable::Column& column, int64_t dict_id)
+{
+    auto name = fbb.add_string (column.name);
+    auto children = fbb.add_offset_vector ({});
+
+    FlatBuilder::Offset type = 0;
+    uint8_t type_id = 0;
+    FlatBuilder::Offset dictionary = 0;
+    switch (column.type)
+    {
+    case GncArrowType::STRING:
+    case GncArrowType::DICTIONARY:
+        fbb.start_table ();
+        type = fbb.end_table ();
+        type_id = TYPE_UTF8;
+        break;
+    case GncArrowType::INT64:
+        type = add_int_type (fbb, 64);
+        type_id = TYPE_INT;
+        break;
+    case GncArrowType::TIMESTAMP:
+    {
+        auto timezone = fbb.add_string ("UTC");
+        fbb.start_table ();
+        fbb.add_offset_field (1, timezone);
+        fbb.add_field<int16_t>(0, 0);      // seconds
+        type = fbb.end_table ();
+        type_id = TYPE_TIMESTAMP;
+        break;
+    }
+    case GncArrowType::BOOL:
+        fbb.start_table ();
+        type = fbb.end_table ();
+        type_id = TYPE_BOOL;
+        break;
+    default:
+        throw std::logic_error {"Arrow column " + column.name + " has an unknown type."};
+    }
+
+    if (column.type == GncArrowType::DICTIONARY)
+    {
+        auto index_type = add_int_type (fbb, 32);
+        fbb.start_table ();
+        fbb.add_field<int64_t>(0, dict_id);
+        fbb.add_offset_field (1, index_type);
+        dictionary = fbb.end_table ();
+    }
+
+    fbb.start_table ();
+    fbb.add_offset_field (0, name);
+    fbb.add_offset_field (3, type);
+    if (dictionary)
+        fbb.add_offset_field (4, dictionary);
+    fbb.add_offset_field (5, children);
+    fbb.add_field<uint8_t>(1, column.nullable);
+    fbb.add_field<uint8_t>(2, type_id);
+    return fbb.end_table ();
+}
+
+FlatBuilder::Offset
+add_schema (FlatBuilder& fbb, const std::vector<GncArrowTable::Column>& columns)
+{
+    std::vector<FlatBuilder::Offset> fields;
+    for (size_t col = 0; col < columns.size (); ++col)
+        fields.push_back (add_field (fbb, columns[col], col));
+    auto fields_vec = fbb.add_offset_vector (fields);
+    fbb.start_table ();
+    fbb.add_offset_field (1, fields_vec);
+    fbb.add_field<int16_t>(0, 0);          // little endian
+    return fbb.end_table ();
+}
+
+/* Rows [begin, end) of a bitmap, begin being a multiple of 8. */
+void
+add_bitmap (FileWriter& writer, const std::vector<uint8_t>& bits,
+            size_t begin, size_t end)
+{
+    writer.add_buffer (bits.data () + begin / 8, (end - begin + 7) / 8);
+}
+
+size_t
+count_nulls (const std::vector<uint8_t>& validity, size_t begin, size_t end)
+{
+    size_t valid = 0;
+    for (auto row = begin; row < end; ++row)
+        valid += (validity[row / 8] >> (row % 8)) & 1;
+    return end - begin - valid;
+}
+
+void
+add_strings (FileWriter& writer, const GncArrowTable::StringArray& strings,
+             size_t begin, size_t end)
+{
+    auto first = strings.offsets[begin];
+    if (strings.offsets[end] - first > std::numeric_limits<int32_t>::max ())
+        throw std::length_error {"Too much text in one Arrow record batch."};
+    std::vector<int32_t> offsets;
+    offsets.reserve (end - begin + 1);
+    for (auto row = begin; row <= end; ++row)
+        offsets.push_back (strings.offsets[row] - first);
+    writer.add_buffer (offsets.data (), offsets.size () * sizeof (int32_t));
+    writer.add_buffer (strings.data.data () + first, strings.offsets[end] - first);
+}
+
+void
+add_column_data (FileWriter& writer, const GncArrowTable::Column& column,
+            size_t begin, size_t end)
+{
+    auto nulls = column.null_count ? count_nulls (column.validity, begin, end) : 0;
+    writer.add_node (end - begin, nulls);
+    if (nulls)
+        add_bitmap (writer, column.validity, begin, end);
+    else
+        writer.add_buffer (nullptr, 0);
+
+    switch (column.type)
+    {
+    case GncArrowType::STRING:
+        add_strings (writer, column.strings, begin, end);
+        break;
+    case GncArrowType::DICTIONARY:
+        writer.add_buffer (column.indices.data () + begin,
+                           (end - begin) * sizeof (int32_t));
+        break;
+    case GncArrowType::INT64:
+    case GncArrowType::TIMESTAMP:
+        writer.add_buffer (column.ints.data () + begin,
+                           (end - begin) * sizeof (int64_t));
+        break;
+    case GncArrowType::BOOL:
+        add_bitmap (writer, column.bools, begin, end);
+        break;
+    }
+}
+
+void
+set_bit (std::vector<uint8_t>& bits, size_t pos, bool value)
+{
+    if (pos % 8 == 0)
+        bits.push_back (0);
+    if (value)
+        bits.back () |= 1 << (pos % 8);
+}
+
+} // anonymous namespace
+
+size_t
+GncArrowTable::add_column (std::string name, GncArrowType type, bool nullable)
+{
+    if (m_rows)
+        throw std::logic_error {"Arrow columns must be added before any row."};
+    auto& column = m_columns.emplace_back ();
+    column.name = std::move (name);
+    column.type = type;
+    column.nullable = nullable;
+    return m_columns.size () - 1;
+}
+
+GncArrowTable::Column&
+GncArrowTable::column_for_append (size_t col, bool valid,
+                                  std::initializer_list<GncArrowType> types)
+{
+    auto& column = m_columns.at (col);
+    if (std::find (types.begin (), types.end (), column.type) == types.end ())
+        throw std::logic_error {"Arrow column " + column.name + " has another type."};
+    if (column.length > m_rows)
+        throw std::logic_error {"Arrow column " + column.name + " has two values in a row."};
+    if (!valid && !column.nullable)
+        throw std::logic_error {"Arrow column " + column.name + " isn't nullable."};
+    set_bit (column.validity, column.length, valid);
+    if (!valid)
+        ++column.null_count;
+    ++column.length;
+    return column;
+}
+
+void
+GncArrowTable::append_string (size_t col, std::string_view value)
+{
+    auto& column = column_for_append (col, true, {GncArrowType::STRING,
+                                                  GncArrowType::DICTIONARY});
+    if (column.type == GncArrowType::STRING)
+    {
+        column.strings.append (value);
+        return;
+    }
+
+    auto [it, added] = column.dictionary_pos.emplace (value, column.dictionary.size ());
+    if (added)
+        column.dictionary.append (value);
+    column.indices.push_back (it->second);
+}
+
+void
+GncArrowTable::append_int64 (size_t col, int64_t value)
+{
+    auto& column = column_for_append (col, true, {GncArrowType::INT64,
+                                                  GncArrowType::TIMESTAMP});
+    column.ints.push_back (value);
+}
+
+void
+GncArrowTable::append_bool (size_t col, bool value)
+{
+    auto& column = column_for_append (col, true, {GncArrowType::BOOL});
+    set_bit (column.bools, column.length - 1, value);
+}
+
+void
+GncArrowTable::append_null (size_t col)
+{
+    auto& column = column_for_append (col, false, {GncArrowType::STRING,
+                                                   GncArrowType::DICTIONARY,
+                                                   GncArrowType::INT64,
+                                                   GncArrowType::TIMESTAMP,
+                                                   GncArrowType::BOOL});
+    /* Nulls still take a slot in the data buffers. */
+    switch (column.type)
+    {
+    case GncArrowType::STRING:
+        column.strings.append ({});
+        break;
+    case GncArrowType::DICTIONARY:
+        column.indices.push_back (0);
+        break;
+    case GncArrowType::INT64:
+    case GncArrowType::TIMESTAMP:
+        column.ints.push_back (0);
+        break;
+    case GncArrowType::BOOL:
+        set_bit (column.bools, column.length - 1, false);
+        break;
+    }
+}
+
+void
+GncArrowTable::end_row ()
+{
+    for (size_t col = 0; col < m_columns.size (); ++col)
+        if (m_columns[col].length == m_rows)
+            append_null (col);
+    ++m_rows;
+}
+
+void
+GncArrowTable::write (std::ostream& out) const
+{
+    FileWriter writer {out};
+    static const char magic[] = "ARROW1";
+    writer.write (magic, 6);
+    writer.align ();
+
+    FlatBuilder schema_fbb;
+    writer.write_message (schema_fbb, HEADER_SCHEMA, add_schema (schema_fbb, m_columns));
+
+    std::vector<Block> dictionaries;
+    for (size_t col = 0; col < m_columns.size (); ++col)
+    {
+        const auto& column = m_columns[col];
+        if (column.type != GncArrowType::DICTIONARY)
+            continue;
+        auto size = column.dictionary.size ();
+        writer.add_node (size, 0);
+        writer.add_buffer (nullptr, 0);
+        add_strings (writer, column.dictionary, 0, size);
+
+        FlatBuilder fbb;
+        auto data = writer.add_record_batch (fbb, size);
+        fbb.start_table ();
+        fbb.add_field<int64_t>(0, col);
+        fbb.add_offset_field (1, data);
+        dictionaries.push_back (writer.write_message (fbb, HEADER_DICTIONARY_BATCH,
+                                                      fbb.end_table ()));
+    }
+
+    /* An empty table still gets a batch. */
+    std::vector<Block> batches;
+    size_t begin = 0;
+    do
+    {
+        auto end = std::min (begin + batch_rows, m_rows);
+        for (const auto& column : m_columns)
+            add_column_data (writer, column, begin, end);
+        FlatBuilder fbb;
+        auto batch = writer.add_record_batch (fbb, end - begin);
+        batches.push_back (writer.write_message (fbb, HEADER_RECORD_BATCH, batch));
+        begin = end;
+    }
+    while (begin < m_rows);
+
+    writer.write_int32 (-1);
+    writer.write_int32 (0);
+
+    FlatBuilder fbb;
+    auto add_blocks = [&fbb](const std::vector<Block>& blocks)
+    {
+        fbb.pad (blocks.size () * 24, 4);
+        fbb.pad (blocks.size () * 24, 8);
+        for (auto it = blocks.rbegin (); it != blocks.rend (); ++it)
+        {
+            fbb.push (it->body_length);
+            fbb.push<int32_t>(0);
+            fbb.push (it->metadata_length);
+            fbb.push (it->offset);
+        }
+        fbb.push<uint32_t>(blocks.size ());
+        return fbb.size ();
+    };
+    auto schema = add_schema (fbb, m_columns);
+    auto dictionary_blocks = add_blocks (dictionaries);
+    auto batch_blocks = add_blocks (batches);
+    fbb.start_table ();
+    fbb.add_offset_field (1, schema);
+    fbb.add_offset_field (2, dictionary_blocks);
+    fbb.add_offset_field (3, batch_blocks);
+    fbb.add_field<int16_t>(0, metadata_v5);
+    auto footer = fbb.finish (fbb.end_table ());
+    writer.write (footer.data (), footer.size ());
+    writer.write_int32 (footer.size ());
+    writer.write (magic, 6);
+}
+
+void
+GncArrowTable::write (const std::string& filename) const
+{
+    std::ofstream out {filename, std::ios::binary | std::ios::trunc};
+    if (out)
+        write (out);
+    if (out)
+        out.close ();
+    if (!out)
+    {
+        auto msg = g_strdup_printf (_("Could not write to file %s: %s"),
+                                    filename.c_str (), strerror (errno));
+        std::runtime_error err {msg};
+        g_free (msg);
+        throw err;
+    }
+}
+
+/** @} */
@@ -0,0 +1,145 @@
+/********************************************************************\
+ * gnc-arrow-writer.hpp -- Write typed columns as Arrow IPC files.  *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+/** @addtogroup Import_Export
+    @{ */
+/** @file gnc-arrow-writer.hpp
+ *  @brief A table of typed columns written in the Apache Arrow IPC
+ *  file format.
+ *
+ *  Arrow files (also known as Feather version 2) carry their schema and
+ *  keep every column in one contiguous typed array, so analytics tools
+ *  such as pyarrow, pandas, polars, DuckDB or R's arrow package read
+ *  them without parsing. The writer is self-contained: it encodes the
+ *  few metadata tables the format needs itself and has no dependency on
+ *  the Arrow libraries.
+ *
+ *  Rows are appended column by column and kept in memory until the
+ *  table is written. Dictionary columns hold each distinct string once
+ *  and an index per row, which suits columns with few distinct values
+ *  such as accounts and commodities.
+ */
+
+#ifndef GNC_ARROW_WRITER_HPP
+#define GNC_ARROW_WRITER_HPP
+
+#include <cstdint>
+#include <initializer_list>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+enum class GncArrowType
+{
+    STRING,         /**< UTF-8 text. */
+    DICTIONARY,     /**< UTF-8 text, dictionary encoded with 32 bit indices. */
+    INT64,          /**< Signed 64 bit integers. */
+    TIMESTAMP,      /**< Seconds since the epoch, in UTC. */
+    BOOL,           /**< Booleans. */
+};
+
+class GncArrowTable
+{
+public:
+    /** The most rows written in one record batch. */
+    static constexpr size_t batch_rows = 64 * 1024;
+
+    /** Add a column. Columns must all be added before the first row.
+     *  @return the column's index, to append its values with. */
+    size_t add_column (std::string name, GncArrowType type, bool nullable = false);
+
+    /** Append a value to a STRING or DICTIONARY column.
+     *  @exception std::logic_error, as all the appends, if the column
+     *  has another type or already has a value in this row. */
+    void append_string (size_t col, std::string_view value);
+
+    /** Append a value to an INT64 or TIMESTAMP column. */
+    void append_int64 (size_t col, int64_t value);
+
+    /** Append a value to a BOOL column. */
+    void append_bool (size_t col, bool value);
+
+    /** Append a null to a nullable column. */
+    void append_null (size_t col);
+
+    /** End the current row. Nullable columns that got no value in it
+     *  get a null.
+     *  @exception std::logic_error if another column got no value or
+     *  any got more than one. */
+    void end_row ();
+
+    /** @return the number of rows ended. */
+    size_t rows () const noexcept { return m_rows; }
+
+    /** Write the table.
+     *  @exception std::length_error if the text of a column in one
+     *  record batch is over 2 GiB, which the format can't index. */
+    void write (std::ostream& out) const;
+
+    /** Write the table to a file, replacing it.
+     *  @exception std::runtime_error with a translated message if the
+     *  file can't be written. */
+    void write (const std::string& filename) const;
+
+    /** The strings and their offsets for a STRING column or a
+     *  dictionary. */
+    struct StringArray
+    {
+        std::vector<int64_t> offsets {0};
+        std::string data;
+
+        void append (std::string_view value)
+        {
+            data.append (value);
+            offsets.push_back (data.size ());
+        }
+        size_t size () const noexcept { return offsets.size () - 1; }
+    };
+
+    struct Column
+    {
+        std::string name;
+        GncArrowType type;
+        bool nullable;
+        size_t length = 0;
+        size_t null_count = 0;
+        /* One bit per row, set if the row isn't null. */
+        std::vector<uint8_t> validity;
+        StringArray strings;
+        std::vector<int64_t> ints;
+        std::vector<int32_t> indices;
+        std::vector<uint8_t> bools;
+        StringArray dictionary;
+        std::unordered_map<std::string, int32_t> dictionary_pos;
+    };
+
+private:
+    Column& column_for_append (size_t col, bool valid,
+                               std::initializer_list<GncArrowType> types);
+
+    std::vector<Column> m_columns;
+    size_t m_rows = 0;
+};
+
+#endif /* GNC_ARROW_WRITER_HPP */
+/** @} */
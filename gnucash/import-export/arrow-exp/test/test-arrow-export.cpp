@@ -0,0 +1,590 @@
+/********************************************************************
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, you can retrieve it from        *
+ * https://www.gnu.org/licenses/old-licenses/gpl-2.0.html            *
+ * or contact:                                                      *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+
+#include <config.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "gnc-arrow-export.hpp"
+#include "gnc-arrow-writer.hpp"
+
+#include <Account.h>
+#include <Split.h>
+#include <Transaction.h>
+#include <cashobjects.h>
+#include <gnc-commodity.h>
+#include <gnc-pricedb.h>
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+/* Just enough of an Arrow IPC reader to check what the exporter wrote.
+ * It reads the messages in order, as a stream reader does, and decodes
+ * the column types the writer uses. */
+
+using Pairs = std::vector<std::pair<int64_t, int64_t>>;
+
+template <typename T> static T
+read_le (const uint8_t *buf, size_t pos)
+{
+    uint64_t bits = 0;
+    for (size_t i = 0; i < sizeof (T); ++i)
+        bits |= static_cast<uint64_t>(buf[pos + i]) << (8 * i);
+    return static_cast<T>(bits);
+}
+
+/* A FlatBuffers table in a message's metadata. */
+class FlatTable
+{
+public:
+    FlatTable (const uint8_t *buf, size_t pos) : m_buf {buf}, m_pos {pos} {}
+
+    static FlatTable root (const uint8_t *buf)
+    {
+        return {buf, read_le<uint32_t>(buf, 0)};
+    }
+
+    template <typename T> T get (uint16_t id) const
+    {
+        auto off = field (id);
+        return off ? read_le<T>(m_buf, m_pos + off) : 0;
+    }
+
+    bool has (uint16_t id) const { return field (id) != 0; }
+
+    FlatTable table (uint16_t id) const { return {m_buf, deref (id)}; }
+
+    std::string string (uint16_t id) const
+    {
+        auto pos = deref (id);
+        return {reinterpret_cast<const char*>(m_buf + pos + 4),
+                read_le<uint32_t>(m_buf, pos)};
+    }
+
+    std::vector<FlatTable> tables (uint16_t id) const
+    {
+        std::vector<FlatTable> rv;
+        auto pos = deref (id);
+        auto count = read_le<uint32_t>(m_buf, pos);
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto elem = pos + 4 + 4 * i;
+            rv.emplace_back (m_buf, elem + read_le<uint32_t>(m_buf, elem));
+        }
+        return rv;
+    }
+
+    Pairs pairs (uint16_t id) const
+    {
+        Pairs rv;
+        auto pos = deref (id);
+        auto count = read_le<uint32_t>(m_buf, pos);
+        for (size_t i = 0; i < count; ++i)
+            rv.emplace_back (read_le<int64_t>(m_buf, pos + 4 + 16 * i),
+                             read_le<int64_t>(m_buf, pos + 12 + 16 * i));
+        return rv;
+    }
+
+private:
+    uint16_t field (uint16_t id) const
+    {
+        auto vtable = m_pos - read_le<int32_t>(m_buf, m_pos);
+        auto vtable_size = read_le<uint16_t>(m_buf, vtable);
+        if (4u + 2 * id >= vtable_size)
+            return 0;
+        return read_le<uint16_t>(m_buf, vtable + 4 + 2 * id);
+    }
+
+    size_t deref (uint16_t id) const
+    {
+        auto pos = m_pos + field (id);
+        return pos + read_le<uint32_t>(m_buf, pos);
+    }
+
+    const uint8_t *m_buf;
+    size_t m_pos;
+};
+
+/* From the Arrow format's Schema.fbs. */
+enum : uint8_t { TYPE_INT = 2, TYPE_UTF8 = 5, TYPE_BOOL = 6, TYPE_TIMESTAMP = 10 };
+
+using Strings = std::vector<std::optional<std::string>>;
+using Ints = std::vector<std::optional<int64_t>>;
+
+struct ArrowColumn
+{
+    std::string name;
+    uint8_t type_id;
+    bool nullable;
+    std::optional<int64_t> dictionary_id;
+    Strings strings;    // UTF8 columns, dictionary encoded or not
+    Ints ints;          // INT, TIMESTAMP and BOOL columns
+};
+
+struct ArrowFile
+{
+    std::vector<ArrowColumn> columns;
+    size_t record_batches = 0;
+    size_t rows = 0;
+
+    const ArrowColumn& operator[] (const std::string& name) const
+    {
+        for (const auto& col : columns)
+            if (col.name == name)
+                return col;
+        throw std::out_of_range {"No Arrow column " + name};
+    }
+
+    /* The row whose column col has the value value. */
+    size_t find (const std::string& col, const std::string& value) const
+    {
+        const auto& strings = (*this)[col].strings;
+        for (size_t row = 0; row < strings.size (); ++row)
+            if (strings[row] == value)
+                return row;
+        throw std::out_of_range {"No row with " + col + " " + value};
+    }
+};
+
+/* Walks the nodes and buffers of a record batch, column by column. */
+class BatchReader
+{
+public:
+    BatchReader (const uint8_t *body, const FlatTable& batch)
+        : m_body {body}, m_nodes {batch.pairs (1)}, m_buffers {batch.pairs (2)} {}
+
+    std::pair<int64_t, int64_t> node () { return m_nodes.at (m_node++); }
+
+    const uint8_t *buffer () { return m_body + m_buffers.at (m_buffer++).first; }
+
+    /* The validity bitmap, null if the column has no nulls in the batch. */
+    const uint8_t *validity ()
+    {
+        auto length = m_buffers.at (m_buffer).second;
+        auto bits = buffer ();
+        return length ? bits : nullptr;
+    }
+
+    bool done () const
+    {
+        return m_node == m_nodes.size () && m_buffer == m_buffers.size ();
+    }
+
+private:
+    const uint8_t *m_body;
+    Pairs m_nodes;
+    Pairs m_buffers;
+    size_t m_node = 0;
+    size_t m_buffer = 0;
+};
+
+static bool
+bit (const uint8_t *bits, int64_t pos)
+{
+    return (bits[pos / 8] >> (pos % 8)) & 1;
+}
+
+static Strings
+read_utf8 (BatchReader& reader, int64_t length, const uint8_t *validity)
+{
+    auto offsets = reader.buffer ();
+    auto data = reader.buffer ();
+    Strings rv;
+    for (int64_t row = 0; row < length; ++row)
+    {
+        if (validity && !bit (validity, row))
+        {
+            rv.emplace_back ();
+            continue;
+        }
+        auto begin = read_le<int32_t>(offsets, 4 * row);
+        auto end = read_le<int32_t>(offsets, 4 * row + 4);
+        rv.emplace_back (std::string (reinterpret_cast<const char*>(data) + begin,
+                                      end - begin));
+    }
+    return rv;
+}
+
+static ArrowFile
+read_arrow_file (const std::string& path)
+{
+    std::ifstream in {path, std::ios::binary};
+    std::string contents {std::istreambuf_iterator<char> (in),
+                          std::istreambuf_iterator<char> ()};
+    auto buf = reinterpret_cast<const uint8_t*>(contents.data ());
+    if (contents.size () < 16 || contents.compare (0, 6, "ARROW1") != 0)
+        throw std::runtime_error {path + " isn't an Arrow file"};
+
+    ArrowFile file;
+    std::unordered_map<int64_t, Strings> dictionaries;
+    size_t pos = 8;
+    while (true)
+    {
+        if (read_le<int32_t>(buf, pos) != -1)
+            throw std::runtime_error {"No continuation marker"};
+        auto metadata_length = read_le<int32_t>(buf, pos + 4);
+        if (metadata_length == 0)
+            break;
+        auto message = FlatTable::root (buf + pos + 8);
+        auto body = buf + pos + 8 + metadata_length;
+        auto header = message.table (2);
+
+        switch (message.get<uint8_t>(1))
+        {
+        case 1:                 // Schema
+            for (const auto& field : header.tables (1))
+            {
+                ArrowColumn col {field.string (0), field.get<uint8_t>(2),
+                                 field.get<uint8_t>(1) != 0, {}, {}, {}};
+                if (field.has (4))
+                    col.dictionary_id = field.table (4).get<int64_t>(0);
+                file.columns.push_back (std::move (col));
+            }
+            break;
+        case 2:                 // DictionaryBatch
+        {
+            BatchReader reader {body, header.table (1)};
+            auto [length, null_count] = reader.node ();
+            EXPECT_EQ (null_count, 0);
+            auto validity = reader.validity ();
+            dictionaries[header.get<int64_t>(0)] = read_utf8 (reader, length, validity);
+            EXPECT_TRUE (reader.done ());
+            break;
+        }
+        case 3:                 // RecordBatch
+        {
+            BatchReader reader {body, header};
+            auto rows = header.get<int64_t>(0);
+            for (auto& col : file.columns)
+            {
+                auto [length, null_count] = reader.node ();
+                EXPECT_EQ (length, rows) << col.name;
+                auto validity = reader.validity ();
+                int64_t nulls = 0;
+                for (int64_t row = 0; validity && row < length; ++row)
+                    nulls += !bit (validity, row);
+                EXPECT_EQ (nulls, null_count) << col.name;
+                EXPECT_TRUE (col.nullable || !null_count) << col.name;
+
+                if (col.dictionary_id)
+                {
+                    auto indices = reader.buffer ();
+                    const auto& dict = dictionaries.at (*col.dictionary_id);
+                    for (int64_t row = 0; row < length; ++row)
+                        if (validity && !bit (validity, row))
+                            col.strings.emplace_back ();
+                        else
+                            col.strings.push_back (dict.at (read_le<int32_t>(indices, 4 * row)));
+                }
+                else if (col.type_id == TYPE_UTF8)
+                {
+                    auto strings = read_utf8 (reader, length, validity);
+                    col.strings.insert (col.strings.end (), strings.begin (), strings.end ());
+                }
+                else
+                {
+                    auto data = reader.buffer ();
+                    for (int64_t row = 0; row < length; ++row)
+                        if (validity && !bit (validity, row))
+                            col.ints.emplace_back ();
+                        else if (col.type_id == TYPE_BOOL)
+                            col.ints.push_back (bit (data, row));
+                        else
+                            col.ints.push_back (read_le<int64_t>(data, 8 * row));
+                }
+            }
+            EXPECT_TRUE (reader.done ());
+            ++file.record_batches;
+            file.rows += rows;
+            break;
+        }
+        default:
+            throw std::runtime_error {"Unknown Arrow message"};
+        }
+        pos += 8 + metadata_length + message.get<int64_t>(3);
+    }
+    return file;
+}
+
+static std::string
+guid_string (gconstpointer inst)
+{
+    char buf[GUID_ENCODING_LENGTH + 1];
+    guid_to_string_buff (qof_instance_get_guid (inst), buf);
+    return buf;
+}
+
+class ArrowExportTest : public ::testing::Test
+{
+protected:
+    void SetUp () override
+    {
+        static bool registered = false;
+        if (!registered)
+        {
+            qof_init ();
+            cashobjects_register ();
+            registered = true;
+        }
+        m_book = qof_book_new ();
+        m_dir = g_dir_make_tmp ("test-arrow-export-XXXXXX", nullptr);
+        ASSERT_NE (m_dir, nullptr);
+
+        auto table = gnc_commodity_table_get_table (m_book);
+        m_usd = gnc_commodity_table_lookup (table, GNC_COMMODITY_NS_CURRENCY, "USD");
+        m_stock = gnc_commodity_new (m_book, "GnuCash Inc.", "NASDAQ", "GNC",
+                                     "123456789", 1000);
+        gnc_commodity_table_insert (table, m_stock);
+
+        auto root = gnc_account_create_root (m_book);
+        m_assets = make_account (root, "Assets", ACCT_TYPE_ASSET);
+        xaccAccountSetPlaceholder (m_assets, TRUE);
+        m_checking = make_account (m_assets, "Checking", ACCT_TYPE_BANK);
+        xaccAccountSetCode (m_checking, "1010");
+        m_expenses = make_account (root, "Expenses", ACCT_TYPE_EXPENSE);
+        xaccAccountSetHidden (m_expenses, TRUE);
+        m_income = make_account (root, "Income", ACCT_TYPE_INCOME);
+    }
+
+    void TearDown () override
+    {
+        for (auto name : {"accounts.arrow", "commodities.arrow", "prices.arrow",
+                          "transactions.arrow", "splits.arrow"})
+        {
+            auto path = g_build_filename (m_dir, name, nullptr);
+            g_unlink (path);
+            g_free (path);
+        }
+        g_rmdir (m_dir);
+        g_free (m_dir);
+        qof_book_destroy (m_book);
+    }
+
+    Account *make_account (Account *parent, const char *name, GNCAccountType type)
+    {
+        auto acc = xaccMallocAccount (m_book);
+        xaccAccountBeginEdit (acc);
+        xaccAccountSetName (acc, name);
+        xaccAccountSetType (acc, type);
+        xaccAccountSetCommodity (acc, m_usd);
+        xaccAccountCommitEdit (acc);
+        gnc_account_append_child (parent, acc);
+        return acc;
+    }
+
+    Transaction *make_trans (time64 date, const char *num, const char *description,
+                             const char *notes,
+                             std::initializer_list<std::pair<Account*, gint64>> splits)
+    {
+        auto trans = xaccMallocTransaction (m_book);
+        xaccTransBeginEdit (trans);
+        xaccTransSetCurrency (trans, m_usd);
+        xaccTransSetDatePostedSecs (trans, date);
+        xaccTransSetDateEnteredSecs (trans, date + 60);
+        xaccTransSetNum (trans, num);
+        xaccTransSetDescription (trans, description);
+        if (notes)
+            xaccTransSetNotes (trans, notes);
+        for (auto [acc, cents] : splits)
+        {
+            auto split = xaccMallocSplit (m_book);
+            auto amount = gnc_numeric_create (cents, 100);
+            xaccSplitSetParent (split, trans);
+            xaccSplitSetAccount (split, acc);
+            xaccSplitSetAmount (split, amount);
+            xaccSplitSetValue (split, amount);
+        }
+        xaccTransCommitEdit (trans);
+        return trans;
+    }
+
+    ArrowFile read (const char *name)
+    {
+        auto path = g_build_filename (m_dir, name, nullptr);
+        auto file = read_arrow_file (path);
+        g_free (path);
+        return file;
+    }
+
+    QofBook *m_book;
+    gchar *m_dir;
+    gnc_commodity *m_usd;
+    gnc_commodity *m_stock;
+    Account *m_assets;
+    Account *m_checking;
+    Account *m_expenses;
+    Account *m_income;
+};
+
+TEST_F (ArrowExportTest, ExportsBook)
+{
+    const time64 paid = 1578657600, shopped = 1578830400;   // 2020-01-10 and -12, noon
+    auto paycheck = make_trans (paid, "1", "Paycheck", nullptr,
+                                {{m_checking, 100000}, {m_income, -100000}});
+    auto groceries = make_trans (shopped, "", "Groceries", "Weekly",
+                                 {{m_checking, -5025}, {m_expenses, 5025}});
+    auto pay_split = xaccTransFindSplitByAccount (paycheck, m_checking);
+    xaccTransBeginEdit (paycheck);
+    xaccSplitSetReconcile (pay_split, YREC);
+    xaccSplitSetDateReconciledSecs (pay_split, shopped);
+    xaccTransCommitEdit (paycheck);
+    xaccSplitSetReconcile (xaccTransFindSplitByAccount (groceries, m_checking), CREC);
+
+    auto price = gnc_price_create (m_book);
+    gnc_price_begin_edit (price);
+    gnc_price_set_commodity (price, m_stock);
+    gnc_price_set_currency (price, m_usd);
+    gnc_price_set_time64 (price, paid);
+    gnc_price_set_source (price, PRICE_SOURCE_USER_PRICE);
+    gnc_price_set_typestr (price, "last");
+    gnc_price_set_value (price, gnc_numeric_create (12345, 100));
+    gnc_price_commit_edit (price);
+    gnc_pricedb_add_price (gnc_pricedb_get_db (m_book), price);
+    gnc_price_unref (price);
+
+    auto counts = gnc_arrow_export_book (m_book, m_dir);
+    // Every currency, and the stock, but not the template commodity.
+    auto num_commodities =
+        gnc_commodity_table_get_size (gnc_commodity_table_get_table (m_book)) - 1;
+    EXPECT_EQ (counts.accounts, 4u);
+    EXPECT_EQ (counts.commodities, num_commodities);
+    EXPECT_EQ (counts.prices, 1u);
+    EXPECT_EQ (counts.transactions, 2u);
+    EXPECT_EQ (counts.splits, 4u);
+
+    auto accounts = read ("accounts.arrow");
+    ASSERT_EQ (accounts.rows, 4u);
+    EXPECT_EQ (accounts.record_batches, 1u);
+    EXPECT_EQ (accounts["full_name"].strings,
+               (Strings {"Assets", "Assets:Checking", "Expenses", "Income"}));
+    EXPECT_EQ (accounts["name"].strings[1], "Checking");
+    EXPECT_EQ (accounts["guid"].strings[1], guid_string (m_checking));
+    EXPECT_EQ (accounts["parent_guid"].strings,
+               (Strings {std::nullopt, guid_string (m_assets), std::nullopt, std::nullopt}));
+    EXPECT_EQ (accounts["type"].strings,
+               (Strings {"ASSET", "BANK", "EXPENSE", "INCOME"}));
+    EXPECT_EQ (accounts["commodity"].strings[2], "CURRENCY::USD");
+    EXPECT_EQ (accounts["code"].strings[1], "1010");
+    EXPECT_EQ (accounts["code"].strings[0], "");
+    EXPECT_EQ (accounts["placeholder"].ints, (Ints {1, 0, 0, 0}));
+    EXPECT_EQ (accounts["hidden"].ints, (Ints {0, 0, 1, 0}));
+
+    auto commodities = read ("commodities.arrow");
+    EXPECT_EQ (commodities.rows, num_commodities);
+    auto stock = commodities.find ("unique_name", "NASDAQ::GNC");
+    EXPECT_EQ (commodities["namespace"].strings[stock], "NASDAQ");
+    EXPECT_EQ (commodities["mnemonic"].strings[stock], "GNC");
+    EXPECT_EQ (commodities["fullname"].strings[stock], "GnuCash Inc.");
+    EXPECT_EQ (commodities["cusip"].strings[stock], "123456789");
+    EXPECT_EQ (commodities["fraction"].ints[stock], 1000);
+    auto usd = commodities.find ("unique_name", "CURRENCY::USD");
+    EXPECT_EQ (commodities["fraction"].ints[usd], 100);
+
+    auto prices = read ("prices.arrow");
+    ASSERT_EQ (prices.rows, 1u);
+    EXPECT_EQ (prices["commodity"].strings[0], "NASDAQ::GNC");
+    EXPECT_EQ (prices["currency"].strings[0], "CURRENCY::USD");
+    EXPECT_EQ (prices["date"].ints[0], paid);
+    EXPECT_EQ (prices["source"].strings[0], "user:price");
+    EXPECT_EQ (prices["type"].strings[0], "last");
+    EXPECT_EQ (prices["value_num"].ints[0], 12345);
+    EXPECT_EQ (prices["value_denom"].ints[0], 100);
+
+    auto transactions = read ("transactions.arrow");
+    ASSERT_EQ (transactions.rows, 2u);
+    EXPECT_EQ (transactions["guid"].strings,
+               (Strings {guid_string (paycheck), guid_string (groceries)}));
+    EXPECT_EQ (transactions["description"].strings,
+               (Strings {"Paycheck", "Groceries"}));
+    EXPECT_EQ (transactions["num"].strings, (Strings {"1", ""}));
+    EXPECT_EQ (transactions["notes"].strings, (Strings {std::nullopt, "Weekly"}));
+    EXPECT_EQ (transactions["currency"].strings[1], "CURRENCY::USD");
+    EXPECT_EQ (transactions["date_posted"].ints,
+               (Ints {xaccTransGetDate (paycheck), xaccTransGetDate (groceries)}));
+    EXPECT_EQ (transactions["date_entered"].ints[0], paid + 60);
+    EXPECT_EQ (transactions["voided"].ints, (Ints {0, 0}));
+
+    auto splits = read ("splits.arrow");
+    ASSERT_EQ (splits.rows, 4u);
+    auto checking_guid = guid_string (m_checking);
+    for (auto [trans, acc, cents, reconcile] :
+             {std::tuple {paycheck, m_checking, 100000, "y"},
+              std::tuple {paycheck, m_income, -100000, "n"},
+              std::tuple {groceries, m_checking, -5025, "c"},
+              std::tuple {groceries, m_expenses, 5025, "n"}})
+    {
+        auto split = xaccTransFindSplitByAccount (trans, acc);
+        auto row = splits.find ("guid", guid_string (split));
+        EXPECT_EQ (splits["transaction_guid"].strings[row], guid_string (trans));
+        EXPECT_EQ (splits["account_guid"].strings[row], guid_string (acc));
+        auto full_name = gnc_account_get_full_name (acc);
+        EXPECT_EQ (splits["account"].strings[row], full_name);
+        g_free (full_name);
+        EXPECT_EQ (splits["reconcile"].strings[row], reconcile);
+        EXPECT_EQ (splits["reconcile_date"].ints[row],
+                   acc == m_checking && trans == paycheck ?
+                   std::optional<int64_t> {shopped} : std::nullopt);
+        EXPECT_EQ (splits["amount_num"].ints[row], cents);
+        EXPECT_EQ (splits["amount_denom"].ints[row], 100);
+        EXPECT_EQ (splits["value_num"].ints[row], cents);
+        EXPECT_EQ (splits["value_denom"].ints[row], 100);
+    }
+    EXPECT_EQ (splits["memo"].strings[0], "");
+}
+
+/* A table bigger than a record batch is split over several, which read
+ * back as one. */
+TEST_F (ArrowExportTest, SplitsOverBatches)
+{
+    GncArrowTable table;
+    auto num = table.add_column ("num", GncArrowType::INT64);
+    auto name = table.add_column ("name", GncArrowType::DICTIONARY, true);
+    auto rows = GncArrowTable::batch_rows + 10;
+    for (size_t row = 0; row < rows; ++row)
+    {
+        table.append_int64 (num, row);
+        if (row % 7)
+            table.append_string (name, row % 2 ? "odd" : "even");
+        table.end_row ();
+    }
+    auto path = g_build_filename (m_dir, "splits.arrow", nullptr);
+    table.write (path);
+    auto file = read_arrow_file (path);
+    g_free (path);
+
+    EXPECT_EQ (file.record_batches, 2u);
+    ASSERT_EQ (file.rows, rows);
+    const auto& nums = file["num"].ints;
+    const auto& names = file["name"].strings;
+    for (size_t row = 0; row < rows; ++row)
+    {
+        ASSERT_EQ (nums[row], static_cast<int64_t>(row));
+        ASSERT_EQ (names[row], row % 7 ? std::optional<std::string> {row % 2 ? "odd" : "even"}
+                                       : std::nullopt) << row;
+    }
+}
@@ -0,0 +1,146 @@
+/********************************************************************
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, you can retrieve it from        *
+ * https://www.gnu.org/licenses/old-licenses/gpl-2.0.html            *
+ * or contact:                                                      *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+
+#include "gnc-arrow-writer.hpp"
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <stdexcept>
+
+static std::string
+write_table (const GncArrowTable& table)
+{
+    std::ostringstream ss;
+    table.write (ss);
+    return ss.str ();
+}
+
+static size_t
+count (const std::string& haystack, const std::string& needle)
+{
+    size_t found = 0;
+    for (auto pos = haystack.find (needle); pos != std::string::npos;
+         pos = haystack.find (needle, pos + 1))
+        ++found;
+    return found;
+}
+
+static int32_t
+read_int32 (const std::string& data, size_t pos)
+{
+    uint32_t value = 0;
+    for (size_t i = 0; i < 4; ++i)
+        value |= static_cast<uint32_t>(static_cast<uint8_t>(data[pos + i])) << (8 * i);
+    return static_cast<int32_t>(value);
+}
+
+/* The file starts and ends with the magic, and the footer length just
+ * before the end points back into the file. */
+static void
+check_framing (const std::string& data)
+{
+    ASSERT_GT (data.size (), 18u);
+    EXPECT_EQ (data.substr (0, 8), std::string ("ARROW1\0\0", 8));
+    EXPECT_EQ (data.substr (data.size () - 6), "ARROW1");
+    auto footer_size = read_int32 (data, data.size () - 10);
+    EXPECT_GT (footer_size, 0);
+    EXPECT_LT (static_cast<size_t>(footer_size), data.size () - 18);
+    EXPECT_EQ ((data.size () - 10 - footer_size) % 8, 0u);
+    /* The schema message follows the magic. */
+    EXPECT_EQ (read_int32 (data, 8), -1);
+    EXPECT_EQ (read_int32 (data, 12) % 8, 0);
+}
+
+TEST (ArrowWriterTest, EmptyTable)
+{
+    GncArrowTable table;
+    table.add_column ("name", GncArrowType::STRING);
+    table.add_column ("amount", GncArrowType::INT64);
+    EXPECT_EQ (table.rows (), 0u);
+    auto data = write_table (table);
+    check_framing (data);
+    EXPECT_EQ (count (data, "name"), 2u);   // In the schema and the footer.
+    EXPECT_EQ (count (data, "amount"), 2u);
+}
+
+TEST (ArrowWriterTest, AllTypes)
+{
+    GncArrowTable table;
+    auto str = table.add_column ("str", GncArrowType::STRING, true);
+    auto dict = table.add_column ("dict", GncArrowType::DICTIONARY);
+    auto num = table.add_column ("num", GncArrowType::INT64);
+    auto date = table.add_column ("date", GncArrowType::TIMESTAMP, true);
+    auto flag = table.add_column ("flag", GncArrowType::BOOL);
+    for (int row = 0; row < 100; ++row)
+    {
+        if (row % 3)
+            table.append_string (str, "text" + std::to_string (row));
+        table.append_string (dict, row % 2 ? "Assets:Checking Account" : "Expenses:Groceries");
+        table.append_int64 (num, -row);
+        table.append_int64 (date, 1700000000 + row);
+        table.append_bool (flag, row % 2);
+        table.end_row ();
+    }
+    EXPECT_EQ (table.rows (), 100u);
+    auto data = write_table (table);
+    check_framing (data);
+    EXPECT_EQ (count (data, "text98"), 1u);
+    EXPECT_EQ (count (data, "text99"), 0u);         // A null.
+    /* Each dictionary value is written once, whatever the rows. */
+    EXPECT_EQ (count (data, "Assets:Checking Account"), 1u);
+    EXPECT_EQ (count (data, "Expenses:Groceries"), 1u);
+    EXPECT_EQ (count (data, "UTC"), 2u);
+}
+
+TEST (ArrowWriterTest, Batches)
+{
+    GncArrowTable table;
+    auto num = table.add_column ("num", GncArrowType::INT64);
+    auto rows = GncArrowTable::batch_rows * 2 + 5;
+    for (size_t row = 0; row < rows; ++row)
+    {
+        table.append_int64 (num, row);
+        table.end_row ();
+    }
+    auto data = write_table (table);
+    check_framing (data);
+    EXPECT_GT (data.size (), rows * sizeof (int64_t));
+}
+
+TEST (ArrowWriterTest, Misuse)
+{
+    GncArrowTable table;
+    auto str = table.add_column ("str", GncArrowType::STRING);
+    auto num = table.add_column ("num", GncArrowType::INT64, true);
+    EXPECT_THROW (table.append_int64 (str, 1), std::logic_error);
+    EXPECT_THROW (table.append_null (str), std::logic_error);
+
+    GncArrowTable table2;
+    str = table2.add_column ("str", GncArrowType::STRING);
+    num = table2.add_column ("num", GncArrowType::INT64, true);
+    table2.append_string (str, "a");
+    EXPECT_THROW (table2.append_string (str, "b"), std::logic_error);
+    table2.end_row ();      // num gets a null.
+    EXPECT_EQ (table2.rows (), 1u);
+    EXPECT_THROW (table2.add_column ("late", GncArrowType::BOOL), std::logic_error);
+    table2.append_int64 (num, 1);
+    EXPECT_THROW (table2.end_row (), std::logic_error);
+}
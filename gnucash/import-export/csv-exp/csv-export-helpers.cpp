@@ -27,6 +27,7 @@
 #include <cstring>
 #include <cstdio>
 #include <fstream>
+#include <string>
 #include <vector>
 
 #include "gnc-ui-util.h"
@@ -45,8 +46,8 @@
 
 #define QUOTE '"'
 
-bool
-gnc_csv_add_line (std::ostream& ss, const StringVec& str_vec,
+void
+gnc_csv_add_line (std::string& buf, const StringVec& str_vec,
                   bool use_quotes, const char* sep)
 {
     auto first{true};
@@ -60,26 +61,36 @@ gnc_csv_add_line (std::ostream& ss, const StringVec& str_vec,
         if (first)
             first = false;
         else
-            ss << sep_view;
-
-        if (need_quote)
-            ss << QUOTE;
+            buf.append (sep_view);
 
-        for (const char& p : str)
+        if (!need_quote)
         {
-            ss << p;
-            if (p == QUOTE)
-                ss << QUOTE;
+            buf.append (str);
+            continue;
         }
 
-        if (need_quote)
-            ss << QUOTE;
-
-        if (ss.fail())
-            return false;
+        buf.push_back (QUOTE);
+        size_t start = 0;
+        for (auto quote = str.find (QUOTE); quote != std::string::npos;
+             quote = str.find (QUOTE, start))
+        {
+            buf.append (str, start, quote + 1 - start);
+            buf.push_back (QUOTE);
+            start = quote + 1;
+        }
+        buf.append (str, start);
+        buf.push_back (QUOTE);
     }
-    ss << EOLSTR;
+    buf.append (EOLSTR);
+}
 
+bool
+gnc_csv_add_line (std::ostream& ss, const StringVec& str_vec,
+                  bool use_quotes, const char* sep)
+{
+    std::string line;
+    gnc_csv_add_line (line, str_vec, use_quotes, sep);
+    ss << line;
     return !ss.fail();
 }
 
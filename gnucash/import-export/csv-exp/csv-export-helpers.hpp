@@ -38,6 +38,10 @@ using StringVec = std::vector<std::string>;
 bool gnc_csv_add_line (std::ostream& ss, const StringVec& charsvec,
                        bool use_quotes, const char* sep);
 
+// append a csv-formatted line, as above, onto a string buffer.
+void gnc_csv_add_line (std::string& buf, const StringVec& charsvec,
+                       bool use_quotes, const char* sep);
+
 std::string account_get_fullname_str (Account*);
 
 #endif
@@ -29,10 +29,17 @@
 #include <glib/gstdio.h>
 #include <stdbool.h>
 
+#include <algorithm>
+#include <atomic>
+#include <optional>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include <gnc-filepath-utils.h>
+#include <gnc-locale-utils.h>
 #include "gnc-commodity.h"
 #include "gnc-ui-util.h"
 #include "Query.h"
@@ -47,204 +54,296 @@
 /* This static indicates the debugging module that this .o belongs to. */
 static QofLogModule log_module = GNC_MOD_ASSISTANT;
 
+/* Lines formatted by one thread at a time. */
+static const size_t format_chunk_size = 1024;
+/* Lines read from the engine before formatting and writing them, which
+ * bounds the memory an export of a big book takes. */
+static const size_t export_batch_size = 64 * format_chunk_size;
 
 /*******************************************************************/
 
-/******************** Helper functions *********************/
-
-static std::string
-get_date (Transaction *trans)
+/* The engine isn't thread safe, so everything a line needs is read from
+ * it on the main thread and the lines are formatted on others. Account
+ * and currency data is read once and shared by all their lines. The
+ * amounts with a symbol still read the commodity's user symbol from the
+ * engine while they are formatted, see write_lines. */
+struct AccountInfo
 {
-    char datebuff [MAX_DATE_LENGTH + 1];
-    qof_print_date_buff(datebuff, MAX_DATE_LENGTH, xaccTransGetDate (trans));
-    return datebuff;
-}
-
-
-static std::string
-get_guid (Transaction *trans)
+    std::string full_name;
+    std::string name;
+    GNCPrintAmountInfo amount_info;
+    GNCPrintAmountInfo amount_sym_info;
+    GNCPrintAmountInfo price_info;
+};
+
+struct CurrencyInfo
 {
-    return gnc::GUID (*qof_entity_get_guid (QOF_INSTANCE (trans))).to_string();
-}
+    std::string unique_name;
+    GNCPrintAmountInfo value_info;
+    GNCPrintAmountInfo value_sym_info;
+};
 
-// Reconcile Date
-static std::string
-get_reconcile_date (Split *split)
+struct ExportLine
 {
-    if (xaccSplitGetReconcile (split) != YREC)
-        return "";
-
-    char datebuff[MAX_DATE_LENGTH + 1];
-    qof_print_date_buff (datebuff, MAX_DATE_LENGTH, xaccSplitGetDateReconciled (split));
-    return datebuff;
-}
-
-// Account Name short or Long
-static std::string
-get_account_name (Split *split, bool full)
-{
-    auto account{xaccSplitGetAccount (split)};
-    return full ? account_get_fullname_str (account) : xaccAccountGetName (account);
-}
-
-// Number
-static std::string
-get_number (Transaction *trans)
+    time64 date;
+    GncGUID guid;
+    const char *num;
+    const char *description;
+    const char *notes;
+    const char *void_reason;
+    const char *action;
+    const char *memo;
+    const char *reconcile;
+    const AccountInfo *account;
+    const CurrencyInfo *currency;
+    /* The other account's full name, for the simple layout. */
+    const std::string *category;
+    std::optional<time64> reconcile_date;
+    gnc_numeric amount;
+    gnc_numeric value;
+    gnc_numeric price;
+};
+
+static const char*
+or_empty (const char *str)
 {
-    auto num{xaccTransGetNum (trans)};
-    return (num ? num : "");
+    return str ? str : "";
 }
 
-// Description
-static std::string
-get_description (Transaction *trans)
+class ExportLineReader
 {
-    auto desc{xaccTransGetDescription (trans)};
-    return (desc ? desc : "");
-}
-
-// Notes
-static std::string
-get_notes (Transaction *trans)
+public:
+    ExportLineReader (bool simple_layout) :
+        m_simple_layout {simple_layout},
+        m_split_category {_("-- Split Transaction --")} {}
+    ExportLine read (Transaction *trans, Split *split);
+
+private:
+    const AccountInfo *account_info (Account *acc);
+    const CurrencyInfo *currency_info (gnc_commodity *comm);
+    const char *reconcile_str (char flag);
+
+    bool m_simple_layout;
+    std::string m_split_category;
+    std::unordered_map<Account*, AccountInfo> m_accounts;
+    std::unordered_map<gnc_commodity*, CurrencyInfo> m_currencies;
+    std::unordered_map<char, const char*> m_reconcile_strs;
+};
+
+const AccountInfo*
+ExportLineReader::account_info (Account *acc)
 {
-    auto notes{xaccTransGetNotes (trans)};
-    return (notes ? notes : "");
+    auto [pos, inserted] = m_accounts.try_emplace (acc);
+    if (inserted)
+    {
+        auto& info = pos->second;
+        info.full_name = acc ? account_get_fullname_str (acc) : "";
+        info.name = acc ? or_empty (xaccAccountGetName (acc)) : "";
+        info.amount_info = gnc_account_print_info (acc, FALSE);
+        info.amount_sym_info = gnc_account_print_info (acc, TRUE);
+        info.price_info = gnc_default_price_print_info (acc ? xaccAccountGetCommodity (acc)
+                                                        : nullptr);
+    }
+    return &pos->second;
 }
 
-// Void reason
-static std::string
-get_void_reason (Transaction *trans)
+const CurrencyInfo*
+ExportLineReader::currency_info (gnc_commodity *comm)
 {
-    auto void_reason{xaccTransGetVoidReason (trans)};
-    return (void_reason ? void_reason : "");
+    auto [pos, inserted] = m_currencies.try_emplace (comm);
+    if (inserted)
+    {
+        auto& info = pos->second;
+        info.unique_name = or_empty (gnc_commodity_get_unique_name (comm));
+        info.value_info = gnc_commodity_print_info (comm, FALSE);
+        info.value_sym_info = gnc_commodity_print_info (comm, TRUE);
+    }
+    return &pos->second;
 }
 
-// Memo
-static std::string
-get_memo (Split *split)
+const char*
+ExportLineReader::reconcile_str (char flag)
 {
-    auto memo{xaccSplitGetMemo (split)};
-    return (memo ? memo : "");
+    auto [pos, inserted] = m_reconcile_strs.try_emplace (flag);
+    if (inserted)
+        pos->second = or_empty (gnc_get_reconcile_str (flag));
+    return pos->second;
 }
 
-// Full Category Path or Not
-static std::string
-get_category (Split *split, bool full)
+ExportLine
+ExportLineReader::read (Transaction *trans, Split *split)
 {
-    auto other{xaccSplitGetOtherSplit(split)};
-    return other ? get_account_name (other, full) : _("-- Split Transaction --");
-}
+    auto t_void{xaccTransGetVoidStatus (trans)};
+    auto recon{xaccSplitGetReconcile (split)};
+    ExportLine line {};
+    line.date = xaccTransGetDate (trans);
+    line.num = or_empty (xaccTransGetNum (trans));
+    line.description = or_empty (xaccTransGetDescription (trans));
+    line.reconcile = reconcile_str (recon);
+    line.account = account_info (xaccSplitGetAccount (split));
+    line.currency = currency_info (xaccTransGetCurrency (trans));
+    line.amount = t_void ? xaccSplitVoidFormerAmount (split) : xaccSplitGetAmount (split);
+    line.value = t_void ? xaccSplitVoidFormerValue (split) : xaccSplitGetValue (split);
+
+    if (m_simple_layout)
+    {
+        auto other{xaccSplitGetOtherSplit (split)};
+        line.category = other ? &account_info (xaccSplitGetAccount (other))->full_name
+            : &m_split_category;
+        line.price = t_void ? gnc_numeric_zero () : xaccSplitGetSharePrice (split);
+        return line;
+    }
 
-// Action
-static std::string
-get_action (Split *split)
-{
-    auto action{xaccSplitGetAction (split)};
-    return (action ? action : "");
+    line.guid = *qof_entity_get_guid (QOF_INSTANCE (trans));
+    line.notes = or_empty (xaccTransGetNotes (trans));
+    line.void_reason = or_empty (xaccTransGetVoidReason (trans));
+    line.action = or_empty (xaccSplitGetAction (split));
+    line.memo = or_empty (xaccSplitGetMemo (split));
+    if (recon == YREC)
+        line.reconcile_date = xaccSplitGetDateReconciled (split);
+    line.price = t_void
+        ? gnc_numeric_div (xaccSplitVoidFormerValue (split),
+                           xaccSplitVoidFormerAmount (split),
+                           GNC_DENOM_AUTO,
+                           GNC_HOW_DENOM_SIGFIGS(6) | GNC_HOW_RND_ROUND_HALF_UP)
+        : xaccSplitGetSharePrice (split);
+    return line;
 }
 
-// Reconcile
-static std::string
-get_reconcile (Split *split)
-{
-    auto recon{gnc_get_reconcile_str (xaccSplitGetReconcile (split))};
-    return (recon ? recon : "");
-}
+/******************** Formatting, on any thread *********************/
 
-// Transaction commodity
-static std::string
-get_commodity (Transaction *trans)
+class ExportLineFormatter
 {
-    return gnc_commodity_get_unique_name (xaccTransGetCurrency (trans));
-}
-
-// Amount with Symbol or not
-static std::string
-get_amount (Split *split, bool t_void, bool symbol)
+public:
+    ExportLineFormatter (bool simple_layout) : m_simple_layout {simple_layout} {}
+    const StringVec& format (const ExportLine& line);
+
+private:
+    const std::string& date (time64 time);
+    const char *amount (gnc_numeric val, const GNCPrintAmountInfo& info);
+
+    bool m_simple_layout;
+    StringVec m_fields;
+    /* Most transactions share their date with others. */
+    std::unordered_map<time64, std::string> m_dates;
+    char m_amount_buff[1024];
+};
+
+const std::string&
+ExportLineFormatter::date (time64 time)
 {
-    auto amt_num{t_void ? xaccSplitVoidFormerAmount (split) : xaccSplitGetAmount (split)};
-    return xaccPrintAmount (amt_num, gnc_split_amount_print_info (split, symbol));
+    auto [pos, inserted] = m_dates.try_emplace (time);
+    if (inserted)
+    {
+        char datebuff[MAX_DATE_LENGTH + 1];
+        qof_print_date_buff (datebuff, MAX_DATE_LENGTH, time);
+        pos->second = datebuff;
+    }
+    return pos->second;
 }
 
-// Value with Symbol or not
-static std::string
-get_value (Split *split, bool t_void, bool symbol)
+const char*
+ExportLineFormatter::amount (gnc_numeric val, const GNCPrintAmountInfo& info)
 {
-    auto trans{xaccSplitGetParent(split)};
-    auto tcurr{xaccTransGetCurrency (trans)};
-    auto pai{gnc_commodity_print_info (tcurr, symbol)};
-    auto amt_num{t_void ? xaccSplitVoidFormerValue (split): xaccSplitGetValue (split)};
-    return xaccPrintAmount (amt_num, pai);
+    if (!xaccSPrintAmount (m_amount_buff, val, info))
+        m_amount_buff[0] = '\0';
+    return m_amount_buff;
 }
 
-// Share Price / Conversion factor
-static std::string
-get_rate (Split *split, bool t_void)
+const StringVec&
+ExportLineFormatter::format (const ExportLine& line)
 {
-    auto curr{xaccAccountGetCommodity (xaccSplitGetAccount (split))};
-    auto amt_num{t_void ? gnc_numeric_zero() : xaccSplitGetSharePrice (split)};
-    return xaccPrintAmount (amt_num, gnc_default_price_print_info (curr));
-}
+    const auto& account{*line.account};
+    const auto& currency{*line.currency};
+    if (m_simple_layout)
+    {
+        /* Write line in simple layout, equivalent to a single line
+         * register view */
+        m_fields.resize (11);
+        m_fields[0] = date (line.date);
+        m_fields[1] = account.full_name;
+        m_fields[2] = line.num;
+        m_fields[3] = line.description;
+        m_fields[4] = *line.category;
+        m_fields[5] = line.reconcile;
+        m_fields[6] = amount (line.amount, account.amount_sym_info);
+        m_fields[7] = amount (line.amount, account.amount_info);
+        m_fields[8] = amount (line.value, currency.value_sym_info);
+        m_fields[9] = amount (line.value, currency.value_info);
+        m_fields[10] = amount (line.price, account.price_info);
+        return m_fields;
+    }
 
-// Share Price / Conversion factor
-static std::string
-get_price (Split *split, bool t_void)
-{
-    auto curr{xaccAccountGetCommodity (xaccSplitGetAccount (split))};
-    auto cf{t_void
-            ? gnc_numeric_div (xaccSplitVoidFormerValue (split),
-                               xaccSplitVoidFormerAmount (split),
-                               GNC_DENOM_AUTO,
-                               GNC_HOW_DENOM_SIGFIGS(6) | GNC_HOW_RND_ROUND_HALF_UP)
-            : xaccSplitGetSharePrice (split)};
-    return xaccPrintAmount (cf, gnc_default_price_print_info (curr));
+    m_fields.resize (18);
+    m_fields[0] = date (line.date);
+    m_fields[1].resize (GUID_ENCODING_LENGTH + 1);
+    guid_to_string_buff (&line.guid, m_fields[1].data ());
+    m_fields[1].resize (GUID_ENCODING_LENGTH);
+    m_fields[2] = line.num;
+    m_fields[3] = line.description;
+    m_fields[4] = line.notes;
+    m_fields[5] = currency.unique_name;
+    m_fields[6] = line.void_reason;
+    m_fields[7] = line.action;
+    m_fields[8] = line.memo;
+    m_fields[9] = account.full_name;
+    m_fields[10] = account.name;
+    m_fields[11] = amount (line.amount, account.amount_sym_info);
+    m_fields[12] = amount (line.amount, account.amount_info);
+    m_fields[13] = amount (line.value, currency.value_sym_info);
+    m_fields[14] = amount (line.value, currency.value_info);
+    m_fields[15] = line.reconcile;
+    if (line.reconcile_date)
+        m_fields[16] = date (*line.reconcile_date);
+    else
+        m_fields[16].clear ();
+    m_fields[17] = amount (line.price, account.price_info);
+    return m_fields;
 }
 
-/******************************************************************************/
-
-static StringVec
-make_simple_trans_line (Transaction *trans, Split *split)
+/*******************************************************
+ * write_lines
+ *
+ * format the lines in chunks on several threads and
+ * write the chunks in order
+ *******************************************************/
+static bool
+write_lines (CsvExportInfo *info, const std::vector<ExportLine>& lines,
+             std::ofstream& ss)
 {
-    auto t_void{xaccTransGetVoidStatus (trans)};
-    return {
-        get_date (trans),
-        get_account_name (split, true),
-        get_number (trans),
-        get_description (trans),
-        get_category (split, true),
-        get_reconcile (split),
-        get_amount (split, t_void, true),
-        get_amount (split, t_void, false),
-        get_value (split, t_void, true),
-        get_value (split, t_void, false),
-        get_rate (split, t_void)
+    auto num_chunks = (lines.size () + format_chunk_size - 1) / format_chunk_size;
+    auto num_threads = std::min<size_t> (std::thread::hardware_concurrency (),
+                                         num_chunks);
+    std::vector<std::string> chunks (num_chunks);
+    std::atomic<size_t> next_chunk {0};
+    /* xaccSPrintAmount reads the commodity's user symbol from its KVP
+     * through gnc_commodity_get_nice_symbol, so the workers do read the
+     * engine. That is only safe because nothing changes it meanwhile: the
+     * main thread runs a worker itself and then blocks in join, and no
+     * other thread uses the engine. Keep it that way, e.g. don't return
+     * to the main loop or run events before all workers are joined. */
+    auto worker = [&]()
+    {
+        ExportLineFormatter formatter {static_cast<bool>(info->simple_layout)};
+        for (auto chunk = next_chunk++; chunk < num_chunks; chunk = next_chunk++)
+        {
+            auto end = std::min (lines.size (), (chunk + 1) * format_chunk_size);
+            for (auto pos = chunk * format_chunk_size; pos < end; ++pos)
+                gnc_csv_add_line (chunks[chunk], formatter.format (lines[pos]),
+                                  info->use_quotes, info->separator_str);
+        }
     };
-}
 
-static StringVec
-make_complex_trans_line (Transaction *trans, Split *split)
-{
-    auto t_void{xaccTransGetVoidStatus (trans)};
-    return {
-        get_date (trans),
-        get_guid (trans),
-        get_number (trans),
-        get_description (trans),
-        get_notes (trans),
-        get_commodity (trans),
-        get_void_reason (trans),
-        get_action (split),
-        get_memo (split),
-        get_account_name (split, true),
-        get_account_name (split, false),
-        get_amount (split, t_void, true),
-        get_amount (split, t_void, false),
-        get_value (split, t_void, true),
-        get_value (split, t_void, false),
-        get_reconcile (split),
-        get_reconcile_date (split),
-        get_price (split, t_void)
-    };
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < num_threads; ++i)
+        threads.emplace_back (worker);
+    worker ();
+    for (auto& thread : threads)
+        thread.join ();
+
+    for (const auto& chunk : chunks)
+        ss.write (chunk.data (), chunk.size ());
+    return !ss.fail ();
 }
 
 using TransSet = std::unordered_set<Transaction*>;
@@ -257,7 +356,8 @@ using TransSet = std::unordered_set<Transaction*>;
  *******************************************************/
 static
 void account_splits (CsvExportInfo *info, Account *acc, std::ofstream& ss,
-                     TransSet& trans_set)
+                     TransSet& trans_set, ExportLineReader& reader,
+                     std::vector<ExportLine>& lines)
 {
     bool is_trading_acct = acc && (xaccAccountGetType (acc) == ACCT_TYPE_TRADING);
 
@@ -299,40 +399,35 @@ void account_splits (CsvExportInfo *info, Account *acc, std::ofstream& ss,
             (xaccAccountGetType (split_acc) == ACCT_TYPE_TRADING))
             continue;
 
-        if (info->simple_layout)
+        // Transaction line, or the only line in the simple layout.
+        lines.push_back (reader.read (trans, split));
+
+        if (!info->simple_layout)
         {
-            // Write line in simple layout, equivalent to a single line register view
-            auto line = make_simple_trans_line (trans, split);
-            info->failed = !gnc_csv_add_line (ss, line, info->use_quotes,
-                                              info->separator_str);
-            continue;
+            /* Loop through the list of splits for the Transaction */
+            for (auto node = xaccTransGetSplitList (trans); node; node = node->next)
+            {
+                auto t_split{static_cast<Split*>(node->data)};
+
+                // base split is already written on the trans_line
+                if (split == t_split)
+                    continue;
+
+                // Only export trading splits if exporting a trading account
+                Account *tsplit_acc = xaccSplitGetAccount (t_split);
+                if (!is_trading_acct &&
+                    (xaccAccountGetType (tsplit_acc) == ACCT_TYPE_TRADING))
+                    continue;
+
+                // Split line.
+                lines.push_back (reader.read (trans, t_split));
+            }
         }
 
-        // Write complex Transaction Line.
-        auto line = make_complex_trans_line (trans, split);
-        info->failed = !gnc_csv_add_line (ss, line, info->use_quotes,
-                                          info->separator_str);
-
-        /* Loop through the list of splits for the Transaction */
-        for (auto node = xaccTransGetSplitList (trans); !info->failed && node;
-             node = node->next)
+        if (lines.size () >= export_batch_size)
         {
-            auto t_split{static_cast<Split*>(node->data)};
-
-            // base split is already written on the trans_line
-            if (split == t_split)
-                continue;
-
-            // Only export trading splits if exporting a trading account
-            Account *tsplit_acc = xaccSplitGetAccount (t_split);
-            if (!is_trading_acct &&
-                (xaccAccountGetType (tsplit_acc) == ACCT_TYPE_TRADING))
-                continue;
-
-            // Write complex Split Line.
-            auto line = make_complex_trans_line (trans, t_split);
-            info->failed = !gnc_csv_add_line (ss, line, info->use_quotes,
-                                              info->separator_str);
+            info->failed = !write_lines (info, lines, ss);
+            lines.clear ();
         }
     }
 
@@ -399,16 +494,27 @@ void csv_transactions_export (CsvExportInfo *info)
     auto ss{gnc_open_filestream(info->file_name)};
     info->failed = !gnc_csv_add_line (ss, headers, info->use_quotes, info->separator_str);
 
+    /* The formatting threads read the locale data these set up on
+     * their first call; make those calls before there are threads. */
+    gnc_localeconv ();
+    char datebuff[MAX_DATE_LENGTH + 1];
+    qof_print_date_buff (datebuff, MAX_DATE_LENGTH, gnc_time (nullptr));
+
     /* Go through list of accounts */
     TransSet trans_set;
+    ExportLineReader reader {static_cast<bool>(info->simple_layout)};
+    std::vector<ExportLine> lines;
+    lines.reserve (export_batch_size);
     for (auto ptr = info->csva.account_list; !info->failed && ptr;
          ptr = g_list_next(ptr))
     {
         auto acc{static_cast<Account*>(ptr->data)};
         DEBUG("Account being processed is : %s", xaccAccountGetName (acc));
-        account_splits (info, acc, ss, trans_set);
-        info->failed = ss.fail();
+        account_splits (info, acc, ss, trans_set, reader, lines);
+        info->failed = info->failed || ss.fail();
     }
+    if (!info->failed && !lines.empty ())
+        info->failed = !write_lines (info, lines, ss);
 
     LEAVE("");
 }
@@ -90,3 +90,23 @@ TEST (CsvHelperTest, ForcedQuote)
     ASSERT_EQ (ss.str(), "A;B;C;\"\n\";\"D\r\"" EOLSTR);
 
 }
+
+TEST (CsvHelperTest, StringBuffer)
+{
+    std::string buf;
+    gnc_csv_add_line (buf, { "A","B\"C","D,E","" }, false, ",");
+    ASSERT_EQ (buf, "A,\"B\"\"C\",\"D,E\"," EOLSTR);
+
+    gnc_csv_add_line (buf, { "\"\"","F" }, true, ";");
+    ASSERT_EQ (buf, "A,\"B\"\"C\",\"D,E\"," EOLSTR "\"\"\"\"\"\";\"F\"" EOLSTR);
+
+    for (auto use_quotes : {false, true})
+    {
+        StringVec line { "A","B\"","\n","C;D","" };
+        std::ostringstream ss;
+        std::string str;
+        gnc_csv_add_line (ss, line, use_quotes, ";");
+        gnc_csv_add_line (str, line, use_quotes, ";");
+        ASSERT_EQ (ss.str(), str);
+    }
+}
@@ -0,0 +1,67 @@
+/********************************************************************\
+ * gnc-imp-parse.cpp - parse date and amount columns ahead of       *
+ *                     setting them in the import properties        *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+#include "gnc-imp-parse.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "gnc-locale-utils.h"
+
+/* Rows handed to a thread at a time. Parsing a cell takes a few
+ * microseconds, so smaller chunks aren't worth starting a thread for. */
+static const size_t parse_chunk_size = 1024;
+
+std::vector<GncParsedCell>
+gnc_imp_parse_rows (size_t num_rows,
+                    const std::function<GncParsedCell(size_t)>& parse)
+{
+    std::vector<GncParsedCell> cells (num_rows);
+    auto num_chunks = (num_rows + parse_chunk_size - 1) / parse_chunk_size;
+    auto num_threads = std::min<size_t> (std::thread::hardware_concurrency(),
+                                         num_chunks);
+
+    /* The amount parsers read the locale data gnc_localeconv() sets up
+     * on its first call; make that call before there are other threads. */
+    gnc_localeconv();
+
+    std::atomic<size_t> next_chunk {0};
+    auto worker = [&]()
+    {
+        for (auto chunk = next_chunk++; chunk < num_chunks; chunk = next_chunk++)
+        {
+            auto end = std::min (num_rows, (chunk + 1) * parse_chunk_size);
+            for (auto row = chunk * parse_chunk_size; row < end; ++row)
+                cells[row] = parse (row);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < num_threads; ++i)
+        threads.emplace_back (worker);
+    worker();
+    for (auto& thread : threads)
+        thread.join();
+
+    return cells;
+}
@@ -0,0 +1,80 @@
+/********************************************************************\
+ * gnc-imp-parse.hpp - parse date and amount columns ahead of       *
+ *                     setting them in the import properties        *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+/** @file
+     @brief Parsing the date and amount cells of a whole column at once.
+     Every line of an import is independent until the transactions or
+     prices are assembled, and converting dates and amounts is the bulk
+     of the work of setting a column's type. The importers parse those
+     columns for all lines up front, spread over several threads, and
+     keep the results per column, property type and format so that
+     switching a column back and forth doesn't parse it again.
+     *
+     gnc-imp-parse.hpp
+ */
+
+#ifndef GNC_IMP_PARSE_HPP
+#define GNC_IMP_PARSE_HPP
+
+#include <config.h>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <variant>
+#include <vector>
+#include <gnc-datetime.hpp>
+#include <gnc-numeric.hpp>
+
+/** A cell parsed ahead as a date or an amount, or the message of the
+ *  exception parsing it threw. std::monostate if it wasn't parsed ahead. */
+using GncParsedCell = std::variant<std::monostate, GncDate, GncNumeric, std::string>;
+
+/** Parsed cells of whole columns, by column, property type (as an int)
+ *  and the date or currency format they were parsed with. */
+using GncParsedColumns = std::map<std::tuple<uint32_t, int, int>,
+                                  std::vector<GncParsedCell>>;
+
+/** Call parse for each row in [0, num_rows) and collect the results,
+ *  spreading the rows over several threads for large imports.
+ *  parse must not throw, nor use the engine or other shared state. */
+std::vector<GncParsedCell> gnc_imp_parse_rows (size_t num_rows,
+        const std::function<GncParsedCell(size_t)>& parse);
+
+/** Get the value of type T parsed ahead in cell, or parse it now with
+ *  parse if it wasn't.
+ *  @exception std::invalid_argument with the stored message if parsing
+ *  the cell ahead failed. */
+template <typename T, typename Parse> T
+gnc_imp_parsed_value (const GncParsedCell& cell, Parse&& parse)
+{
+    if (auto value = std::get_if<T>(&cell))
+        return *value;
+    if (auto error = std::get_if<std::string>(&cell))
+        throw std::invalid_argument (*error);
+    return parse();
+}
+
+#endif
@@ -65,10 +65,11 @@ std::map<GncPricePropType, const char*> gnc_price_col_type_strs = {
 GncNumeric parse_amount_price (const std::string &str, int currency_format)
 {
     /* If a cell is empty or just spaces return invalid amount */
-    if(!boost::regex_search(str, boost::regex("[0-9]")))
+    static const boost::regex digit ("[0-9]");
+    if(!boost::regex_search(str, digit))
         throw std::invalid_argument (_("Value doesn't appear to contain a valid number."));
 
-    auto expr = boost::make_u32regex("[[:Sc:]]");
+    static const auto expr = boost::make_u32regex("[[:Sc:]]");
     std::string str_no_symbols = boost::u32regex_replace(str, expr, "");
 
     /* Convert based on user chosen currency format */
@@ -96,6 +97,28 @@ GncNumeric parse_amount_price (const std::string &str, int currency_format)
     return GncNumeric(val);
 }
 
+GncParsedCell parse_cell_price (GncPricePropType prop, const std::string& value, int format)
+{
+    try
+    {
+        switch (prop)
+        {
+            case GncPricePropType::DATE:
+                return GncDate (value, GncDate::c_formats[format].m_fmt);
+
+            case GncPricePropType::AMOUNT:
+                return parse_amount_price (value, format);
+
+            default:
+                return {};
+        }
+    }
+    catch (const std::exception& e)
+    {
+        return std::string {e.what()};
+    }
+}
+
 /** Convert the combination of symbol_str and namespace_str into a gnc_commodity.
  * @param symbol_str The symbol string to be parsed
  * @param namespace_str The Namespace for this commodity
@@ -146,7 +169,8 @@ bool parse_namespace (const std::string& namespace_str)
     return false;
 }
 
-void GncImportPrice::set (GncPricePropType prop_type, const std::string& value, bool enable_test_empty)
+void GncImportPrice::set (GncPricePropType prop_type, const std::string& value, bool enable_test_empty,
+                          const GncParsedCell& parsed)
 {
     try
     {
@@ -162,12 +186,14 @@ void GncImportPrice::set (GncPricePropType prop_type, const std::string& value,
         {
             case GncPricePropType::DATE:
                 m_date.reset();
-                m_date = GncDate(value, GncDate::c_formats[m_date_format].m_fmt); // Throws if parsing fails
+                m_date = gnc_imp_parsed_value<GncDate> (parsed, [&]()
+                    { return GncDate (value, GncDate::c_formats[m_date_format].m_fmt); }); // Throws if parsing fails
                 break;
 
             case GncPricePropType::AMOUNT:
                 m_amount.reset();
-                m_amount = parse_amount_price (value, m_currency_format); // Throws if parsing fails
+                m_amount = gnc_imp_parsed_value<GncNumeric> (parsed, [&]()
+                    { return parse_amount_price (value, m_currency_format); }); // Throws if parsing fails
                 break;
 
             case GncPricePropType::FROM_SYMBOL:
@@ -39,6 +39,7 @@
 #include <optional>
 #include <gnc-datetime.hpp>
 #include <gnc-numeric.hpp>
+#include "gnc-imp-parse.hpp"
 
 /** Enumeration for column types. These are the different types of
  * columns that can exist in a CSV/Fixed-Width file. There should be
@@ -80,13 +81,25 @@ gnc_commodity* parse_commodity_price_comm (const std::string& symbol_str, const
 bool parse_namespace (const std::string& namespace_str);
 GncNumeric parse_amount_price (const std::string &str, int currency_format);
 
+/** Parse a date or amount cell the way GncImportPrice::set would. This
+ *  doesn't touch the engine, so it can run on any thread.
+ *  @param format the date format for dates, the currency format for
+ *  amounts
+ *  @return the parsed value or error, or std::monostate for the other
+ *  properties.
+ */
+GncParsedCell parse_cell_price (GncPricePropType prop, const std::string& value, int format);
+
 struct GncImportPrice
 {
 public:
     GncImportPrice (int date_format, int currency_format) : m_date_format{date_format},
         m_currency_format{currency_format}{};
 
-    void set (GncPricePropType prop_type, const std::string& value, bool enable_test_empty);
+    /** Set a property from its cell's text. A date or amount cell that
+     *  was parsed ahead with parse_cell_price() can be passed in parsed. */
+    void set (GncPricePropType prop_type, const std::string& value, bool enable_test_empty,
+              const GncParsedCell& parsed = {});
     void set_date_format (int date_format) { m_date_format = date_format ;}
     void set_currency_format (int currency_format) { m_currency_format = currency_format ;}
     void reset (GncPricePropType prop_type);
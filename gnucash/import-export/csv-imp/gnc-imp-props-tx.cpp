@@ -135,10 +135,11 @@ GncNumeric parse_monetary (const std::string &str, int currency_format)
         return GncNumeric{};
 
     /* Strings otherwise containing no digits will be considered invalid */
-    if(!boost::regex_search(str, boost::regex("[0-9]")))
+    static const boost::regex digit ("[0-9]");
+    if(!boost::regex_search(str, digit))
         throw std::invalid_argument (_("Value doesn't appear to contain a valid number."));
 
-    auto expr = boost::make_u32regex("[[:Sc:][:blank:]]|--");
+    static const auto expr = boost::make_u32regex("[[:Sc:][:blank:]]|--");
     std::string str_no_symbols = boost::u32regex_replace(str, expr, "");
 
     /* Convert based on user chosen currency format */
@@ -166,6 +167,74 @@ GncNumeric parse_monetary (const std::string &str, int currency_format)
     return GncNumeric(val);
 }
 
+bool is_preparsed_prop (GncTransPropType prop)
+{
+    switch (prop)
+    {
+        case GncTransPropType::DATE:
+        case GncTransPropType::REC_DATE:
+        case GncTransPropType::TREC_DATE:
+        case GncTransPropType::AMOUNT:
+        case GncTransPropType::AMOUNT_NEG:
+        case GncTransPropType::VALUE:
+        case GncTransPropType::VALUE_NEG:
+        case GncTransPropType::PRICE:
+        case GncTransPropType::TAMOUNT:
+        case GncTransPropType::TAMOUNT_NEG:
+            return true;
+        default:
+            return false;
+    }
+}
+
+GncParsedCell parse_cell (GncTransPropType prop, const std::string& value, int format)
+{
+    try
+    {
+        switch (prop)
+        {
+            case GncTransPropType::DATE:
+            case GncTransPropType::REC_DATE:
+            case GncTransPropType::TREC_DATE:
+                if (value.empty())
+                    return {};
+                return GncDate (value, GncDate::c_formats[format].m_fmt);
+
+            case GncTransPropType::AMOUNT:
+            case GncTransPropType::AMOUNT_NEG:
+            case GncTransPropType::VALUE:
+            case GncTransPropType::VALUE_NEG:
+            case GncTransPropType::PRICE:
+            case GncTransPropType::TAMOUNT:
+            case GncTransPropType::TAMOUNT_NEG:
+                return parse_monetary (value, format);
+
+            default:
+                return {};
+        }
+    }
+    catch (const std::exception& e)
+    {
+        return std::string {e.what()};
+    }
+}
+
+/* Get a date or amount from its cell, using the value parsed ahead if
+ * there is one. Both throw if parsing fails. */
+static GncDate
+cell_date (const std::string& value, int date_format, const GncParsedCell& parsed)
+{
+    return gnc_imp_parsed_value<GncDate> (parsed, [&]()
+        { return GncDate (value, GncDate::c_formats[date_format].m_fmt); });
+}
+
+static GncNumeric
+cell_monetary (const std::string& value, int currency_format, const GncParsedCell& parsed)
+{
+    return gnc_imp_parsed_value<GncNumeric> (parsed, [&]()
+        { return parse_monetary (value, currency_format); });
+}
+
 static char parse_reconciled (const std::string& reconcile)
 {
     if (g_strcmp0 (reconcile.c_str(), gnc_get_reconcile_str(NREC)) == 0) // Not reconciled
@@ -221,7 +290,8 @@ gnc_commodity* parse_commodity (const std::string& comm_str)
         return comm;
 }
 
-void GncPreTrans::set (GncTransPropType prop_type, const std::string& value)
+void GncPreTrans::set (GncTransPropType prop_type, const std::string& value,
+                       const GncParsedCell& parsed)
 {
     try
     {
@@ -239,7 +309,7 @@ void GncPreTrans::set (GncTransPropType prop_type, const std::string& value)
             case GncTransPropType::DATE:
                 m_date.reset();
                 if (!value.empty())
-                    m_date = GncDate(value, GncDate::c_formats[m_date_format].m_fmt); // Throws if parsing fails
+                    m_date = cell_date (value, m_date_format, parsed); // Throws if parsing fails
                 else if (!m_multi_split)
                     throw std::invalid_argument (
                         (bl::format (std::string{_("Date field can not be empty if 'Multi-split' option is unset.\n")}) %
@@ -316,6 +386,19 @@ StrVec GncPreTrans::verify_essentials (void)
     return errors;
 }
 
+GNCImportLastSplitInfo DraftTransaction::last_split_info () const
+{
+    return GNCImportLastSplitInfo {
+        m_price ? static_cast<gnc_numeric>(*m_price) : gnc_numeric{0, 0},
+        m_taction ? m_taction->c_str() : nullptr,
+        m_tmemo ? m_tmemo->c_str() : nullptr,
+        m_tamount ? static_cast<gnc_numeric>(*m_tamount) : gnc_numeric{0, 0},
+        m_taccount ? *m_taccount : nullptr,
+        m_trec_state ? *m_trec_state : '\0',
+        m_trec_date ? static_cast<time64>(GncDateTime(*m_trec_date, DayPart::neutral)) : 0,
+    };
+}
+
 std::shared_ptr<DraftTransaction> GncPreTrans::create_trans (QofBook* book, gnc_commodity* currency)
 {
     if (created)
@@ -419,7 +502,8 @@ void GncPreSplit::UpdateCrossSplitCounters ()
     }
 }
 
-void GncPreSplit::set (GncTransPropType prop_type, const std::string& value)
+void GncPreSplit::set (GncTransPropType prop_type, const std::string& value,
+                       const GncParsedCell& parsed)
 {
     try
     {
@@ -478,32 +562,32 @@ void GncPreSplit::set (GncTransPropType prop_type, const std::string& value)
 
             case GncTransPropType::AMOUNT:
                 m_amount.reset();
-                m_amount = parse_monetary (value, m_currency_format); // Will throw if parsing fails
+                m_amount = cell_monetary (value, m_currency_format, parsed); // Will throw if parsing fails
                 break;
 
             case GncTransPropType::AMOUNT_NEG:
                 m_amount_neg.reset();
-                m_amount_neg = parse_monetary (value, m_currency_format); // Will throw if parsing fails
+                m_amount_neg = cell_monetary (value, m_currency_format, parsed); // Will throw if parsing fails
                 break;
 
             case GncTransPropType::VALUE:
                 m_value.reset();
-                m_value = parse_monetary (value, m_currency_format); // Will throw if parsing fails
+                m_value = cell_monetary (value, m_currency_format, parsed); // Will throw if parsing fails
                 break;
 
             case GncTransPropType::VALUE_NEG:
                 m_value_neg.reset();
-                m_value_neg = parse_monetary (value, m_currency_format); // Will throw if parsing fails
+                m_value_neg = cell_monetary (value, m_currency_format, parsed); // Will throw if parsing fails
                 break;
 
             case GncTransPropType::TAMOUNT:
                 m_tamount.reset();
-                m_tamount = parse_monetary (value, m_currency_format); // Will throw if parsing fails
+                m_tamount = cell_monetary (value, m_currency_format, parsed); // Will throw if parsing fails
                 break;
 
             case GncTransPropType::TAMOUNT_NEG:
                 m_tamount_neg.reset();
-                m_tamount_neg = parse_monetary (value, m_currency_format); // Will throw if parsing fails
+                m_tamount_neg = cell_monetary (value, m_currency_format, parsed); // Will throw if parsing fails
                 break;
 
             case GncTransPropType::PRICE:
@@ -511,7 +595,7 @@ void GncPreSplit::set (GncTransPropType prop_type, const std::string& value)
                  * the same decimal point as currencies in the csv file, so parse
                  * using the same parser */
                 m_price.reset();
-                m_price = parse_monetary (value, m_currency_format); // Will throw if parsing fails
+                m_price = cell_monetary (value, m_currency_format, parsed); // Will throw if parsing fails
                 break;
 
             case GncTransPropType::REC_STATE:
@@ -527,15 +611,13 @@ void GncPreSplit::set (GncTransPropType prop_type, const std::string& value)
             case GncTransPropType::REC_DATE:
                 m_rec_date.reset();
                 if (!value.empty())
-                    m_rec_date = GncDate (value,
-                                          GncDate::c_formats[m_date_format].m_fmt); // Throws if parsing fails
+                    m_rec_date = cell_date (value, m_date_format, parsed); // Throws if parsing fails
                 break;
 
             case GncTransPropType::TREC_DATE:
                 m_trec_date.reset();
                 if (!value.empty())
-                    m_trec_date = GncDate (value,
-                                           GncDate::c_formats[m_date_format].m_fmt); // Throws if parsing fails
+                    m_trec_date = cell_date (value, m_date_format, parsed); // Throws if parsing fails
                 break;
 
             default:
@@ -565,7 +647,8 @@ void GncPreSplit::reset (GncTransPropType prop_type)
         m_errors.erase(prop_type);
 }
 
-void GncPreSplit::add (GncTransPropType prop_type, const std::string& value)
+void GncPreSplit::add (GncTransPropType prop_type, const std::string& value,
+                       const GncParsedCell& parsed)
 {
     try
     {
@@ -577,42 +660,42 @@ void GncPreSplit::add (GncTransPropType prop_type, const std::string& value)
         switch (prop_type)
         {
             case GncTransPropType::AMOUNT:
-                num_val = parse_monetary (value, m_currency_format); // Will throw if parsing fails
+                num_val = cell_monetary (value, m_currency_format, parsed); // Will throw if parsing fails
                 if (m_amount)
                     num_val += *m_amount;
                 m_amount = num_val;
                 break;
 
             case GncTransPropType::AMOUNT_NEG:
-                num_val = parse_monetary (value, m_currency_format); // Will throw if parsing fails
+                num_val = cell_monetary (value, m_currency_format, parsed); // Will throw if parsing fails
                 if (m_amount_neg)
                     num_val += *m_amount_neg;
                 m_amount_neg = num_val;
                 break;
 
             case GncTransPropType::VALUE:
-                num_val = parse_monetary (value, m_currency_format); // Will throw if parsing fails
+                num_val = cell_monetary (value, m_currency_format, parsed); // Will throw if parsing fails
                 if (m_value)
                     num_val += *m_value;
             m_value = num_val;
             break;
 
             case GncTransPropType::VALUE_NEG:
-                num_val = parse_monetary (value, m_currency_format); // Will throw if parsing fails
+                num_val = cell_monetary (value, m_currency_format, parsed); // Will throw if parsing fails
                 if (m_value_neg)
                     num_val += *m_value_neg;
             m_value_neg = num_val;
             break;
 
             case GncTransPropType::TAMOUNT:
-                num_val = parse_monetary (value, m_currency_format); // Will throw if parsing fails
+                num_val = cell_monetary (value, m_currency_format, parsed); // Will throw if parsing fails
                 if (m_tamount)
                     num_val += *m_tamount;
                 m_tamount = num_val;
                 break;
 
             case GncTransPropType::TAMOUNT_NEG:
-                num_val = parse_monetary (value, m_currency_format); // Will throw if parsing fails
+                num_val = cell_monetary (value, m_currency_format, parsed); // Will throw if parsing fails
                 if (m_tamount_neg)
                     num_val += *m_tamount_neg;
                 m_tamount_neg = num_val;
@@ -34,6 +34,7 @@
 #include "Account.h"
 #include "Transaction.h"
 #include "gnc-commodity.h"
+#include "import-backend.h"
 
 #include <string>
 #include <map>
@@ -41,6 +42,7 @@
 #include <optional>
 #include <gnc-datetime.hpp>
 #include <gnc-numeric.hpp>
+#include "gnc-imp-parse.hpp"
 
 /** Enumeration for column types. These are the different types of
  * columns that can exist in a CSV/Fixed-Width file. There should be
@@ -120,6 +122,22 @@ GncTransPropType sanitize_trans_prop (GncTransPropType prop, bool multi_split);
 gnc_commodity* parse_commodity (const std::string& comm_str);
 GncNumeric parse_monetary (const std::string &str, int currency_format);
 
+/** Date and amount properties are parsed for whole columns at once,
+ *  ahead of setting them. This function returns true if prop is such a
+ *  property.
+ */
+bool is_preparsed_prop (GncTransPropType prop);
+
+/** Parse a cell the way GncPreTrans::set or GncPreSplit::set would for
+ *  a date or amount property. This doesn't touch the engine, so it can
+ *  run on any thread.
+ *  @param format the date format for date properties, the currency
+ *  format for amounts
+ *  @return the parsed value or error, or std::monostate for an empty
+ *  date or a property that isn't preparsed.
+ */
+GncParsedCell parse_cell (GncTransPropType prop, const std::string& value, int format);
+
 
 /** The final form of a transaction to import before it is passed on to the
  *  generic importer.
@@ -149,6 +167,10 @@ struct DraftTransaction
     std::optional<GncDate> m_trec_date;
 
     std::optional<std::string> void_reason;
+
+    /** The data for the balancing split in the form the generic import
+     *  matcher takes it. Its strings point into this draft transaction. */
+    GNCImportLastSplitInfo last_split_info () const;
 };
 
 class GncPreTrans
@@ -157,7 +179,10 @@ public:
     GncPreTrans(int date_format, bool multi_split)
         : m_date_format{date_format}, m_multi_split{multi_split}, m_currency{nullptr} {};
 
-    void set (GncTransPropType prop_type, const std::string& value);
+    /** Set a property from its cell's text. A date cell that was parsed
+     *  ahead with parse_cell() can be passed in parsed. */
+    void set (GncTransPropType prop_type, const std::string& value,
+              const GncParsedCell& parsed = {});
     void set_date_format (int date_format) { m_date_format = date_format ;}
     void set_multi_split (bool multi_split) { m_multi_split = multi_split ;}
     void reset (GncTransPropType prop_type);
@@ -223,9 +248,14 @@ class GncPreSplit
 public:
     GncPreSplit (int date_format, int currency_format) : m_date_format{date_format},
         m_currency_format{currency_format} {};
-    void set (GncTransPropType prop_type, const std::string& value);
+    /** Set or add to a property from its cell's text. A date or amount
+     *  cell that was parsed ahead with parse_cell() can be passed in
+     *  parsed. */
+    void set (GncTransPropType prop_type, const std::string& value,
+              const GncParsedCell& parsed = {});
     void reset (GncTransPropType prop_type);
-    void add (GncTransPropType prop_type, const std::string& value);
+    void add (GncTransPropType prop_type, const std::string& value,
+              const GncParsedCell& parsed = {});
     void set_date_format (int date_format) { m_date_format = date_format ;}
     void set_currency_format (int currency_format) { m_currency_format = currency_format; }
     void set_pre_trans (std::shared_ptr<GncPreTrans> pre_trans) { m_pre_trans = pre_trans; }
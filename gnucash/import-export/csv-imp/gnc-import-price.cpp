@@ -378,18 +378,19 @@ void GncPriceImport::tokenize (bool guessColTypes)
         return;
 
     uint32_t max_cols = 0;
-    m_tokenizer->tokenize();
     m_parsed_lines.clear();
-    for (auto tokenized_line : m_tokenizer->get_tokens())
+    m_parsed_columns.clear();
+    m_tokenizer->tokenize_rows ([this, &max_cols](const StrViewVec& tokenized_line)
     {
         auto length = tokenized_line.size();
         if (length > 0)
-            m_parsed_lines.push_back (std::make_tuple (tokenized_line, std::string(),
+            m_parsed_lines.push_back (std::make_tuple (StrVec (tokenized_line.begin(), tokenized_line.end()),
+                    std::string(),
                     std::make_shared<GncImportPrice>(date_format(), currency_format()),
                     false));
         if (length > max_cols)
             max_cols = length;
-    }
+    });
 
     /* If it failed, generate an error. */
     if (m_parsed_lines.size() == 0)
@@ -665,6 +666,46 @@ GncPriceImport::check_for_column_type (GncPricePropType type)
                         != m_settings.m_column_types_price.end());
 }
 
+std::tuple<uint32_t, int, int>
+GncPriceImport::parsed_column_key (uint32_t col, GncPricePropType type)
+{
+    auto format = (type == GncPricePropType::DATE) ? m_settings.m_date_format :
+                                                      m_settings.m_currency_format;
+    return std::make_tuple (col, static_cast<int>(type), format);
+}
+
+/* Parse the column's cells with the current format, unless that was
+ * done before. */
+void GncPriceImport::preparse_column (uint32_t col, GncPricePropType type)
+{
+    if ((type != GncPricePropType::DATE) && (type != GncPricePropType::AMOUNT))
+        return;
+
+    auto key = parsed_column_key (col, type);
+    if (m_parsed_columns.find (key) != m_parsed_columns.end())
+        return;
+
+    auto format = std::get<2>(key);
+    auto parse = [this, col, type, format](size_t row)
+    {
+        auto& input = std::get<PL_INPUT>(m_parsed_lines[row]);
+        return parse_cell_price (type, col < input.size() ? input[col] : std::string(), format);
+    };
+    m_parsed_columns.emplace (key, gnc_imp_parse_rows (m_parsed_lines.size(), parse));
+}
+
+/* The cell at row and col as parsed by preparse_column, or std::monostate
+ * if it wasn't. */
+const GncParsedCell&
+GncPriceImport::parsed_cell (uint32_t row, uint32_t col, GncPricePropType type)
+{
+    static const GncParsedCell not_parsed;
+    auto iter = m_parsed_columns.find (parsed_column_key (col, type));
+    if ((iter == m_parsed_columns.end()) || (row >= iter->second.size()))
+        return not_parsed;
+    return iter->second[row];
+}
+
 /* A helper function intended to be called only from set_column_type_price */
 void GncPriceImport::update_price_props (uint32_t row, uint32_t col, GncPricePropType prop_type)
 {
@@ -699,7 +740,8 @@ void GncPriceImport::update_price_props (uint32_t row, uint32_t col, GncPricePro
                 if (m_settings.m_from_commodity)
                     enable_test_empty = false;
             }
-            price_props->set(prop_type, value, enable_test_empty);
+            price_props->set(prop_type, value, enable_test_empty,
+                             parsed_cell (row, col, prop_type));
         }
         catch (const std::exception& e)
         {
@@ -742,6 +784,9 @@ GncPriceImport::set_column_type_price (uint32_t position, GncPricePropType type,
     if (type == GncPricePropType::TO_CURRENCY)
         to_currency (nullptr);
 
+    /* Parse the date and amount cells of the column up front */
+    preparse_column (position, type);
+
     /* Update the preparsed data */
     for (auto parsed_lines_it = m_parsed_lines.begin();
             parsed_lines_it != m_parsed_lines.end();
@@ -38,6 +38,7 @@
 #include <map>
 #include <memory>
 #include <optional>
+#include <tuple>
 
 #include "gnc-tokenizer.hpp"
 #include "gnc-imp-props-price.hpp"
@@ -157,12 +158,20 @@ private:
     /* Internal helper function to force reparsing of columns subject to format changes */
     void reset_formatted_column (std::vector<GncPricePropType>& col_types);
 
+    /* Internal helper functions to parse date and amount columns ahead
+     * and look up the results */
+    std::tuple<uint32_t, int, int> parsed_column_key (uint32_t col, GncPricePropType type);
+    void preparse_column (uint32_t col, GncPricePropType type);
+    const GncParsedCell& parsed_cell (uint32_t row, uint32_t col, GncPricePropType type);
+
     /* Two internal helper functions that should only be called from within
      * set_column_type_price for consistency (otherwise error messages may not be (re)set)
      */
     void update_price_props (uint32_t row, uint32_t col, GncPricePropType prop_type);
 
     CsvPriceImpSettings m_settings;
+    /* Date and amount columns parsed ahead, see preparse_column */
+    GncParsedColumns m_parsed_columns;
     bool m_skip_errors;
     bool m_over_write;
 };
@@ -400,9 +400,9 @@ void GncTxImport::tokenize (bool guessColTypes)
         return;
 
     uint32_t max_cols = 0;
-    m_tokenizer->tokenize();
     m_parsed_lines.clear();
-    for (auto tokenized_line : m_tokenizer->get_tokens())
+    m_parsed_columns.clear();
+    m_tokenizer->tokenize_rows ([this, &max_cols](const StrViewVec& tokenized_line)
     {
         auto length = tokenized_line.size();
         if (length > 0)
@@ -410,12 +410,12 @@ void GncTxImport::tokenize (bool guessColTypes)
             auto pretrans = std::make_shared<GncPreTrans>(date_format(), m_settings.m_multi_split);
             auto presplit = std::make_shared<GncPreSplit>(date_format(), currency_format());
             presplit->set_pre_trans (std::move (pretrans));
-            m_parsed_lines.push_back (std::make_tuple (tokenized_line, ErrMap(),
-                                      std::move (presplit), false));
+            m_parsed_lines.push_back (std::make_tuple (StrVec (tokenized_line.begin(), tokenized_line.end()),
+                                      ErrMap(), std::move (presplit), false));
         }
         if (length > max_cols)
             max_cols = length;
-    }
+    });
 
     /* If it failed, generate an error. */
     if (m_parsed_lines.size() == 0)
@@ -749,6 +749,60 @@ GncTxImport::check_for_column_type (GncTransPropType type)
                         != m_settings.m_column_types.end());
 }
 
+static bool
+is_date_prop (GncTransPropType type)
+{
+    return (type == GncTransPropType::DATE) ||
+           (type == GncTransPropType::REC_DATE) ||
+           (type == GncTransPropType::TREC_DATE);
+}
+
+std::tuple<uint32_t, int, int>
+GncTxImport::parsed_column_key (uint32_t col, GncTransPropType type)
+{
+    auto format = is_date_prop (type) ? m_settings.m_date_format :
+                                        m_settings.m_currency_format;
+    return std::make_tuple (col, static_cast<int>(type), format);
+}
+
+/* Parse the cells of all columns of the given type with the current
+ * formats, unless that was done before. */
+void GncTxImport::preparse_columns (GncTransPropType type)
+{
+    if (!is_preparsed_prop (type))
+        return;
+
+    for (uint32_t col = 0; col < m_settings.m_column_types.size(); col++)
+    {
+        if (m_settings.m_column_types[col] != type)
+            continue;
+
+        auto key = parsed_column_key (col, type);
+        if (m_parsed_columns.find (key) != m_parsed_columns.end())
+            continue;
+
+        auto format = std::get<2>(key);
+        auto parse = [this, col, type, format](size_t row)
+        {
+            auto& input = std::get<PL_INPUT>(m_parsed_lines[row]);
+            return parse_cell (type, col < input.size() ? input[col] : std::string(), format);
+        };
+        m_parsed_columns.emplace (key, gnc_imp_parse_rows (m_parsed_lines.size(), parse));
+    }
+}
+
+/* The cell at row and col as parsed by preparse_columns, or std::monostate
+ * if it wasn't. */
+const GncParsedCell&
+GncTxImport::parsed_cell (uint32_t row, uint32_t col, GncTransPropType type)
+{
+    static const GncParsedCell not_parsed;
+    auto iter = m_parsed_columns.find (parsed_column_key (col, type));
+    if ((iter == m_parsed_columns.end()) || (row >= iter->second.size()))
+        return not_parsed;
+    return iter->second[row];
+}
+
 /* A helper function intended to be called only from set_column_type */
 void GncTxImport::update_pre_trans_split_props (uint32_t row, uint32_t col, GncTransPropType old_type, GncTransPropType new_type)
 {
@@ -770,7 +824,7 @@ void GncTxImport::update_pre_trans_split_props (uint32_t row, uint32_t col, GncT
         if (col < std::get<PL_INPUT>(m_parsed_lines[row]).size())
             value = std::get<PL_INPUT>(m_parsed_lines[row]).at(col);
 
-        trans_props->set(new_type, value);
+        trans_props->set(new_type, value, parsed_cell (row, col, new_type));
     }
 
     /* In the trans_props we also keep track of currencies/commodities for further
@@ -818,7 +872,7 @@ void GncTxImport::update_pre_trans_split_props (uint32_t row, uint32_t col, GncT
 
                     if (col_num < std::get<PL_INPUT>(m_parsed_lines[row]).size())
                         value = std::get<PL_INPUT>(m_parsed_lines[row]).at(col_num);
-                    split_props->add (old_type, value);
+                    split_props->add (old_type, value, parsed_cell (row, col_num, old_type));
                 }
         }
     }
@@ -841,7 +895,7 @@ void GncTxImport::update_pre_trans_split_props (uint32_t row, uint32_t col, GncT
 
                     if (col_num < std::get<PL_INPUT>(m_parsed_lines[row]).size())
                         value = std::get<PL_INPUT>(m_parsed_lines[row]).at(col_num);
-                    split_props->add (new_type, value);
+                    split_props->add (new_type, value, parsed_cell (row, col_num, new_type));
                 }
         }
         else
@@ -849,7 +903,7 @@ void GncTxImport::update_pre_trans_split_props (uint32_t row, uint32_t col, GncT
             auto value = std::string();
             if (col < std::get<PL_INPUT>(m_parsed_lines[row]).size())
                 value = std::get<PL_INPUT>(m_parsed_lines[row]).at(col);
-            split_props->set(new_type, value);
+            split_props->set(new_type, value, parsed_cell (row, col, new_type));
         }
     }
     m_multi_currency |= split_props->get_pre_trans()->is_multi_currency();
@@ -878,6 +932,11 @@ GncTxImport::set_column_type (uint32_t position, GncTransPropType type, bool for
     if (type == GncTransPropType::ACCOUNT)
         base_account (nullptr);
 
+    /* Parse the date and amount cells of the affected columns up front */
+    preparse_columns (type);
+    if (is_multi_col_prop (old_type))
+        preparse_columns (old_type);
+
     /* Update the preparsed data */
     m_parent = nullptr;
     m_multi_currency = false;
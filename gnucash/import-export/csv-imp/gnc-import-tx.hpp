@@ -39,6 +39,7 @@
 #include <map>
 #include <memory>
 #include <optional>
+#include <tuple>
 
 #include "gnc-tokenizer.hpp"
 #include "gnc-imp-props-tx.hpp"
@@ -173,6 +174,12 @@ private:
     /* Internal helper function to force reparsing of columns subject to format changes */
     void reset_formatted_column (std::vector<GncTransPropType>& col_types);
 
+    /* Internal helper functions to parse date and amount columns ahead
+     * and look up the results */
+    std::tuple<uint32_t, int, int> parsed_column_key (uint32_t col, GncTransPropType type);
+    void preparse_columns (GncTransPropType type);
+    const GncParsedCell& parsed_cell (uint32_t row, uint32_t col, GncTransPropType type);
+
     /* Internal helper function that does the actual conversion from property lists
      * to real (possibly unbalanced) transaction with splits.
      */
@@ -187,6 +194,8 @@ private:
     bool m_skip_errors;
     /* Field used internally to track whether some transactions are multi-currency */
     bool m_multi_currency;
+    /* Date and amount columns parsed ahead, see preparse_columns */
+    GncParsedColumns m_parsed_columns;
 
     /* The parameters below are only used while creating
      * transactions. They keep state information while processing multi-split
@@ -1,17 +1,10 @@
 #include "gnc-tokenizer-csv.hpp"
 
-#include <iostream>
-#include <fstream>      // fstream
+#include <array>
+#include <cstdint>
 #include <vector>
 #include <string>
-#include <algorithm>    // copy
-#include <iterator>     // ostream_operator
-
-#include <boost/tokenizer.hpp>
-#include <boost/locale.hpp>
-#include <boost/algorithm/string.hpp>
-
-#include <glib/gi18n.h>
+#include <string_view>
 
 void
 GncCsvTokenizer::set_separators(const std::string& separators)
@@ -22,90 +15,266 @@ GncCsvTokenizer::set_separators(const std::string& separators)
 
 int GncCsvTokenizer::tokenize()
 {
-    using Tokenizer = boost::tokenizer< boost::escaped_list_separator<char>>;
+    m_tokenized_contents.clear();
+    tokenize_rows ([this](const StrViewVec& row)
+                   { m_tokenized_contents.emplace_back (row.begin(), row.end()); });
+    return 0;
+}
 
-    boost::escaped_list_separator<char> sep("\\", m_sep_str, "\"");
+namespace
+{
 
-    StrVec vec;
-    std::string line;
-    std::string buffer;
+/* The kinds of bytes the scanner has to act on. Runs of plain bytes and
+ * spaces are stepped over with one table lookup per byte. */
+enum class CsvChar : uint8_t
+{
+    PLAIN,
+    SPACE,
+    SEPARATOR,
+    QUOTE,
+    BACKSLASH,
+    NEWLINE
+};
 
-    bool inside_quotes(false);
-    size_t last_quote(0);
+/* A field's text is either a slice of the file contents, when it needed
+ * no unquoting, or a slice of the row's scratch buffer. */
+struct CsvField
+{
+    bool in_scratch;
+    size_t start;
+    size_t length;
+};
 
-    m_tokenized_contents.clear();
-    std::istringstream in_stream(m_utf8_contents);
+class CsvScanner
+{
+public:
+    CsvScanner (std::string_view contents, const std::string& separators);
+    /* Fill row with the next row's fields. The views stay valid until the
+     * next call. Returns false at the end of the contents. */
+    bool next_row (StrViewVec& row);
+
+private:
+    CsvChar char_at (size_t pos) const
+    { return m_classes[static_cast<uint8_t>(m_contents[pos])]; }
+    void skip_spaces ();
+    void skip_newline ();
+    bool field_ends_at (size_t pos) const;
+    bool scan_field ();
+
+    std::string_view m_contents;
+    size_t m_pos = 0;
+    std::array<CsvChar, 256> m_classes;
+    std::vector<CsvField> m_fields;
+    std::string m_scratch;
+};
+
+CsvScanner::CsvScanner (std::string_view contents, const std::string& separators)
+    : m_contents {contents}
+{
+    m_classes.fill (CsvChar::PLAIN);
+    for (auto c : std::string_view {" \t\v\f"})
+        m_classes[static_cast<uint8_t>(c)] = CsvChar::SPACE;
+    m_classes['\n'] = m_classes['\r'] = CsvChar::NEWLINE;
+    m_classes['"'] = CsvChar::QUOTE;
+    m_classes['\\'] = CsvChar::BACKSLASH;
+    /* Last, so that a tab separator isn't trimmed away as white space. */
+    for (auto c : separators)
+        m_classes[static_cast<uint8_t>(c)] = CsvChar::SEPARATOR;
+}
 
-    try
+void
+CsvScanner::skip_spaces ()
+{
+    while (m_pos < m_contents.size() && char_at (m_pos) == CsvChar::SPACE)
+        ++m_pos;
+}
+
+void
+CsvScanner::skip_newline ()
+{
+    if (m_contents[m_pos] == '\r' && m_pos + 1 < m_contents.size() &&
+        m_contents[m_pos + 1] == '\n')
+        ++m_pos;
+    ++m_pos;
+}
+
+/* Whether a field would end at pos, allowing for the white space that is
+ * trimmed from the end of the line. */
+bool
+CsvScanner::field_ends_at (size_t pos) const
+{
+    if (pos < m_contents.size() && char_at (pos) == CsvChar::SEPARATOR)
+        return true;
+    while (pos < m_contents.size() && char_at (pos) == CsvChar::SPACE)
+        ++pos;
+    return pos == m_contents.size() || char_at (pos) == CsvChar::NEWLINE;
+}
+
+/* Scan one field starting at m_pos. Returns true if a separator ended it,
+ * so that another field follows on the same row. */
+bool
+CsvScanner::scan_field ()
+{
+    auto start = m_pos;
+    auto copying = false;
+    auto in_quotes = false;
+    auto scratch_start = m_scratch.size();
+    /* Quoted or escaped text in the scratch buffer up to here; trimming
+     * the end of the line mustn't remove it. */
+    auto keep = scratch_start;
+
+    auto start_copy = [&]()
+    {
+        if (copying)
+            return;
+        copying = true;
+        m_scratch.append (m_contents.substr (start, m_pos - start));
+    };
+    auto end_field = [&](bool row_end)
     {
-        while (std::getline (in_stream, buffer))
+        if (!copying)
         {
-            // --- deal with line breaks in quoted strings
-            buffer = boost::trim_copy (buffer); // Removes trailing newline and spaces
-            last_quote = buffer.find_first_of('"');
-            while (last_quote != std::string::npos)
-            {
-                if (last_quote == 0) // Test separately because last_quote - 1 would be out of range
-                    inside_quotes = !inside_quotes;
-                else if (buffer[ last_quote - 1 ] != '\\')
-                    inside_quotes = !inside_quotes;
+            auto length = m_pos - start;
+            if (row_end)
+                while (length > 0 && char_at (start + length - 1) == CsvChar::SPACE)
+                    --length;
+            m_fields.push_back ({false, start, length});
+            return;
+        }
+        if (row_end)
+            while (m_scratch.size() > keep &&
+                   m_classes[static_cast<uint8_t>(m_scratch.back())] == CsvChar::SPACE)
+                m_scratch.pop_back();
+        m_fields.push_back ({true, scratch_start, m_scratch.size() - scratch_start});
+    };
 
-                last_quote = buffer.find_first_of('"',last_quote+1);
+    while (m_pos < m_contents.size())
+    {
+        switch (char_at (m_pos))
+        {
+        case CsvChar::PLAIN:
+        case CsvChar::SPACE:
+        {
+            auto run_end = m_pos + 1;
+            while (run_end < m_contents.size() &&
+                   (char_at (run_end) == CsvChar::PLAIN ||
+                    char_at (run_end) == CsvChar::SPACE))
+                ++run_end;
+            if (copying)
+            {
+                m_scratch.append (m_contents.substr (m_pos, run_end - m_pos));
+                if (in_quotes)
+                    keep = m_scratch.size();
             }
-
-            line.append(buffer);
-            if (inside_quotes)
+            m_pos = run_end;
+            break;
+        }
+        case CsvChar::SEPARATOR:
+            if (in_quotes)
             {
-                line.append(" ");
-                continue;
+                m_scratch.push_back (m_contents[m_pos++]);
+                keep = m_scratch.size();
+                break;
             }
-            // ---
-
-            // Deal with backslashes that are not meant to be escapes
-            // The boost::tokenizer with escaped_list_separator as we use
-            // it would choke on this.
-            auto bs_pos = line.find ('\\');
-            while (bs_pos != std::string::npos)
+            end_field (false);
+            ++m_pos;
+            return true;
+        case CsvChar::NEWLINE:
+            if (in_quotes)
             {
-                if ((bs_pos == line.size()) ||                                 // got trailing single backslash
-                    (line.find_first_of ("\"\\n", bs_pos + 1) != bs_pos + 1))  // backslash is not part of known escapes \\, \" or \n
-                    line = line.substr(0, bs_pos) + "\\\\" + line.substr(bs_pos + 1);
-                bs_pos += 2;
-                bs_pos = line.find ('\\', bs_pos);
+                /* Join the lines of a quoted field the way they are
+                 * displayed: trimmed and separated by a single space. */
+                while (m_scratch.size() > scratch_start &&
+                       m_classes[static_cast<uint8_t>(m_scratch.back())] == CsvChar::SPACE)
+                    m_scratch.pop_back();
+                m_scratch.push_back (' ');
+                keep = m_scratch.size();
+                skip_newline ();
+                skip_spaces ();
+                break;
             }
-
-            // Deal with repeated " ("") in strings.
-            // This is commonly used as escape mechanism for double quotes in csv files.
-            // However boost just eats them.
-            bs_pos = line.find ("\"\"");
-            while (bs_pos != std::string::npos)
+            end_field (true);
+            skip_newline ();
+            return false;
+        case CsvChar::QUOTE:
+            start_copy ();
+            if (m_pos + 1 < m_contents.size() && m_contents[m_pos + 1] == '"')
             {
-                // Only make changes in case the double quotes are part of a larger field
-                // In other words a field which only contains two double quotes represent an
-                // empty field. We don't need to touch those.
-                // The way to determine whether the double quotes represent an empty string
-                // is by checking whether the character in front or after are either
-                // a field separator or the beginning or end of of the string.
-                if (!(((bs_pos == 0) ||                                          // quotes are at start of line
-                       (m_sep_str.find (line[bs_pos-1]) != std::string::npos))    // quotes preceded by field separator
-                      &&
-                      ((bs_pos + 2 >= line.length()) ||                          // quotes are at end of line
-                       (m_sep_str.find (line[bs_pos+2]) != std::string::npos))))   // quotes followed by field separator
-                    // Only make changes in case the double quotes are not an empty field
-                    line.replace (bs_pos, 2, "\\\"");
-                bs_pos = line.find ("\"\"", bs_pos + 2);
+                /* A doubled quote is a literal quote, unless it makes up
+                 * the whole field: then it's an empty quoted field. */
+                if (m_pos != start || !field_ends_at (m_pos + 2))
+                    m_scratch.push_back ('"');
+                m_pos += 2;
             }
-
-            Tokenizer tok(line, sep);
-            vec.assign(tok.begin(),tok.end());
-            m_tokenized_contents.push_back(vec);
-            line.clear();
+            else
+            {
+                in_quotes = !in_quotes;
+                ++m_pos;
+            }
+            keep = m_scratch.size();
+            break;
+        case CsvChar::BACKSLASH:
+            start_copy ();
+            /* Only \\, \" and \n are escapes, any other backslash is
+             * kept as is. */
+            if (m_pos + 1 < m_contents.size() &&
+                (m_contents[m_pos + 1] == '\\' || m_contents[m_pos + 1] == '"'))
+            {
+                m_scratch.push_back (m_contents[m_pos + 1]);
+                m_pos += 2;
+            }
+            else if (m_pos + 1 < m_contents.size() && m_contents[m_pos + 1] == 'n')
+            {
+                m_scratch.push_back ('\n');
+                m_pos += 2;
+            }
+            else
+            {
+                m_scratch.push_back ('\\');
+                ++m_pos;
+            }
+            keep = m_scratch.size();
+            break;
         }
     }
-    catch (boost::escaped_list_error &e)
+    end_field (true);
+    return false;
+}
+
+bool
+CsvScanner::next_row (StrViewVec& row)
+{
+    m_fields.clear();
+    m_scratch.clear();
+    row.clear();
+
+    skip_spaces ();
+    if (m_pos == m_contents.size())
+        return false;
+
+    /* An empty line gives a row without fields. */
+    if (char_at (m_pos) == CsvChar::NEWLINE)
     {
-        throw (std::range_error N_("There was an error parsing the file."));
+        skip_newline ();
+        return true;
     }
 
-    return 0;
+    while (scan_field ())
+        ;
+
+    for (const auto& field : m_fields)
+        row.push_back (field.in_scratch ?
+                       std::string_view (m_scratch).substr (field.start, field.length) :
+                       m_contents.substr (field.start, field.length));
+    return true;
+}
+
+} // anonymous namespace
+
+void GncCsvTokenizer::tokenize_rows(const GncTokenizerRowFunc& row_func)
+{
+    CsvScanner scanner {m_utf8_contents, m_sep_str};
+    StrViewVec row;
+    while (scanner.next_row (row))
+        row_func (row);
 }
@@ -26,6 +26,12 @@
      into multiple fields. Quote characters will be removed.
      However, no gnucash specific interpretation is done yet, that's up
      to the code using this class.
+
+     Besides the quoting of RFC 4180 (fields in double quotes, "" for a
+     literal quote) a backslash escapes a following backslash, quote or
+     n (for a line break). Leading and trailing white space is removed
+     from each line and line breaks inside quoted fields are replaced by
+     a space.
      *
      gnc-tokenizer-csv.hpp
      @author Copyright (c) 2015 Geert Janssens <geert@kobaltwit.be>
@@ -54,6 +60,9 @@ public:
 
     void set_separators(const std::string& separators);
     int  tokenize() override;
+    /** Scan the file in a single pass. Fields that need no unquoting are
+     *  handed out as views into the file contents. */
+    void tokenize_rows(const GncTokenizerRowFunc& row_func) override;
 
 private:
     std::string m_sep_str = ",";
@@ -44,19 +44,27 @@ GncTokenizer::load_file(const std::string& path)
         return;
 
     m_imp_file_str = path;
-    char *raw_contents;
-    size_t raw_length;
     GError *error = nullptr;
 
-    if (!g_file_get_contents(path.c_str(), &raw_contents, &raw_length, &error))
-      throw std::ifstream::failure(error->message);
+    /* Map the file rather than reading it: only the UTF-8 converted
+     * copy of a large file needs to be held in memory. */
+    auto mapped = g_mapped_file_new (path.c_str(), FALSE, &error);
+    if (!mapped)
+    {
+        std::string msg {error->message};
+        g_error_free (error);
+        throw std::ifstream::failure(msg);
+    }
+
+    m_raw_file.reset (mapped, g_mapped_file_unref);
+    auto raw_contents = g_mapped_file_get_contents (mapped);
+    m_raw_contents = raw_contents ?
+        std::string_view (raw_contents, g_mapped_file_get_length (mapped)) :
+        std::string_view ();
 
-    m_raw_contents = raw_contents;
-    g_free(raw_contents);
-    
     // Guess encoding, user can override if needed later on.
     const char *guessed_enc = NULL;
-    guessed_enc = go_guess_encoding (m_raw_contents.c_str(),
+    guessed_enc = go_guess_encoding (m_raw_contents.data(),
                                      m_raw_contents.length(),
                                      m_enc_str.empty() ? "UTF-8" : m_enc_str.c_str(),
                                      NULL);
@@ -77,7 +85,9 @@ void
 GncTokenizer::encoding(const std::string& encoding)
 {
     m_enc_str = encoding;
-    m_utf8_contents = boost::locale::conv::to_utf<char>(m_raw_contents, m_enc_str);
+    m_utf8_contents = boost::locale::conv::to_utf<char>(m_raw_contents.data(),
+                                                        m_raw_contents.data() + m_raw_contents.size(),
+                                                        m_enc_str);
 
     // While we are converting here, let's also normalize line-endings to "\n"
     // That's what STL expects by default
@@ -92,6 +102,18 @@ GncTokenizer::encoding()
 }
 
 
+void
+GncTokenizer::tokenize_rows(const GncTokenizerRowFunc& row_func)
+{
+    tokenize();
+    StrViewVec row;
+    for (const auto& tokens : m_tokenized_contents)
+    {
+        row.assign (tokens.begin(), tokens.end());
+        row_func (row);
+    }
+}
+
 const std::vector<StrVec>&
 GncTokenizer::get_tokens()
 {
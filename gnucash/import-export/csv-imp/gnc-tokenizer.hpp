@@ -41,9 +41,18 @@
 #include <fstream>      // fstream
 #include <vector>
 #include <string>
+#include <string_view>
 #include <memory>
+#include <functional>
+
+#include <glib.h>
 
 using StrVec = std::vector<std::string>;
+using StrViewVec = std::vector<std::string_view>;
+
+/** Called by GncTokenizer::tokenize_rows for each row. The views are
+ *  only valid until the function returns. */
+using GncTokenizerRowFunc = std::function<void(const StrViewVec&)>;
 
 /** Enumeration for file formats supported by this importer. */
 enum class GncImpFileFormat {
@@ -70,6 +79,11 @@ public:
     void encoding(const std::string& encoding);
     const std::string& encoding();
     virtual int  tokenize() = 0;
+    /** Tokenize the file and hand each row to row_func as it is found,
+     *  without storing the rows. get_tokens() is not updated.
+     *  The default implementation runs tokenize() and hands out views of
+     *  the stored rows. */
+    virtual void tokenize_rows(const GncTokenizerRowFunc& row_func);
     const std::vector<StrVec>& get_tokens();
 
 protected:
@@ -78,7 +92,8 @@ protected:
 
 private:
     std::string m_imp_file_str;
-    std::string m_raw_contents;
+    std::shared_ptr<GMappedFile> m_raw_file;
+    std::string_view m_raw_contents;
     std::string m_enc_str;
 };
 
@@ -72,3 +72,44 @@ TEST_F(GncImpPropsTxTest, ParseMonetary)
     /* Things that will throw */
     EXPECT_THROW (parse_monetary ("3000.00.01", 1), std::invalid_argument);
 };
+
+//! Test for function parse_cell (GncTransPropType prop, const std::string& value, int format)
+TEST_F(GncImpPropsTxTest, ParseCell)
+{
+    /* Amounts */
+    auto cell = parse_cell (GncTransPropType::AMOUNT, "1,000.00", 1);
+    ASSERT_TRUE (std::holds_alternative<GncNumeric> (cell));
+    EXPECT_EQ (std::get<GncNumeric> (cell), (GncNumeric {100000, 100}));
+    cell = parse_cell (GncTransPropType::TAMOUNT_NEG, "abc", 1);
+    EXPECT_TRUE (std::holds_alternative<std::string> (cell));
+
+    /* Dates, with format 0 being y-m-d */
+    cell = parse_cell (GncTransPropType::DATE, "2023-04-05", 0);
+    ASSERT_TRUE (std::holds_alternative<GncDate> (cell));
+    EXPECT_EQ (std::get<GncDate> (cell), (GncDate {2023, 4, 5}));
+    cell = parse_cell (GncTransPropType::REC_DATE, "not a date", 0);
+    EXPECT_TRUE (std::holds_alternative<std::string> (cell));
+    cell = parse_cell (GncTransPropType::DATE, "", 0);
+    EXPECT_TRUE (std::holds_alternative<std::monostate> (cell));
+
+    /* Properties that aren't parsed ahead */
+    EXPECT_FALSE (is_preparsed_prop (GncTransPropType::ACCOUNT));
+    cell = parse_cell (GncTransPropType::ACCOUNT, "Assets", 0);
+    EXPECT_TRUE (std::holds_alternative<std::monostate> (cell));
+};
+
+//! Test that GncPreSplit::set uses a cell parsed ahead, including its errors
+TEST_F(GncImpPropsTxTest, SetParsedCell)
+{
+    GncPreSplit split {0, 1};
+
+    split.set (GncTransPropType::AMOUNT, "1.00", GncNumeric {5, 1});
+    EXPECT_TRUE (split.errors().empty());
+
+    split.set (GncTransPropType::AMOUNT, "1.00",
+               parse_cell (GncTransPropType::AMOUNT, "abc", 1));
+    EXPECT_EQ (split.errors().count (GncTransPropType::AMOUNT), 1u);
+
+    split.set (GncTransPropType::AMOUNT, "1.00");
+    EXPECT_TRUE (split.errors().empty());
+};
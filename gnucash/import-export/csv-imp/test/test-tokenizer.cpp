@@ -199,6 +199,34 @@ TEST_F (GncTokenizerTest, tokenize_semicolon_sep)
     test_gnc_tokenize_helper (";", semicolon_separated);
 }
 
+TEST_F (GncTokenizerTest, tokenize_multi_line)
+{
+    set_utf8_contents (csv_tok,
+                       "Date,Description\r\n"
+                       "\n"
+                       "  05/01/15,\"Spans  \n   two lines\"  \n"
+                       "05/02/15,\"\"\n");
+    csv_tok->tokenize();
+    auto tokens = csv_tok->get_tokens();
+    ASSERT_EQ(4ul, tokens.size());
+    EXPECT_EQ((StrVec {"Date", "Description"}), tokens[0]);
+    EXPECT_TRUE(tokens[1].empty());
+    EXPECT_EQ((StrVec {"05/01/15", "Spans two lines"}), tokens[2]);
+    EXPECT_EQ((StrVec {"05/02/15", ""}), tokens[3]);
+}
+
+TEST_F (GncTokenizerTest, tokenize_rows_csv)
+{
+    set_utf8_contents (csv_tok, "a,\"b,c\"\nd,e\n");
+    std::vector<StrVec> rows;
+    csv_tok->tokenize_rows ([&rows](const StrViewVec& row)
+                            { rows.emplace_back (row.begin(), row.end()); });
+    ASSERT_EQ(2ul, rows.size());
+    EXPECT_EQ((StrVec {"a", "b,c"}), rows[0]);
+    EXPECT_EQ((StrVec {"d", "e"}), rows[1]);
+    EXPECT_TRUE(csv_tok->get_tokens().empty());
+}
+
 
 
 void
@@ -0,0 +1,252 @@
+/********************************************************************\
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+/** @addtogroup Import_Export
+    @{ */
+/** @internal
+    @file import-auto-matcher.cpp
+    @brief Transaction matcher that needs no user interface.
+*/
+#include <config.h>
+
+#include "import-auto-matcher.h"
+#include "Account.h"
+#include "Transaction.h"
+#include "gnc-engine.h"
+#include "gnc-bulk-loader.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+static QofLogModule log_module = GNC_MOD_IMPORT;
+
+struct _auto_matcher_info
+{
+    GNCImportSettings *settings;
+    /* Prepended as they're added, like the main matcher's list, so that
+     * both make the same choices for the same import. */
+    GSList *trans_list;
+    GHashTable *acct_id_hash;
+    guint duplicates;
+};
+
+GNCImportAutoMatcher *
+gnc_import_auto_matcher_new (GNCImportSettings *settings)
+{
+    g_return_val_if_fail (settings, nullptr);
+    auto matcher = g_new0 (GNCImportAutoMatcher, 1);
+    matcher->settings = settings;
+    matcher->acct_id_hash = g_hash_table_new (g_direct_hash, g_direct_equal);
+    return matcher;
+}
+
+void
+gnc_import_auto_matcher_delete (GNCImportAutoMatcher *matcher)
+{
+    if (!matcher)
+        return;
+    g_slist_free_full (matcher->trans_list,
+                       (GDestroyNotify)gnc_import_TransInfo_delete);
+    g_hash_table_destroy (matcher->acct_id_hash);
+    g_free (matcher);
+}
+
+void
+gnc_import_auto_matcher_add_trans (GNCImportAutoMatcher *matcher,
+                                   Transaction *trans,
+                                   GNCImportLastSplitInfo *lsplit)
+{
+    g_return_if_fail (matcher && trans);
+
+    /* This destroys the transaction if it's a duplicate. */
+    if (gnc_import_exists_online_id (trans, matcher->acct_id_hash))
+    {
+        ++matcher->duplicates;
+        return;
+    }
+
+    auto info = gnc_import_TransInfo_new (trans, nullptr);
+    gnc_import_TransInfo_set_last_split_info (info, lsplit);
+    matcher->trans_list = g_slist_prepend (matcher->trans_list, info);
+}
+
+static Transaction*
+top_match_trans (const GNCImportTransInfo *info)
+{
+    auto match_list = gnc_import_TransInfo_get_match_list (info);
+    if (!match_list || !match_list->data)
+        return nullptr;
+    return static_cast<GNCImportMatchInfo*>(match_list->data)->trans;
+}
+
+static gint
+top_match_score (const GNCImportTransInfo *info)
+{
+    auto match_list = gnc_import_TransInfo_get_match_list (info);
+    return static_cast<GNCImportMatchInfo*>(match_list->data)->probability;
+}
+
+/* A greedy conflict resolution, like the main matcher's: of the imported
+ * transactions with the same best match, the one with the highest score
+ * (the first one on a tie) keeps it, the others drop it and fall back to
+ * their next best, which may start a new conflict. Each round drops at
+ * least one match, so this ends. Unlike the main matcher, the losers get
+ * their action chosen again since nobody will review it. */
+static void
+resolve_conflicts (const std::vector<GNCImportTransInfo*>& infos,
+                   GNCImportSettings *settings)
+{
+    std::unordered_map<Transaction*, std::vector<size_t>> claims;
+    std::vector<Transaction*> contested;
+    auto claim = [&claims, &contested, &infos](size_t pos)
+    {
+        auto trans = top_match_trans (infos[pos]);
+        if (!trans)
+            return;
+        auto& claimants = claims[trans];
+        claimants.push_back (pos);
+        if (claimants.size () == 2)
+            contested.push_back (trans);
+    };
+
+    for (size_t pos = 0; pos < infos.size (); ++pos)
+        claim (pos);
+
+    while (!contested.empty ())
+    {
+        auto claimants = std::move (claims[contested.back ()]);
+        contested.pop_back ();
+        std::sort (claimants.begin (), claimants.end ());
+        auto winner = *std::max_element (claimants.begin (), claimants.end (),
+                                         [&infos](size_t a, size_t b)
+                                         {
+                                             return top_match_score (infos[a]) <
+                                                 top_match_score (infos[b]);
+                                         });
+        claims[top_match_trans (infos[winner])] = {winner};
+
+        for (auto pos : claimants)
+        {
+            if (pos == winner)
+                continue;
+            auto info = infos[pos];
+            auto match_list = gnc_import_TransInfo_get_match_list (info);
+            g_free (match_list->data);
+            match_list = g_list_delete_link (match_list, match_list);
+            gnc_import_TransInfo_set_match_list (info, match_list);
+            gnc_import_TransInfo_init_matches (info, settings);
+            claim (pos);
+        }
+    }
+}
+
+void
+gnc_import_auto_matcher_run (GNCImportAutoMatcher *matcher,
+                             GNCImportAutoMatcherCounts *counts)
+{
+    g_return_if_fail (matcher && counts);
+    ENTER ("%u transactions", g_slist_length (matcher->trans_list));
+
+    *counts = {};
+    counts->duplicates = matcher->duplicates;
+    matcher->duplicates = 0;
+
+    auto settings = matcher->settings;
+    auto index = gnc_import_match_index_new_for_imports
+        (matcher->trans_list, gnc_import_Settings_get_match_date_hardlimit (settings));
+    auto display_threshold = gnc_import_Settings_get_display_threshold (settings);
+    auto date_threshold = gnc_import_Settings_get_date_threshold (settings);
+    auto date_not_threshold = gnc_import_Settings_get_date_not_threshold (settings);
+    auto fuzzy_amount = gnc_import_Settings_get_fuzzy_amount (settings);
+
+    std::vector<GNCImportTransInfo*> infos;
+    for (auto node = matcher->trans_list; node; node = g_slist_next (node))
+    {
+        auto info = static_cast<GNCImportTransInfo*>(node->data);
+        gnc_import_match_index_find_matches (index, info, display_threshold,
+                                             date_threshold, date_not_threshold,
+                                             fuzzy_amount);
+        gnc_import_TransInfo_init_matches (info, settings);
+        infos.push_back (info);
+    }
+    gnc_import_match_index_free (index);
+    resolve_conflicts (infos, settings);
+
+    if (infos.empty ())
+    {
+        LEAVE ("%u duplicates", counts->duplicates);
+        return;
+    }
+
+    /* Hold every touched account open so that each is sorted and has its
+     * balances computed once, after the last transaction. */
+    GncBulkLoader loader {xaccTransGetBook (gnc_import_TransInfo_get_trans (infos.front ()))};
+    for (auto info : infos)
+    {
+        auto trans = gnc_import_TransInfo_get_trans (info);
+        for (auto node = xaccTransGetSplitList (trans); node; node = g_list_next (node))
+            loader.hold (xaccSplitGetAccount (static_cast<Split*>(node->data)));
+        auto dest_acc = gnc_import_TransInfo_get_destacc (info);
+        loader.hold (dest_acc);
+
+        /* The main matcher proposes the imported account's last choice. */
+        auto fsplit = gnc_import_TransInfo_get_fsplit (info);
+        gnc_import_TransInfo_set_append_text
+            (info, xaccAccountGetAppendText (xaccSplitGetAccount (fsplit)));
+
+        auto action = gnc_import_TransInfo_get_action (info);
+        auto unbalanced = action == GNCImport_ADD && !dest_acc &&
+            !gnc_import_TransInfo_is_balanced (info);
+        if (!gnc_import_process_trans_item (nullptr, info))
+        {
+            ++counts->skipped;
+            continue;
+        }
+        switch (action)
+        {
+        case GNCImport_ADD:
+            ++counts->added;
+            if (unbalanced)
+                ++counts->unbalanced;
+            break;
+        case GNCImport_CLEAR:
+            ++counts->cleared;
+            break;
+        case GNCImport_UPDATE:
+            ++counts->updated;
+            break;
+        default:
+            ++counts->skipped;
+            break;
+        }
+    }
+
+    /* Destroys the transactions that weren't added. */
+    g_slist_free_full (matcher->trans_list,
+                       (GDestroyNotify)gnc_import_TransInfo_delete);
+    matcher->trans_list = nullptr;
+
+    loader.commit ();
+
+    LEAVE ("%u added, %u cleared, %u updated, %u skipped, %u duplicates",
+           counts->added, counts->cleared, counts->updated, counts->skipped,
+           counts->duplicates);
+}
+
+/** @} */
@@ -0,0 +1,95 @@
+/********************************************************************\
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+/** @addtogroup Import_Export
+    @{ */
+/** @file import-auto-matcher.h
+    @brief Transaction matcher that needs no user interface.
+
+    The automatic matcher makes the choices the main matcher proposes
+    and applies them without asking: imported transactions whose
+    online id is already in their account are dropped, the others get
+    a destination account from the account match maps, are scored
+    against the existing transactions and are added, cleared, updated
+    or skipped as the thresholds in the import settings say. When
+    several imported transactions have the same best match, the best
+    scoring one keeps it and the others fall back to their next one.
+*/
+
+#ifndef IMPORT_AUTO_MATCHER_H
+#define IMPORT_AUTO_MATCHER_H
+
+#include <glib.h>
+#include "import-backend.h"
+#include "import-settings.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct _auto_matcher_info GNCImportAutoMatcher;
+
+/** What gnc_import_auto_matcher_run() did with the imported
+ * transactions. */
+typedef struct _auto_matcher_counts
+{
+    guint duplicates;   /**< Dropped because their online id exists. */
+    guint added;        /**< Added as new transactions, */
+    guint unbalanced;   /**< of which this many without a destination
+                             account. */
+    guint cleared;      /**< Matched and reconciled an existing one. */
+    guint updated;      /**< Matched and updated an existing one. */
+    guint skipped;      /**< Left out. */
+} GNCImportAutoMatcherCounts;
+
+/** Create an automatic matcher.
+ *
+ * @param settings The thresholds and enabled actions to use. The
+ * caller keeps ownership, and must keep them until the matcher is
+ * deleted.
+ */
+GNCImportAutoMatcher *gnc_import_auto_matcher_new (GNCImportSettings *settings);
+
+/** Delete the matcher, destroying the transactions it still holds. */
+void gnc_import_auto_matcher_delete (GNCImportAutoMatcher *matcher);
+
+/** Add a newly imported transaction, which must still be open for
+ * edit and have its split in the imported account first, as for
+ * gnc_gen_trans_list_add_trans_with_split_data(). The matcher takes
+ * ownership of the transaction.
+ *
+ * @param lsplit Data for the balancing split, or NULL.
+ */
+void gnc_import_auto_matcher_add_trans (GNCImportAutoMatcher *matcher,
+                                        Transaction *trans,
+                                        GNCImportLastSplitInfo *lsplit);
+
+/** Match all transactions added so far and process them, with every
+ * account they touch held open for edit until the last one is done.
+ *
+ * @param counts Filled with what was done.
+ */
+void gnc_import_auto_matcher_run (GNCImportAutoMatcher *matcher,
+                                  GNCImportAutoMatcherCounts *counts);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+/**@}*/
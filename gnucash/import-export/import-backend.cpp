@@ -43,8 +43,15 @@
 #include "engine-helpers.h"
 #include "gnc-prefs.h"
 #include "gnc-ui-util.h"
+#include "guid.hpp"
 
 #include <algorithm>
+#include <array>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #define GNCIMPORT_DESC    "desc"
 #define GNCIMPORT_MEMO    "memo"
@@ -66,6 +73,8 @@ static void matchmap_store_destination(Account* base_acc,
 
 static void trans_info_calculate_dest_amount (GNCImportTransInfo *info);
 
+static void trans_info_free_tokens (GNCImportTransInfo *info);
+
 
 /********************************************************************\
  *               Structures passed between the functions            *
@@ -89,7 +98,8 @@ struct _transactioninfo
     GNCImportAction action;
     GNCImportAction previous_action;
 
-    /* A list of tokenized strings to use for bayesian matching purposes */
+    /* A list of tokenized strings to use for bayesian matching purposes,
+     * interned by the token cache. */
     GList * match_tokens;
 
     /* In case of a single destination account it is stored here. */
@@ -347,7 +357,7 @@ void gnc_import_TransInfo_delete (GNCImportTransInfo *info)
             xaccTransDestroy(info->trans);
             xaccTransCommitEdit(info->trans);
         }
-        g_list_free_full (info->match_tokens, g_free);
+        trans_info_free_tokens (info);
         g_free(info->lsplit_action);
         g_free(info->lsplit_memo);
 
@@ -409,31 +419,98 @@ GdkPixbuf* gen_probability_pixbuf(gint score_original, GNCImportSettings *settin
  * MatchMap related functions (storing and retrieving)
  */
 
-/* Tokenize a string and append the tokens to an existing GList
- * (or an empty GList)
- */
-static GList*
-tokenize_string(GList* existing_tokens, const char *string)
+/* The Bayesian matcher tokenizes every imported transaction, and
+ * statements repeat the same payees over and over. Tokens are interned
+ * in the string cache so that a token's pointer serves as its id: equal
+ * tokens are the same pointer and the token lists need no copies. The
+ * tokens of each distinct description or memo are kept, so a repeated
+ * one is only split once.
+ *
+ * The GNCImportTransInfos' token lists point into the cache, which is
+ * emptied when the last of them is deleted. */
+using TokenIds = std::vector<const char*>;
+
+class TokenCache
 {
-    char **tokenized_strings = g_strsplit(string, " ", 0);
-    char **stringpos = tokenized_strings;
+public:
+    ~TokenCache () { clear (); }
 
-    /* add each unique non-empty token to the token GList */
-    while (stringpos && *stringpos)
+    /* The distinct non-empty space separated tokens of string, in the
+     * order they first appear. */
+    const TokenIds& tokens (const char *string)
     {
-        if ((strlen(*stringpos) > 0) &&
-            (!g_list_find_custom (existing_tokens, *stringpos, (GCompareFunc)g_strcmp0)))
-                existing_tokens = g_list_prepend(existing_tokens, g_strdup(*stringpos));
+        std::string_view view {string ? string : ""};
+        auto iter = m_tokens.find (view);
+        if (iter != m_tokens.end ())
+            return iter->second;
 
-        stringpos++;
+        TokenIds ids;
+        for (size_t pos = 0; pos < view.size ();)
+        {
+            auto end = std::min (view.find (' ', pos), view.size ());
+            if (end > pos)
+            {
+                auto token = qof_string_cache_insert (view.substr (pos, end - pos));
+                if (std::find (ids.begin (), ids.end (), token) == ids.end ())
+                    ids.push_back (token);
+                else
+                    qof_string_cache_remove (token);
+            }
+            pos = end + 1;
+        }
+        std::string_view key {qof_string_cache_insert (view)};
+        return m_tokens.emplace (key, std::move (ids)).first->second;
     }
 
-    /* free up the strings that g_strsplit() created */
-    g_strfreev(tokenized_strings);
+    /* The local name of the day of the week of time, in UTC. */
+    const char *weekday (time64 time)
+    {
+        auto days = time / 86400 - (time % 86400 < 0 ? 1 : 0);
+        auto wday = ((days + 4) % 7 + 7) % 7;    // 1970-01-01 was a Thursday.
+        auto& name = m_weekdays[wday];
+        if (name)
+            return name;
+
+        auto tm_struct = gnc_gmtime (&time);
+        char local_day_of_week[16];
+        if (!qof_strftime (local_day_of_week, sizeof (local_day_of_week), "%A", tm_struct))
+            PERR("TransactionGetTokens: error, strftime failed\n");
+        gnc_tm_free (tm_struct);
+        name = qof_string_cache_insert (local_day_of_week);
+        return name;
+    }
 
-    return existing_tokens;
+    void clear ()
+    {
+        for (auto& [key, ids] : m_tokens)
+        {
+            for (auto id : ids)
+                qof_string_cache_remove (id);
+            qof_string_cache_remove (key.data ());
+        }
+        m_tokens.clear ();
+        for (auto& name : m_weekdays)
+        {
+            qof_string_cache_remove (name);
+            name = nullptr;
+        }
+    }
+
+private:
+    std::unordered_map<std::string_view, TokenIds> m_tokens;
+    std::array<const char*, 7> m_weekdays {};
+};
+
+static TokenCache&
+token_cache ()
+{
+    static TokenCache cache;
+    return cache;
 }
 
+/* The GNCImportTransInfos whose tokens may be in the cache. */
+static size_t trans_info_count = 0;
+
 /* create and return a list of tokens for a given transaction info. */
 static GList*
 TransactionGetTokens(GNCImportTransInfo *info)
@@ -445,35 +522,43 @@ TransactionGetTokens(GNCImportTransInfo *info)
     auto transaction = gnc_import_TransInfo_get_trans(info);
     g_assert(transaction);
 
+    auto& cache = token_cache ();
+    TokenIds tokens;
+    auto add_tokens = [&tokens](const TokenIds& ids)
+    {
+        for (auto id : ids)
+            if (std::find (tokens.begin (), tokens.end (), id) == tokens.end ())
+                tokens.push_back (id);
+    };
+
     /* make tokens from the transaction description */
-    auto text = xaccTransGetDescription(transaction);
-    GList *tokens = nullptr;
-    tokens = tokenize_string(tokens, text);
+    add_tokens (cache.tokens (xaccTransGetDescription (transaction)));
 
     /* The day of week the transaction occurred is a good indicator of
      * what account this transaction belongs in.  Get the date and convert
      * it to day of week as a token
      */
-    auto transtime = xaccTransGetDate(transaction);
-    auto tm_struct = gnc_gmtime(&transtime);
-    char local_day_of_week[16];
-    if (!qof_strftime(local_day_of_week, sizeof(local_day_of_week), "%A", tm_struct))
-        PERR("TransactionGetTokens: error, strftime failed\n");
-    gnc_tm_free (tm_struct);
-    /* we cannot add a locally allocated string to this array, dup it so
-     * it frees the same way the rest do
-     */
-    tokens = g_list_prepend(tokens, g_strdup(local_day_of_week));
+    tokens.push_back (cache.weekday (xaccTransGetDate (transaction)));
 
     /* make tokens from the memo of each split of this transaction */
     for (GList *node=xaccTransGetSplitList (transaction); node; node=node->next)
-    {
-        text = xaccSplitGetMemo(static_cast<Split*>(node->data));
-        tokens = tokenize_string(tokens, text);
-    }
+        add_tokens (cache.tokens (xaccSplitGetMemo (static_cast<Split*>(node->data))));
+
+    /* The tokens belong to the cache. */
+    GList *list = nullptr;
+    for (auto id : tokens)
+        list = g_list_prepend (list, const_cast<char*>(id));
+    info->match_tokens = list;
+    return list;
+}
 
-    info->match_tokens = tokens;
-    return tokens;
+static void
+trans_info_free_tokens (GNCImportTransInfo *info)
+{
+    g_list_free (info->match_tokens);
+    info->match_tokens = nullptr;
+    if (--trans_info_count == 0)
+        token_cache ().clear ();
 }
 
 /* searches using the GNCImportTransInfo through all existing transactions
@@ -555,6 +640,21 @@ matchmap_store_destination (Account *base_acc,
 
 
 
+/* The scores split_find_match() gives. The match index works out from
+ * them which candidates can't reach the display threshold. */
+static const gint same_amount_score = 3;
+static const gint fuzzy_amount_score = 2;
+static const gint amount_miss_score = -5;
+static const gint same_day_score = 3;
+static const gint near_date_score = 2;
+static const gint far_date_score = -5;
+static const gint num_match_score = 4;
+static const gint num_miss_score = -2;
+static const gint memo_match_score = 2;
+static const gint desc_match_score = 2;
+static const gint text_prefix_score = 1;
+static const double same_amount_epsilon = 1e-6;
+
 /** @brief The transaction matching heuristics are here.
  */
 void split_find_match (GNCImportTransInfo * trans_info,
@@ -577,7 +677,7 @@ void split_find_match (GNCImportTransInfo * trans_info,
     /*DEBUG(" downloaded_split_amount=%f", downloaded_split_amount);*/
     auto match_split_amount = gnc_numeric_to_double(xaccSplitGetAmount(split));
     /*DEBUG(" match_split_amount=%f", match_split_amount);*/
-    if (fabs(downloaded_split_amount - match_split_amount) < 1e-6)
+    if (fabs(downloaded_split_amount - match_split_amount) < same_amount_epsilon)
         /* bug#347791: Double type shouldn't be compared for exact
             equality, so we're using fabs() instead. */
         /*if (gnc_numeric_equal(xaccSplitGetAmount
@@ -585,7 +685,7 @@ void split_find_match (GNCImportTransInfo * trans_info,
             xaccSplitGetAmount(split)))
             -- gnc_numeric_equal is an expensive function call */
     {
-        prob = prob + 3;
+        prob = prob + same_amount_score;
         /*DEBUG("heuristics:  probability + 3 (amount)");*/
     }
     else if (fabs (downloaded_split_amount - match_split_amount) <=
@@ -594,7 +694,7 @@ void split_find_match (GNCImportTransInfo * trans_info,
         /* ATM fees are sometimes added directly in the transaction.
             So you withdraw 100$ and get charged 101,25$ in the same
             transaction */
-        prob = prob + 2;
+        prob = prob + fuzzy_amount_score;
         /*DEBUG("heuristics:  probability + 2 (amount)");*/
     }
     else
@@ -602,7 +702,7 @@ void split_find_match (GNCImportTransInfo * trans_info,
         /* If a transaction's amount doesn't match within the
             threshold, it's very unlikely to be the same transaction
             so we give it an extra -5 penalty */
-        prob = prob - 5;
+        prob = prob + amount_miss_score;
         /* DEBUG("heuristics:  probability - 1 (amount)"); */
     }
 
@@ -618,19 +718,19 @@ void split_find_match (GNCImportTransInfo * trans_info,
     /*DEBUG("diff day %d", datediff_day);*/
     if (datediff_day == 0)
     {
-        prob = prob + 3;
+        prob = prob + same_day_score;
         /*DEBUG("heuristics:  probability + 3 (date)");*/
     }
     else if (datediff_day <= date_threshold)
     {
-        prob = prob + 2;
+        prob = prob + near_date_score;
         /*DEBUG("heuristics:  probability + 2 (date)");*/
     }
     else if (datediff_day > date_not_threshold)
     {
         /* Extra penalty if that split lies awfully far away from
             the given one. */
-        prob = prob - 5;
+        prob = prob + far_date_score;
         /*DEBUG("heuristics:  probability - 5 (date)"); */
         /* Changed 2005-02-21: Revert the hard-limiting behaviour
             back to the previous large penalty. (Changed 2004-11-27:
@@ -639,7 +739,7 @@ void split_find_match (GNCImportTransInfo * trans_info,
     }
 
     /* Check if date and amount are identical */
-    auto update_proposed = (prob < 6);
+    auto update_proposed = (prob < same_amount_score + same_day_score);
 
     /* Check number heuristics */
     auto new_trans_str = gnc_get_num_action(new_trans, new_trans_fsplit);
@@ -664,14 +764,14 @@ void split_find_match (GNCImportTransInfo * trans_info,
                 (g_strcmp0(new_trans_str, split_str) == 0) )
         {
             /* An exact match of the Check number gives a +4 */
-            prob += 4;
+            prob += num_match_score;
             /*DEBUG("heuristics:  probability + 4 (Check number)");*/
         }
         else if (strlen(new_trans_str) > 0 && strlen(split_str) > 0)
         {
             /* If both number are not empty yet do not match, add a
                             little extra penalty */
-            prob -= 2;
+            prob += num_miss_score;
         }
     }
 
@@ -682,7 +782,7 @@ void split_find_match (GNCImportTransInfo * trans_info,
         if (safe_strcasecmp(memo, xaccSplitGetMemo(split)) == 0)
         {
             /* An exact match of memo gives a +2 */
-            prob = prob + 2;
+            prob = prob + memo_match_score;
             /* DEBUG("heuristics:  probability + 2 (memo)"); */
         }
         else if ((strncasecmp(memo, xaccSplitGetMemo(split),
@@ -692,7 +792,7 @@ void split_find_match (GNCImportTransInfo * trans_info,
                             first 50% of the strings to skip annoying transaction
                             number some banks seem to include in the memo but someone
                             should write something more sophisticated */
-            prob = prob + 1;
+            prob = prob + text_prefix_score;
             /*DEBUG("heuristics:  probability + 1 (memo)");	*/
         }
     }
@@ -705,7 +805,7 @@ void split_find_match (GNCImportTransInfo * trans_info,
                 xaccTransGetDescription(xaccSplitGetParent(split))) == 0)
         {
             /*An exact match of Description gives a +2 */
-            prob = prob + 2;
+            prob = prob + desc_match_score;
             /*DEBUG("heuristics:  probability + 2 (description)");*/
         }
         else if ((strncasecmp(descr,
@@ -716,7 +816,7 @@ void split_find_match (GNCImportTransInfo * trans_info,
                             first 50% of the strings to skip annoying transaction
                             number some banks seem to include in the description but someone
                             should write something more sophisticated */
-            prob = prob + 1;
+            prob = prob + text_prefix_score;
             /*DEBUG("heuristics:  probability + 1 (description)");	*/
         }
     }
@@ -741,6 +841,199 @@ void split_find_match (GNCImportTransInfo * trans_info,
     trans_info->match_list = g_list_prepend(trans_info->match_list, match_info);
 }
 
+struct IndexedSplit
+{
+    Split *split;
+    size_t seq;
+    double amount;
+    time64 date;
+};
+
+struct AccountCandidates
+{
+    std::vector<IndexedSplit> by_amount;
+    std::vector<IndexedSplit> by_date;
+    bool sorted = false;
+};
+
+struct _GNCImportMatchIndex
+{
+    std::unordered_map<Account*, AccountCandidates> accounts;
+    size_t next_seq = 0;
+};
+
+GNCImportMatchIndex *
+gnc_import_match_index_new (void)
+{
+    return new GNCImportMatchIndex;
+}
+
+void
+gnc_import_match_index_free (GNCImportMatchIndex *index)
+{
+    delete index;
+}
+
+void
+gnc_import_match_index_add_split (GNCImportMatchIndex *index, Split *split)
+{
+    g_return_if_fail (index && split);
+    auto& candidates = index->accounts[xaccSplitGetAccount (split)];
+    IndexedSplit entry {split, index->next_seq++,
+                        gnc_numeric_to_double (xaccSplitGetAmount (split)),
+                        xaccTransGetDate (xaccSplitGetParent (split))};
+    candidates.by_amount.push_back (entry);
+    candidates.by_date.push_back (entry);
+    candidates.sorted = false;
+}
+
+void
+gnc_import_match_index_find_matches (GNCImportMatchIndex *index,
+                                     GNCImportTransInfo *trans_info,
+                                     gint display_threshold,
+                                     gint date_threshold,
+                                     gint date_not_threshold,
+                                     double fuzzy_amount_difference)
+{
+    g_return_if_fail (index && trans_info);
+
+    auto new_trans = gnc_import_TransInfo_get_trans (trans_info);
+    auto new_trans_fsplit = gnc_import_TransInfo_get_fsplit (trans_info);
+    auto iter = index->accounts.find (xaccSplitGetAccount (new_trans_fsplit));
+    if (iter == index->accounts.end ())
+        return;
+
+    auto& candidates = iter->second;
+    if (!candidates.sorted)
+    {
+        std::sort (candidates.by_amount.begin (), candidates.by_amount.end (),
+                   [](auto& a, auto& b) { return a.amount < b.amount; });
+        std::sort (candidates.by_date.begin (), candidates.by_date.end (),
+                   [](auto& a, auto& b) { return a.date < b.date; });
+        candidates.sorted = true;
+    }
+
+    auto amount = gnc_numeric_to_double (xaccSplitGetAmount (new_trans_fsplit));
+    auto amount_matches = [amount, fuzzy_amount_difference](double other)
+    {
+        auto diff = fabs (amount - other);
+        return diff < same_amount_epsilon || diff <= fuzzy_amount_difference;
+    };
+    std::vector<const IndexedSplit*> selected;
+
+    /* Every candidate within the fuzzy amount difference gets scored. */
+    auto width = std::max (fuzzy_amount_difference, same_amount_epsilon) +
+        same_amount_epsilon;
+    auto lo = std::lower_bound (candidates.by_amount.begin (),
+                                candidates.by_amount.end (), amount - width,
+                                [](auto& c, double val) { return c.amount < val; });
+    auto hi = std::upper_bound (lo, candidates.by_amount.end (), amount + width,
+                                [](double val, auto& c) { return val < c.amount; });
+    for (auto c = lo; c != hi; ++c)
+        if (amount_matches (c->amount))
+            selected.push_back (&*c);
+
+    /* The others start from the amount penalty, and can only reach the
+     * threshold with the date score they need on top of the best the
+     * number, memo and description can add. */
+    auto num = gnc_get_num_action (new_trans, new_trans_fsplit);
+    auto memo = xaccSplitGetMemo (new_trans_fsplit);
+    auto descr = xaccTransGetDescription (new_trans);
+    auto best_text_score = (num && *num ? num_match_score : 0) +
+        (memo && *memo ? memo_match_score : 0) +
+        (descr && *descr ? desc_match_score : 0);
+    auto date_score_needed = display_threshold - amount_miss_score -
+        best_text_score;
+
+    if (date_score_needed <= same_day_score)
+    {
+        auto from = candidates.by_date.cbegin ();
+        auto to = candidates.by_date.cend ();
+        if (date_score_needed > far_date_score)
+        {
+            gint64 max_days = 0;
+            if (date_score_needed <= 0)
+                max_days = std::max ({date_threshold, date_not_threshold, 0});
+            else if (date_score_needed <= near_date_score)
+                max_days = std::max (date_threshold, 0);
+            /* split_find_match() counts whole days of difference. */
+            auto window = max_days * 86400 + 86399;
+            auto date = xaccTransGetDate (new_trans);
+            from = std::lower_bound (from, to, date - window,
+                                     [](auto& c, time64 val) { return c.date < val; });
+            to = std::upper_bound (from, to, date + window,
+                                   [](time64 val, auto& c) { return val < c.date; });
+        }
+        for (auto c = from; c != to; ++c)
+            if (!amount_matches (c->amount))
+                selected.push_back (&*c);
+    }
+
+    /* Score in the order the splits were added so that equal scores
+     * sort the same way they would without the index. */
+    std::sort (selected.begin (), selected.end (),
+               [](auto a, auto b) { return a->seq < b->seq; });
+    for (auto c : selected)
+        split_find_match (trans_info, c->split, display_threshold,
+                          date_threshold, date_not_threshold,
+                          fuzzy_amount_difference);
+}
+
+GNCImportMatchIndex *
+gnc_import_match_index_new_for_imports (GSList *trans_info_list,
+                                        gint match_date_hardlimit)
+{
+    static const int secs_per_day = 86400;
+    auto index = gnc_import_match_index_new ();
+    if (!trans_info_list)
+        return index;
+
+    /* Gather the accounts and the date range of the imported transactions. */
+    time64 min_time = G_MAXINT64, max_time = 0;
+    time64 match_timelimit = match_date_hardlimit * secs_per_day;
+    GList *all_accounts = nullptr;
+    QofBook *book = nullptr;
+    for (auto node = trans_info_list; node; node = g_slist_next (node))
+    {
+        auto info = static_cast<GNCImportTransInfo*>(node->data);
+        auto account = xaccSplitGetAccount (gnc_import_TransInfo_get_fsplit (info));
+        auto time = xaccTransGetDate (gnc_import_TransInfo_get_trans (info));
+        all_accounts = g_list_prepend (all_accounts, account);
+        book = gnc_account_get_book (account);
+        min_time = std::min (min_time, time);
+        max_time = std::max (max_time, time);
+    }
+
+    // Make a query to find splits with the right accounts and dates.
+    auto query = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (query, book);
+    xaccQueryAddAccountMatch (query, all_accounts,
+                              QOF_GUID_MATCH_ANY, QOF_QUERY_AND);
+    xaccQueryAddDateMatchTT (query,
+                             true, min_time - match_timelimit,
+                             true, max_time + match_timelimit,
+                             QOF_QUERY_AND);
+    auto candidates = qof_query_run (query);
+    g_list_free (all_accounts);
+
+    /* Add the candidates backwards: matches with equal scores are kept
+     * in the order they're scored in, which has always been the reverse
+     * of the query results. */
+    for (auto node = g_list_last (candidates); node; node = g_list_previous (node))
+    {
+        auto split = static_cast<Split*>(node->data);
+        if (gnc_import_split_has_online_id (split))
+            continue;
+        /* In this context an open transaction represents a freshly
+         * downloaded one. That can't possibly be a match yet */
+        if (xaccTransIsOpen (xaccSplitGetParent (split)))
+            continue;
+        gnc_import_match_index_add_split (index, split);
+    }
+    qof_query_destroy (query);
+    return index;
+}
+
 /***********************************************************************
  */
 
@@ -802,6 +1095,87 @@ update_desc_and_notes (const GNCImportTransInfo* trans_info)
     }
 }
 
+/* The online ids of the splits of each account, kept with the book so
+ * that successive imports don't read every split's online id again. The
+ * transactions an import adds stay open, and outside of the engine's
+ * events, until the matcher is done with them, so an account's entry is
+ * instead brought up to date the first time each import looks at it:
+ * only the splits it hasn't seen before have their online id read. */
+struct AccountOnlineIds
+{
+    std::unordered_map<std::string, GncGUID> ids;
+    /* Every split read, whether it has an online id or not. */
+    std::unordered_set<GncGUID> splits;
+};
+
+using OnlineIdIndex = std::unordered_map<GncGUID, AccountOnlineIds>;
+
+#define ONLINE_ID_INDEX "gnc-import-online-id-index"
+
+static void
+online_id_index_free (QofBook *book, gpointer key, gpointer data)
+{
+    delete static_cast<OnlineIdIndex*>(data);
+}
+
+static AccountOnlineIds&
+account_online_ids (Account *account)
+{
+    auto book = gnc_account_get_book (account);
+    auto index = static_cast<OnlineIdIndex*>(qof_book_get_data (book, ONLINE_ID_INDEX));
+    if (!index)
+    {
+        index = new OnlineIdIndex;
+        qof_book_set_data_fin (book, ONLINE_ID_INDEX, index, online_id_index_free);
+    }
+    return (*index)[*xaccAccountGetGUID (account)];
+}
+
+static void
+update_account_online_ids (AccountOnlineIds& entry, Account *account)
+{
+    for (GList *n = xaccAccountGetSplitList (account); n; n = n->next)
+    {
+        auto split = static_cast<Split*>(n->data);
+        auto guid = xaccSplitGetGUID (split);
+        if (!entry.splits.insert (*guid).second)
+            continue;
+        auto id = gnc_import_get_split_online_id (split);
+        if (id && *id)
+            entry.ids.emplace (id, *guid);
+        g_free (id);
+    }
+}
+
+/* Whether the split the entry has for online_id is still in the account
+ * with that id. */
+static bool
+online_id_split_valid (const GncGUID& guid, Account *account,
+                       const char *online_id)
+{
+    auto split = xaccSplitLookup (&guid, gnc_account_get_book (account));
+    if (!split || xaccSplitGetAccount (split) != account)
+        return false;
+    auto id = gnc_import_get_split_online_id (split);
+    auto valid = g_strcmp0 (id, online_id) == 0;
+    g_free (id);
+    return valid;
+}
+
+/* Record the online_id just given to a split that is already in its
+ * account. */
+static void
+online_id_index_add (Split *split, const char *online_id)
+{
+    auto account = xaccSplitGetAccount (split);
+    if (!account)
+        return;
+    auto& entry = account_online_ids (account);
+    auto guid = xaccSplitGetGUID (split);
+    if (entry.splits.count (*guid))
+        entry.ids[online_id] = *guid;
+}
+
 static void
 process_reconcile(Account *base_acc,
                   GNCImportTransInfo *trans_info,
@@ -821,7 +1195,10 @@ process_reconcile(Account *base_acc,
      *      the match will be remembered */
     auto online_id = gnc_import_get_split_online_id(trans_info->first_split);
     if (online_id && *online_id)
+    {
         gnc_import_set_split_online_id(selected_match->split, online_id);
+        online_id_index_add (selected_match->split, online_id);
+    }
 
     g_free (online_id);
 
@@ -991,20 +1368,6 @@ gnc_import_process_trans_item (Account *base_acc,
     return false;
 }
 
-static GHashTable*
-hash_account_online_ids (Account *account)
-{
-     auto acct_hash = g_hash_table_new_full
-          (g_str_hash, g_str_equal, g_free, nullptr);
-     for (GList *n = xaccAccountGetSplitList (account) ; n; n = n->next)
-     {
-        auto id = gnc_import_get_split_online_id (static_cast<Split *>(n->data));
-        if (id && *id)
-            g_hash_table_insert (acct_hash, (void*) id, GINT_TO_POINTER (1));
-     }
-     return acct_hash;
-}
-
 /** Checks whether the given transaction's online_id already exists in
   its parent account. */
 gboolean gnc_import_exists_online_id (Transaction *trans, GHashTable* acct_id_hash)
@@ -1020,20 +1383,31 @@ gboolean gnc_import_exists_online_id (Transaction *trans, GHashTable* acct_id_ha
     if (!source_online_id)
         return false;
 
-    // Create a hash per account of a hash of all split IDs. Then the
-    // test below will be fast if we have many transactions to import.
+    // Bring the account's entry in the book's index up to date once per
+    // import. The test below is then fast if we have many transactions
+    // to import.
     auto dest_acct = xaccSplitGetAccount (source_split);
+    auto& entry = account_online_ids (dest_acct);
 
-    auto online_id_hash = static_cast<GHashTable*>(g_hash_table_lookup (acct_id_hash, dest_acct));
+    if (!g_hash_table_contains (acct_id_hash, dest_acct))
+    {
+        update_account_online_ids (entry, dest_acct);
+        g_hash_table_add (acct_id_hash, dest_acct);
+    }
 
-    if (!online_id_hash)
+    auto iter = entry.ids.find (source_online_id);
+    if (iter != entry.ids.end () &&
+        !online_id_split_valid (iter->second, dest_acct, source_online_id))
     {
-        online_id_hash = hash_account_online_ids (dest_acct);
-        g_hash_table_insert (acct_id_hash, dest_acct, online_id_hash);
+        // The split was deleted, moved or given another id since. Another
+        // split may still have the id, so read the account again.
+        DEBUG("Online ID %s is stale, rereading the account", source_online_id);
+        entry = AccountOnlineIds {};
+        update_account_online_ids (entry, dest_acct);
+        iter = entry.ids.find (source_online_id);
     }
+    auto online_id_exists = iter != entry.ids.end ();
 
-    auto online_id_exists = g_hash_table_contains (online_id_hash, source_online_id);
-    
     /* If it does, abort the process for this transaction, since it is
        already in the system. */
     if (online_id_exists)
@@ -1094,6 +1468,7 @@ gnc_import_TransInfo_new (Transaction *trans, Account *base_acc)
     g_assert (trans);
 
     auto t_info = g_new0(GNCImportTransInfo, 1);
+    ++trans_info_count;
 
     t_info->trans = trans;
     /* Only use first split, the source split */
@@ -77,8 +77,16 @@ typedef enum _action
  * editing. If a matching online_id exists, the transaction is
  * destroyed (!) and TRUE is returned, otherwise FALSE is returned.
  *
+ * The online ids of each account's splits are indexed in the book, so
+ * an account's splits are only read once and later imports read only
+ * the splits added since.
+ *
  * @param trans The transaction for which to check for an existing
- * online_id. */
+ * online_id.
+ *
+ * @param acct_id_hash The accounts already checked during this import,
+ * from g_hash_table_new (g_direct_hash, g_direct_equal). The index entry
+ * of an account not in it is brought up to date first. */
 gboolean gnc_import_exists_online_id (Transaction *trans, GHashTable* acct_id_hash);
 
 /** Evaluates the match between trans_info and split using the provided parameters.
@@ -102,6 +110,46 @@ void split_find_match (GNCImportTransInfo * trans_info,
                        gint date_not_threshold,
                        double fuzzy_amount_difference);
 
+/** An index of the splits an import could match, by account, amount
+ * and date. It lets the matcher score each imported transaction
+ * against only those candidates that could reach the display
+ * threshold instead of every split in its account. */
+typedef struct _GNCImportMatchIndex GNCImportMatchIndex;
+
+GNCImportMatchIndex * gnc_import_match_index_new (void);
+
+void gnc_import_match_index_free (GNCImportMatchIndex *index);
+
+/** Add a split that imported transactions may match. */
+void gnc_import_match_index_add_split (GNCImportMatchIndex *index,
+                                       Split *split);
+
+/** Call split_find_match() for trans_info with every indexed split in
+ * its account that could score at least display_threshold, in the
+ * order the splits were added. The splits skipped are exactly those
+ * split_find_match() would reject, so the matches found are the same
+ * as calling it for every split in the account.
+ *
+ * The parameters are those of split_find_match(). */
+void gnc_import_match_index_find_matches (GNCImportMatchIndex *index,
+                                          GNCImportTransInfo *trans_info,
+                                          gint display_threshold,
+                                          gint date_threshold,
+                                          gint date_not_threshold,
+                                          double fuzzy_amount_difference);
+
+/** Create an index of the existing splits that the imported
+ * transactions could match: those in the imported transactions'
+ * accounts, posted at most match_date_hardlimit days before the
+ * earliest or after the latest of them. Splits with an online id and
+ * splits of open transactions are left out.
+ *
+ * @param trans_info_list A list of GNCImportTransInfo.
+ *
+ * @return the index, to be freed with gnc_import_match_index_free(). */
+GNCImportMatchIndex * gnc_import_match_index_new_for_imports (GSList *trans_info_list,
+                                                              gint match_date_hardlimit);
+
 /** Iterates through all splits of the originating account of
  * trans_info. Sorts the resulting list and sets the selected_match
  * and action fields in the trans_info.
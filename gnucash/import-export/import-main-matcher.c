@@ -80,7 +80,7 @@ struct _main_matcher_info
     bool add_toggled;     // flag to indicate that add has been toggled to stop selection
     gint id;
     GSList* temp_trans_list;  // Temporary list of imported transactions
-    GHashTable* acct_id_hash; // Hash table, per account, of list of transaction IDs.
+    GHashTable* acct_id_hash; // Accounts whose online IDs were checked.
     GSList* edited_accounts;  // List of accounts currently edited.
 
     /* only when editing fields */
@@ -1695,8 +1695,7 @@ gnc_gen_trans_common_setup (GNCImportMainMatcher *info,
     bool show_update = gnc_import_Settings_get_action_update_enabled (info->user_settings);
     gnc_gen_trans_init_view (info, all_from_same_account, show_update);
 
-    info->acct_id_hash = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
-                                                (GDestroyNotify)g_hash_table_destroy);
+    info->acct_id_hash = g_hash_table_new (g_direct_hash, g_direct_equal);
     info->desc_hash = g_hash_table_new (g_str_hash, g_str_equal);
     info->notes_hash = g_hash_table_new (g_str_hash, g_str_equal);
     info->memo_hash = g_hash_table_new (g_str_hash, g_str_equal);
@@ -2262,108 +2261,12 @@ void gnc_gen_trans_list_add_trans_with_split_data (GNCImportMainMatcher *gui,
     gnc_gen_trans_list_add_trans_internal (gui, trans, 0, lsplit);
 }
 
-/* Return a list of splits from already existing transactions for
- * which the account matches an account used by the transactions to
- * import. The matching range is also date-limited (configurable
- * via preferences) to not go too far in the past or future.
- */
-static GList*
-filter_existing_splits_on_account_and_date (GNCImportMainMatcher *gui)
-{
-    static const int secs_per_day = 86400;
-    gint match_date_limit =
-        gnc_import_Settings_get_match_date_hardlimit (gui->user_settings);
-    time64 min_time=G_MAXINT64, max_time=0;
-    time64 match_timelimit = match_date_limit * secs_per_day;
-    GList *all_accounts = NULL;
-
-    /* Go through all imported transactions, gather the list of accounts, and
-     * min/max date range.
-     */
-    for (GSList* txn = gui->temp_trans_list; txn != NULL;
-         txn = g_slist_next (txn))
-    {
-        GNCImportTransInfo* txn_info = txn->data;
-        Account *txn_account =
-            xaccSplitGetAccount (gnc_import_TransInfo_get_fsplit (txn_info));
-        time64 txn_time =
-            xaccTransGetDate (gnc_import_TransInfo_get_trans (txn_info));
-        all_accounts = g_list_prepend (all_accounts, txn_account);
-        min_time = MIN(min_time, txn_time);
-        max_time = MAX(max_time, txn_time);
-    }
-
-    // Make a query to find splits with the right accounts and dates.
-    Query *query = qof_query_create_for (GNC_ID_SPLIT);
-    qof_query_set_book (query, gnc_get_current_book ());
-    xaccQueryAddAccountMatch (query, all_accounts,
-                              QOF_GUID_MATCH_ANY, QOF_QUERY_AND);
-    xaccQueryAddDateMatchTT (query,
-                             true, min_time - match_timelimit,
-                             true, max_time + match_timelimit,
-                             QOF_QUERY_AND);
-    GList *query_results = qof_query_run (query);
-    g_list_free (all_accounts);
-    GList *retval = g_list_copy (query_results);
-    qof_query_destroy (query);
-
-    return retval;
-}
-
-/* Create a hash by account of all splits that could match one of the imported
- * transactions based on their account and date and organized per account.
- */
-static GHashTable*
-create_hash_of_potential_matches (GList *candidate_splits,
-                                  GHashTable *account_hash)
-{
-    for (GList* candidate = candidate_splits; candidate != NULL;
-         candidate = g_list_next (candidate))
-    {
-        if (gnc_import_split_has_online_id (candidate->data))
-            continue;
-        /* In this context an open transaction represents a freshly
-         * downloaded one. That can't possibly be a match yet */
-        if (xaccTransIsOpen(xaccSplitGetParent(candidate->data)))
-            continue;
-        Account *split_account = xaccSplitGetAccount (candidate->data);
-        /* g_hash_table_steal_extended would do the two calls in one shot but is
-         * not available until GLib 2.58.
-         */
-        GSList *split_list = g_hash_table_lookup (account_hash, split_account);
-        g_hash_table_steal (account_hash, split_account);
-        split_list = g_slist_prepend (split_list, candidate->data);
-        g_hash_table_insert (account_hash, split_account, split_list);
-    }
-    return account_hash;
-}
-
-typedef struct _match_struct
-{
-    GNCImportTransInfo* transaction_info;
-    gint display_threshold;
-    gint date_threshold;
-    gint date_not_threshold;
-    double fuzzy_amount;
-} match_struct;
-
-static void
-match_helper (Split* data, match_struct* s)
-{
-    split_find_match (s->transaction_info, data,
-                      s->display_threshold,
-                      s->date_threshold,
-                      s->date_not_threshold,
-                      s->fuzzy_amount);
-}
-
 /* Iterate through the imported transactions selecting matches from the
- * potential match lists in the account hash and update the matcher with the
- * results.
+ * potential matches in the index and update the matcher with the results.
  */
 
 static void
-perform_matching (GNCImportMainMatcher *gui, GHashTable *account_hash)
+perform_matching (GNCImportMainMatcher *gui, GNCImportMatchIndex *index)
 {
     GtkTreeModel* model = gtk_tree_view_get_model (gui->view);
     gint display_threshold =
@@ -2379,11 +2282,10 @@ perform_matching (GNCImportMainMatcher *gui, GHashTable *account_hash)
          imported_txn = g_slist_next (imported_txn))
     {
         GNCImportTransInfo* txn_info = imported_txn->data;
-        Account *importaccount = xaccSplitGetAccount (gnc_import_TransInfo_get_fsplit (txn_info));
-        match_struct s = {txn_info, display_threshold, date_threshold, date_not_threshold, fuzzy_amount};
 
-        g_slist_foreach (g_hash_table_lookup (account_hash, importaccount),
-                         (GFunc) match_helper, &s);
+        gnc_import_match_index_find_matches (index, txn_info, display_threshold,
+                                             date_threshold, date_not_threshold,
+                                             fuzzy_amount);
 
         // Sort the matches, select the best match, and set the action.
         gnc_import_TransInfo_init_matches (txn_info, gui->user_settings);
@@ -2406,17 +2308,16 @@ perform_matching (GNCImportMainMatcher *gui, GHashTable *account_hash)
 void
 gnc_gen_trans_list_create_matches (GNCImportMainMatcher *gui)
 {
-    GHashTable* account_hash =
-        g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
-                              (GDestroyNotify)g_slist_free);
     g_assert (gui);
-    GList *candidate_splits = filter_existing_splits_on_account_and_date (gui);
+    gint match_date_limit =
+        gnc_import_Settings_get_match_date_hardlimit (gui->user_settings);
+    GNCImportMatchIndex *index =
+        gnc_import_match_index_new_for_imports (gui->temp_trans_list,
+                                                match_date_limit);
 
-    create_hash_of_potential_matches (candidate_splits, account_hash);
-    perform_matching (gui, account_hash);
+    perform_matching (gui, index);
 
-    g_list_free (candidate_splits);
-    g_hash_table_destroy (account_hash);
+    gnc_import_match_index_free (index);
     return;
 }
 
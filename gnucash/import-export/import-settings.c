@@ -143,6 +143,13 @@ gboolean gnc_import_Settings_get_action_update_enabled (GNCImportSettings *setti
     return settings->action_update_enabled;
 }
 
+void gnc_import_Settings_set_action_update_enabled (GNCImportSettings *settings,
+                                                    gboolean enabled)
+{
+    g_assert (settings);
+    settings->action_update_enabled = enabled;
+}
+
 gboolean gnc_import_Settings_get_action_clear_enabled (GNCImportSettings *settings)
 {
     g_assert (settings);
@@ -167,6 +174,27 @@ gint gnc_import_Settings_get_display_threshold (GNCImportSettings *settings)
     return settings->display_threshold;
 }
 
+void gnc_import_Settings_set_clear_threshold (GNCImportSettings *settings,
+                                              gint clear_threshold)
+{
+    g_assert (settings);
+    settings->clear_threshold = clear_threshold;
+}
+
+void gnc_import_Settings_set_add_threshold (GNCImportSettings *settings,
+                                            gint add_threshold)
+{
+    g_assert (settings);
+    settings->add_threshold = add_threshold;
+}
+
+void gnc_import_Settings_set_display_threshold (GNCImportSettings *settings,
+                                                gint display_threshold)
+{
+    g_assert (settings);
+    settings->display_threshold = display_threshold;
+}
+
 gint gnc_import_Settings_get_date_threshold (GNCImportSettings *settings)
 {
     g_assert (settings);
@@ -74,6 +74,11 @@ gboolean gnc_import_Settings_get_action_add_enabled (GNCImportSettings *settings
 */
 gboolean gnc_import_Settings_get_action_update_enabled (GNCImportSettings *settings);
 
+/** Override whether the user prefs enable the update action.
+*/
+void gnc_import_Settings_set_action_update_enabled (GNCImportSettings *settings,
+                                                    gboolean enabled);
+
 /** Return the selected action is enable state.
 */
 gboolean gnc_import_Settings_get_action_clear_enabled (GNCImportSettings *settings);
@@ -90,6 +95,22 @@ gint gnc_import_Settings_get_add_threshold (GNCImportSettings *settings);
 */
 gint gnc_import_Settings_get_display_threshold (GNCImportSettings *settings);
 
+/** Override the threshold the user prefs set, for imports that run
+ * without asking the user.
+*/
+void gnc_import_Settings_set_clear_threshold (GNCImportSettings *settings,
+                                              gint clear_threshold);
+
+/** Override the threshold the user prefs set.
+*/
+void gnc_import_Settings_set_add_threshold (GNCImportSettings *settings,
+                                            gint add_threshold);
+
+/** Override the threshold the user prefs set.
+*/
+void gnc_import_Settings_set_display_threshold (GNCImportSettings *settings,
+                                                gint display_threshold);
+
 gint gnc_import_Settings_get_date_threshold (GNCImportSettings *settings);
 
 gint gnc_import_Settings_get_date_not_threshold (GNCImportSettings *settings);
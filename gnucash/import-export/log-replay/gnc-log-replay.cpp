@@ -0,0 +1,114 @@
+/********************************************************************\
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+/** @addtogroup Import_Export
+    @{ */
+/** @internal
+    @file gnc-log-replay.cpp
+    @brief .log file replay code
+    @author Copyright (c) 2003 Benoit Grégoire <bock@step.polymtl.ca>
+*/
+#include <config.h>
+
+#include <gtk/gtk.h>
+#include <glib/gi18n.h>
+
+#include "TransLog.h"
+#include "gnc-log-replay.h"
+#include "gnc-file.h"
+#include "gnc-translog-replay.hpp"
+#include "qof.h"
+#include "gnc-ui-util.h"
+#include "gnc-gui-query.h"
+
+#include <stdexcept>
+
+#define GNC_PREFS_GROUP "dialogs.log-replay"
+
+/* NW: If you want a new log_module, just define
+a unique string either in gnc-engine.h or
+locally.*/
+static QofLogModule log_module = GNC_MOD_IMPORT;
+
+/********************************************************************\
+ * gnc_file_log_replay
+ * Entry point
+\********************************************************************/
+
+void gnc_file_log_replay (GtkWindow *parent)
+{
+    ENTER(" ");
+
+    auto default_dir = gnc_get_default_directory(GNC_PREFS_GROUP);
+
+    auto filter = gtk_file_filter_new();
+    gtk_file_filter_set_name(filter, "*.log");
+    gtk_file_filter_add_pattern(filter, "*.[Ll][Oo][Gg]");
+    auto selected_filename = gnc_file_dialog(parent,
+                                             _("Select a .log file to replay"),
+                                             g_list_prepend(NULL, filter),
+                                             default_dir,
+                                             GNC_FILE_DIALOG_OPEN);
+    g_free(default_dir);
+
+    if (!selected_filename)
+    {
+        LEAVE("no file selected");
+        return;
+    }
+
+    /* Remember the directory as the default. */
+    default_dir = g_path_get_dirname(selected_filename);
+    gnc_set_default_directory(GNC_PREFS_GROUP, default_dir);
+    g_free(default_dir);
+
+    DEBUG("Filename found: %s", selected_filename);
+    if (xaccFileIsCurrentLog(selected_filename))
+    {
+        g_warning("Cannot open the current log file: %s", selected_filename);
+        gnc_error_dialog(NULL,
+                         /* Translators: %s is the file name. */
+                         _("Cannot open the current log file: %s"),
+                         selected_filename);
+    }
+    else
+    {
+        try
+        {
+            GncTransLogReplay replay {gnc_get_current_book()};
+            replay.read(selected_filename);
+            if (replay.incomplete())
+                PWARN("Dropped %zu incomplete records", replay.incomplete());
+            auto counts = replay.apply();
+            PINFO("%zu created, %zu changed, %zu deleted, %zu not found",
+                  counts.created, counts.changed, counts.deleted,
+                  counts.not_found);
+        }
+        catch (const std::runtime_error& err)
+        {
+            PERR("%s", err.what());
+            gnc_error_dialog(NULL, "%s", err.what());
+        }
+    }
+    g_free(selected_filename);
+
+    LEAVE("");
+}
+
+
+/** @} */
@@ -1300,6 +1300,7 @@ runMatcher (ofx_info* info, char * selected_filename, gboolean go_to_next_file)
     GHashTable* trans_hash = g_hash_table_new_full (g_str_hash, g_str_equal,
                                                     g_free, NULL);
     info->num_trans_processed = 0;
+    qof_event_begin_batch ();
     // Add transactions, but verify that there isn't one that was already added with identical
     // amounts and date, and a different account. To do that, create a hash table whose key is
     // a hash of amount and date, and whose value is the account in which they appear.
@@ -1339,6 +1340,7 @@ runMatcher (ofx_info* info, char * selected_filename, gboolean go_to_next_file)
             info->num_trans_processed ++;
         }
     }
+    qof_event_end_batch ();
     g_list_free (info->trans_list);
     g_hash_table_destroy (trans_hash);
     info->trans_list = g_list_reverse (trans_list_remain);
@@ -1417,7 +1419,12 @@ gnc_file_ofx_import_process_file (ofx_info* info)
 
     // Create the match dialog, and run the ofx file through the importer.
     info->gnc_ofx_importer_gui = gnc_gen_trans_list_new (GTK_WIDGET(parent), NULL, FALSE, 42, FALSE);
+    /* The transactions are staged in info->trans_list, still open, while
+     * the file is parsed. Coalesce the events of creating them so that
+     * the batched handlers see each object once. */
+    qof_event_begin_batch ();
     libofx_proc_file (libofx_context, selected_filename, AUTODETECT);
+    qof_event_end_batch ();
 
     // Free the libofx context before recursing to process the next file
     libofx_free_context(libofx_context);
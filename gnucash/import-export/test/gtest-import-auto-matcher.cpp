@@ -0,0 +1,256 @@
+/********************************************************************
+ * gtest-import-auto-matcher.cpp --                                 *
+ *                        unit tests import-auto-matcher.           *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+ *******************************************************************/
+
+#include <gtest/gtest.h>
+#include <config.h>
+#include <import-auto-matcher.h>
+#include <import-utilities.h>
+#include <gnc-session.h>
+#include <cashobjects.h>
+#include <gnc-commodity.h>
+#include <Account.h>
+#include <Transaction.h>
+#include <Split.h>
+#include <gtk/gtk.h>
+#include <string>
+#include <vector>
+
+class ImportAutoMatcherTest : public ::testing::Test
+{
+protected:
+    void SetUp () override
+    {
+        static bool registered = false;
+        if (!registered)
+        {
+            qof_init ();
+            cashobjects_register ();
+            registered = true;
+        }
+        m_book = qof_book_new ();
+        auto table = gnc_commodity_table_get_table (m_book);
+        m_usd = gnc_commodity_new (m_book, "US Dollar",
+                                   GNC_COMMODITY_NS_CURRENCY, "USD",
+                                   "840", 100);
+        gnc_commodity_table_insert (table, m_usd);
+        auto root = gnc_account_create_root (m_book);
+        m_bank = make_account (root, "Bank", ACCT_TYPE_BANK);
+        m_expenses = make_account (root, "Expenses", ACCT_TYPE_EXPENSE);
+        m_date = gnc_dmy2time64_neutral (18, 3, 2020);
+
+        /* No preferences are set up, so the date thresholds and the
+         * fuzzy amount difference are 0. */
+        m_settings = gnc_import_Settings_new ();
+        gnc_import_Settings_set_display_threshold (m_settings, 1);
+        gnc_import_Settings_set_clear_threshold (m_settings, 5);
+        gnc_import_Settings_set_add_threshold (m_settings, 3);
+        gnc_import_Settings_set_action_update_enabled (m_settings, FALSE);
+    }
+
+    void TearDown () override
+    {
+        gnc_import_Settings_delete (m_settings);
+        qof_book_destroy (m_book);
+        gnc_clear_current_session ();
+    }
+
+    Account *make_account (Account *parent, const char *name,
+                           GNCAccountType type)
+    {
+        auto acc = xaccMallocAccount (m_book);
+        xaccAccountBeginEdit (acc);
+        xaccAccountSetName (acc, name);
+        xaccAccountSetType (acc, type);
+        xaccAccountSetCommodity (acc, m_usd);
+        xaccAccountCommitEdit (acc);
+        gnc_account_append_child (parent, acc);
+        return acc;
+    }
+
+    // An existing transaction from the bank account to the expenses
+    Split *add_existing (time64 date, gint64 cents, const char *description,
+                         const char *online_id = nullptr)
+    {
+        auto trans = xaccMallocTransaction (m_book);
+        auto amount = gnc_numeric_create (cents, 100);
+        Split *bank_split = nullptr;
+        xaccTransBeginEdit (trans);
+        xaccTransSetCurrency (trans, m_usd);
+        xaccTransSetDatePostedSecsNormalized (trans, date);
+        xaccTransSetDescription (trans, description);
+        for (auto [acc, amt] : {std::pair {m_bank, amount},
+                                std::pair {m_expenses, gnc_numeric_neg (amount)}})
+        {
+            auto split = xaccMallocSplit (m_book);
+            xaccSplitSetParent (split, trans);
+            xaccSplitSetAccount (split, acc);
+            xaccSplitSetAmount (split, amt);
+            xaccSplitSetValue (split, amt);
+            if (acc == m_bank)
+                bank_split = split;
+        }
+        if (online_id)
+            gnc_import_set_split_online_id (bank_split, online_id);
+        xaccTransCommitEdit (trans);
+        return bank_split;
+    }
+
+    /* An imported transaction as the CSV importer makes them: open for
+     * edit, with only its split in the bank account. */
+    Transaction *import_trans (time64 date, gint64 cents,
+                               const char *description, const char *online_id)
+    {
+        auto trans = xaccMallocTransaction (m_book);
+        auto amount = gnc_numeric_create (cents, 100);
+        xaccTransBeginEdit (trans);
+        xaccTransSetCurrency (trans, m_usd);
+        xaccTransSetDatePostedSecsNormalized (trans, date);
+        xaccTransSetDescription (trans, description);
+        auto split = xaccMallocSplit (m_book);
+        xaccSplitSetParent (split, trans);
+        xaccSplitSetAccount (split, m_bank);
+        xaccSplitSetAmount (split, amount);
+        xaccSplitSetValue (split, amount);
+        gnc_import_set_split_online_id (split, online_id);
+        return trans;
+    }
+
+    GNCImportAutoMatcherCounts run (const std::vector<Transaction*>& imports)
+    {
+        auto matcher = gnc_import_auto_matcher_new (m_settings);
+        for (auto trans : imports)
+            gnc_import_auto_matcher_add_trans (matcher, trans, nullptr);
+        GNCImportAutoMatcherCounts counts;
+        gnc_import_auto_matcher_run (matcher, &counts);
+        gnc_import_auto_matcher_delete (matcher);
+        return counts;
+    }
+
+    QofBook *m_book {};
+    gnc_commodity *m_usd {};
+    Account *m_bank {};
+    Account *m_expenses {};
+    time64 m_date {};
+    GNCImportSettings *m_settings {};
+};
+
+/* Two imported transactions have the same best match. The better one
+ * reconciles it; the other has no match left and is added. A third one
+ * is dropped because its online id is already in the account. */
+TEST_F (ImportAutoMatcherTest, duplicates_and_competing_matches)
+{
+    auto grocery = add_existing (m_date, -5000, "Grocery Store");
+    auto petrol = add_existing (m_date, -2000, "Petrol", "old-1");
+
+    /* Amount +3, date +3 and description +2 or, for only the first half
+     * of it, +1. */
+    auto counts = run ({import_trans (m_date, -5000, "Grocery Store", "new-1"),
+                        import_trans (m_date, -5000, "Grocery", "new-2"),
+                        import_trans (m_date, -2000, "Petrol", "old-1")});
+
+    EXPECT_EQ (counts.duplicates, 1u);
+    EXPECT_EQ (counts.cleared, 1u);
+    EXPECT_EQ (counts.added, 1u);
+    EXPECT_EQ (counts.unbalanced, 1u);
+    EXPECT_EQ (counts.updated, 0u);
+    EXPECT_EQ (counts.skipped, 0u);
+
+    EXPECT_EQ (xaccSplitGetReconcile (grocery), CREC);
+    auto online_id = gnc_import_get_split_online_id (grocery);
+    EXPECT_STREQ (online_id, "new-1");
+    g_free (online_id);
+    EXPECT_EQ (xaccSplitGetReconcile (petrol), NREC);
+
+    // the existing two and the added one
+    auto splits = xaccAccountGetSplitList (m_bank);
+    ASSERT_EQ (g_list_length (splits), 3u);
+    for (auto node = splits; node; node = g_list_next (node))
+    {
+        auto split = static_cast<Split*>(node->data);
+        if (split == grocery || split == petrol)
+            continue;
+        EXPECT_STREQ (xaccTransGetDescription (xaccSplitGetParent (split)),
+                      "Grocery");
+        EXPECT_EQ (xaccSplitGetReconcile (split), CREC);
+    }
+
+    // Importing the same again drops all of them.
+    counts = run ({import_trans (m_date, -5000, "Grocery Store", "new-1"),
+                   import_trans (m_date, -5000, "Grocery", "new-2"),
+                   import_trans (m_date, -2000, "Petrol", "old-1")});
+    EXPECT_EQ (counts.duplicates, 3u);
+    EXPECT_EQ (counts.added + counts.cleared + counts.updated + counts.skipped, 0u);
+    EXPECT_EQ (g_list_length (xaccAccountGetSplitList (m_bank)), 3u);
+}
+
+/* A match a day off scores amount +3, date -5 and description +2, so it
+ * is one to update if that is enabled and one to clear otherwise. */
+TEST_F (ImportAutoMatcherTest, clear_or_update)
+{
+    auto rent = add_existing (m_date, -30000, "Rent");
+    auto rent_trans = xaccSplitGetParent (rent);
+    auto next_day = m_date + 86400;
+    gnc_import_Settings_set_display_threshold (m_settings, 0);
+    gnc_import_Settings_set_clear_threshold (m_settings, 0);
+    gnc_import_Settings_set_add_threshold (m_settings, -20);
+
+    auto counts = run ({import_trans (next_day, -30000, "Rent", "rent-1")});
+    EXPECT_EQ (counts.cleared, 1u);
+    EXPECT_EQ (counts.updated, 0u);
+    EXPECT_EQ (xaccSplitGetReconcile (rent), CREC);
+    EXPECT_EQ (xaccTransGetDate (rent_trans), m_date);
+
+    // Make it a candidate again, then import it once more with updates.
+    xaccTransBeginEdit (rent_trans);
+    xaccSplitSetReconcile (rent, NREC);
+    gnc_import_set_split_online_id (rent, nullptr);
+    xaccTransCommitEdit (rent_trans);
+    gnc_import_Settings_set_action_update_enabled (m_settings, TRUE);
+
+    counts = run ({import_trans (next_day, -30000, "Rent", "rent-2")});
+    EXPECT_EQ (counts.updated, 1u);
+    EXPECT_EQ (counts.cleared, 0u);
+    EXPECT_EQ (xaccSplitGetReconcile (rent), CREC);
+    EXPECT_EQ (xaccTransGetDate (rent_trans), next_day);
+}
+
+/* The accounts are held open until the last transaction is in, and are
+ * then left sorted and balanced. */
+TEST_F (ImportAutoMatcherTest, commits_accounts_once)
+{
+    auto counts = run ({import_trans (m_date + 2 * 86400, -300, "Three", "n-3"),
+                        import_trans (m_date, -100, "One", "n-1"),
+                        import_trans (m_date + 86400, -200, "Two", "n-2")});
+    EXPECT_EQ (counts.added, 3u);
+
+    EXPECT_EQ (qof_instance_get_editlevel (m_bank), 0);
+    EXPECT_FALSE (gnc_account_get_defer_bal_computation (m_bank));
+    EXPECT_TRUE (gnc_numeric_equal (xaccAccountGetBalance (m_bank),
+                                    gnc_numeric_create (-600, 100)));
+
+    std::vector<std::string> descriptions;
+    for (auto node = xaccAccountGetSplitList (m_bank); node; node = g_list_next (node))
+        descriptions.push_back (xaccTransGetDescription
+                                (xaccSplitGetParent (static_cast<Split*>(node->data))));
+    EXPECT_EQ (descriptions, (std::vector<std::string> {"One", "Two", "Three"}));
+}
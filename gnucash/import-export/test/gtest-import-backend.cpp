@@ -15,6 +15,7 @@
 #include "gmock-Account.h"
 #include "gmock-Transaction.h"
 #include "gmock-Split.h"
+#include "fake-qofquery.h"
 
 
 
@@ -296,3 +297,492 @@ TEST_F(ImportBackendBayesTest, CreateTransInfo)
     // delete transaction info
     gnc_import_TransInfo_delete(trans_info);
 };
+
+
+//! Test that transactions with the same description and memo get the same tokens
+TEST_F(ImportBackendBayesTest, RepeatedTokens)
+{
+    using namespace testing;
+
+    time64 date(GncDateTime(GncDate(2020, 3, 18)));
+
+    ON_CALL(*m_trans, get_split(0))
+        .WillByDefault(Return(m_split));
+    ON_CALL(*m_trans, get_split_list())
+        .WillByDefault(Return(m_splitList));
+    ON_CALL(*m_trans, get_split(Gt(0)))
+        .WillByDefault(Return(nullptr));
+    ON_CALL(*m_trans, get_description())
+        .WillByDefault(Return("Grocery Store  Grocery"));
+    ON_CALL(*m_split, get_memo())
+        .WillByDefault(Return("Card payment Store"));
+    ON_CALL(*m_trans, get_date())
+        .WillByDefault(Return(date));
+
+    std::vector<const char*> first_tokens, second_tokens;
+    EXPECT_CALL(*m_import_acc, find_account_bayes(_))
+        .WillOnce(DoAll(SaveArg<0>(&first_tokens), Return(m_dest_acc)))
+        .WillOnce(DoAll(SaveArg<0>(&second_tokens), Return(m_dest_acc)));
+
+    auto first_info = gnc_import_TransInfo_new(m_trans, m_import_acc);
+    auto second_info = gnc_import_TransInfo_new(m_trans, m_import_acc);
+
+    // The tokens are the same, down to the interned strings.
+    EXPECT_EQ(first_tokens.size(), 5u);
+    EXPECT_THAT(first_tokens, Not(HasDuplicates()));
+    EXPECT_THAT(first_tokens, Contains(StrEq("Grocery")));
+    EXPECT_THAT(first_tokens, Contains(StrEq("payment")));
+    EXPECT_EQ(first_tokens, second_tokens);
+
+    ON_CALL(*m_trans, is_open())
+        .WillByDefault(Return(false));
+
+    gnc_import_TransInfo_delete(first_info);
+    gnc_import_TransInfo_delete(second_info);
+};
+
+
+
+// Test fixture for matching imported transactions against existing ones
+class ImportBackendMatchTest : public ImportBackendTest
+{
+protected:
+    void SetUp()
+    {
+        ImportBackendTest::SetUp();
+
+        using namespace testing;
+
+        m_date = static_cast<time64>(GncDateTime(GncDate(2020, 3, 18)));
+
+        // the imported transaction
+        ON_CALL(*m_trans, get_split(0))
+            .WillByDefault(Return(m_split));
+        ON_CALL(*m_trans, get_split_list())
+            .WillByDefault(Return(m_splitList));
+        ON_CALL(*m_trans, get_description())
+            .WillByDefault(Return("Grocery Store"));
+        ON_CALL(*m_trans, get_num())
+            .WillByDefault(Return("42"));
+        ON_CALL(*m_trans, get_date())
+            .WillByDefault(Return(m_date));
+        ON_CALL(*m_split, get_account())
+            .WillByDefault(Return(m_import_acc));
+        ON_CALL(*m_split, get_amount())
+            .WillByDefault(Return(gnc_numeric_create(10000, 100)));
+        ON_CALL(*m_split, get_memo())
+            .WillByDefault(Return("Card payment"));
+        ON_CALL(*m_import_acc, find_account(_, _))
+            .WillByDefault(Return(nullptr));
+
+        /* The existing splits lie on both sides of the amount and date
+         * limits: exactly the fuzzy amount difference away and just
+         * beyond it, the last second of a whole day of difference and
+         * the first second of the next one. */
+        const gint64 amounts[] = {10000, 10200, 9800, 10201, 9799, 25000};
+        const gint64 days[] = {0, 1, 4, 5, 14, 15, 30};
+        const char *descriptions[] = {"Grocery Store", "Grocery", "Petrol"};
+        const char *memos[] = {"Card payment", "Card", "Cash", "", "Card payment 123"};
+        gint i = 0;
+        for (auto amount : amounts)
+            for (auto day : days)
+                for (auto sign : {1, -1})
+                    for (auto secs : {day * 86400, day * 86400 + 86399})
+                    {
+                        add_existing_split (m_import_acc, amount,
+                                            m_date + sign * secs,
+                                            descriptions[i % 3],
+                                            i % 2 ? "42" : "7",
+                                            memos[i % 5]);
+                        ++i;
+                    }
+
+        // splits in another account aren't candidates
+        add_existing_split (m_dest_acc, 10000, m_date, "Grocery Store", "42",
+                            "Card payment");
+        add_existing_split (m_dest_acc, 10200, m_date, "Grocery", "7", "Cash");
+    }
+
+    void TearDown()
+    {
+        for (auto split : m_existing_splits)
+            split->free();
+        for (auto trans : m_existing_trans)
+            trans->free();
+        ImportBackendTest::TearDown();
+    }
+
+    void add_existing_split (Account *account, gint64 amount, time64 date,
+                             const char *description, const char *num,
+                             const char *memo)
+    {
+        using namespace testing;
+
+        auto trans = new MockTransaction();
+        auto split = new MockSplit();
+
+        ON_CALL(*trans, get_date())
+            .WillByDefault(Return(date));
+        ON_CALL(*trans, get_description())
+            .WillByDefault(Return(description));
+        ON_CALL(*trans, get_num())
+            .WillByDefault(Return(num));
+        ON_CALL(*split, get_account())
+            .WillByDefault(Return(account));
+        ON_CALL(*split, get_amount())
+            .WillByDefault(Return(gnc_numeric_create(amount, 100)));
+        ON_CALL(*split, get_memo())
+            .WillByDefault(Return(memo));
+        ON_CALL(*split, get_parent())
+            .WillByDefault(Return(trans));
+
+        m_existing_trans.push_back(trans);
+        m_existing_splits.push_back(split);
+    }
+
+    // The splits and probabilities of the matches found, in list order
+    static std::vector<std::pair<Split*, gint>>
+    get_matches (GNCImportTransInfo *trans_info)
+    {
+        std::vector<std::pair<Split*, gint>> matches;
+        for (auto node = gnc_import_TransInfo_get_match_list (trans_info);
+             node; node = g_list_next (node))
+        {
+            auto match_info = static_cast<GNCImportMatchInfo*>(node->data);
+            matches.emplace_back (gnc_import_MatchInfo_get_split (match_info),
+                                  gnc_import_MatchInfo_get_probability (match_info));
+        }
+        return matches;
+    }
+
+    time64                        m_date;
+    std::vector<MockTransaction*> m_existing_trans;
+    std::vector<MockSplit*>       m_existing_splits;
+};
+
+static const gint date_threshold = 4;
+static const gint date_not_threshold = 14;
+static const double fuzzy_amount_difference = 2.0;
+
+
+
+/* Tests using fixture ImportBackendMatchTest */
+
+//! Test that the match index finds the same matches as scoring every split
+TEST_F(ImportBackendMatchTest, IndexedMatchesEqualUnindexed)
+{
+    size_t import_acc_splits = 0;
+    for (auto split : m_existing_splits)
+        if (xaccSplitGetAccount (split) == m_import_acc)
+            ++import_acc_splits;
+
+    auto index = gnc_import_match_index_new ();
+    for (auto split : m_existing_splits)
+        gnc_import_match_index_add_split (index, split);
+
+    /* The display thresholds cover every way the index picks the
+     * candidates: by amount only, by amount and within the same day, the
+     * date threshold or the date-not threshold, and all of them. */
+    bool some_rejected = false;
+    for (gint display_threshold = -12; display_threshold <= 14; ++display_threshold)
+    {
+        auto indexed_info = gnc_import_TransInfo_new (m_trans, m_import_acc);
+        auto unindexed_info = gnc_import_TransInfo_new (m_trans, m_import_acc);
+
+        gnc_import_match_index_find_matches (index, indexed_info, display_threshold,
+                                             date_threshold, date_not_threshold,
+                                             fuzzy_amount_difference);
+        for (auto split : m_existing_splits)
+            if (xaccSplitGetAccount (split) == m_import_acc)
+                split_find_match (unindexed_info, split, display_threshold,
+                                  date_threshold, date_not_threshold,
+                                  fuzzy_amount_difference);
+
+        // same splits and scores, in the same order
+        auto indexed = get_matches (indexed_info);
+        EXPECT_EQ(indexed, get_matches (unindexed_info))
+            << "display threshold " << display_threshold;
+        if (!indexed.empty () && indexed.size () < import_acc_splits)
+            some_rejected = true;
+
+        gnc_import_TransInfo_delete (indexed_info);
+        gnc_import_TransInfo_delete (unindexed_info);
+    }
+    EXPECT_TRUE(some_rejected);
+
+    gnc_import_match_index_free (index);
+};
+
+
+//! Test that the index for imports scores the query results the way the matcher did
+TEST_F(ImportBackendMatchTest, IndexForImportsKeepsOrder)
+{
+    using namespace testing;
+
+    const gint match_date_hardlimit = 42;
+
+    // neither a split with an online id nor one of an open transaction is a candidate
+    gnc_import_set_split_online_id (m_existing_splits[3], "online");
+    ON_CALL(*m_existing_trans[5], is_open())
+        .WillByDefault(Return(true));
+
+    QofFakeQuery query(GNC_ID_SPLIT);
+    EXPECT_CALL(query, set_book(((TestEnvironment*)env)->m_book));
+    EXPECT_CALL(query, add_account_match(ElementsAre(m_import_acc),
+                                         QOF_GUID_MATCH_ANY, QOF_QUERY_AND));
+    EXPECT_CALL(query, add_date_match_tt(true, m_date - match_date_hardlimit * 86400,
+                                         true, m_date + match_date_hardlimit * 86400,
+                                         QOF_QUERY_AND));
+    EXPECT_CALL(query, run())
+        .WillOnce(Return(std::vector<void*>(m_existing_splits.begin (),
+                                            m_existing_splits.end ())));
+    auto indexed_info = gnc_import_TransInfo_new (m_trans, m_import_acc);
+    auto unindexed_info = gnc_import_TransInfo_new (m_trans, m_import_acc);
+    auto trans_info_list = g_slist_prepend (nullptr, indexed_info);
+    auto index = gnc_import_match_index_new_for_imports (trans_info_list,
+                                                         match_date_hardlimit);
+
+    gnc_import_match_index_find_matches (index, indexed_info, -12,
+                                         date_threshold, date_not_threshold,
+                                         fuzzy_amount_difference);
+
+    /* Without the index, the candidates of an account were prepended to
+     * a list as the query returned them, and then scored in that order. */
+    std::vector<Split*> candidates;
+    for (auto split : m_existing_splits)
+        if (xaccSplitGetAccount (split) == m_import_acc &&
+            !gnc_import_split_has_online_id (split) &&
+            !xaccTransIsOpen (xaccSplitGetParent (split)))
+            candidates.insert (candidates.begin (), split);
+    for (auto split : candidates)
+        split_find_match (unindexed_info, split, -12,
+                          date_threshold, date_not_threshold,
+                          fuzzy_amount_difference);
+
+    auto indexed = get_matches (indexed_info);
+    EXPECT_EQ(indexed.size (), candidates.size ());
+    EXPECT_EQ(indexed, get_matches (unindexed_info));
+    EXPECT_THAT(indexed, Not(Contains(Pair(m_existing_splits[3], _))));
+    EXPECT_THAT(indexed, Not(Contains(Pair(m_existing_splits[5], _))));
+
+    gnc_import_match_index_free (index);
+    g_slist_free (trans_info_list);
+    gnc_import_TransInfo_delete (indexed_info);
+    gnc_import_TransInfo_delete (unindexed_info);
+};
+
+
+
+// Test fixture for finding already imported transactions by their online id
+class ImportBackendOnlineIdTest : public ImportBackendTest
+{
+protected:
+    void SetUp()
+    {
+        ImportBackendTest::SetUp();
+
+        using namespace testing;
+
+        m_acct_id_hash = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+        ON_CALL(*m_import_acc, xaccAccountGetSplitList())
+            .WillByDefault(Invoke([this]() { return m_acc_splits; }));
+        ON_CALL(*book(), lookup_split(_))
+            .WillByDefault(Invoke(this, &ImportBackendOnlineIdTest::lookup_split));
+    }
+
+    void TearDown()
+    {
+        testing::Mock::VerifyAndClear(book());
+        g_hash_table_destroy (m_acct_id_hash);
+        g_list_free (m_acc_splits);
+        for (auto split : m_splits)
+            split->free();
+        for (auto trans : m_transactions)
+            trans->free();
+        ImportBackendTest::TearDown();
+    }
+
+    static QofMockBook* book ()
+    {
+        return ((TestEnvironment*)env)->m_book;
+    }
+
+    // An existing split in m_import_acc
+    MockSplit* add_split (const char *online_id)
+    {
+        using namespace testing;
+
+        auto trans = new MockTransaction();
+        auto split = new MockSplit();
+        ON_CALL(*split, get_account())
+            .WillByDefault(Return(m_import_acc));
+        ON_CALL(*split, get_parent())
+            .WillByDefault(Return(trans));
+        if (online_id)
+            gnc_import_set_split_online_id (split, online_id);
+
+        m_transactions.push_back(trans);
+        m_splits.push_back(split);
+        m_acc_splits = g_list_append (m_acc_splits, split);
+        return split;
+    }
+
+    void delete_split (MockSplit *split)
+    {
+        m_acc_splits = g_list_remove (m_acc_splits, split);
+        m_deleted.push_back(split);
+    }
+
+    void move_split (MockSplit *split)
+    {
+        using namespace testing;
+
+        m_acc_splits = g_list_remove (m_acc_splits, split);
+        ON_CALL(*split, get_account())
+            .WillByDefault(Return(m_dest_acc));
+    }
+
+    Split* lookup_split (const GncGUID *guid)
+    {
+        for (auto split : m_splits)
+            if (std::find(m_deleted.begin(), m_deleted.end(), split) == m_deleted.end() &&
+                guid_equal (xaccSplitGetGUID (split), guid))
+                return split;
+        return nullptr;
+    }
+
+    // Whether an imported transaction with online_id is already in m_import_acc
+    bool exists (const char *online_id)
+    {
+        using namespace testing;
+
+        auto trans = new MockTransaction();
+        auto split = new MockSplit();
+        ON_CALL(*trans, get_split(0))
+            .WillByDefault(Return(split));
+        ON_CALL(*split, get_account())
+            .WillByDefault(Return(m_import_acc));
+        gnc_import_set_split_online_id (split, online_id);
+
+        m_transactions.push_back(trans);
+        m_splits.push_back(split);
+        return gnc_import_exists_online_id (trans, m_acct_id_hash);
+    }
+
+    void start_import ()
+    {
+        g_hash_table_remove_all (m_acct_id_hash);
+    }
+
+    GHashTable*                   m_acct_id_hash;
+    GList*                        m_acc_splits = nullptr;
+    std::vector<MockTransaction*> m_transactions;
+    std::vector<MockSplit*>       m_splits;
+    std::vector<MockSplit*>       m_deleted;
+};
+
+
+
+/* Tests using fixture ImportBackendOnlineIdTest */
+
+//! Test that a later import reads only the splits added since the last one
+TEST_F(ImportBackendOnlineIdTest, LaterImportReadsNewSplits)
+{
+    add_split ("id-1");
+    auto no_id = add_split (nullptr);
+
+    EXPECT_TRUE(exists ("id-1"));
+    EXPECT_FALSE(exists ("id-2"));
+
+    add_split ("id-2");
+    start_import ();
+    EXPECT_TRUE(exists ("id-2"));
+    EXPECT_TRUE(exists ("id-1"));
+
+    /* A split read before isn't read again, so an id it is given outside
+     * of the importer isn't seen. The importer records the ids it gives
+     * to existing splits itself, see ReconcileRecordsOnlineId. */
+    gnc_import_set_split_online_id (no_id, "id-3");
+    start_import ();
+    EXPECT_FALSE(exists ("id-3"));
+};
+
+
+//! Test that a hit whose split was deleted, moved or given another id isn't trusted
+TEST_F(ImportBackendOnlineIdTest, StaleHitRereadsAccount)
+{
+    auto deleted = add_split ("deleted");
+    auto moved = add_split ("moved");
+    auto changed = add_split ("changed");
+    auto first_dup = add_split ("dup");
+    add_split ("dup");
+
+    for (auto id : {"deleted", "moved", "changed", "dup"})
+        EXPECT_TRUE(exists (id)) << id;
+
+    // Each change is looked for in a later import that still has the hit.
+    delete_split (deleted);
+    start_import ();
+    EXPECT_FALSE(exists ("deleted"));
+
+    move_split (moved);
+    start_import ();
+    EXPECT_FALSE(exists ("moved"));
+
+    gnc_import_set_split_online_id (changed, "other");
+    start_import ();
+    EXPECT_FALSE(exists ("changed"));
+    // reading the account again picked up the new id
+    EXPECT_TRUE(exists ("other"));
+
+    // another split may still have the id
+    delete_split (first_dup);
+    start_import ();
+    EXPECT_TRUE(exists ("dup"));
+};
+
+
+//! Test that the online id copied to a reconciled split is found by later imports
+TEST_F(ImportBackendOnlineIdTest, ReconcileRecordsOnlineId)
+{
+    using namespace testing;
+
+    // the match's other split has no account to remember
+    auto existing = add_split (nullptr);
+    auto other = new MockSplit();
+    m_splits.push_back(other);
+    ON_CALL(*existing, get_other_split())
+        .WillByDefault(Return(other));
+    EXPECT_FALSE(exists ("bank-1"));
+
+    ON_CALL(*m_trans, get_split(0))
+        .WillByDefault(Return(m_split));
+    ON_CALL(*m_trans, get_split_list())
+        .WillByDefault(Return(m_splitList));
+    ON_CALL(*m_split, get_account())
+        .WillByDefault(Return(m_import_acc));
+    gnc_import_set_split_online_id (m_split, "bank-1");
+
+    auto trans_info = gnc_import_TransInfo_new (m_trans, m_import_acc);
+    split_find_match (trans_info, existing, -100, date_threshold,
+                      date_not_threshold, fuzzy_amount_difference);
+    auto match_list = gnc_import_TransInfo_get_match_list (trans_info);
+    ASSERT_NE(match_list, nullptr);
+    gnc_import_TransInfo_set_selected_match_info (trans_info,
+        static_cast<GNCImportMatchInfo*>(match_list->data), FALSE);
+    gnc_import_TransInfo_set_action (trans_info, GNCImport_CLEAR);
+
+    EXPECT_CALL(*m_trans, destroy());
+    EXPECT_TRUE(gnc_import_process_trans_item (m_import_acc, trans_info));
+    gnc_import_TransInfo_delete (trans_info);
+
+    auto online_id = gnc_import_get_split_online_id (existing);
+    EXPECT_STREQ(online_id, "bank-1");
+    g_free (online_id);
+
+    // found without reading the account again, in this import and the next
+    EXPECT_TRUE(exists ("bank-1"));
+    start_import ();
+    EXPECT_TRUE(exists ("bank-1"));
+};
@@ -381,6 +381,7 @@ gnc_split_register_move_cursor (VirtualLocation *p_new_virt_loc,
     gboolean exact_traversal;
     gboolean do_refresh;
     gboolean saved;
+    gboolean reload = FALSE;
     SRInfo *info;
 
     ENTER("reg=%p, p_new_virt_loc=%p (%d, %d)",
@@ -529,8 +530,23 @@ gnc_split_register_move_cursor (VirtualLocation *p_new_virt_loc,
 
     gnc_resume_gui_refresh ();
 
+    /* The auto-split and journal styles only load the split rows of the
+     * transactions near the cursor. Moving past them reloads the register
+     * around the new transaction. */
+    if (!saved && new_trans_split && (old_trans_split != new_trans_split) &&
+        ((REG_STYLE_AUTO_LEDGER == reg->style) ||
+         (REG_STYLE_JOURNAL     == reg->style)) &&
+        !gnc_split_register_trans_splits_loaded (reg, new_virt_loc.vcell_loc))
+    {
+        info->cursor_hint_trans = new_trans;
+        info->cursor_hint_split = new_split;
+        info->cursor_hint_trans_split = new_trans_split;
+        info->cursor_hint_cursor_class = new_class;
+        reload = TRUE;
+    }
+
     /* redrawing the register can muck everything up */
-    if (saved)
+    if (saved || reload)
     {
         VirtualCellLocation vcell_loc;
 
@@ -573,11 +589,11 @@ gnc_split_register_move_cursor (VirtualLocation *p_new_virt_loc,
 
     /* if the register was reloaded, then everything should be fine :)
      * otherwise, we may need to change some visibility settings. */
-    if (saved)
+    if (saved || reload)
     {
         gnc_split_register_set_cell_fractions (reg, new_split);
 
-        LEAVE("saved");
+        LEAVE("%s", saved ? "saved" : "reloaded");
         return;
     }
 
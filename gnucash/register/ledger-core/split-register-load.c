@@ -50,6 +50,11 @@
 /* This static indicates the debugging module that this .o belongs to. */
 static QofLogModule log_module = GNC_MOD_LEDGER;
 
+/* The auto-split and journal styles load the split rows of the
+ * transactions within this many places of the cursor's in the split
+ * list. */
+#define SPLIT_ROWS_WINDOW 250
+
 
 static void gnc_split_register_load_xfer_cells (SplitRegister* reg,
                                                 Account* base_account);
@@ -126,6 +131,11 @@ gnc_split_register_load_type_cells (SplitRegister* reg)
  *  is associated. The leading virtual cell will be assigned the GncGUID of
  *  the "anchoring split" specified by @a split.
  *
+ *  If @a add_splits is @c FALSE, only the leading virtual cell is set up.
+ *  The load uses this to leave out the split rows of the transactions away
+ *  from the cursor, which keeps large registers from materializing rows
+ *  nobody is looking at.
+ *
  *  Optionally an extra, empty virtual cell will be assigned to no split.
  *  This should not be confused with the "blank split", because this cell is
  *  not tied to any split at all, not even the "blank split". A null GncGUID
@@ -155,6 +165,9 @@ gnc_split_register_load_type_cells (SplitRegister* reg)
  *
  *  @param split_cursor the cursor to use in the split rows that follow
  *
+ *  @param add_splits @c TRUE to add the split rows and the empty row,
+ *  @c FALSE to add only the leading row
+ *
  *  @param visible_splits @c TRUE to make the split rows visible, @c FALSE
  *  otherwise
  *
@@ -181,6 +194,7 @@ gnc_split_register_add_transaction (SplitRegister* reg,
                                     Split* split,
                                     CellBlock* lead_cursor,
                                     CellBlock* split_cursor,
+                                    gboolean add_splits,
                                     gboolean visible_splits,
                                     gboolean start_primary_color,
                                     gboolean add_empty,
@@ -203,6 +217,9 @@ gnc_split_register_add_transaction (SplitRegister* reg,
                          TRUE, start_primary_color, *vcell_loc);
     vcell_loc->virt_row++;
 
+    if (!add_splits)
+        return;
+
     /* Continue setting up virtual cells in a column, using a row for each
      * split in the transaction. */
     for (node = xaccTransGetSplitList (trans); node; node = node->next)
@@ -346,6 +363,39 @@ update_info (SRInfo* info, SplitRegister* reg)
     info->reg_loaded = TRUE;
 }
 
+/* The place in slist of the transaction holding the cursor, around which
+ * the split rows are loaded. The blank transaction isn't in the list; it
+ * goes at the top, at the present or at the bottom. */
+static int
+find_window_center (GList* slist, Transaction* find_trans,
+                    gboolean blank_at_top, gboolean blank_at_present,
+                    gboolean reverse_sort, time64 present)
+{
+    GList* node;
+    int pos = 0;
+    int present_pos = -1;
+
+    for (node = slist; node; node = node->next, pos++)
+    {
+        Transaction* trans = xaccSplitGetParent (node->data);
+        time64 date;
+
+        if (trans == find_trans)
+            return pos;
+
+        date = xaccTransGetDate (trans);
+        if (present_pos < 0 &&
+            (reverse_sort ? date < present : date > present))
+            present_pos = pos;
+    }
+
+    if (blank_at_top)
+        return 0;
+    if (blank_at_present && present_pos >= 0)
+        return present_pos;
+    return pos;
+}
+
 void
 gnc_split_register_load (SplitRegister* reg, GList* slist,
                          Account* default_account)
@@ -384,6 +434,8 @@ gnc_split_register_load (SplitRegister* reg, GList* slist,
                                       GNC_PREFS_GROUP_GENERAL_REGISTER,
                                       GNC_PREF_FUTURE_AFTER_BLANK);
     gboolean added_blank_trans = FALSE;
+    int window_center = 0;
+    int pos;
 
     VirtualCellLocation vcell_loc;
     VirtualLocation save_loc;
@@ -571,6 +623,21 @@ gnc_split_register_load (SplitRegister* reg, GList* slist,
         }
     }
 
+    /* The split rows are only loaded for the transactions near the
+     * cursor. The ledger style only shows those of the transaction
+     * holding it, and expanding another transaction reloads the register
+     * around that. The auto-split and journal styles show them as the
+     * cursor moves, so they load those of a window of transactions, and
+     * moving out of it reloads the register. */
+    if (dynamic || multi_line)
+        window_center = find_window_center (slist, find_trans,
+                                            table->model->reverse_sort &&
+                                            !future_after_blank,
+                                            future_after_blank &&
+                                            info->show_present_divider,
+                                            table->model->reverse_sort,
+                                            present);
+
     if (multi_line)
         trans_table = g_hash_table_new (g_direct_hash, g_direct_equal);
 
@@ -597,7 +664,8 @@ gnc_split_register_load (SplitRegister* reg, GList* slist,
         gnc_split_register_add_transaction (reg,
                                             blank_trans, blank_split,
                                             lead_cursor, split_cursor,
-                                            multi_line, start_primary_color,
+                                            TRUE, multi_line,
+                                            start_primary_color,
                                             info->blank_split_edited,
                                             find_trans, find_split,
                                             find_class, &new_split_row,
@@ -610,7 +678,7 @@ gnc_split_register_load (SplitRegister* reg, GList* slist,
     }
 
     /* populate the table */
-    for (node = slist; node; node = node->next)
+    for (node = slist, pos = 0; node; node = node->next, pos++)
     {
         split = node->data;
         trans = xaccSplitGetParent (split);
@@ -707,7 +775,8 @@ gnc_split_register_load (SplitRegister* reg, GList* slist,
                 gnc_split_register_add_transaction (reg,
                                                     blank_trans, blank_split,
                                                     lead_cursor, split_cursor,
-                                                    multi_line, start_primary_color,
+                                                    TRUE, multi_line,
+                                                    start_primary_color,
                                                     info->blank_split_edited,
                                                     find_trans, find_split,
                                                     find_class, &new_split_row,
@@ -741,6 +810,11 @@ gnc_split_register_load (SplitRegister* reg, GList* slist,
 
         gnc_split_register_add_transaction (reg, trans, split,
                                             lead_cursor, split_cursor,
+                                            trans == find_trans ||
+                                            trans == pending_trans ||
+                                            ((dynamic || multi_line) &&
+                                             ABS (pos - window_center) <=
+                                             SPLIT_ROWS_WINDOW),
                                             multi_line, start_primary_color,
                                             TRUE,
                                             find_trans, find_split, find_class,
@@ -799,7 +873,8 @@ gnc_split_register_load (SplitRegister* reg, GList* slist,
 
         gnc_split_register_add_transaction (reg, blank_trans, blank_split,
                                             lead_cursor, split_cursor,
-                                            multi_line, start_primary_color,
+                                            TRUE, multi_line,
+                                            start_primary_color,
                                             info->blank_split_edited,
                                             find_trans, find_split,
                                             find_class, &new_split_row,
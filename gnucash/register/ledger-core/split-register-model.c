@@ -50,8 +50,43 @@ static QofLogModule log_module = GNC_MOD_LEDGER;
 /* Flag for determining colorization of negative amounts. */
 static gboolean use_red_for_negative = TRUE;
 
-/* This returns the balance at runtime of a register at the split defined by virt_loc regardless of
- * sort order. It always assumes that the first txn in the register is starting from a 0 balance.
+/* The balance of account after trans, which is the engine's running
+ * balance of its last split in or before trans. */
+static gnc_numeric
+get_account_balance_after_trans (Account* account, Transaction* trans)
+{
+    Split* latest = NULL;
+    GList* node;
+
+    /* The account's splits in trans are next to each other in its split
+     * list, so the last of them has the balance after trans. */
+    for (node = xaccTransGetSplitList (trans); node; node = node->next)
+    {
+        Split* split = node->data;
+
+        if (xaccSplitGetAccount (split) == account &&
+            (!latest || xaccSplitOrder (latest, split) < 0))
+            latest = split;
+    }
+
+    /* Otherwise it's the last split before trans, found as in
+     * xaccAccountGetBalanceAsOfDate(). */
+    if (!latest)
+    {
+        for (node = xaccAccountGetSplitList (account); node; node = node->next)
+        {
+            if (xaccTransOrder (xaccSplitGetParent (node->data), trans) > 0)
+                break;
+            latest = node->data;
+        }
+    }
+
+    return latest ? xaccSplitGetBalance (latest) : gnc_numeric_zero ();
+}
+
+/* This returns the balance of the register's account after the transaction
+ * at virt_loc, taken from the engine's split balances, so it needs neither
+ * the rows above nor a particular sort order.
  * If gboolean subaccounts is TRUE, then it will return the total balance of the parent account
  * and all its subaccounts. FALSE will return the balance of just the parent account of the register. */
 static gnc_numeric
@@ -64,9 +99,6 @@ gnc_split_register_get_rbaln (VirtualLocation virt_loc, gpointer user_data,
     gnc_numeric balance;
     Account* account = NULL;
     Transaction* trans;
-    GList* node, *child;
-    GList* children = NULL;
-    int i, row;
 
     balance = gnc_numeric_zero();
 
@@ -80,61 +112,25 @@ gnc_split_register_get_rbaln (VirtualLocation virt_loc, gpointer user_data,
     if (!trans)
         return gnc_numeric_zero();
 
-    /* Get a list of accounts for matching */
     account = gnc_split_register_get_default_account (reg);
     if (!account)
         /* Register has no account (perhaps general journal) so it has no
            well defined balance, return zero. */
         return balance;
 
-    if (subaccounts)
-    {
-        children = gnc_account_get_descendants (account);
-        children = g_list_prepend (children, account);
-    }
-
-    /* Get the row number we're on, then start with the first row. */
-    row = virt_loc.vcell_loc.virt_row;
-    virt_loc.vcell_loc.virt_row = 0;
+    balance = get_account_balance_after_trans (account, trans);
 
-    while (virt_loc.vcell_loc.virt_row <= row)
+    if (subaccounts)
     {
-        /* Get new temporary split and its parent transaction */
-        split = gnc_split_register_get_split (reg, virt_loc.vcell_loc);
-        trans = xaccSplitGetParent (split);
-
-        i = 1;
-        for (node = xaccTransGetSplitList (trans); node; node = node->next)
-        {
-            Split* secondary = node->data;
-            i++;
-
-            if (subaccounts)
-            {
-                /* Add up the splits that belong to the transaction if they are
-                 * from the lead account or one of the subaccounts. */
-                account = xaccSplitGetAccount (secondary);
+        GList* children = gnc_account_get_descendants (account);
+        GList* child;
 
-                for (child = children; child; child = child->next)
-                {
-                    if (account == child->data)
-                    {
-                        balance = gnc_numeric_add_fixed (balance, xaccSplitGetAmount (secondary));
-                        break;
-                    }
-                }
-            }
-            else
-            {
-                if (account == xaccSplitGetAccount (secondary))
-                    balance = gnc_numeric_add_fixed (balance, xaccSplitGetAmount (secondary));
-            }
-        }
-        virt_loc.vcell_loc.virt_row += i;
-    }
-
-    if (subaccounts)
+        for (child = children; child; child = child->next)
+            balance = gnc_numeric_add_fixed (balance,
+                                             get_account_balance_after_trans (child->data,
+                                                                              trans));
         g_list_free (children);
+    }
 
     return balance;
 }
@@ -161,6 +161,12 @@ gboolean gnc_split_register_find_split (SplitRegister *reg,
 void gnc_split_register_show_trans (SplitRegister *reg,
                                     VirtualCellLocation start_loc);
 
+/** Whether the split rows of the transaction located at vcell_loc are
+ * loaded. The register only loads those of the transactions near the
+ * cursor; see gnc_split_register_load(). */
+gboolean gnc_split_register_trans_splits_loaded (SplitRegister *reg,
+        VirtualCellLocation vcell_loc);
+
 /** Set the visibility of the split rows belonging to a transaction located at
  * vcell_loc.
  *
@@ -312,6 +312,18 @@ gnc_split_register_show_trans (SplitRegister *reg,
     gnc_table_show_range (reg->table, start_loc, end_loc);
 }
 
+gboolean
+gnc_split_register_trans_splits_loaded (SplitRegister *reg,
+                                        VirtualCellLocation vcell_loc)
+{
+    if (!gnc_split_register_get_trans_split (reg, vcell_loc, &vcell_loc))
+        return FALSE;
+    vcell_loc.virt_row++;
+
+    return gnc_split_register_get_cursor_class (reg, vcell_loc) ==
+           CURSOR_CLASS_SPLIT;
+}
+
 void
 gnc_split_register_set_trans_visible (SplitRegister *reg,
                                       VirtualCellLocation vcell_loc,
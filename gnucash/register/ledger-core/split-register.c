@@ -217,6 +217,28 @@ gnc_split_register_expand_current_trans (SplitRegister* reg, gboolean expand)
     if (! (expand ^ info->trans_expanded))
         return;
 
+    /* Reload around the current transaction to get its split rows; the
+     * load expands it. */
+    if (expand &&
+        !gnc_split_register_trans_splits_loaded (reg,
+                                                 reg->table->current_cursor_loc.vcell_loc))
+    {
+        info->trans_expanded = TRUE;
+        gnc_split_register_redraw (reg);
+
+        if (!gnc_split_register_trans_splits_loaded (reg,
+                                                     reg->table->current_cursor_loc.vcell_loc))
+        {
+            PWARN ("Couldn't load the split rows of the current transaction");
+            info->trans_expanded = FALSE;
+            return;
+        }
+
+        gnc_split_register_show_trans (reg,
+                                       reg->table->current_cursor_loc.vcell_loc);
+        return;
+    }
+
     if (!expand)
     {
         virt_loc = reg->table->current_cursor_loc;
@@ -324,12 +346,15 @@ gnc_split_register_get_split_virt_loc (SplitRegister* reg, Split* split,
                                        VirtualCellLocation* vcell_loc)
 {
     Table* table;
+    Transaction* trans;
+    VirtualCellLocation trans_loc = { -1, -1 };
     int v_row;
     int v_col;
 
     if (!reg || !split) return FALSE;
 
     table = reg->table;
+    trans = xaccSplitGetParent (split);
 
     /* go backwards because typically you search for splits at the end
      * and because we find split rows before transaction rows. */
@@ -354,9 +379,23 @@ gnc_split_register_get_split_virt_loc (SplitRegister* reg, Split* split,
 
                 return TRUE;
             }
+
+            /* The split rows of transactions away from the cursor aren't
+             * loaded, so fall back on the transaction's row. */
+            if (trans_loc.virt_row < 0 && xaccSplitGetParent (s) == trans &&
+                gnc_split_register_get_cursor_class (reg, vc_loc) ==
+                CURSOR_CLASS_TRANS &&
+                !gnc_split_register_trans_splits_loaded (reg, vc_loc))
+                trans_loc = vc_loc;
         }
 
-    return FALSE;
+    if (trans_loc.virt_row < 0)
+        return FALSE;
+
+    if (vcell_loc)
+        *vcell_loc = trans_loc;
+
+    return TRUE;
 }
 
 gboolean
@@ -27,6 +27,7 @@
 #include <TransLog.h>
 
 extern void test_suite_split_register_copy_ops();
+extern void test_suite_split_register();
 
 int
 main (int   argc,
@@ -41,6 +42,7 @@ main (int   argc,
     xaccLogDisable();
 
     test_suite_split_register_copy_ops();
+    test_suite_split_register();
 
     return g_test_run( );
 }
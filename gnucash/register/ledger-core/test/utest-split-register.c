@@ -0,0 +1,383 @@
+/********************************************************************
+ * utest-split-register.c: GLib g_test test suite for loading the   *
+ * split register.                                                  *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, you can retrieve it from        *
+ * https://www.gnu.org/licenses/old-licenses/gpl-2.0.html            *
+ * or contact:                                                      *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+#include <config.h>
+#include <glib.h>
+#include <unittest-support.h>
+/* Add specific headers for this class */
+#include <cashobjects.h>
+#include <gnc-session.h>
+#include <gnc-ui-util.h>
+#include <gnucash-register.h>
+#include "split-register.h"
+#include "split-register-p.h"
+
+static const gchar *suitename = "/register/ledger-core/split-register";
+void test_suite_split_register ( void );
+
+#define NUM_TXNS 3
+
+typedef struct
+{
+    QofBook *book;
+    gnc_commodity *curr;
+    Account *bank;
+    Account *expense;
+    Account *fees;
+
+    /* Each has a split in the bank account; txn[1] has a third split. */
+    Transaction *txn[NUM_TXNS];
+    Split *bank_split[NUM_TXNS];
+
+    SplitRegister *reg;
+} Fixture;
+
+static Account*
+make_account (Fixture *fixture, Account *root, const char *name,
+              GNCAccountType type)
+{
+    Account *acc = xaccMallocAccount (fixture->book);
+
+    xaccAccountBeginEdit (acc);
+    xaccAccountSetName (acc, name);
+    xaccAccountSetType (acc, type);
+    xaccAccountSetCommodity (acc, fixture->curr);
+    xaccAccountCommitEdit (acc);
+    gnc_account_append_child (root, acc);
+    return acc;
+}
+
+static Split*
+add_split (Fixture *fixture, Transaction *txn, Account *acc, gint64 cents)
+{
+    Split *split = xaccMallocSplit (fixture->book);
+    gnc_numeric amount = gnc_numeric_create (cents, 100);
+
+    xaccSplitSetParent (split, txn);
+    xaccSplitSetAccount (split, acc);
+    xaccSplitSetAmount (split, amount);
+    xaccSplitSetValue (split, amount);
+    return split;
+}
+
+static void
+setup ( Fixture *fixture, gconstpointer pData )
+{
+    static const gint64 bank_cents[NUM_TXNS] = { 10000, -3000, 5000 };
+    Account *root;
+    int i;
+
+    fixture->book = gnc_get_current_book ();
+    fixture->curr = gnc_commodity_new (fixture->book, "Gnu Rand", "CURRENCY",
+                                       "GNR", "", 100);
+    gnc_commodity_table_insert (gnc_commodity_table_get_table (fixture->book),
+                                fixture->curr);
+
+    root = gnc_account_create_root (fixture->book);
+    fixture->bank = make_account (fixture, root, "Bank", ACCT_TYPE_BANK);
+    fixture->expense = make_account (fixture, root, "Expense",
+                                     ACCT_TYPE_EXPENSE);
+    fixture->fees = make_account (fixture, root, "Fees", ACCT_TYPE_EXPENSE);
+
+    for (i = 0; i < NUM_TXNS; i++)
+    {
+        Transaction *txn = xaccMallocTransaction (fixture->book);
+
+        xaccTransBeginEdit (txn);
+        xaccTransSetCurrency (txn, fixture->curr);
+        xaccTransSetDatePostedSecsNormalized (txn,
+                                              gnc_dmy2time64_neutral (i + 1, 1, 2020));
+        fixture->bank_split[i] = add_split (fixture, txn, fixture->bank,
+                                            bank_cents[i]);
+        if (i == 1)
+        {
+            add_split (fixture, txn, fixture->expense, 2000);
+            add_split (fixture, txn, fixture->fees, 1000);
+        }
+        else
+            add_split (fixture, txn, fixture->expense, -bank_cents[i]);
+        xaccTransCommitEdit (txn);
+        fixture->txn[i] = txn;
+    }
+
+    fixture->reg = NULL;
+}
+
+static void
+teardown ( Fixture *fixture, gconstpointer pData )
+{
+    if (fixture->reg)
+        gnc_split_register_destroy (fixture->reg);
+    gnc_clear_current_session ();
+}
+
+/* A transaction from the bank account to the expense account. */
+static Transaction*
+add_txn (Fixture *fixture, time64 date, gint64 cents)
+{
+    Transaction *txn = xaccMallocTransaction (fixture->book);
+
+    xaccTransBeginEdit (txn);
+    xaccTransSetCurrency (txn, fixture->curr);
+    xaccTransSetDatePostedSecsNormalized (txn, date);
+    add_split (fixture, txn, fixture->bank, cents);
+    add_split (fixture, txn, fixture->expense, -cents);
+    xaccTransCommitEdit (txn);
+    return txn;
+}
+
+/* Load the splits of slist with the cursor on txn. The first pass of a
+ * load fills the quickfill cells and sizes the doclink glyphs, which
+ * needs a display, so the register is made to look loaded already. */
+static void
+load_splits_at (Fixture *fixture, GList *slist, Transaction *txn)
+{
+    SRInfo *info = gnc_split_register_get_info (fixture->reg);
+    Split *split = xaccTransFindSplitByAccount (txn, fixture->bank);
+
+    info->first_pass = FALSE;
+    info->cursor_hint_trans = txn;
+    info->cursor_hint_split = split;
+    info->cursor_hint_trans_split = split;
+    info->cursor_hint_cursor_class = CURSOR_CLASS_TRANS;
+
+    gnc_split_register_load (fixture->reg, slist, fixture->bank);
+}
+
+/* Load the bank account's register with the cursor on txn. */
+static void
+load_at (Fixture *fixture, Transaction *txn)
+{
+    load_splits_at (fixture, xaccAccountGetSplitList (fixture->bank), txn);
+}
+
+/* The row of txn's leading cursor, or -1 if it isn't in the register. */
+static int
+find_trans_row (SplitRegister *reg, Transaction *txn)
+{
+    VirtualCellLocation vcell_loc = { 1, 0 };
+
+    for (; vcell_loc.virt_row < reg->table->num_virt_rows; vcell_loc.virt_row++)
+    {
+        if (gnc_split_register_get_cursor_class (reg, vcell_loc) !=
+            CURSOR_CLASS_TRANS)
+            continue;
+
+        if (xaccSplitGetParent (gnc_split_register_get_split (reg, vcell_loc)) == txn)
+            return vcell_loc.virt_row;
+    }
+    return -1;
+}
+
+/* The number of split rows, the empty one included, loaded below txn. */
+static int
+count_split_rows (SplitRegister *reg, Transaction *txn)
+{
+    VirtualCellLocation vcell_loc = { find_trans_row (reg, txn), 0 };
+    int count = 0;
+
+    g_assert_cmpint (vcell_loc.virt_row, >, 0);
+
+    for (vcell_loc.virt_row++; vcell_loc.virt_row < reg->table->num_virt_rows;
+         vcell_loc.virt_row++)
+    {
+        if (gnc_split_register_get_cursor_class (reg, vcell_loc) !=
+            CURSOR_CLASS_SPLIT)
+            break;
+        count++;
+    }
+    return count;
+}
+
+static void
+test_ledger_loads_current_trans_splits ( Fixture *fixture, gconstpointer pData )
+{
+    SRInfo *info;
+    int i;
+
+    fixture->reg = gnc_split_register_new (BANK_REGISTER, REG_STYLE_LEDGER,
+                                           FALSE, FALSE, FALSE);
+    info = gnc_split_register_get_info (fixture->reg);
+
+    load_at (fixture, fixture->txn[1]);
+    g_assert_cmpint (count_split_rows (fixture->reg, fixture->txn[0]), ==, 0);
+    g_assert_cmpint (count_split_rows (fixture->reg, fixture->txn[1]), ==, 4);
+    g_assert_cmpint (count_split_rows (fixture->reg, fixture->txn[2]), ==, 0);
+    g_assert_true (gnc_split_register_get_current_trans (fixture->reg) ==
+                   fixture->txn[1]);
+
+    /* Moving on and reloading drops the rows of the old transaction. */
+    load_at (fixture, fixture->txn[2]);
+    g_assert_cmpint (count_split_rows (fixture->reg, fixture->txn[1]), ==, 0);
+    g_assert_cmpint (count_split_rows (fixture->reg, fixture->txn[2]), ==, 3);
+    g_assert_false (info->trans_expanded);
+
+    /* An expanded transaction stays expanded. */
+    info->trans_expanded = TRUE;
+    load_at (fixture, fixture->txn[0]);
+    g_assert_cmpint (count_split_rows (fixture->reg, fixture->txn[0]), ==, 3);
+    g_assert_cmpint (count_split_rows (fixture->reg, fixture->txn[2]), ==, 0);
+    g_assert_true (info->trans_expanded);
+    info->trans_expanded = FALSE;
+
+    /* The pending transaction keeps its rows wherever the cursor is. */
+    xaccTransBeginEdit (fixture->txn[2]);
+    info->pending_trans_guid = *xaccTransGetGUID (fixture->txn[2]);
+    load_at (fixture, fixture->txn[0]);
+    g_assert_cmpint (count_split_rows (fixture->reg, fixture->txn[0]), ==, 3);
+    g_assert_cmpint (count_split_rows (fixture->reg, fixture->txn[1]), ==, 0);
+    g_assert_cmpint (count_split_rows (fixture->reg, fixture->txn[2]), ==, 3);
+    info->pending_trans_guid = *guid_null ();
+    xaccTransCommitEdit (fixture->txn[2]);
+
+    for (i = 0; i < NUM_TXNS; i++)
+        g_assert_cmpint (find_trans_row (fixture->reg, fixture->txn[i]), >, 0);
+}
+
+/* The auto-split and journal styles load the split rows of the
+ * transactions near the cursor, and the jump to a split elsewhere goes to
+ * its transaction's row. */
+static void
+test_window_loads_nearby_splits ( Fixture *fixture, gconstpointer pData )
+{
+    Transaction *last = NULL;
+    VirtualCellLocation vcell_loc;
+    int i;
+
+    /* More transactions than the window around the cursor, after the
+     * first three. */
+    for (i = 0; i < 300; i++)
+        last = add_txn (fixture, gnc_dmy2time64_neutral (1, 2, 2020) + i * 86400,
+                        100);
+
+    fixture->reg = gnc_split_register_new (BANK_REGISTER,
+                                           GPOINTER_TO_INT (pData),
+                                           FALSE, FALSE, FALSE);
+
+    load_at (fixture, fixture->txn[1]);
+    g_assert_cmpint (count_split_rows (fixture->reg, fixture->txn[0]), ==, 3);
+    g_assert_cmpint (count_split_rows (fixture->reg, fixture->txn[1]), ==, 4);
+    g_assert_cmpint (count_split_rows (fixture->reg, fixture->txn[2]), ==, 3);
+    g_assert_cmpint (count_split_rows (fixture->reg, last), ==, 0);
+    g_assert_true (gnc_split_register_get_current_trans (fixture->reg) ==
+                   fixture->txn[1]);
+
+    vcell_loc.virt_row = find_trans_row (fixture->reg, last);
+    vcell_loc.virt_col = 0;
+    g_assert_false (gnc_split_register_trans_splits_loaded (fixture->reg,
+                                                            vcell_loc));
+    g_assert_true (gnc_split_register_get_split_virt_loc (
+                       fixture->reg,
+                       xaccTransFindSplitByAccount (last, fixture->expense),
+                       &vcell_loc));
+    g_assert_cmpint (vcell_loc.virt_row, ==, find_trans_row (fixture->reg, last));
+
+    /* Reloading around the last one moves the window. */
+    load_at (fixture, last);
+    g_assert_cmpint (count_split_rows (fixture->reg, fixture->txn[0]), ==, 0);
+    g_assert_cmpint (count_split_rows (fixture->reg, last), ==, 3);
+    vcell_loc.virt_row = find_trans_row (fixture->reg, last);
+    g_assert_true (gnc_split_register_trans_splits_loaded (fixture->reg,
+                                                           vcell_loc));
+
+    for (i = 0; i < NUM_TXNS; i++)
+        g_assert_cmpint (find_trans_row (fixture->reg, fixture->txn[i]), >, 0);
+}
+
+/* The running balance is the account's, subaccounts included, after the
+ * transaction on each leading row, whichever rows are loaded. */
+static void
+test_rbaln ( Fixture *fixture, gconstpointer pData )
+{
+    static const gint64 rbaln_cents[NUM_TXNS] = { 11000, 8000, 13000 };
+    Account *savings = make_account (fixture, fixture->bank, "Savings",
+                                     ACCT_TYPE_BANK);
+    Transaction *deposit = xaccMallocTransaction (fixture->book);
+    GNCPrintAmountInfo print_info;
+    VirtualLocation virt_loc;
+    GList *slist;
+    int i;
+
+    /* A deposit in the subaccount before all of the bank's. */
+    xaccTransBeginEdit (deposit);
+    xaccTransSetCurrency (deposit, fixture->curr);
+    xaccTransSetDatePostedSecsNormalized (deposit,
+                                          gnc_dmy2time64_neutral (15, 12, 2019));
+    add_split (fixture, deposit, savings, 1000);
+    add_split (fixture, deposit, fixture->expense, -1000);
+    xaccTransCommitEdit (deposit);
+
+    fixture->reg = gnc_split_register_new (SEARCH_LEDGER, REG_STYLE_JOURNAL,
+                                           FALSE, FALSE, FALSE);
+    load_at (fixture, fixture->txn[0]);
+    print_info = gnc_account_print_info (fixture->bank, FALSE);
+
+    virt_loc.vcell_loc.virt_col = 0;
+    virt_loc.phys_row_offset = 0;
+    virt_loc.phys_col_offset = 7;
+
+    for (i = 0; i < NUM_TXNS; i++)
+    {
+        gchar *expected = g_strdup (
+            xaccPrintAmount (gnc_numeric_create (rbaln_cents[i], 100),
+                             print_info));
+
+        virt_loc.vcell_loc.virt_row = find_trans_row (fixture->reg,
+                                                      fixture->txn[i]);
+        g_assert_cmpstr (gnc_table_get_cell_name (fixture->reg->table, virt_loc),
+                         ==, RBALN_CELL);
+        g_assert_cmpstr (gnc_table_get_entry (fixture->reg->table, virt_loc),
+                         ==, expected);
+        g_free (expected);
+    }
+
+    /* Without the first transaction in the register, the second still
+     * has the account's balance after it. */
+    slist = g_list_prepend (NULL, fixture->bank_split[2]);
+    slist = g_list_prepend (slist, fixture->bank_split[1]);
+    load_splits_at (fixture, slist, fixture->txn[1]);
+    g_list_free (slist);
+
+    g_assert_cmpint (find_trans_row (fixture->reg, fixture->txn[0]), <, 0);
+    virt_loc.vcell_loc.virt_row = find_trans_row (fixture->reg, fixture->txn[1]);
+    {
+        gchar *expected = g_strdup (
+            xaccPrintAmount (gnc_numeric_create (rbaln_cents[1], 100),
+                             print_info));
+        g_assert_cmpstr (gnc_table_get_entry (fixture->reg->table, virt_loc),
+                         ==, expected);
+        g_free (expected);
+    }
+}
+
+void
+test_suite_split_register (void)
+{
+    cashobjects_register ();
+    gnucash_register_add_cell_types ();
+
+    GNC_TEST_ADD (suitename, "ledger loads current trans splits", Fixture, NULL, setup, test_ledger_loads_current_trans_splits, teardown);
+    GNC_TEST_ADD (suitename, "journal loads nearby splits", Fixture, GINT_TO_POINTER (REG_STYLE_JOURNAL), setup, test_window_loads_nearby_splits, teardown);
+    GNC_TEST_ADD (suitename, "auto-split loads nearby splits", Fixture, GINT_TO_POINTER (REG_STYLE_AUTO_LEDGER), setup, test_window_loads_nearby_splits, teardown);
+    GNC_TEST_ADD (suitename, "running balance", Fixture, NULL, setup, test_rbaln, teardown);
+}
@@ -207,6 +207,39 @@ gnc_reports_get_global(void)
     return reports;
 }
 
+/* Reports can run reports (e.g. the multicolumn report), so count how
+ * deep we are and only clear a cancel request when the outermost one
+ * starts. */
+static gint report_run_depth = 0;
+static gboolean report_cancelled = FALSE;
+
+void
+gnc_report_cancel (void)
+{
+    if (report_run_depth > 0)
+        report_cancelled = TRUE;
+}
+
+gboolean
+gnc_report_cancelled (void)
+{
+    return report_cancelled;
+}
+
+void
+gnc_report_run_begin (void)
+{
+    if (report_run_depth++ == 0)
+        report_cancelled = FALSE;
+}
+
+void
+gnc_report_run_end (void)
+{
+    g_return_if_fail (report_run_depth > 0);
+    report_run_depth--;
+}
+
 gboolean
 gnc_run_report_with_error_handling (gint report_id, gchar ** data, gchar **errmsg)
 {
@@ -217,10 +250,18 @@ gnc_run_report_with_error_handling (gint report_id, gchar ** data, gchar **errms
     g_return_val_if_fail (errmsg, FALSE);
     g_return_val_if_fail (!scm_is_false (report), FALSE);
 
+    QOF_TRACE_SCOPE ("report-run");
     res = scm_call_1 (scm_c_eval_string ("gnc:render-report"), report);
     html = scm_car (res);
     captured_error = scm_cadr (res);
 
+    if (report_cancelled)
+    {
+        *errmsg = g_strdup ("Report cancelled");
+        *data = NULL;
+        PINFO ("Report %d cancelled", report_id);
+        return FALSE;
+    }
     if (!scm_is_false (html))
     {
         *data = gnc_scm_to_utf8_string (html);
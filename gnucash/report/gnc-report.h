@@ -50,6 +50,20 @@ gboolean gnc_run_report_id_string_with_error_handling(const char* id_string,
                                                       char** data,
                                                       gchar** errmsg);
 
+/** Ask the report being run to stop. The renderer checks at its next
+ *  progress update and gnc_run_report_with_error_handling() then
+ *  returns FALSE. Does nothing if no report is running. */
+void gnc_report_cancel(void);
+
+/** @return TRUE if the running report, or the last one run, was
+ *  cancelled. */
+gboolean gnc_report_cancelled(void);
+
+/** Bracket the rendering of a report; gnc:render-report calls these.
+ *  Starting the outermost report clears an earlier cancel request. */
+void gnc_report_run_begin(void);
+void gnc_report_run_end(void);
+
 /**
  * @param report The SCM version of the report.
  * @return a caller-owned copy of the name of the report, or NULL if report
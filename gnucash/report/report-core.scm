@@ -757,7 +757,10 @@ not found.")))
 ;; where captured-error is the error string.
 (define (gnc:render-report report)
   (define (get-report) (gnc:report-render-html report #t))
-  (gnc:apply-with-error-handling get-report '()))
+  (gnc-report-run-begin)
+  (let ((res (gnc:apply-with-error-handling get-report '())))
+    (gnc-report-run-end)
+    res))
 
 ;; "thunk" should take the report-type and the report template record
 (define (gnc:report-templates-for-each thunk)
@@ -19,6 +19,10 @@
 
 (define-module (gnucash report report-utilities))
 
+(eval-when (compile load eval expand)
+  (load-extension "libgnc-report" "scm_init_sw_report_module"))
+
+(use-modules (sw_report))
 (use-modules (srfi srfi-1))
 (use-modules (srfi srfi-13))
 (use-modules (srfi srfi-26))
@@ -651,10 +655,17 @@
                                          (G_ report-name)))
                             0))
 
+;; showing progress runs the main loop, which is when the user can ask
+;; for the report to stop; unwind out of the renderer if they did.
+(define (check-report-cancelled)
+  (when (gnc-report-cancelled)
+    (throw 'report-cancelled)))
+
 (define (gnc:report-percent-done percent)
   (if (> percent 100)
       (gnc:warn "report more than 100% finished. " percent))
-  (gnc-window-show-progress "" percent))
+  (gnc-window-show-progress "" percent)
+  (check-report-cancelled))
 
 (define-public gnc:pulse-progress-bar
   (let ((pulse-idx 0))
@@ -662,7 +673,8 @@
       (set! pulse-idx (1+ pulse-idx))
       (when (= pulse-idx 1000)
         (set! pulse-idx 0)
-        (gnc-window-show-progress "" 105)))))
+        (gnc-window-show-progress "" 105)
+        (check-report-cancelled)))))
 
 (define (gnc:report-finished)
   (gnc-window-show-progress "" -1))
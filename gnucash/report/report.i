@@ -36,6 +36,10 @@ SCM scm_init_sw_report_module (void);
 
 SCM gnc_report_find(gint id);
 gint gnc_report_add(SCM report);
+void gnc_report_cancel(void);
+gboolean gnc_report_cancelled(void);
+void gnc_report_run_begin(void);
+void gnc_report_run_end(void);
 
 %newobject gnc_get_default_report_font_family;
 gchar* gnc_get_default_report_font_family();
@@ -18,6 +18,7 @@
   (test-report-template-getters)
   (test-make-report)
   (test-report)
+  (test-report-cancel)
   (test-end "Testing/Temporary/test-report"))
 
 (define test4-guid "54c2fc051af64a08ba2334c2e9179e24")
@@ -232,3 +233,32 @@
     (test-assert "gnc:report-serialize = string"
       (string?
        (gnc:report-serialize report)))))
+
+(define (test-report-cancel)
+  (define cancel? #t)
+  (define test-uuid "cancel-report-guid")
+  (gnc:define-report
+   'version 1
+   'name "cancel report"
+   'report-guid test-uuid
+   'options-generator gnc:new-options
+   'renderer (lambda (obj)
+               ;; as if Stop were pressed while the progress bar updates
+               (when cancel? (gnc-report-cancel))
+               (gnc:report-percent-done 50)
+               "finished"))
+  (let ((report (gnc:make-report test-uuid)))
+    (test-begin "test-report-cancel")
+    (gnc-report-cancel)
+    (test-assert "cancelling with no report running does nothing"
+      (not (gnc-report-cancelled)))
+    (let ((res (gnc:render-report (gnc-report-find report))))
+      (test-assert "a cancelled report has no html" (not (car res)))
+      (test-assert "the cancel request is kept" (gnc-report-cancelled)))
+    (set! cancel? #f)
+    (let ((res (gnc:render-report (gnc-report-find report))))
+      (test-equal "the next run clears it and finishes"
+        "finished"
+        (car res))
+      (test-assert "not cancelled" (not (gnc-report-cancelled))))
+    (test-end "test-report-cancel")))
@@ -27,6 +27,7 @@
 #include "gnc-prefs-utils.h"
 #include "gnc-prefs.h"
 #include "xml/gnc-backend-xml.h"
+#include "TransLog.h"
 
 static QofLogModule log_module = G_LOG_DOMAIN;
 
@@ -36,6 +37,7 @@ static QofLogModule log_module = G_LOG_DOMAIN;
 #define GNC_PREF_RETAIN_TYPE_DAYS    "retain-type-days"
 #define GNC_PREF_RETAIN_TYPE_FOREVER "retain-type-forever"
 #define GNC_PREF_RETAIN_DAYS         "retain-days"
+#define GNC_PREF_TRANSLOG_SYNC       "translog-sync"
 
 /***************************************************************
  * Initialization                                              *
@@ -78,6 +80,26 @@ file_compression_changed_cb(gpointer gsettings, gchar *key, gpointer user_data)
     }
 }
 
+static void
+translog_sync_changed_cb(gpointer gsettings, gchar *key, gpointer user_data)
+{
+    if (gnc_prefs_is_set_up())
+    {
+        gchar *sync = gnc_prefs_get_string (GNC_PREFS_GROUP_GENERAL, GNC_PREF_TRANSLOG_SYNC);
+        XaccLogSyncPolicy policy = XACC_LOG_SYNC_NONE;
+
+        if (g_strcmp0 (sync, "batch") == 0)
+            policy = XACC_LOG_SYNC_BATCH;
+        else if (g_strcmp0 (sync, "commit") == 0)
+            policy = XACC_LOG_SYNC_COMMIT;
+        else if (sync && *sync && g_strcmp0 (sync, "none") != 0)
+            PWARN("unknown transaction log sync policy '%s', assuming 'none'", sync);
+
+        xaccLogSetSyncPolicy (policy);
+        g_free (sync);
+    }
+}
+
 
 void gnc_prefs_init (void)
 {
@@ -89,6 +111,7 @@ void gnc_prefs_init (void)
     file_retain_changed_cb (NULL, NULL, NULL);
     file_retain_type_changed_cb (NULL, NULL, NULL);
     file_compression_changed_cb (NULL, NULL, NULL);
+    translog_sync_changed_cb (NULL, NULL, NULL);
 
     /* Check for invalid retain_type (days)/retain_days (0) combo.
      * This can happen either because a user changed the preferences
@@ -122,6 +145,8 @@ void gnc_prefs_init (void)
                            file_retain_type_changed_cb, NULL);
     gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_FILE_COMPRESSION,
                            file_compression_changed_cb, NULL);
+    gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_TRANSLOG_SYNC,
+                           translog_sync_changed_cb, NULL);
 
 }
 
@@ -139,4 +164,6 @@ gnc_prefs_remove_registered (void)
                            file_retain_type_changed_cb, NULL);
     gnc_prefs_remove_cb_by_func (GNC_PREFS_GROUP_GENERAL, GNC_PREF_FILE_COMPRESSION,
                            file_compression_changed_cb, NULL);
+    gnc_prefs_remove_cb_by_func (GNC_PREFS_GROUP_GENERAL, GNC_PREF_TRANSLOG_SYNC,
+                           translog_sync_changed_cb, NULL);
 }
@@ -0,0 +1,41 @@
+/********************************************************************
+ * bench-backend-xml.cpp: Load and save benchmarks for the XML       *
+ * backend.                                                         *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+#include <config.h>
+
+#include <gnc-prefs.h>
+#include <bench-backend.hpp>
+
+#include "../gnc-backend-xml.h"
+
+#define GNC_LIB_NAME "gncmod-backend-xml"
+#define GNC_LIB_REL_PATH "xml"
+
+int
+main (int argc, char** argv)
+{
+    if (!bench_backend_init (GNC_LIB_REL_PATH, GNC_LIB_NAME))
+        return 1;
+    /* Don't accumulate a backup file for every save. */
+    gnc_prefs_set_file_retention_policy (XML_RETAIN_NONE);
+    return bench_backend_run (argc, argv, "xml", "xml://");
+}
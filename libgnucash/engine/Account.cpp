@@ -2282,6 +2282,7 @@ xaccAccountRecomputeBalance (Account * acc)
     if (qof_instance_get_destroying(acc)) return;
     if (qof_book_shutting_down(qof_instance_get_book(acc))) return;
 
+    QOF_TRACE_SCOPE ("recompute-balance");
     balance            = priv->starting_balance;
     noclosing_balance  = priv->starting_noclosing_balance;
     cleared_balance    = priv->starting_cleared_balance;
@@ -2311,11 +2312,8 @@ xaccAccountRecomputeBalance (Account * acc)
         if (!(xaccTransGetIsClosingTxn (split->parent)))
             noclosing_balance = gnc_numeric_add_fixed(noclosing_balance, amt);
 
-        split->balance = balance;
-        split->noclosing_balance = noclosing_balance;
-        split->cleared_balance = cleared_balance;
-        split->reconciled_balance = reconciled_balance;
-
+        xaccSplitSetRunningBalances (split, balance, noclosing_balance,
+                                     cleared_balance, reconciled_balance);
     }
 
     priv->balance = balance;
@@ -72,6 +72,9 @@ static QofLogModule log_module = GNC_MOD_ENGINE;
 #define GNC_SX_DEBIT_NUMERIC         "debit-numeric"
 #define GNC_SX_SHARES                "shares"
 
+/* All of a split's running balances are gnc_numeric_zero(). */
+#define SPLIT_ALL_UNIT_ZERO ((1 << SPLIT_NUM_BALANCES) - 1)
+
 enum
 {
     PROP_0,
@@ -120,10 +123,10 @@ gnc_split_init(Split* split)
 
     split->date_reconciled  = 0;
 
-    split->balance             = gnc_numeric_zero();
-    split->cleared_balance     = gnc_numeric_zero();
-    split->reconciled_balance  = gnc_numeric_zero();
-    split->noclosing_balance   = gnc_numeric_zero();
+    memset (split->balance_num, 0, sizeof (split->balance_num));
+    split->balance_denom = 1;
+    split->balance_unit_zero = SPLIT_ALL_UNIT_ZERO;
+    split->wide_balance = NULL;
 
     split->gains = GAINS_STATUS_UNKNOWN;
     split->gains_split = NULL;
@@ -138,6 +141,9 @@ gnc_split_dispose(GObject *splitp)
 static void
 gnc_split_finalize(GObject* splitp)
 {
+    Split *split = GNC_SPLIT(splitp);
+    g_free (split->wide_balance);
+    split->wide_balance = NULL;
     G_OBJECT_CLASS(gnc_split_parent_class)->finalize(splitp);
 }
 /* Note that g_value_set_object() refs the object, as does
@@ -512,10 +518,11 @@ xaccSplitReinit(Split * split)
 
     split->date_reconciled  = 0;
 
-    split->balance             = gnc_numeric_zero();
-    split->cleared_balance     = gnc_numeric_zero();
-    split->reconciled_balance  = gnc_numeric_zero();
-    split->noclosing_balance   = gnc_numeric_zero();
+    memset (split->balance_num, 0, sizeof (split->balance_num));
+    split->balance_denom = 1;
+    split->balance_unit_zero = SPLIT_ALL_UNIT_ZERO;
+    g_free (split->wide_balance);
+    split->wide_balance = NULL;
 
     qof_instance_set_idata(split, 0);
 
@@ -597,10 +604,11 @@ xaccSplitCloneNoKvp (const Split *s)
     split->date_reconciled     = s->date_reconciled;
     split->value               = s->value;
     split->amount              = s->amount;
-    split->balance             = s->balance;
-    split->cleared_balance     = s->cleared_balance;
-    split->reconciled_balance  = s->reconciled_balance;
-    split->noclosing_balance   = s->noclosing_balance;
+    xaccSplitSetRunningBalances
+        (split, xaccSplitGetRunningBalance (s, SPLIT_BALANCE),
+         xaccSplitGetRunningBalance (s, SPLIT_NOCLOSING_BALANCE),
+         xaccSplitGetRunningBalance (s, SPLIT_CLEARED_BALANCE),
+         xaccSplitGetRunningBalance (s, SPLIT_RECONCILED_BALANCE));
 
     split->gains = GAINS_STATUS_UNKNOWN;
     split->gains_split = NULL;
@@ -681,11 +689,14 @@ xaccSplitDump (const Split *split, const char *tag)
 
     printf("    Value:    %s\n", gnc_numeric_to_string(split->value));
     printf("    Amount:   %s\n", gnc_numeric_to_string(split->amount));
-    printf("    Balance:  %s\n", gnc_numeric_to_string(split->balance));
-    printf("    CBalance: %s\n", gnc_numeric_to_string(split->cleared_balance));
+    printf("    Balance:  %s\n",
+           gnc_numeric_to_string(xaccSplitGetBalance(split)));
+    printf("    CBalance: %s\n",
+           gnc_numeric_to_string(xaccSplitGetClearedBalance(split)));
     printf("    RBalance: %s\n",
-           gnc_numeric_to_string(split->reconciled_balance));
-    printf("    NoClose:  %s\n", gnc_numeric_to_string(split->noclosing_balance));
+           gnc_numeric_to_string(xaccSplitGetReconciledBalance(split)));
+    printf("    NoClose:  %s\n",
+           gnc_numeric_to_string(xaccSplitGetNoclosingBalance(split)));
     printf("    idata:    %x\n", qof_instance_get_idata(split));
 }
 #endif
@@ -867,16 +878,20 @@ xaccSplitEqual(const Split *sa, const Split *sb,
 
     if (check_balances)
     {
-        if (!xaccSplitEqualCheckBal ("", sa->balance, sb->balance))
+        if (!xaccSplitEqualCheckBal ("", xaccSplitGetBalance (sa),
+                                     xaccSplitGetBalance (sb)))
             return FALSE;
-        if (!xaccSplitEqualCheckBal ("cleared ", sa->cleared_balance,
-                                     sb->cleared_balance))
+        if (!xaccSplitEqualCheckBal ("cleared ",
+                                     xaccSplitGetClearedBalance (sa),
+                                     xaccSplitGetClearedBalance (sb)))
             return FALSE;
-        if (!xaccSplitEqualCheckBal ("reconciled ", sa->reconciled_balance,
-                                     sb->reconciled_balance))
+        if (!xaccSplitEqualCheckBal ("reconciled ",
+                                     xaccSplitGetReconciledBalance (sa),
+                                     xaccSplitGetReconciledBalance (sb)))
             return FALSE;
-        if (!xaccSplitEqualCheckBal ("noclosing ", sa->noclosing_balance,
-                                     sb->noclosing_balance))
+        if (!xaccSplitEqualCheckBal ("noclosing ",
+                                     xaccSplitGetNoclosingBalance (sa),
+                                     xaccSplitGetNoclosingBalance (sb)))
             return FALSE;
     }
 
@@ -1284,28 +1299,162 @@ xaccSplitSetValue (Split *s, gnc_numeric amt)
 /********************************************************************\
 \********************************************************************/
 
+/* gnc_numeric_zero(), as new balances are, is remembered as such so
+ * that it keeps its denominator of 1 whatever the packed one is. */
+static inline gboolean
+split_balance_unit_zero (gnc_numeric val)
+{
+    return val.num == 0 && val.denom == 1;
+}
+
+/* Store vals as packed numerators if they share a denominator that
+ * fits in balance_denom, releasing any unpacked copy. */
+static gboolean
+split_pack_balances (Split *s, const gnc_numeric *vals)
+{
+    gint64 denom = 1;
+    gboolean have_denom = FALSE;
+    unsigned char unit_zero = 0;
+    int i;
+
+    for (i = 0; i < SPLIT_NUM_BALANCES; ++i)
+    {
+        if (split_balance_unit_zero (vals[i]))
+            unit_zero |= 1 << i;
+        else if (!have_denom)
+        {
+            denom = vals[i].denom;
+            have_denom = TRUE;
+        }
+        else if (vals[i].denom != denom)
+            return FALSE;
+    }
+    if (denom <= 0 || denom > G_MAXINT32)
+        return FALSE;
+
+    for (i = 0; i < SPLIT_NUM_BALANCES; ++i)
+        s->balance_num[i] = vals[i].num;
+    s->balance_denom = (gint32) denom;
+    s->balance_unit_zero = unit_zero;
+    g_free (s->wide_balance);
+    s->wide_balance = NULL;
+    return TRUE;
+}
+
+static void
+split_unpack_balances (Split *s)
+{
+    gnc_numeric *wide;
+    int i;
+
+    if (s->wide_balance)
+        return;
+    wide = g_new (gnc_numeric, SPLIT_NUM_BALANCES);
+    for (i = 0; i < SPLIT_NUM_BALANCES; ++i)
+        wide[i] = xaccSplitGetRunningBalance (s, i);
+    s->wide_balance = wide;
+    s->balance_denom = 0;
+}
+
+gnc_numeric
+xaccSplitGetRunningBalance (const Split *s, SplitBalanceType which)
+{
+    if (!s) return gnc_numeric_zero();
+    g_return_val_if_fail (which < SPLIT_NUM_BALANCES, gnc_numeric_zero());
+
+    if (s->wide_balance)
+        return s->wide_balance[which];
+    if (s->balance_unit_zero & (1 << which))
+        return gnc_numeric_zero();
+    return gnc_numeric_create (s->balance_num[which], s->balance_denom);
+}
+
+void
+xaccSplitSetRunningBalance (Split *s, SplitBalanceType which,
+                            gnc_numeric val)
+{
+    if (!s) return;
+    g_return_if_fail (which < SPLIT_NUM_BALANCES);
+
+    if (!s->wide_balance)
+    {
+        unsigned char bit = 1 << which;
+
+        if (split_balance_unit_zero (val))
+        {
+            s->balance_num[which] = 0;
+            s->balance_unit_zero |= bit;
+            return;
+        }
+        if (val.denom == s->balance_denom)
+        {
+            s->balance_num[which] = val.num;
+            s->balance_unit_zero &= ~bit;
+            return;
+        }
+        /* The others are all gnc_numeric_zero(), so val sets the
+         * denominator. */
+        if ((s->balance_unit_zero | bit) == SPLIT_ALL_UNIT_ZERO &&
+            val.denom > 0 && val.denom <= G_MAXINT32)
+        {
+            s->balance_num[which] = val.num;
+            s->balance_denom = (gint32) val.denom;
+            s->balance_unit_zero &= ~bit;
+            return;
+        }
+        split_unpack_balances (s);
+    }
+
+    s->wide_balance[which] = val;
+    split_pack_balances (s, s->wide_balance);
+}
+
+void
+xaccSplitSetRunningBalances (Split *s, gnc_numeric balance,
+                             gnc_numeric noclosing_balance,
+                             gnc_numeric cleared_balance,
+                             gnc_numeric reconciled_balance)
+{
+    gnc_numeric vals[SPLIT_NUM_BALANCES];
+
+    if (!s) return;
+
+    vals[SPLIT_BALANCE] = balance;
+    vals[SPLIT_NOCLOSING_BALANCE] = noclosing_balance;
+    vals[SPLIT_CLEARED_BALANCE] = cleared_balance;
+    vals[SPLIT_RECONCILED_BALANCE] = reconciled_balance;
+
+    if (split_pack_balances (s, vals))
+        return;
+
+    if (!s->wide_balance)
+        s->wide_balance = g_new (gnc_numeric, SPLIT_NUM_BALANCES);
+    memcpy (s->wide_balance, vals, sizeof (vals));
+    s->balance_denom = 0;
+}
+
 gnc_numeric
 xaccSplitGetBalance (const Split *s)
 {
-    return s ? s->balance : gnc_numeric_zero();
+    return xaccSplitGetRunningBalance (s, SPLIT_BALANCE);
 }
 
 gnc_numeric
 xaccSplitGetNoclosingBalance (const Split *s)
 {
-    return s ? s->noclosing_balance : gnc_numeric_zero();
+    return xaccSplitGetRunningBalance (s, SPLIT_NOCLOSING_BALANCE);
 }
 
 gnc_numeric
 xaccSplitGetClearedBalance (const Split *s)
 {
-    return s ? s->cleared_balance : gnc_numeric_zero();
+    return xaccSplitGetRunningBalance (s, SPLIT_CLEARED_BALANCE);
 }
 
 gnc_numeric
 xaccSplitGetReconciledBalance (const Split *s)
 {
-    return s ? s->reconciled_balance : gnc_numeric_zero();
+    return xaccSplitGetRunningBalance (s, SPLIT_RECONCILED_BALANCE);
 }
 
 void
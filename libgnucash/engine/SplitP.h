@@ -72,6 +72,16 @@ extern "C" {
 #define GAINS_STATUS_VDIRTY    (GAINS_STATUS_VALU_DIRTY)
 #define GAINS_STATUS_A_VDIRTY  (GAINS_STATUS_AMNT_DIRTY|GAINS_STATUS_VALU_DIRTY|GAINS_STATUS_LOT_DIRTY)
 
+/* Indexes of the running balances kept in each split. */
+typedef enum
+{
+    SPLIT_BALANCE,
+    SPLIT_NOCLOSING_BALANCE,
+    SPLIT_CLEARED_BALANCE,
+    SPLIT_RECONCILED_BALANCE,
+    SPLIT_NUM_BALANCES
+} SplitBalanceType;
+
 struct split_s
 {
     QofInstance inst;
@@ -107,6 +117,16 @@ struct split_s
      */
     unsigned char  gains;
 
+    /* One bit per running balance, set if it is gnc_numeric_zero()
+     * rather than zero over balance_denom. */
+    unsigned char  balance_unit_zero;
+
+    /* The denominator shared by the packed running balances below, or
+     * 0 if they are held unpacked in wide_balance. Sits in what would
+     * otherwise be padding.
+     */
+    gint32 balance_denom;
+
     /* 'gains_split' is a convenience pointer used to track down the
      * other end of a cap-gains transaction pair.  NULL if this split
      * doesn't involve cap gains.
@@ -127,11 +147,17 @@ struct split_s
     /* The various "balances" are the sum of all of the values of
      * all the splits in the account, up to and including this split.
      * These balances apply to a sorting order by date posted
-     * (not by date entered). */
-    gnc_numeric  balance;
-    gnc_numeric  noclosing_balance;
-    gnc_numeric  cleared_balance;
-    gnc_numeric  reconciled_balance;
+     * (not by date entered).
+     *
+     * Since they are sums of amounts in the account's commodity they
+     * nearly always share its SCU as denominator, so only the
+     * numerators are stored, over balance_denom. Balances that don't
+     * share a denominator fall back to a separately allocated array of
+     * gnc_numerics in wide_balance. Use xaccSplitGetRunningBalance() and
+     * xaccSplitSetRunningBalance() rather than accessing these directly.
+     */
+    gint64       balance_num[SPLIT_NUM_BALANCES];
+    gnc_numeric *wide_balance;
 };
 
 struct _SplitClass
@@ -164,6 +190,22 @@ void xaccSplitUnvoid(Split *split);
 void xaccSplitCommitEdit(Split *s);
 void xaccSplitRollbackEdit(Split *s);
 
+/* Get or set one of the split's running balances. These are private
+ * to the engine: the balances are computed by
+ * xaccAccountRecomputeBalance() and published through
+ * xaccSplitGetBalance() and friends. */
+gnc_numeric xaccSplitGetRunningBalance (const Split *s, SplitBalanceType which);
+void xaccSplitSetRunningBalance (Split *s, SplitBalanceType which,
+                                 gnc_numeric val);
+
+/* Set all of the split's running balances at once. Cheaper than four
+ * calls to xaccSplitSetRunningBalance() as the balances are only
+ * packed once. */
+void xaccSplitSetRunningBalances (Split *s, gnc_numeric balance,
+                                  gnc_numeric noclosing_balance,
+                                  gnc_numeric cleared_balance,
+                                  gnc_numeric reconciled_balance);
+
 /* Compute the value of a list of splits in the given currency,
  * excluding the skip_me split. */
 gnc_numeric xaccSplitsComputeValue (GList *splits, const Split * skip_me,
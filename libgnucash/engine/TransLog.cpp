@@ -0,0 +1,528 @@
+/********************************************************************\
+ * TransLog.c -- the transaction logger                             *
+ * Copyright (C) 1998 Linas Vepstas                                 *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+#include <config.h>
+#ifdef __MINGW32__
+#define __USE_MINGW_ANSI_STDIO 1
+#endif
+#include <errno.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <string.h>
+#ifdef G_OS_WIN32
+# include <io.h>
+#elif defined HAVE_UNISTD_H
+# include <unistd.h>
+#endif
+
+#include "Account.h"
+#include "Transaction.h"
+#include "TransactionP.h"
+#include "TransLog.h"
+#include "gnc-datetime.hpp"
+#include "qof.h"
+#ifdef _MSC_VER
+# define g_fopen fopen
+#endif
+
+#include <atomic>
+#include <charconv>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+static QofLogModule log_module = "gnc.translog";
+
+/*
+ * Some design philosophy that I think would be good to keep in mind:
+ * (0) Simplicity and foolproofness are the over-riding design points.
+ *     This is supposed to be a fail-safe safety net.   We don't want
+ *     our safety net to fail because of some whiz-bang shenanigans.
+ *
+ * (1) Try to keep the code simple.  Want to make it simple and obvious
+ *     that we are recording everything that we need to record.
+ *
+ * (2) Keep the printed format human readable, for the same reasons.
+ * (2.a) Keep the format, simple, flat, more or less unstructured,
+ *       record oriented.  This will help parsing by perl scripts.
+ *       No, using a perl script to analyze a file that's supposed to
+ *       be human readable is not a contradication in terms -- that's
+ *       exactly the point.
+ * (2.b) Use tabs as a human friendly field separator; its also a
+ *       character that does not (should not) appear naturally anywhere
+ *       in the data, as it serves no formatting purpose in the current
+ *       GUI design.  (hack alert -- this is not currently tested for
+ *       or enforced, so this is a very unsafe assumption. Maybe
+ *       urlencoding should be used.)
+ * (2.c) Don't print redundant information in a single record. This
+ *       would just confuse any potential user of this file.
+ * (2.d) Saving space, being compact is not a priority, I don't think.
+ *
+ * (3) There are no compatibility requirements from release to release.
+ *     Sounds OK to me to change the format of the output when needed.
+ *
+ * (-) print transaction start and end delimiters
+ * (-) print a unique transaction id as a handy label for anyone
+ *     who actually examines these logs.
+ *     The C address pointer to the transaction struct should be fine,
+ *     as it is simple and unique until the transaction is deleted ...
+ *     and we log deletions, so that's OK.  Just note that the id
+ *     for a deleted transaction might be recycled.
+ * (-) print the current timestamp, so that if it is known that a bug
+ *     occurred at a certain time, it can be located.
+ * (-) hack alert -- something better than just the account name
+ *     is needed for identifying the account.
+ */
+/* ------------------------------------------------------------------ */
+
+
+/* Records are formatted on the committing thread and handed to a writer
+ * thread, which writes whatever has accumulated since its last write in
+ * one go. The writer wakes as soon as a record arrives, so a record
+ * reaches the operating system at most one write after it was logged;
+ * meanwhile the engine goes on without waiting for the disk. Records
+ * are written in the order they were logged. */
+class LogWriter
+{
+public:
+    explicit LogWriter (FILE *file) : m_file {file}, m_thread {&LogWriter::run, this} {}
+    LogWriter (const LogWriter&) = delete;
+    LogWriter& operator= (const LogWriter&) = delete;
+    /* Writes what is pending, syncs it unless the policy is none, and
+     * closes the file. */
+    ~LogWriter ();
+
+    /* Queue the record, emptying it. Waits only if the writer is more
+     * than max_pending bytes behind, or until the record is synced if
+     * the policy is XACC_LOG_SYNC_COMMIT. */
+    void write (std::string& record);
+    /* Wait until everything queued has been written. */
+    void flush ();
+
+private:
+    void run ();
+    void wait_for (uint64_t seq, std::unique_lock<std::mutex>& lock);
+
+    static constexpr size_t max_pending = 1 << 20;
+
+    FILE *m_file;
+    std::mutex m_mutex;
+    std::condition_variable m_queued;
+    std::condition_variable m_written;
+    std::string m_pending;
+    uint64_t m_queued_seq = 0;
+    uint64_t m_written_seq = 0;
+    bool m_stop = false;
+    std::thread m_thread;
+};
+
+static int gen_logs = 1;
+static std::unique_ptr<LogWriter> trans_log; /**< current log file writer */
+static char * trans_log_name = NULL; /**< current log file name */
+static char * log_base_name = NULL;
+static std::atomic<XaccLogSyncPolicy> sync_policy {XACC_LOG_SYNC_NONE};
+
+static void
+sync_file (FILE *file)
+{
+#ifdef G_OS_WIN32
+    if (_commit (_fileno (file)) != 0)
+#else
+    if (fsync (fileno (file)) != 0)
+#endif
+        PWARN ("Failed to sync the transaction log: %s", g_strerror (errno));
+}
+
+void
+LogWriter::run ()
+{
+    std::string batch;
+    std::unique_lock<std::mutex> lock {m_mutex};
+    while (true)
+    {
+        m_queued.wait (lock, [this] { return m_stop || !m_pending.empty (); });
+        if (m_pending.empty ())
+            break;
+        batch.swap (m_pending);
+        auto seq = m_queued_seq;
+        /* Producers blocked on a full queue can go on now. */
+        m_written.notify_all ();
+        lock.unlock ();
+
+        if (fwrite (batch.data (), 1, batch.size (), m_file) != batch.size () ||
+            fflush (m_file) != 0)
+            PWARN ("Failed to write the transaction log: %s", g_strerror (errno));
+        else if (sync_policy != XACC_LOG_SYNC_NONE)
+            sync_file (m_file);
+        batch.clear ();
+
+        lock.lock ();
+        m_written_seq = seq;
+        m_written.notify_all ();
+    }
+}
+
+LogWriter::~LogWriter ()
+{
+    {
+        std::lock_guard<std::mutex> lock {m_mutex};
+        m_stop = true;
+    }
+    m_queued.notify_one ();
+    m_thread.join ();
+    fclose (m_file);
+}
+
+void
+LogWriter::wait_for (uint64_t seq, std::unique_lock<std::mutex>& lock)
+{
+    m_written.wait (lock, [this, seq] { return m_written_seq >= seq; });
+}
+
+void
+LogWriter::write (std::string& record)
+{
+    std::unique_lock<std::mutex> lock {m_mutex};
+    m_written.wait (lock, [this] { return m_pending.size () < max_pending; });
+    if (m_pending.empty ())
+        m_pending.swap (record);
+    else
+        m_pending.append (record);
+    auto seq = ++m_queued_seq;
+    m_queued.notify_one ();
+    if (sync_policy == XACC_LOG_SYNC_COMMIT)
+        wait_for (seq, lock);
+    record.clear ();
+}
+
+void
+LogWriter::flush ()
+{
+    std::unique_lock<std::mutex> lock {m_mutex};
+    wait_for (m_queued_seq, lock);
+}
+
+/********************************************************************\
+\********************************************************************/
+
+void xaccLogDisable (void)
+{
+    gen_logs = 0;
+}
+void xaccLogEnable  (void)
+{
+    gen_logs = 1;
+}
+
+void
+xaccLogSetSyncPolicy (XaccLogSyncPolicy policy)
+{
+    switch (policy)
+    {
+    case XACC_LOG_SYNC_NONE:
+    case XACC_LOG_SYNC_BATCH:
+    case XACC_LOG_SYNC_COMMIT:
+        sync_policy = policy;
+        break;
+    default:
+        PWARN ("Unknown transaction log sync policy %d, using none",
+               static_cast<int>(policy));
+        sync_policy = XACC_LOG_SYNC_NONE;
+        break;
+    }
+}
+
+XaccLogSyncPolicy
+xaccLogGetSyncPolicy (void)
+{
+    return sync_policy;
+}
+
+/********************************************************************\
+\********************************************************************/
+
+void
+xaccReopenLog (void)
+{
+    if (trans_log)
+    {
+        xaccCloseLog();
+        xaccOpenLog();
+    }
+}
+
+
+void
+xaccLogSetBaseName (const char *basepath)
+{
+    if (!basepath) return;
+
+    g_free (log_base_name);
+    log_base_name = g_strdup (basepath);
+
+    if (trans_log)
+    {
+        xaccCloseLog();
+        xaccOpenLog();
+    }
+}
+
+
+/*
+ * See if the provided file name is that of the current log file.
+ * Since the filename is generated with a time-stamp we can ignore the
+ * directory path and avoid problems with worrying about any ".."
+ * components in the path.
+ */
+gboolean
+xaccFileIsCurrentLog (const gchar *name)
+{
+    gchar *base;
+    gint result;
+
+    if (!name || !trans_log_name)
+        return FALSE;
+
+    base = g_path_get_basename(name);
+    result = (strcmp(base, trans_log_name) == 0);
+    g_free(base);
+    return result;
+}
+
+/********************************************************************\
+\********************************************************************/
+
+void
+xaccOpenLog (void)
+{
+    char * filename;
+    char * timestamp;
+
+    if (!gen_logs)
+    {
+	 PINFO ("Attempt to open disabled transaction log");
+	 return;
+    }
+    if (trans_log) return;
+
+    if (!log_base_name) log_base_name = g_strdup ("translog");
+
+    /* tag each filename with a timestamp */
+    timestamp = gnc_date_timestamp ();
+
+    filename = g_strconcat (log_base_name, ".", timestamp, ".log", NULL);
+
+    auto file = g_fopen (filename, "a");
+    if (!file)
+    {
+        int norr = errno;
+        printf ("Error: xaccOpenLog(): cannot open journal\n"
+                "\t %d %s\n", norr, g_strerror (norr) ? g_strerror (norr) : "");
+
+        g_free (filename);
+        g_free (timestamp);
+        return;
+    }
+
+    /* Save the log file name */
+    if (trans_log_name)
+        g_free (trans_log_name);
+    trans_log_name = g_path_get_basename(filename);
+
+    g_free (filename);
+    g_free (timestamp);
+
+    /*  Note: this must match gnc-translog-replay.cpp */
+    fprintf (file, "mod\ttrans_guid\tsplit_guid\ttime_now\t"
+             "date_entered\tdate_posted\t"
+             "acc_guid\tacc_name\tnum\tdescription\t"
+             "notes\tmemo\taction\treconciled\t"
+             "amount\tvalue\tdate_reconciled\n");
+    fprintf (file, "-----------------\n");
+    fflush (file);
+
+    trans_log = std::make_unique<LogWriter> (file);
+}
+
+/********************************************************************\
+\********************************************************************/
+
+void
+xaccCloseLog (void)
+{
+    trans_log.reset ();
+}
+
+void
+xaccLogFlush (void)
+{
+    if (trans_log)
+        trans_log->flush ();
+}
+
+/********************************************************************\
+\********************************************************************/
+
+/* The same as gnc_time64_to_iso8601_buff() writes, "YYYY-MM-DD HH:MM:SS"
+ * in UTC, without building a GncDateTime for every date. Dates
+ * GncDateTime can't represent are left empty. */
+static void
+append_iso8601 (std::string& str, time64 time)
+{
+    if (time < MINTIME || time > MAXTIME)
+    {
+        PWARN ("Time %" G_GINT64_FORMAT " is out of range", time);
+        return;
+    }
+    auto days = time / 86400;
+    auto secs = time % 86400;
+    if (secs < 0)
+    {
+        secs += 86400;
+        --days;
+    }
+    /* Howard Hinnant's civil_from_days(). */
+    days += 719468;
+    auto era = (days >= 0 ? days : days - 146096) / 146097;
+    auto doe = days - era * 146097;
+    auto yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    auto doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    auto mp = (5 * doy + 2) / 153;
+    auto day = doy - (153 * mp + 2) / 5 + 1;
+    auto month = mp < 10 ? mp + 3 : mp - 9;
+    auto year = yoe + era * 400 + (month <= 2);
+
+    char buf[20];
+    auto put = [&buf](int pos, int64_t val, int width)
+    {
+        for (auto i = pos + width - 1; i >= pos; --i, val /= 10)
+            buf[i] = '0' + val % 10;
+    };
+    put (0, year, 4);
+    buf[4] = '-';
+    put (5, month, 2);
+    buf[7] = '-';
+    put (8, day, 2);
+    buf[10] = ' ';
+    put (11, secs / 3600, 2);
+    buf[13] = ':';
+    put (14, secs / 60 % 60, 2);
+    buf[16] = ':';
+    put (17, secs % 60, 2);
+    str.append (buf, 19);
+}
+
+static void
+append_guid (std::string& str, const GncGUID *guid)
+{
+    char buf[GUID_ENCODING_LENGTH + 1];
+    guid_to_string_buff (guid, buf);
+    str.append (buf, GUID_ENCODING_LENGTH);
+}
+
+static void
+append_numeric (std::string& str, gnc_numeric num)
+{
+    char buf[48];
+    auto end = std::to_chars (buf, buf + sizeof (buf), gnc_numeric_num (num)).ptr;
+    *end++ = '/';
+    end = std::to_chars (end, buf + sizeof (buf), gnc_numeric_denom (num)).ptr;
+    str.append (buf, end);
+}
+
+static void
+append_field (std::string& str, const char *field)
+{
+    if (field)
+        str.append (field);
+    str.push_back ('\t');
+}
+
+void
+xaccTransWriteLog (Transaction *trans, char flag)
+{
+    /* Reused so that formatting a record doesn't allocate once the
+     * buffers have grown to the size of the largest transaction. */
+    static std::string record, trans_fields, date_fields;
+
+    if (!gen_logs)
+    {
+         PINFO ("Attempt to write disabled transaction log");
+	 return;
+    }
+    if (!trans_log) return;
+
+    /* The fields that are the same for every split. */
+    trans_fields.clear ();
+    append_guid (trans_fields, xaccTransGetGUID (trans));
+    trans_fields.push_back ('\t');
+    date_fields.clear ();
+    append_iso8601 (date_fields, gnc_time (NULL));
+    date_fields.push_back ('\t');
+    append_iso8601 (date_fields, trans->date_entered);
+    date_fields.push_back ('\t');
+    append_iso8601 (date_fields, trans->date_posted);
+    date_fields.push_back ('\t');
+    auto trans_notes = xaccTransGetNotes(trans);
+
+    record.append ("===== START\n");
+    for (auto node = trans->splits; node; node = node->next)
+    {
+        auto split = static_cast<Split*>(node->data);
+        auto account = xaccSplitGetAccount (split);
+
+        /* use tab-separated fields */
+        record.push_back (flag);
+        record.push_back ('\t');
+        /* trans+split make up unique id */
+        record.append (trans_fields);
+        append_guid (record, xaccSplitGetGUID (split));
+        record.push_back ('\t');
+        record.append (date_fields);
+        if (account)
+            append_guid (record, xaccAccountGetGUID (account));
+        record.push_back ('\t');
+        append_field (record, account ? xaccAccountGetName (account) : "");
+        append_field (record, trans->num);
+        append_field (record, trans->description);
+        append_field (record, trans_notes);
+        append_field (record, split->memo);
+        append_field (record, split->action);
+        record.push_back (split->reconciled);
+        record.push_back ('\t');
+        append_numeric (record, xaccSplitGetAmount (split));
+        record.push_back ('\t');
+        append_numeric (record, xaccSplitGetValue (split));
+        record.push_back ('\t');
+        append_iso8601 (record, split->date_reconciled);
+        record.push_back ('\n');
+    }
+    record.append ("===== END\n");
+
+    trans_log->write (record);
+}
+
+/************************ END OF ************************************\
+\************************* FILE *************************************/
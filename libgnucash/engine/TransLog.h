@@ -34,6 +34,27 @@
     There are some simple command-line tools that will read a log
     and replay it.
 
+    Records are written by a background thread so that committing a
+    transaction doesn't wait for the disk. What survives a crash
+    depends on the sync policy, see xaccLogSetSyncPolicy():
+
+    - A record reaches the operating system at most one batch write
+      after it was logged. If GnuCash crashes, the records logged in
+      the last moments before, which the writer hadn't written yet,
+      are lost; xaccCloseLog(), xaccLogFlush() and a normal exit write
+      everything.
+    - With XACC_LOG_SYNC_NONE the operating system writes the file back
+      in its own time, so a system crash or power failure can also lose
+      the records of the last seconds.
+    - With XACC_LOG_SYNC_BATCH each batch is synced to disk after it is
+      written, which narrows that window to one batch.
+    - With XACC_LOG_SYNC_COMMIT xaccTransWriteLog() returns only after
+      its record is synced, so every committed transaction is on disk.
+      That is the slowest policy, by far.
+
+    In every case the records in the file are complete and in the order
+    they were logged, except possibly for a truncated last one.
+
     @{ */
 /** @file TransLog.h
     @brief API for the transaction logger
@@ -50,10 +71,28 @@
 extern "C" {
 #endif
 
+/** When the transaction log has the operating system put what it wrote
+ * on disk. */
+typedef enum
+{
+    XACC_LOG_SYNC_NONE,     /**< Never; the system does in its own time. */
+    XACC_LOG_SYNC_BATCH,    /**< After each batch of records is written. */
+    XACC_LOG_SYNC_COMMIT,   /**< Before xaccTransWriteLog() returns. */
+} XaccLogSyncPolicy;
+
 void    xaccOpenLog (void);
+/** Write what is still pending and close the log file. */
 void    xaccCloseLog (void);
 void    xaccReopenLog (void);
 
+/** Wait until everything logged so far is written to the log file. */
+void    xaccLogFlush (void);
+
+/** Set when the log is synced to disk. The default is
+ * XACC_LOG_SYNC_NONE. */
+void    xaccLogSetSyncPolicy (XaccLogSyncPolicy policy);
+XaccLogSyncPolicy xaccLogGetSyncPolicy (void);
+
 /**
  * @param trans The transaction to write out to the log
  * @param flag The engine currently uses the log mechanism with flag char set as
@@ -1648,6 +1648,10 @@ xaccTransCommitEdit (Transaction *trans)
      * call to xaccTransCommitEdit. */
     qof_instance_increase_editlevel(trans);
 
+    /* Let batched listeners see the events of the commit once per
+     * entity instead of once per split. */
+    qof_event_begin_batch ();
+
     if (was_trans_emptied(trans))
         qof_instance_set_destroying(trans, TRUE);
 
@@ -1693,6 +1697,7 @@ xaccTransCommitEdit (Transaction *trans)
                           trans_on_error,
                           (void (*) (QofInstance *)) trans_cleanup_commit,
                           (void (*) (QofInstance *)) do_destroy);
+    qof_event_end_batch ();
     LEAVE ("(trans=%p)", trans);
 }
 
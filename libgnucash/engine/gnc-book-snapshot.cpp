@@ -0,0 +1,253 @@
+/********************************************************************\
+ * gnc-book-snapshot.cpp -- Immutable views of a book for readers   *
+ *                          on other threads.                       *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+#include <config.h>
+
+#include "gnc-book-snapshot.hpp"
+#include "Split.h"
+#include "Transaction.h"
+#include "gnc-commodity.h"
+#include "gnc-pricedb.h"
+
+#include <algorithm>
+
+static QofLogModule log_module = GNC_MOD_ENGINE;
+
+static const char *snapshot_key = "gnc-book-snapshot";
+
+static std::string
+to_string (const char *str)
+{
+    return str ? str : "";
+}
+
+static std::string
+commodity_name (const gnc_commodity *comm)
+{
+    return to_string (comm ? gnc_commodity_get_unique_name (comm) : nullptr);
+}
+
+static GncSnapshotAccount
+copy_account (const Account *acc)
+{
+    auto parent = gnc_account_get_parent (acc);
+    auto full_name = gnc_account_get_full_name (acc);
+    GncSnapshotAccount ret {
+        *xaccAccountGetGUID (acc),
+        parent ? *xaccAccountGetGUID (parent) : *guid_null (),
+        to_string (xaccAccountGetName (acc)),
+        to_string (full_name),
+        xaccAccountGetType (acc),
+        commodity_name (xaccAccountGetCommodity (acc)),
+        xaccAccountGetBalance (acc),
+        xaccAccountGetClearedBalance (acc),
+        xaccAccountGetReconciledBalance (acc)
+    };
+    g_free (full_name);
+    return ret;
+}
+
+static GncSnapshotTransaction
+copy_transaction (const Transaction *trans)
+{
+    GncSnapshotTransaction ret {
+        *xaccTransGetGUID (trans),
+        xaccTransGetDate (trans),
+        to_string (xaccTransGetNum (trans)),
+        to_string (xaccTransGetDescription (trans)),
+        commodity_name (xaccTransGetCurrency (trans)),
+        {}
+    };
+    for (auto node = xaccTransGetSplitList (trans); node; node = g_list_next (node))
+    {
+        auto split = static_cast<const Split*>(node->data);
+        auto acc = xaccSplitGetAccount (split);
+        ret.splits.push_back ({
+            *xaccSplitGetGUID (split),
+            acc ? *xaccAccountGetGUID (acc) : *guid_null (),
+            to_string (xaccSplitGetMemo (split)),
+            xaccSplitGetReconcile (split),
+            xaccSplitGetAmount (split),
+            xaccSplitGetValue (split)
+        });
+    }
+    return ret;
+}
+
+GncBookSnapshot::GncBookSnapshot (QofBook *book)
+{
+    g_return_if_fail (book);
+    ENTER ("book %p", book);
+
+    if (auto root = gnc_book_get_root_account (book))
+    {
+        m_accounts.push_back (copy_account (root));
+        auto descendants = gnc_account_get_descendants (root);
+        for (auto node = descendants; node; node = g_list_next (node))
+            m_accounts.push_back (copy_account (static_cast<Account*>(node->data)));
+        g_list_free (descendants);
+    }
+    for (size_t i = 0; i < m_accounts.size (); ++i)
+        m_account_index.emplace (m_accounts[i].guid, i);
+
+    auto col = qof_book_get_collection (book, GNC_ID_TRANS);
+    m_transactions.reserve (qof_collection_count (col));
+    qof_collection_foreach (col, [](QofInstance *inst, gpointer data)
+    {
+        auto transactions = static_cast<std::vector<GncSnapshotTransaction>*>(data);
+        transactions->push_back (copy_transaction (GNC_TRANSACTION (inst)));
+    }, &m_transactions);
+
+    for (size_t i = 0; i < m_transactions.size (); ++i)
+    {
+        auto& trans = m_transactions[i];
+        m_transaction_index.emplace (trans.guid, i);
+        /* Start with each split's amount; the loop below turns them
+         * into running balances once the postings are in date order. */
+        for (auto& split : trans.splits)
+            m_postings[split.account].push_back ({trans.date_posted,
+                                                  split.amount});
+    }
+    for (auto& [guid, postings] : m_postings)
+    {
+        std::stable_sort (postings.begin (), postings.end (),
+                          [](auto& a, auto& b) { return a.date < b.date; });
+        auto balance = gnc_numeric_zero ();
+        for (auto& posting : postings)
+            posting.balance = balance = gnc_numeric_add_fixed (balance,
+                                                              posting.balance);
+    }
+
+    if (auto pdb = gnc_pricedb_get_db (book))
+        gnc_pricedb_foreach_price (pdb, [](GNCPrice *price, gpointer data)
+        {
+            auto prices = static_cast<std::vector<GncSnapshotPrice>*>(data);
+            prices->push_back ({
+                *gnc_price_get_guid (price),
+                commodity_name (gnc_price_get_commodity (price)),
+                commodity_name (gnc_price_get_currency (price)),
+                gnc_price_get_time64 (price),
+                gnc_price_get_value (price),
+                to_string (gnc_price_get_source_string (price)),
+                to_string (gnc_price_get_typestr (price))
+            });
+            return TRUE;
+        }, &m_prices, TRUE);
+
+    LEAVE ("%zu accounts, %zu transactions, %zu prices", m_accounts.size (),
+           m_transactions.size (), m_prices.size ());
+}
+
+const GncSnapshotAccount*
+GncBookSnapshot::find_account (const GncGUID& guid) const
+{
+    auto iter = m_account_index.find (guid);
+    return iter == m_account_index.end () ? nullptr : &m_accounts[iter->second];
+}
+
+const GncSnapshotTransaction*
+GncBookSnapshot::find_transaction (const GncGUID& guid) const
+{
+    auto iter = m_transaction_index.find (guid);
+    return iter == m_transaction_index.end () ? nullptr :
+        &m_transactions[iter->second];
+}
+
+gnc_numeric
+GncBookSnapshot::balance_as_of (const GncGUID& account, time64 date) const
+{
+    auto iter = m_postings.find (account);
+    if (iter == m_postings.end ())
+        return gnc_numeric_zero ();
+    auto& postings = iter->second;
+    auto after = std::upper_bound (postings.begin (), postings.end (), date,
+                                   [](time64 date, auto& posting)
+                                   { return date < posting.date; });
+    return after == postings.begin () ? gnc_numeric_zero () :
+        std::prev (after)->balance;
+}
+
+/* The last snapshot taken of a book, kept in the book's data table until
+ * one of its instances changes. */
+struct SnapshotCache
+{
+    GncBookSnapshotPtr snapshot;
+};
+
+static void
+snapshot_cache_free (QofBook*, gpointer, gpointer data)
+{
+    delete static_cast<SnapshotCache*>(data);
+}
+
+static void
+snapshot_event_handler (QofInstance *ent, QofEventId, gpointer, gpointer)
+{
+    auto book = qof_instance_get_book (ent);
+    if (!book || qof_book_shutting_down (book))
+        return;
+    if (auto cache = static_cast<SnapshotCache*>(qof_book_get_data (book, snapshot_key)))
+        cache->snapshot.reset ();
+}
+
+static SnapshotCache*
+get_snapshot_cache (QofBook *book)
+{
+    static gint handler_id = 0;
+    if (!handler_id)
+        handler_id = qof_event_register_typed_handler (nullptr,
+                                                       QOF_EVENT_CREATE |
+                                                       QOF_EVENT_MODIFY |
+                                                       QOF_EVENT_DESTROY |
+                                                       QOF_EVENT_ADD |
+                                                       QOF_EVENT_REMOVE,
+                                                       QOF_EVENT_DELIVER_SYNC,
+                                                       snapshot_event_handler,
+                                                       nullptr);
+
+    auto cache = static_cast<SnapshotCache*>(qof_book_get_data (book, snapshot_key));
+    if (!cache)
+    {
+        cache = new SnapshotCache;
+        qof_book_set_data_fin (book, snapshot_key, cache, snapshot_cache_free);
+    }
+    return cache;
+}
+
+GncBookSnapshotPtr
+gnc_book_snapshot (QofBook *book)
+{
+    g_return_val_if_fail (book, nullptr);
+    auto cache = get_snapshot_cache (book);
+    if (!cache->snapshot)
+        cache->snapshot = std::make_shared<const GncBookSnapshot> (book);
+    return cache->snapshot;
+}
+
+void
+gnc_book_snapshot_invalidate (QofBook *book)
+{
+    g_return_if_fail (book);
+    if (auto cache = static_cast<SnapshotCache*>(qof_book_get_data (book, snapshot_key)))
+        cache->snapshot.reset ();
+}
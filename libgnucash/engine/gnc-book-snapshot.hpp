@@ -0,0 +1,154 @@
+/********************************************************************\
+ * gnc-book-snapshot.hpp -- Immutable views of a book for readers   *
+ *                          on other threads.                       *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+/** @addtogroup Engine
+    @{ */
+/** @file gnc-book-snapshot.hpp
+ *  @brief Read-only copies of a book's accounts, transactions and
+ *  prices that any number of threads can read while the book changes.
+ *
+ *  The engine objects themselves are not thread safe. A snapshot copies
+ *  the data readers usually need into plain values when it is taken,
+ *  on the thread that owns the book, and never changes afterwards. It
+ *  holds no pointers into the book, so it stays valid after the book is
+ *  edited or destroyed.
+ *
+ *  Taking a snapshot is copy-on-write at the book level: the last
+ *  snapshot of a book is kept and handed out again until an event
+ *  reports a change to one of the book's instances. Changes made while
+ *  events are suspended aren't seen; call gnc_book_snapshot_invalidate()
+ *  after such edits.
+ */
+
+#ifndef GNC_BOOK_SNAPSHOT_HPP
+#define GNC_BOOK_SNAPSHOT_HPP
+
+#include "Account.h"
+#include "guid.hpp"
+#include "qof.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct GncSnapshotAccount
+{
+    GncGUID guid;
+    GncGUID parent;             /**< guid_null() for the root account. */
+    std::string name;
+    std::string full_name;
+    GNCAccountType type;
+    std::string commodity;      /**< gnc_commodity_get_unique_name() */
+    gnc_numeric balance;
+    gnc_numeric cleared_balance;
+    gnc_numeric reconciled_balance;
+};
+
+struct GncSnapshotSplit
+{
+    GncGUID guid;
+    GncGUID account;
+    std::string memo;
+    char reconcile;
+    gnc_numeric amount;
+    gnc_numeric value;
+};
+
+struct GncSnapshotTransaction
+{
+    GncGUID guid;
+    time64 date_posted;
+    std::string num;
+    std::string description;
+    std::string currency;       /**< gnc_commodity_get_unique_name() */
+    std::vector<GncSnapshotSplit> splits;
+};
+
+struct GncSnapshotPrice
+{
+    GncGUID guid;
+    std::string commodity;      /**< gnc_commodity_get_unique_name() */
+    std::string currency;       /**< gnc_commodity_get_unique_name() */
+    time64 time;
+    gnc_numeric value;
+    std::string source;
+    std::string type;
+};
+
+class GncBookSnapshot
+{
+public:
+    /** Copy the book. Call only from the thread that owns it. */
+    explicit GncBookSnapshot (QofBook *book);
+
+    /** Accounts in depth-first order, starting with the root. */
+    const std::vector<GncSnapshotAccount>& accounts () const noexcept
+    { return m_accounts; }
+    /** Transactions in the order they were added to the book. */
+    const std::vector<GncSnapshotTransaction>& transactions () const noexcept
+    { return m_transactions; }
+    /** Prices in gnc_pricedb_foreach_price()'s stable order. */
+    const std::vector<GncSnapshotPrice>& prices () const noexcept
+    { return m_prices; }
+
+    /** @return the account, or nullptr if the book had no such account. */
+    const GncSnapshotAccount* find_account (const GncGUID& guid) const;
+    /** @return the transaction, or nullptr if there was none. */
+    const GncSnapshotTransaction* find_transaction (const GncGUID& guid) const;
+
+    /** The sum of the account's split amounts posted on or before date,
+     * not including subaccounts. */
+    gnc_numeric balance_as_of (const GncGUID& account, time64 date) const;
+
+private:
+    /* A split's posted date and the account's running balance after it,
+     * kept per account in date order so that balance_as_of() can binary
+     * search. */
+    struct Posting
+    {
+        time64 date;
+        gnc_numeric balance;
+    };
+
+    std::vector<GncSnapshotAccount> m_accounts;
+    std::vector<GncSnapshotTransaction> m_transactions;
+    std::vector<GncSnapshotPrice> m_prices;
+    std::unordered_map<GncGUID, size_t> m_account_index;
+    std::unordered_map<GncGUID, size_t> m_transaction_index;
+    std::unordered_map<GncGUID, std::vector<Posting>> m_postings;
+};
+
+using GncBookSnapshotPtr = std::shared_ptr<const GncBookSnapshot>;
+
+/** Get a snapshot of the book's current state, taking a new one only if
+ * the book changed since the last call. Call only from the thread that
+ * owns the book; the snapshot may then be passed to and read from any
+ * thread. */
+GncBookSnapshotPtr gnc_book_snapshot (QofBook *book);
+
+/** Make the next gnc_book_snapshot() call for this book take a new
+ * snapshot. */
+void gnc_book_snapshot_invalidate (QofBook *book);
+
+#endif /* GNC_BOOK_SNAPSHOT_HPP */
+/** @} */
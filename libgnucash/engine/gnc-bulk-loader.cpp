@@ -0,0 +1,152 @@
+/********************************************************************\
+ * gnc-bulk-loader.cpp -- Create many transactions at once.         *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+#include <config.h>
+
+#include "gnc-bulk-loader.hpp"
+#include "qof.h"
+
+#include <stdexcept>
+
+static QofLogModule log_module = GNC_MOD_ENGINE;
+
+GncBulkLoader::GncBulkLoader (QofBook *book) : m_book {book}
+{
+    if (!book)
+        throw std::invalid_argument {"GncBulkLoader needs a book."};
+}
+
+void
+GncBulkLoader::add (GncBulkTransaction&& trans)
+{
+    if (!trans.currency)
+        throw std::invalid_argument {"Transaction has no currency."};
+    if (trans.splits.empty ())
+        throw std::invalid_argument {"Transaction has no splits."};
+    for (const auto& split : trans.splits)
+    {
+        if (!split.account)
+            throw std::invalid_argument {"Split has no account."};
+        if (gnc_account_get_book (split.account) != m_book)
+            throw std::invalid_argument {"Split's account is in another book."};
+    }
+    m_pending.push_back (std::move (trans));
+}
+
+void
+GncBulkLoader::hold (Account *acc)
+{
+    if (!acc || m_held_set.count (acc))
+        return;
+    if (gnc_account_get_book (acc) != m_book)
+        throw std::invalid_argument {"Account is in another book."};
+
+    /* Inserting a split in an account that is open for edit just
+     * prepends it and marks the account for sorting, and the deferred
+     * balance is left for the commit. A caller that already defers it
+     * keeps doing so. */
+    if (m_held.empty ())
+        qof_event_begin_batch ();
+    m_held_set.insert (acc);
+    m_held.emplace_back (acc, gnc_account_get_defer_bal_computation (acc));
+    xaccAccountBeginEdit (acc);
+    gnc_account_set_defer_bal_computation (acc, TRUE);
+}
+
+void
+GncBulkLoader::release ()
+{
+    if (m_held.empty ())
+        return;
+
+    /* Committing the accounts sorts their splits and recomputes their
+     * balances, once each, unless the caller defers that. */
+    for (auto [acc, defer] : m_held)
+    {
+        gnc_account_set_defer_bal_computation (acc, defer);
+        xaccAccountCommitEdit (acc);
+    }
+    m_held.clear ();
+    m_held_set.clear ();
+    qof_event_end_batch ();
+}
+
+GncBulkLoader::~GncBulkLoader ()
+{
+    release ();
+}
+
+static Transaction*
+create_transaction (QofBook *book, const GncBulkTransaction& bulk_trans,
+                    time64 now)
+{
+    auto trans = xaccMallocTransaction (book);
+    xaccTransBeginEdit (trans);
+    xaccTransSetCurrency (trans, bulk_trans.currency);
+    xaccTransSetDatePostedSecsNormalized (trans, bulk_trans.date_posted);
+    xaccTransSetDateEnteredSecs (trans, now);
+    if (!bulk_trans.num.empty ())
+        xaccTransSetNum (trans, bulk_trans.num.c_str ());
+    xaccTransSetDescription (trans, bulk_trans.description.c_str ());
+    if (!bulk_trans.notes.empty ())
+        xaccTransSetNotes (trans, bulk_trans.notes.c_str ());
+
+    for (const auto& bulk_split : bulk_trans.splits)
+    {
+        auto split = xaccMallocSplit (book);
+        xaccSplitSetParent (split, trans);
+        xaccSplitSetAccount (split, bulk_split.account);
+        xaccSplitSetAmount (split, bulk_split.amount);
+        xaccSplitSetValue (split, bulk_split.value);
+        if (!bulk_split.memo.empty ())
+            xaccSplitSetMemo (split, bulk_split.memo.c_str ());
+        if (!bulk_split.action.empty ())
+            xaccSplitSetAction (split, bulk_split.action.c_str ());
+        xaccSplitSetReconcile (split, bulk_split.reconcile);
+    }
+    xaccTransCommitEdit (trans);
+    return trans;
+}
+
+std::vector<Transaction*>
+GncBulkLoader::commit ()
+{
+    ENTER ("%zu transactions", m_pending.size ());
+    std::vector<Transaction*> created;
+    created.reserve (m_pending.size ());
+
+    for (const auto& trans : m_pending)
+        for (const auto& split : trans.splits)
+            hold (split.account);
+
+    auto now = gnc_time (nullptr);
+    for (const auto& trans : m_pending)
+        created.push_back (create_transaction (m_book, trans, now));
+    m_pending.clear ();
+
+    auto num_accounts = m_held.size ();
+    release ();
+
+    LEAVE ("created %zu transactions in %zu accounts", created.size (),
+           num_accounts);
+    return created;
+}
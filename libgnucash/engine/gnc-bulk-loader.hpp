@@ -0,0 +1,119 @@
+/********************************************************************\
+ * gnc-bulk-loader.hpp -- Create many transactions at once.         *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+/** @addtogroup Engine
+    @{ */
+/** @file gnc-bulk-loader.hpp
+ *  @brief Create many fully specified transactions in one go.
+ *
+ *  Committing transactions one at a time re-sorts each touched account's
+ *  split list, recomputes its balances and notifies listeners for every
+ *  split. GncBulkLoader validates the transactions as they are added,
+ *  then creates them all with the touched accounts held open for edit,
+ *  so each account is sorted and rebalanced once at the end, and inside
+ *  one event batch, so batched listeners hear about each entity once.
+ *
+ *  Each transaction is still committed, scrubbed and logged
+ *  individually, exactly as xaccTransCommitEdit() does.
+ *
+ *  Code that commits transactions of its own, as the import matcher
+ *  does, can hold the accounts they touch to have them sorted and
+ *  rebalanced with the loader's.
+ */
+
+#ifndef GNC_BULK_LOADER_HPP
+#define GNC_BULK_LOADER_HPP
+
+#include "Account.h"
+#include "Transaction.h"
+#include "Split.h"
+
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+struct GncBulkSplit
+{
+    Account *account;
+    gnc_numeric amount;
+    gnc_numeric value;
+    std::string memo;
+    std::string action;
+    char reconcile = NREC;
+};
+
+struct GncBulkTransaction
+{
+    gnc_commodity *currency;
+    time64 date_posted;
+    std::string num;
+    std::string description;
+    std::string notes;
+    std::vector<GncBulkSplit> splits;
+};
+
+class GncBulkLoader
+{
+public:
+    explicit GncBulkLoader (QofBook *book);
+    GncBulkLoader (const GncBulkLoader&) = delete;
+    GncBulkLoader& operator= (const GncBulkLoader&) = delete;
+
+    /** Queue a transaction.
+     *  @exception std::invalid_argument if it has no currency or no
+     *  splits, or a split has no account or one from another book. */
+    void add (GncBulkTransaction&& trans);
+
+    /** @return the number of queued transactions. */
+    size_t size () const noexcept { return m_pending.size (); }
+
+    /** Hold an account open for edit, with its balance computation
+     *  deferred, until commit(). Transactions committed meanwhile with
+     *  splits in it are sorted and balanced with the loader's. The
+     *  first account held starts the loader's event batch. A null
+     *  account is ignored.
+     *  @exception std::invalid_argument if the account is in another
+     *  book. */
+    void hold (Account *acc);
+
+    /** Create the queued transactions, empty the queue and release
+     *  the held accounts.
+     *  @return the new transactions, in the order they were added. */
+    std::vector<Transaction*> commit ();
+
+    /** Releases the accounts still held. Queued transactions are
+     *  dropped. */
+    ~GncBulkLoader ();
+
+private:
+    void release ();
+
+    QofBook *m_book;
+    std::vector<GncBulkTransaction> m_pending;
+    /* Each held account, with whether it deferred its balance
+     * computation before. */
+    std::vector<std::pair<Account*, gboolean>> m_held;
+    std::unordered_set<Account*> m_held_set;
+};
+
+#endif /* GNC_BULK_LOADER_HPP */
+/** @} */
@@ -846,6 +846,52 @@ gnc_numeric_sub(gnc_numeric a, gnc_numeric b,
     }
 }
 
+/* *******************************************************************
+ *  gnc_numeric_sum
+ ********************************************************************/
+
+#if defined(__GNUC__) || defined(__clang__)
+/* Sum the numerators of values sharing one denominator. The loop has no
+ * early exit so that the compiler is free to unroll and vectorize it;
+ * overflow is accumulated and checked once at the end.
+ */
+static bool
+sum_same_denom(const gnc_numeric *array, size_t n, int64_t *sum)
+{
+    auto denom = array[0].denom;
+    bool same_denom = true;
+    for (size_t i = 1; i < n; ++i)
+        same_denom &= (array[i].denom == denom);
+    if (!same_denom || denom <= 0)
+        return false;
+
+    int64_t acc = 0;
+    bool overflow = false;
+    for (size_t i = 0; i < n; ++i)
+        overflow |= __builtin_add_overflow(acc, array[i].num, &acc);
+    *sum = acc;
+    return !overflow;
+}
+#endif
+
+gnc_numeric
+gnc_numeric_sum(const gnc_numeric *array, gsize n)
+{
+    if (!array || n == 0)
+        return gnc_numeric_zero();
+
+#if defined(__GNUC__) || defined(__clang__)
+    int64_t num;
+    if (sum_same_denom(array, n, &num))
+        return gnc_numeric_create(num, array[0].denom);
+#endif
+
+    auto sum = gnc_numeric_zero();
+    for (gsize i = 0; i < n; ++i)
+        sum = gnc_numeric_add_fixed(sum, array[i]);
+    return sum;
+}
+
 /* *******************************************************************
  *  gnc_numeric_mul
  ********************************************************************/
@@ -427,10 +427,21 @@ gnc_numeric gnc_numeric_abs(gnc_numeric a);
 /**
  * Shortcut for common case: gnc_numeric_add(a, b, GNC_DENOM_AUTO,
  *                        GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER);
+ *
+ * When both arguments have the same positive denominator, as split
+ * amounts in a single account almost always do, the numerators are
+ * added directly and the full rational arithmetic is only used if
+ * that overflows.
  */
 static inline
 gnc_numeric gnc_numeric_add_fixed(gnc_numeric a, gnc_numeric b)
 {
+#if defined(__GNUC__) || defined(__clang__)
+    gint64 num;
+    if (a.denom == b.denom && a.denom > 0 &&
+        !__builtin_add_overflow(a.num, b.num, &num))
+        return gnc_numeric_create(num, a.denom);
+#endif
     return gnc_numeric_add(a, b, GNC_DENOM_AUTO,
                            GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER);
 }
@@ -438,13 +449,36 @@ gnc_numeric gnc_numeric_add_fixed(gnc_numeric a, gnc_numeric b)
 /**
  * Shortcut for most common case: gnc_numeric_sub(a, b, GNC_DENOM_AUTO,
  *                        GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER);
+ *
+ * Like gnc_numeric_add_fixed() this subtracts the numerators directly
+ * when the denominators are the same.
  */
 static inline
 gnc_numeric gnc_numeric_sub_fixed(gnc_numeric a, gnc_numeric b)
 {
+#if defined(__GNUC__) || defined(__clang__)
+    gint64 num;
+    if (a.denom == b.denom && a.denom > 0 &&
+        !__builtin_sub_overflow(a.num, b.num, &num))
+        return gnc_numeric_create(num, a.denom);
+#endif
     return gnc_numeric_sub(a, b, GNC_DENOM_AUTO,
                            GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER);
 }
+
+/** Return the sum of the n values in array, with the same result as
+ *  folding them with gnc_numeric_add_fixed() starting from zero.
+ *
+ *  If all of the values share one positive denominator the numerators
+ *  are summed as plain integers in a single pass; mixed denominators or
+ *  an overflowing numerator fall back to the general arithmetic.
+ *
+ *  @param array The values to add. May be NULL if n is 0.
+ *  @param n The number of values in array.
+ *  @return The sum, zero if n is 0, or an error value if any element is
+ *  invalid or the sum can't be represented.
+ */
+gnc_numeric gnc_numeric_sum(const gnc_numeric *array, gsize n);
 /** @} */
 
 
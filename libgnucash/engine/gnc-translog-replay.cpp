@@ -0,0 +1,489 @@
+/********************************************************************\
+ * gnc-translog-replay.cpp -- Replay transaction log files.         *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+#include <config.h>
+
+#include <glib/gi18n.h>
+
+#include "gnc-translog-replay.hpp"
+#include "Scrub.h"
+#include "Split.h"
+#include "TransLog.h"
+#include "qof.h"
+#include "qofinstance-p.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_set>
+
+static QofLogModule log_module = GNC_MOD_ENGINE;
+
+/* These must match what xaccOpenLog() and xaccTransWriteLog() write. */
+static constexpr std::string_view log_header
+{
+    "mod\ttrans_guid\tsplit_guid\ttime_now\t"
+    "date_entered\tdate_posted\t"
+    "acc_guid\tacc_name\tnum\tdescription\t"
+    "notes\tmemo\taction\treconciled\t"
+    "amount\tvalue\tdate_reconciled"
+};
+static constexpr std::string_view record_start {"===== START"};
+static constexpr std::string_view record_end {"===== END"};
+
+enum LogField
+{
+    FLAG, TRANS_GUID, SPLIT_GUID, TIME_NOW, DATE_ENTERED, DATE_POSTED,
+    ACC_GUID, ACC_NAME, NUM, DESCRIPTION, NOTES, MEMO, ACTION, RECONCILED,
+    AMOUNT, VALUE, DATE_RECONCILED, NUM_LOG_FIELDS
+};
+
+using LogFields = std::array<std::string_view, NUM_LOG_FIELDS>;
+
+static bool
+starts_with (std::string_view str, std::string_view prefix)
+{
+    return str.substr (0, prefix.size ()) == prefix;
+}
+
+/* Returns the number of tab separated fields in line, filling in as
+ * many of them as fit. */
+static size_t
+split_fields (std::string_view line, LogFields& fields)
+{
+    size_t count = 0;
+    for (;;)
+    {
+        auto tab = line.find ('\t');
+        if (count < NUM_LOG_FIELDS)
+            fields[count] = line.substr (0, tab);
+        ++count;
+        if (tab == std::string_view::npos)
+            return count;
+        line.remove_prefix (tab + 1);
+    }
+}
+
+static std::optional<GncGUID>
+parse_guid (std::string_view str)
+{
+    gnc::GUID guid;
+    if (str.empty () || !gnc::GUID::from_string (str, guid))
+        return std::nullopt;
+    return static_cast<GncGUID>(guid);
+}
+
+template <typename T> static bool
+parse_int (std::string_view str, T& val)
+{
+    auto end = str.data () + str.size ();
+    auto [ptr, ec] = std::from_chars (str.data (), end, val);
+    return ec == std::errc () && ptr == end;
+}
+
+/* TransLog writes UTC times as "YYYY-MM-DD HH:MM:SS"; anything else
+ * goes through the general parser. */
+static std::optional<time64>
+parse_time (std::string_view str)
+{
+    if (str.empty ())
+        return std::nullopt;
+    int64_t year;
+    int month, day, hour, min, sec;
+    if (str.size () == 19 && str[4] == '-' && str[7] == '-' &&
+        str[10] == ' ' && str[13] == ':' && str[16] == ':' &&
+        parse_int (str.substr (0, 4), year) &&
+        parse_int (str.substr (5, 2), month) &&
+        parse_int (str.substr (8, 2), day) &&
+        parse_int (str.substr (11, 2), hour) &&
+        parse_int (str.substr (14, 2), min) &&
+        parse_int (str.substr (17, 2), sec) &&
+        month >= 1 && month <= 12 && day >= 1 && day <= 31 &&
+        hour < 24 && min < 60 && sec < 60)
+    {
+        /* Howard Hinnant's days_from_civil(). */
+        year -= month <= 2;
+        auto era = (year >= 0 ? year : year - 399) / 400;
+        auto yoe = year - era * 400;
+        auto doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+        auto doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        auto days = era * 146097 + doe - 719468;
+        return days * 86400 + hour * 3600 + min * 60 + sec;
+    }
+
+    auto time = gnc_iso8601_to_time64_gmt (std::string {str}.c_str ());
+    if (time == INT64_MAX)
+        return std::nullopt;
+    return time;
+}
+
+static std::optional<gnc_numeric>
+parse_numeric (std::string_view str)
+{
+    if (str.empty ())
+        return std::nullopt;
+    auto slash = str.find ('/');
+    gint64 num, denom;
+    if (slash != std::string_view::npos &&
+        parse_int (str.substr (0, slash), num) &&
+        parse_int (str.substr (slash + 1), denom) && denom > 0)
+        return gnc_numeric_create (num, denom);
+
+    gnc_numeric val;
+    if (!string_to_gnc_numeric (std::string {str}.c_str (), &val))
+        return std::nullopt;
+    return val;
+}
+
+GncTransLogReplay::GncTransLogReplay (QofBook *book) : m_book {book}
+{
+    if (!book)
+        throw std::invalid_argument {"GncTransLogReplay needs a book."};
+}
+
+void
+GncTransLogReplay::read (const std::string& filename)
+{
+    std::ifstream log;
+    log.open (filename, std::ios_base::in | std::ios_base::binary);
+    if (!log)
+    {
+        /* Translators: First argument is the filename,
+         * second argument is the error. */
+        auto msg = g_strdup_printf (_("Failed to open log file: %s: %s"),
+                                    filename.c_str (), g_strerror (errno));
+        std::runtime_error err {msg};
+        g_free (msg);
+        throw err;
+    }
+    read (log);
+}
+
+void
+GncTransLogReplay::read (std::istream& log)
+{
+    std::string line;
+    if (!std::getline (log, line))
+        throw std::runtime_error {_("The log file you selected was empty.")};
+    if (!starts_with (line, log_header))
+    {
+        PERR ("File header not recognised:\n%s", line.c_str ());
+        throw std::runtime_error {_("The log file you selected cannot be read. "
+                                    "The file header was not recognized.")};
+    }
+
+    ENTER ("");
+    /* The record being read, if one has started. */
+    auto in_record = false;
+    auto flag = '\0';
+    std::optional<LogTrans> trans;
+    /* TransLog doesn't escape newlines in notes, so a line with too few
+     * fields is continued by the next one. */
+    std::string partial;
+    LogFields fields;
+
+    while (std::getline (log, line))
+    {
+        if (starts_with (line, record_start))
+        {
+            if (in_record)
+                ++m_incomplete;
+            in_record = true;
+            flag = '\0';
+            trans.reset ();
+            partial.clear ();
+            continue;
+        }
+        if (!in_record)
+            continue;
+        if (starts_with (line, record_end))
+        {
+            if (!partial.empty ())
+                PWARN ("Dropping a record line with too few fields");
+            partial.clear ();
+            if (trans)
+                add (std::move (*trans));
+            ++m_records;
+            in_record = false;
+            continue;
+        }
+
+        if (!partial.empty ())
+        {
+            partial.push_back ('\n');
+            partial.append (line);
+            line.swap (partial);
+            partial.clear ();
+        }
+        auto count = split_fields (line, fields);
+        if (count < NUM_LOG_FIELDS)
+        {
+            partial.swap (line);
+            continue;
+        }
+        if (count > NUM_LOG_FIELDS)
+            PWARN ("Ignoring %zu extra fields", count - NUM_LOG_FIELDS);
+
+        /* All lines of a record are for the same transaction and have
+         * the same flag. Begin edit and rollback records are skipped. */
+        if (!flag)
+            flag = fields[FLAG].empty () ? ' ' : fields[FLAG].front ();
+        if (flag != 'C' && flag != 'D')
+            continue;
+
+        if (!trans)
+        {
+            auto guid = parse_guid (fields[TRANS_GUID]);
+            if (!guid)
+            {
+                PERR ("Corrupted record: bad transaction guid");
+                flag = ' ';
+                continue;
+            }
+            trans = LogTrans {*guid, flag == 'D',
+                              parse_time (fields[DATE_ENTERED]),
+                              parse_time (fields[DATE_POSTED]),
+                              std::string {fields[NUM]},
+                              std::string {fields[DESCRIPTION]},
+                              std::string {fields[NOTES]}, {}};
+        }
+        if (trans->deleted)
+            continue;
+
+        auto split_guid = parse_guid (fields[SPLIT_GUID]);
+        if (!split_guid)
+        {
+            PERR ("Corrupted record: bad split guid");
+            continue;
+        }
+        trans->splits.push_back ({*split_guid, parse_guid (fields[ACC_GUID]),
+                                  std::string {fields[MEMO]},
+                                  std::string {fields[ACTION]},
+                                  fields[RECONCILED].empty () ? NREC :
+                                  fields[RECONCILED].front (),
+                                  parse_numeric (fields[AMOUNT]),
+                                  parse_numeric (fields[VALUE]),
+                                  parse_time (fields[DATE_RECONCILED])});
+    }
+    if (in_record)
+        ++m_incomplete;
+    LEAVE ("%zu records, %zu transactions, %zu incomplete", m_records,
+           m_trans.size (), m_incomplete);
+}
+
+void
+GncTransLogReplay::add (LogTrans&& trans)
+{
+    auto [pos, inserted] = m_trans_pos.emplace (trans.guid, m_trans.size ());
+    if (inserted)
+    {
+        m_trans.push_back (std::move (trans));
+        m_last_record.push_back (m_records);
+    }
+    else
+    {
+        m_trans[pos->second] = std::move (trans);
+        m_last_record[pos->second] = m_records;
+    }
+}
+
+GncTransLogReplayCounts
+GncTransLogReplay::apply ()
+{
+    ENTER ("%zu transactions", m_trans.size ());
+    GncTransLogReplayCounts counts;
+
+    std::unordered_map<GncGUID, Account*> account_cache;
+    auto lookup_account = [this, &account_cache](const GncGUID& guid)
+    {
+        auto [pos, inserted] = account_cache.emplace (guid, nullptr);
+        if (inserted)
+        {
+            pos->second = xaccAccountLookup (&guid, m_book);
+            if (!pos->second)
+            {
+                char buff[GUID_ENCODING_LENGTH + 1];
+                guid_to_string_buff (&guid, buff);
+                PWARN ("Account %s is not in the book", buff);
+            }
+        }
+        return pos->second;
+    };
+
+    /* Hold every touched account open so that each is sorted and has
+     * its balances computed once, after the last transaction. */
+    std::vector<Account*> accounts;
+    std::unordered_set<Account*> seen;
+    auto begin_edit = [&accounts, &seen](Account *acc)
+    {
+        if (!acc || !seen.insert (acc).second)
+            return;
+        xaccAccountBeginEdit (acc);
+        gnc_account_set_defer_bal_computation (acc, TRUE);
+        accounts.push_back (acc);
+    };
+    auto begin_edit_accounts = [&begin_edit](Transaction *trans)
+    {
+        for (auto node = xaccTransGetSplitList (trans); node; node = g_list_next (node))
+            begin_edit (xaccSplitGetAccount (static_cast<Split*>(node->data)));
+    };
+
+    /* A split may have moved from one transaction to another, so they
+     * must be applied in the order they were last committed. */
+    std::vector<size_t> order (m_trans.size ());
+    std::iota (order.begin (), order.end (), 0);
+    std::sort (order.begin (), order.end (), [this](size_t a, size_t b)
+               { return m_last_record[a] < m_last_record[b]; });
+
+    /* Don't log the replay, it would only repeat the log. */
+    xaccLogDisable ();
+    qof_event_begin_batch ();
+    for (auto pos : order)
+    {
+        const auto& log_trans = m_trans[pos];
+        auto trans = xaccTransLookup (&log_trans.guid, m_book);
+        if (log_trans.deleted)
+        {
+            if (!trans)
+            {
+                ++counts.not_found;
+                continue;
+            }
+            begin_edit_accounts (trans);
+            if (xaccTransGetReadOnly (trans))
+            {
+                PWARN ("Destroying a read only transaction.");
+                xaccTransClearReadOnly (trans);
+            }
+            xaccTransDestroy (trans);
+            ++counts.deleted;
+            continue;
+        }
+
+        std::string read_only;
+        if (trans)
+        {
+            begin_edit_accounts (trans);
+            xaccTransBeginEdit (trans);
+            if (auto reason = xaccTransGetReadOnly (trans))
+            {
+                PWARN ("Replaying a read only transaction.");
+                read_only = reason;
+                xaccTransClearReadOnly (trans);
+            }
+            ++counts.changed;
+        }
+        else
+        {
+            trans = xaccMallocTransaction (m_book);
+            xaccTransBeginEdit (trans);
+            qof_instance_set_guid (trans, &log_trans.guid);
+            ++counts.created;
+        }
+
+        if (log_trans.date_entered)
+            xaccTransSetDateEnteredSecs (trans, *log_trans.date_entered);
+        if (log_trans.date_posted)
+            xaccTransSetDatePostedSecs (trans, *log_trans.date_posted);
+        xaccTransSetNum (trans, log_trans.num.c_str ());
+        xaccTransSetDescription (trans, log_trans.description.c_str ());
+        if (!log_trans.notes.empty () || xaccTransGetNotes (trans))
+            xaccTransSetNotes (trans, log_trans.notes.c_str ());
+
+        std::unordered_set<Split*> logged;
+        for (const auto& log_split : log_trans.splits)
+        {
+            auto split = xaccSplitLookup (&log_split.guid, m_book);
+            if (split)
+            {
+                begin_edit (xaccSplitGetAccount (split));
+            }
+            else
+            {
+                split = xaccMallocSplit (m_book);
+                qof_instance_set_guid (split, &log_split.guid);
+            }
+            if (xaccSplitGetParent (split) != trans)
+                xaccSplitSetParent (split, trans);
+            logged.insert (split);
+
+            if (log_split.account)
+            {
+                if (auto acc = lookup_account (*log_split.account))
+                {
+                    begin_edit (acc);
+                    xaccSplitSetAccount (split, acc);
+                    /* The log doesn't have the currency, but it's needed
+                     * before setting the value. */
+                    if (!xaccTransGetCurrency (trans))
+                        xaccTransSetCurrency (trans, gnc_account_get_currency_or_parent (acc));
+                }
+            }
+            xaccSplitSetMemo (split, log_split.memo.c_str ());
+            xaccSplitSetAction (split, log_split.action.c_str ());
+            if (log_split.date_reconciled)
+                xaccSplitSetDateReconciledSecs (split, *log_split.date_reconciled);
+            xaccSplitSetReconcile (split, log_split.reconcile);
+            if (log_split.amount)
+                xaccSplitSetAmount (split, *log_split.amount);
+            if (log_split.value)
+                xaccSplitSetValue (split, *log_split.value);
+        }
+
+        /* Splits removed before the transaction was last committed. */
+        std::vector<Split*> removed;
+        for (auto node = xaccTransGetSplitList (trans); node; node = g_list_next (node))
+        {
+            auto split = static_cast<Split*>(node->data);
+            if (xaccTransStillHasSplit (trans, split) && !logged.count (split))
+                removed.push_back (split);
+        }
+        for (auto split : removed)
+            xaccSplitDestroy (split);
+
+        xaccTransScrubCurrency (trans);
+        if (!read_only.empty ())
+            xaccTransSetReadOnly (trans, read_only.c_str ());
+        xaccTransCommitEdit (trans);
+    }
+    m_trans.clear ();
+    m_last_record.clear ();
+    m_trans_pos.clear ();
+
+    for (auto acc : accounts)
+    {
+        gnc_account_set_defer_bal_computation (acc, FALSE);
+        xaccAccountCommitEdit (acc);
+    }
+    qof_event_end_batch ();
+    xaccLogEnable ();
+
+    LEAVE ("%zu created, %zu changed, %zu deleted, %zu not found",
+           counts.created, counts.changed, counts.deleted, counts.not_found);
+    return counts;
+}
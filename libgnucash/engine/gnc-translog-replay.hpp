@@ -0,0 +1,139 @@
+/********************************************************************\
+ * gnc-translog-replay.hpp -- Replay transaction log files.         *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+/** @addtogroup Engine
+    @{ */
+/** @file gnc-translog-replay.hpp
+ *  @brief Bring a book up to date from the .log files TransLog writes.
+ *
+ *  Every commit record in a transaction log holds the complete
+ *  transaction as it was committed, so only the last commit or delete
+ *  record of each transaction matters. GncTransLogReplay streams one or
+ *  more log files, keeping just that last state per transaction GUID,
+ *  and then applies them all at once with the touched accounts held
+ *  open for edit, as GncBulkLoader does.
+ *
+ *  Begin edit and rollback records don't change anything and are
+ *  ignored. A record cut short by a crash, with no end line, is
+ *  dropped.
+ *
+ *  Transactions get exactly the splits of their last commit record:
+ *  splits an existing transaction has but the record hasn't are
+ *  destroyed. Accounts aren't logged, so a split whose account isn't
+ *  in the book is left without one.
+ */
+
+#ifndef GNC_TRANSLOG_REPLAY_HPP
+#define GNC_TRANSLOG_REPLAY_HPP
+
+#include "Account.h"
+#include "Transaction.h"
+#include "guid.hpp"
+
+#include <istream>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/** What GncTransLogReplay::apply() did. */
+struct GncTransLogReplayCounts
+{
+    size_t created = 0;     /**< Transactions not in the book. */
+    size_t changed = 0;     /**< Transactions overwritten. */
+    size_t deleted = 0;     /**< Transactions destroyed. */
+    size_t not_found = 0;   /**< Transactions to delete that weren't in
+                                 the book. */
+};
+
+class GncTransLogReplay
+{
+public:
+    explicit GncTransLogReplay (QofBook *book);
+    GncTransLogReplay (const GncTransLogReplay&) = delete;
+    GncTransLogReplay& operator= (const GncTransLogReplay&) = delete;
+
+    /** Read a log file. Reading several files must be done in the order
+     *  they were written.
+     *  @exception std::runtime_error with a translated message if the
+     *  file can't be opened, is empty or isn't a transaction log. */
+    void read (const std::string& filename);
+
+    /** Read a log from a stream, as read(const std::string&). */
+    void read (std::istream& log);
+
+    /** @return the number of records read, of all kinds. */
+    size_t records () const noexcept { return m_records; }
+
+    /** @return the number of records dropped because they had no end
+     *  line. */
+    size_t incomplete () const noexcept { return m_incomplete; }
+
+    /** @return the number of distinct transactions to apply. */
+    size_t size () const noexcept { return m_trans.size (); }
+
+    /** Apply the last state of every transaction read, in the order of
+     *  their last records, and forget them. Logging is disabled while
+     *  doing it, and enabled afterwards.
+     *  @return what was done. */
+    GncTransLogReplayCounts apply ();
+
+    /** A split as its transaction's last commit record has it. Fields
+     *  the log left empty are unset. */
+    struct LogSplit
+    {
+        GncGUID guid;
+        std::optional<GncGUID> account;
+        std::string memo;
+        std::string action;
+        char reconcile;
+        std::optional<gnc_numeric> amount;
+        std::optional<gnc_numeric> value;
+        std::optional<time64> date_reconciled;
+    };
+
+    /** The last state of a transaction in the logs read. */
+    struct LogTrans
+    {
+        GncGUID guid;
+        bool deleted;
+        std::optional<time64> date_entered;
+        std::optional<time64> date_posted;
+        std::string num;
+        std::string description;
+        std::string notes;
+        std::vector<LogSplit> splits;
+    };
+
+private:
+    void add (LogTrans&& trans);
+
+    QofBook *m_book;
+    std::vector<LogTrans> m_trans;
+    /* The number of the last record of each of m_trans. */
+    std::vector<size_t> m_last_record;
+    std::unordered_map<GncGUID, size_t> m_trans_pos;
+    size_t m_records = 0;
+    size_t m_incomplete = 0;
+};
+
+#endif /* GNC_TRANSLOG_REPLAY_HPP */
+/** @} */
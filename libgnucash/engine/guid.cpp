@@ -54,8 +54,10 @@
 #include <boost/uuid/uuid.hpp>
 #include <boost/uuid/uuid_generators.hpp>
 #include <boost/uuid/uuid_io.hpp>
+#include <array>
 #include <sstream>
 #include <string>
+#include <string_view>
 
 /* This static indicates the debugging module that this .o belongs to.  */
 static QofLogModule log_module = QOF_MOD_ENGINE;
@@ -86,6 +88,63 @@ GncGUID * guid_convert_create (gnc::GUID const &);
 static gnc::GUID s_null_guid {boost::uuids::uuid { {0}}};
 static GncGUID * s_null_gncguid {guid_convert_create (s_null_guid)};
 
+/* Hex encoding and decoding tables. GUIDs are written as 32 lower-case
+ * hex digits with no separators; anything else goes through boost's
+ * string_generator, which accepts dashes, braces and upper case. */
+static constexpr char hex_digits[] = "0123456789abcdef";
+static constexpr unsigned char not_hex = 0xff;
+
+static constexpr std::array<unsigned char, 256>
+make_hex_values ()
+{
+    std::array<unsigned char, 256> values {};
+    for (auto& val : values)
+        val = not_hex;
+    for (int i = 0; i < 10; ++i)
+        values['0' + i] = i;
+    for (int i = 0; i < 6; ++i)
+    {
+        values['a' + i] = 10 + i;
+        values['A' + i] = 10 + i;
+    }
+    return values;
+}
+
+static constexpr auto hex_values {make_hex_values ()};
+
+static void
+encode_hex (const unsigned char *bytes, char *str) noexcept
+{
+    for (size_t i = 0; i < GUID_DATA_SIZE; ++i)
+    {
+        *str++ = hex_digits[bytes[i] >> 4];
+        *str++ = hex_digits[bytes[i] & 0xf];
+    }
+    *str = '\0';
+}
+
+/* Returns false, leaving bytes alone, if str isn't exactly
+ * GUID_ENCODING_LENGTH hex digits. */
+static bool
+decode_hex (std::string_view str, unsigned char *bytes) noexcept
+{
+    if (str.size () != GUID_ENCODING_LENGTH)
+        return false;
+    unsigned char decoded[GUID_DATA_SIZE];
+    unsigned char bad = 0;
+    for (size_t i = 0; i < GUID_DATA_SIZE; ++i)
+    {
+        auto hi = hex_values[static_cast<unsigned char>(str[2 * i])];
+        auto lo = hex_values[static_cast<unsigned char>(str[2 * i + 1])];
+        bad |= (hi | lo) & 0xf0;
+        decoded[i] = (hi << 4) | (lo & 0xf);
+    }
+    if (bad)
+        return false;
+    memcpy (bytes, decoded, GUID_DATA_SIZE);
+    return true;
+}
+
 /* Memory management routines ***************************************/
 
 /**
@@ -163,9 +222,9 @@ gchar *
 guid_to_string (const GncGUID * guid)
 {
     if (!guid) return nullptr;
-    gnc::GUID temp {*guid};
-    auto temp_str = temp.to_string ();
-    return g_strdup (temp_str.c_str ());
+    auto ret = g_new (gchar, GUID_ENCODING_LENGTH + 1);
+    encode_hex (guid->reserved, ret);
+    return ret;
 }
 
 gchar *
@@ -173,19 +232,16 @@ guid_to_string_buff (const GncGUID * guid, gchar *str)
 {
     if (!str || !guid) return NULL;
 
-    gnc::GUID temp {*guid};
-    auto val = temp.to_string ();
-    /*We need to be sure to copy the terminating null character.
-     * The standard guarantees that std::basic_string::c_str ()
-     * returns with a terminating null character, too.*/
-    std::copy (val.c_str (), val.c_str () + val.size () + 1, str);
-    return str + val.size ();
+    encode_hex (guid->reserved, str);
+    return str + GUID_ENCODING_LENGTH;
 }
 
 gboolean
 string_to_guid (const char * str, GncGUID * guid)
 {
     if (!guid || !str) return false;
+    if (decode_hex (str, guid->reserved))
+        return true;
 
     try
     {
@@ -203,9 +259,7 @@ guid_equal (const GncGUID *guid_1, const GncGUID *guid_2)
 {
     if (!guid_1 || !guid_2)
         return !guid_1 && !guid_2;
-    gnc::GUID temp1 {*guid_1};
-    gnc::GUID temp2 {*guid_2};
-    return temp1 == temp2;
+    return memcmp (guid_1->reserved, guid_2->reserved, GUID_DATA_SIZE) == 0;
 }
 
 gint
@@ -213,13 +267,8 @@ guid_compare (const GncGUID *guid_1, const GncGUID *guid_2)
 {
     if (!guid_1 || !guid_2)
         return !guid_1 && !guid_2;
-    gnc::GUID temp1 {*guid_1};
-    gnc::GUID temp2 {*guid_2};
-    if (temp1 < temp2)
-        return -1;
-    if (temp1 == temp2)
-        return 0;
-    return 1;
+    auto cmp = memcmp (guid_1->reserved, guid_2->reserved, GUID_DATA_SIZE);
+    return cmp < 0 ? -1 : cmp > 0 ? 1 : 0;
 }
 
 guint
@@ -230,15 +279,14 @@ guid_hash_to_guint (gconstpointer ptr)
         PERR ("received NULL guid pointer.");
         return 0;
     }
-    GncGUID const & guid = * reinterpret_cast <GncGUID const *> (ptr);
-    gnc::GUID const & temp {guid};
-
-    guint hash {0};
-    std::for_each (temp.begin (), temp.end (), [&hash] (unsigned char a) {
-        hash <<=4;
-        hash |= a;
-    });
-    return hash;
+    /* Random GUIDs are already well mixed, so just fold the bits down.
+     * Folding all of them keeps sequential test GUIDs apart too. */
+    auto guid = reinterpret_cast <GncGUID const *> (ptr);
+    uint64_t lo, hi;
+    memcpy (&lo, guid->reserved, sizeof lo);
+    memcpy (&hi, guid->reserved + sizeof lo, sizeof hi);
+    auto folded = lo ^ hi;
+    return static_cast<guint> (folded ^ (folded >> 32));
 }
 
 gint
@@ -333,41 +381,42 @@ GUID::null_guid () noexcept
 std::string
 GUID::to_string () const noexcept
 {
-    auto const & val = boost::uuids::to_string (implementation);
-    std::string ret;
-    std::for_each (val.begin (), val.end (), [&ret] (char a) {
-        if (a != '-') ret.push_back (a);
-    });
-    return ret;
+    char buff[GUID_ENCODING_LENGTH + 1];
+    encode_hex (implementation.begin (), buff);
+    return {buff, GUID_ENCODING_LENGTH};
 }
 
-GUID
-GUID::from_string (std::string const & str)
+bool
+GUID::from_string (std::string_view str, GUID & guid) noexcept
 {
+    if (decode_hex (str, guid.implementation.begin ()))
+        return true;
     try
     {
         static boost::uuids::string_generator strgen;
-        return strgen (str);
+        guid.implementation = strgen (str.begin (), str.end ());
+        return true;
     }
     catch (...)
     {
-        throw guid_syntax_exception {};
+        return false;
     }
 }
 
+GUID
+GUID::from_string (std::string_view str)
+{
+    GUID ret;
+    if (!from_string (str, ret))
+        throw guid_syntax_exception {};
+    return ret;
+}
+
 bool
-GUID::is_valid_guid (std::string const & str)
+GUID::is_valid_guid (std::string_view str)
 {
-    try
-    {
-        static boost::uuids::string_generator strgen;
-        strgen (str);
-        return true;
-    }
-    catch (...)
-    {
-        return false;
-    }
+    GUID ignored;
+    return from_string (str, ignored);
 }
 
 guid_syntax_exception::guid_syntax_exception () noexcept
@@ -23,7 +23,9 @@
 #define GUID_HPP_HEADER
 
 #include <boost/uuid/uuid.hpp>
+#include <functional>
 #include <stdexcept>
+#include <string_view>
 
 #include "guid.h"
 
@@ -48,8 +50,11 @@ struct GUID
     operator GncGUID () const noexcept;
     static GUID create_random () noexcept;
     static GUID const & null_guid () noexcept;
-    static GUID from_string (std::string const &);
-    static bool is_valid_guid (std::string const &);
+    static GUID from_string (std::string_view);
+    /** Parse str into guid without throwing; returns false if str isn't
+     * a GUID, leaving guid unspecified. */
+    static bool from_string (std::string_view str, GUID & guid) noexcept;
+    static bool is_valid_guid (std::string_view);
     std::string to_string () const noexcept;
     auto begin () const noexcept -> decltype (implementation.begin ());
     auto end () const noexcept -> decltype (implementation.end ());
@@ -65,4 +70,16 @@ bool operator == (GUID const &, GncGUID const &) noexcept;
 } // namespace gnc
 
 bool operator== (const GncGUID&, const GncGUID&);
+
+namespace std
+{
+template<>
+struct hash<GncGUID>
+{
+    size_t operator() (const GncGUID& guid) const noexcept
+    {
+        return guid_hash_to_guint (&guid);
+    }
+};
+} // namespace std
 #endif
@@ -144,6 +144,16 @@ xaccQueryAddSingleAccountMatch(QofQuery *query, Account *acc, QofQueryOp op)
     ((QofFakeQuery*)query)->add_single_account_match(acc, op);
 }
 
+void
+xaccQueryAddAccountMatch(QofQuery *query, AccountList *acct_list,
+                         QofGuidMatch how, QofQueryOp op)
+{
+    ASSERT_TRUE(queryPool.query_used(query));
+    std::vector<Account*> accounts;
+    for (auto node = acct_list; node; node = g_list_next(node))
+        accounts.push_back(static_cast<Account*>(node->data));
+    ((QofFakeQuery*)query)->add_account_match(accounts, how, op);
+}
 
 GList *
 qof_query_run (QofQuery *query)
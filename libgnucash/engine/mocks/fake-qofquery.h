@@ -60,6 +60,7 @@ public:
     MOCK_METHOD1(set_book, void(QofBook*));
     MOCK_METHOD5(add_date_match_tt, void(gboolean, time64, gboolean, time64, QofQueryOp));
     MOCK_METHOD2(add_single_account_match, void(Account*, QofQueryOp));
+    MOCK_METHOD3(add_account_match, void(std::vector<Account*>, QofGuidMatch, QofQueryOp));
     MOCK_METHOD0(run, std::vector<void*>());
 
     QofIdTypeConst m_obj_type;
@@ -21,10 +21,61 @@ gnc_mocksplit_init (MockSplit *inst)
     // function is unused, initialization is done in the MockSplit's C++ constructor
 }
 
+enum
+{
+    PROP_0,
+    PROP_ONLINE_ID,
+};
+
+// The import code keeps the online id of a split in its "online-id"
+// property, so mock splits hold it as object data.
+static void
+gnc_mocksplit_get_property (GObject *object, guint prop_id, GValue *value,
+                            GParamSpec *pspec)
+{
+    switch (prop_id)
+    {
+    case PROP_ONLINE_ID:
+        g_value_set_string (value, static_cast<const char*>(g_object_get_data (object, "online-id")));
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+        break;
+    }
+}
+
+static void
+gnc_mocksplit_set_property (GObject *object, guint prop_id, const GValue *value,
+                            GParamSpec *pspec)
+{
+    switch (prop_id)
+    {
+    case PROP_ONLINE_ID:
+        g_object_set_data_full (object, "online-id", g_value_dup_string (value), g_free);
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+        break;
+    }
+}
+
 static void
 gnc_mocksplit_class_init (MockSplitClass *klass)
 {
-    // function is unused, class functions are defined in C++ code
+    // other class functions are defined in C++ code
+    GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+    gobject_class->get_property = gnc_mocksplit_get_property;
+    gobject_class->set_property = gnc_mocksplit_set_property;
+
+    g_object_class_install_property
+    (gobject_class,
+     PROP_ONLINE_ID,
+     g_param_spec_string ("online-id",
+                          "Online ID",
+                          "The online id of the split.",
+                          nullptr,
+                          G_PARAM_READWRITE));
 }
 
 
@@ -163,3 +214,11 @@ xaccSplitSetParent(Split *split, Transaction *trans)
     ASSERT_TRUE(GNC_IS_TRANSACTION(trans));
     gnc_mocksplit(split)->set_parent(trans);
 }
+
+Split *
+xaccSplitLookup (const GncGUID *guid, QofBook *book)
+{
+    SCOPED_TRACE("");
+    QofMockBook* mockbook = qof_mockbook(book);
+    return mockbook ? mockbook->lookup_split(guid) : nullptr;
+}
@@ -34,3 +34,23 @@ qof_book_use_split_action_for_num_field (const QofBook *book)
     return mockbook ? mockbook->use_split_action_for_num_field() : FALSE;
 }
 
+// This is a reimplementation of the function from qofbook.cpp. Mock
+// books aren't finalized, so neither is their data.
+void
+qof_book_set_data_fin (QofBook *book, const char *key, gpointer data,
+                       QofBookFinalCB cb)
+{
+    ASSERT_TRUE (QOF_IS_MOCKBOOK (book));
+    if (!book->data_tables)
+        book->data_tables = g_hash_table_new (g_str_hash, g_str_equal);
+    g_hash_table_insert (book->data_tables, (gpointer)key, data);
+}
+
+// This is a reimplementation of the function from qofbook.cpp
+gpointer
+qof_book_get_data (const QofBook *book, const char *key)
+{
+    if (!book || !key || !book->data_tables)
+        return nullptr;
+    return g_hash_table_lookup (book->data_tables, (gpointer)key);
+}
@@ -51,6 +51,7 @@ public:
     }
 
     MOCK_METHOD0(malloc_split, Split *());
+    MOCK_METHOD1(lookup_split, Split *(const GncGUID *));
     MOCK_CONST_METHOD0(use_split_action_for_num_field, gboolean());
 
 protected:
@@ -45,3 +45,20 @@ qof_instance_set (QofInstance *inst, const gchar *first_prop, ...)
     va_end (ap);
 }
 
+// Mock instances have no private data, so each one is given a new GUID
+// the first time it is asked for.
+const GncGUID *
+qof_entity_get_guid (gconstpointer ent)
+{
+    if (!ent)
+        return guid_null ();
+    auto object = G_OBJECT (ent);
+    auto guid = static_cast<GncGUID*>(g_object_get_data (object, "mock-guid"));
+    if (!guid)
+    {
+        guid = guid_new ();
+        g_object_set_data_full (object, "mock-guid", guid,
+                                (GDestroyNotify)guid_free);
+    }
+    return guid;
+}
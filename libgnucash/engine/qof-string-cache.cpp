@@ -34,46 +34,83 @@
 #include <string.h>
 #include "qof.h"
 
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+
 /* Uncomment if you need to log anything.
 static QofLogModule log_module = QOF_MOD_UTIL;
 */
 /* =================================================================== */
 /* The QOF string cache                                                */
 /*                                                                     */
-/* The cache is a GHashTable where a copy of the string is the key,    */
-/* and a ref count is the value                                        */
+/* The cache is split into shards by the string's hash so that threads */
+/* interning different strings rarely contend. Each shard maps a view  */
+/* of the cached copy to its entry. Finding a string and bumping its   */
+/* refcount only needs the shard's shared lock; adding a new string or */
+/* dropping the last reference to one needs the exclusive lock.        */
 /* =================================================================== */
 
-static GHashTable* qof_string_cache = NULL;
+namespace
+{
 
-static GHashTable*
-qof_get_string_cache(void)
+struct CacheEntry
 {
-    if (!qof_string_cache)
-    {
-        qof_string_cache = g_hash_table_new_full(
-                               g_str_hash,               /* hash_func          */
-                               g_str_equal,              /* key_equal_func     */
-                               g_free,                   /* key_destroy_func   */
-                               g_free);                  /* value_destroy_func */
-    }
-    return qof_string_cache;
+    CacheEntry (std::unique_ptr<char[]>&& s) : str {std::move (s)} {}
+    std::unique_ptr<char[]> str;
+    std::atomic<guint> refcount {1};
+};
+
+struct CacheShard
+{
+    std::shared_mutex mutex;
+    std::unordered_map<std::string_view, CacheEntry> entries;
+};
+
+constexpr size_t shard_bits = 6;
+constexpr size_t num_shards = 1 << shard_bits;
+
+using StringCache = std::array<CacheShard, num_shards>;
+
+/* Never freed, so that strings can still be removed from static
+ * destructors that run after this file's. */
+StringCache&
+get_cache ()
+{
+    static auto cache = new StringCache;
+    return *cache;
+}
+
+CacheShard&
+get_shard (std::string_view key)
+{
+    /* The shard's map hashes the key again; use the high bits here so
+     * the two don't pick the same buckets. */
+    auto hash = std::hash<std::string_view> {} (key);
+    return get_cache ()[hash >> (sizeof (hash) * 8 - shard_bits)];
 }
 
+} // anonymous namespace
+
 void
 qof_string_cache_init(void)
 {
-    (void)qof_get_string_cache();
+    (void)get_cache();
 }
 
 void
 qof_string_cache_destroy (void)
 {
-    if (qof_string_cache)
+    for (auto& shard : get_cache ())
     {
-        g_hash_table_destroy(qof_string_cache);
+        std::unique_lock lock {shard.mutex};
+        shard.entries.clear ();
     }
-    qof_string_cache = NULL;
 }
 
 /* If the key exists in the cache, check the refcount.  If 1, just
@@ -81,56 +118,71 @@ qof_string_cache_destroy (void)
 void
 qof_string_cache_remove(const char * key)
 {
-    if (key && key[0] != 0)
+    if (!key || key[0] == 0)
+        return;
+
+    std::string_view view {key};
+    auto& shard = get_shard (view);
     {
-        GHashTable* cache = qof_get_string_cache();
-        gpointer value;
-        gpointer cache_key;
-        if (g_hash_table_lookup_extended(cache, key, &cache_key, &value))
-        {
-            guint* refcount = (guint*)value;
-            if (*refcount == 1)
-            {
-                g_hash_table_remove(cache, key);
-            }
-            else
-            {
-                --(*refcount);
-            }
-        }
+        std::shared_lock lock {shard.mutex};
+        auto iter = shard.entries.find (view);
+        if (iter == shard.entries.end ())
+            return;
+        auto& refcount = iter->second.refcount;
+        for (auto count = refcount.load (); count > 1; )
+            if (refcount.compare_exchange_weak (count, count - 1))
+                return;
     }
+
+    /* This may be the last reference. Inserts of an existing string
+     * hold the shared lock, so under the exclusive lock the count is
+     * stable. */
+    std::unique_lock lock {shard.mutex};
+    auto iter = shard.entries.find (view);
+    if (iter != shard.entries.end () && --iter->second.refcount == 0)
+        shard.entries.erase (iter);
 }
 
 /* If the key exists in the cache, increment the refcount.  Otherwise,
  * add it with a refcount of 1. */
 const char *
-qof_string_cache_insert(const char * key)
+qof_string_cache_insert (std::string_view key)
 {
-    if (key)
+    if (key.empty ())
+        return "";
+
+    auto& shard = get_shard (key);
     {
-        if (key[0] == 0)
+        std::shared_lock lock {shard.mutex};
+        auto iter = shard.entries.find (key);
+        if (iter != shard.entries.end ())
         {
-            return "";
+            ++iter->second.refcount;
+            return iter->second.str.get ();
         }
+    }
 
-        GHashTable* cache = qof_get_string_cache();
-        gpointer value;
-        gpointer cache_key;
-        if (g_hash_table_lookup_extended(cache, key, &cache_key, &value))
-        {
-            guint* refcount = (guint*)value;
-            ++(*refcount);
-            return static_cast <char *> (cache_key);
-        }
-        else
-        {
-            gpointer new_key = g_strdup(static_cast<const char*>(key));
-            guint* refcount = static_cast<unsigned int*>(g_malloc(sizeof(guint)));
-            *refcount = 1;
-            g_hash_table_insert(cache, new_key, refcount);
-            return static_cast <char *> (new_key);
-        }
+    std::unique_lock lock {shard.mutex};
+    auto iter = shard.entries.find (key);
+    if (iter != shard.entries.end ())
+    {
+        ++iter->second.refcount;
+        return iter->second.str.get ();
     }
+    auto str = std::make_unique<char[]> (key.size () + 1);
+    std::copy (key.begin (), key.end (), str.get ());
+    std::string_view cached {str.get (), key.size ()};
+    iter = shard.entries.emplace (std::piecewise_construct,
+                                  std::forward_as_tuple (cached),
+                                  std::forward_as_tuple (std::move (str))).first;
+    return iter->second.str.get ();
+}
+
+const char *
+qof_string_cache_insert(const char * key)
+{
+    if (key)
+        return qof_string_cache_insert (std::string_view {key});
     return NULL;
 }
 
@@ -66,7 +66,7 @@ extern "C"
  * Note that all the work is done when inserting or removing.  Once
  * cached the strings are just plain C strings.
  *
- * The string cache is demand-created on first use.
+ * The cache may be used from several threads at once.
  *
  **/
 
@@ -110,6 +110,11 @@ const char * qof_string_cache_replace(const char * dst, const char * src);
 
 #ifdef __cplusplus
 }
+
+#include <string_view>
+
+/** Insert a string that need not be nul-terminated. */
+const char * qof_string_cache_insert(std::string_view key);
 #endif
 
 #endif /* QOF_STRING_CACHE_H */
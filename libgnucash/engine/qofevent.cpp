@@ -28,6 +28,19 @@
 #include "qof.h"
 #include "qofevent-p.h"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 /* Static Variables ************************************************/
 static guint   suspend_counter   = 0;
 static gint    next_handler_id   = 1;
@@ -38,8 +51,197 @@ static GList   *handlers  =   NULL;
 /* This static indicates the debugging module that this .o belongs to.  */
 static QofLogModule log_module = QOF_MOD_ENGINE;
 
+/* Typed handlers, indexed by entity type. The all-types table has the
+ * empty key. Everything here is only touched from the thread that
+ * generates events. */
+struct TypedHandler
+{
+    gint handler_id;
+    std::string_view type;
+    QofEventId mask;
+    QofEventDelivery delivery;
+    QofEventHandler handler;
+    gpointer user_data;
+};
+
+using TypedHandlerVec = std::vector<TypedHandler*>;
+
+static std::unordered_set<std::string> type_names;
+static std::unordered_map<std::string_view, TypedHandlerVec> typed_tables;
+static std::vector<std::unique_ptr<TypedHandler>> typed_handlers;
+static QofEventId batched_mask = 0;
+/* Ids of the typed and background handlers. */
+static std::unordered_set<gint> typed_ids;
+
+/* Background handlers are called on the worker thread. The worker reads
+ * them through a snapshot that is replaced on every change, so
+ * registration never waits for a running handler. */
+struct BackgroundHandler
+{
+    gint handler_id;
+    std::string type;
+    QofEventId mask;
+    QofEventBackgroundHandler handler;
+    gpointer user_data;
+    std::atomic<bool> alive{true};
+};
+
+using BackgroundHandlerPtr = std::shared_ptr<BackgroundHandler>;
+using BackgroundHandlerList = std::vector<BackgroundHandlerPtr>;
+
+struct BackgroundEvent
+{
+    GncGUID guid;
+    QofIdTypeConst type;
+    QofEventId event_id;
+};
+
+class EventWorker
+{
+public:
+    ~EventWorker ();
+    void add (BackgroundHandlerPtr handler);
+    bool remove (gint handler_id);
+    void push (const BackgroundEvent& event);
+    void flush ();
+    QofEventId mask () const { return m_mask; }
+private:
+    void run ();
+    std::mutex m_mutex;
+    std::mutex m_delivery_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    std::deque<BackgroundEvent> m_queue;
+    std::shared_ptr<const BackgroundHandlerList> m_handlers
+        {std::make_shared<BackgroundHandlerList>()};
+    std::thread m_thread;
+    std::atomic<QofEventId> m_mask{0};
+    bool m_busy = false;
+    bool m_stop = false;
+};
+
+static EventWorker event_worker;
+
+/* Events coalesced per entity for batched and background handlers. */
+struct PendingEvent
+{
+    QofInstance *entity;
+    QofEventId event_id;
+};
+
+static guint batch_level = 0;
+static std::vector<PendingEvent> pending_events;
+static std::unordered_map<QofInstance*, size_t> pending_index;
+
 /* Implementations *************************************************/
 
+EventWorker::~EventWorker ()
+{
+    {
+        std::lock_guard<std::mutex> lock (m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all ();
+    if (m_thread.joinable ())
+        m_thread.join ();
+}
+
+void
+EventWorker::add (BackgroundHandlerPtr handler)
+{
+    std::lock_guard<std::mutex> lock (m_mutex);
+    auto handlers = std::make_shared<BackgroundHandlerList>(*m_handlers);
+    m_mask |= handler->mask;
+    handlers->push_back (std::move (handler));
+    m_handlers = std::move (handlers);
+    if (!m_thread.joinable ())
+        m_thread = std::thread (&EventWorker::run, this);
+}
+
+bool
+EventWorker::remove (gint handler_id)
+{
+    BackgroundHandlerPtr removed;
+    {
+        std::lock_guard<std::mutex> lock (m_mutex);
+        auto handlers = std::make_shared<BackgroundHandlerList>(*m_handlers);
+        auto iter = std::find_if (handlers->begin (), handlers->end (),
+                                  [handler_id](const auto& handler)
+                                  { return handler->handler_id == handler_id; });
+        if (iter == handlers->end ())
+            return false;
+        removed = *iter;
+        removed->alive = false;
+        handlers->erase (iter);
+        QofEventId mask = 0;
+        for (const auto& handler : *handlers)
+            mask |= handler->mask;
+        m_mask = mask;
+        m_handlers = std::move (handlers);
+    }
+    /* Wait out a call of the handler that is already running, unless
+     * it is the one unregistering itself. */
+    if (std::this_thread::get_id () != m_thread.get_id ())
+    {
+        std::lock_guard<std::mutex> delivery (m_delivery_mutex);
+    }
+    return true;
+}
+
+void
+EventWorker::push (const BackgroundEvent& event)
+{
+    {
+        std::lock_guard<std::mutex> lock (m_mutex);
+        m_queue.push_back (event);
+    }
+    m_wake.notify_one ();
+}
+
+void
+EventWorker::flush ()
+{
+    std::unique_lock<std::mutex> lock (m_mutex);
+    if (std::this_thread::get_id () == m_thread.get_id ())
+        return;
+    m_idle.wait (lock, [this]{ return m_queue.empty () && !m_busy; });
+}
+
+void
+EventWorker::run ()
+{
+    std::unique_lock<std::mutex> lock (m_mutex);
+    while (true)
+    {
+        m_wake.wait (lock, [this]{ return m_stop || !m_queue.empty (); });
+        if (m_queue.empty ())
+            break;
+
+        auto event = m_queue.front ();
+        m_queue.pop_front ();
+        auto handlers = m_handlers;
+        m_busy = true;
+        lock.unlock ();
+
+        for (const auto& handler : *handlers)
+        {
+            if (!(handler->mask & event.event_id) ||
+                (!handler->type.empty () && handler->type != event.type))
+                continue;
+            std::lock_guard<std::mutex> delivery (m_delivery_mutex);
+            if (handler->alive)
+                handler->handler (&event.guid, event.type,
+                                  event.event_id & handler->mask,
+                                  handler->user_data);
+        }
+
+        lock.lock ();
+        m_busy = false;
+        if (m_queue.empty ())
+            m_idle.notify_all ();
+    }
+}
+
 static gint
 find_next_handler_id(void)
 {
@@ -64,6 +266,8 @@ find_next_handler_id(void)
 
         node = node->next;
     }
+    while (typed_ids.count (handler_id))
+        handler_id++;
     /* Update id for next registration */
     next_handler_id = handler_id + 1;
     return handler_id;
@@ -99,6 +303,120 @@ qof_event_register_handler (QofEventHandler handler, gpointer user_data)
     return handler_id;
 }
 
+static std::string_view
+intern_type (QofIdTypeConst type)
+{
+    return *type_names.emplace (type ? type : "").first;
+}
+
+static void
+update_batched_mask (void)
+{
+    batched_mask = 0;
+    for (const auto& hi : typed_handlers)
+        if (hi->handler && hi->delivery == QOF_EVENT_DELIVER_BATCHED)
+            batched_mask |= hi->mask;
+}
+
+gint
+qof_event_register_typed_handler (QofIdTypeConst type, QofEventId event_mask,
+                                  QofEventDelivery delivery,
+                                  QofEventHandler handler, gpointer user_data)
+{
+    ENTER ("(type=%s, mask=%d, handler=%p, data=%p)", type ? type : "(all)",
+           event_mask, handler, user_data);
+
+    if (!handler)
+    {
+        PERR ("no handler specified");
+        return 0;
+    }
+
+    auto hi = std::make_unique<TypedHandler>();
+    hi->handler_id = find_next_handler_id ();
+    typed_ids.insert (hi->handler_id);
+    hi->type = intern_type (type);
+    hi->mask = event_mask;
+    hi->delivery = delivery;
+    hi->handler = handler;
+    hi->user_data = user_data;
+
+    typed_tables[hi->type].push_back (hi.get ());
+    typed_handlers.push_back (std::move (hi));
+    update_batched_mask ();
+
+    auto handler_id = typed_handlers.back ()->handler_id;
+    LEAVE ("handler_id=%d", handler_id);
+    return handler_id;
+}
+
+gint
+qof_event_register_background_handler (QofIdTypeConst type,
+                                       QofEventId event_mask,
+                                       QofEventBackgroundHandler handler,
+                                       gpointer user_data)
+{
+    ENTER ("(type=%s, mask=%d, handler=%p, data=%p)", type ? type : "(all)",
+           event_mask, handler, user_data);
+
+    if (!handler)
+    {
+        PERR ("no handler specified");
+        return 0;
+    }
+
+    auto handler_id = find_next_handler_id ();
+    typed_ids.insert (handler_id);
+
+    auto hi = std::make_shared<BackgroundHandler>();
+    hi->handler_id = handler_id;
+    hi->type = type ? type : "";
+    hi->mask = event_mask;
+    hi->handler = handler;
+    hi->user_data = user_data;
+    event_worker.add (std::move (hi));
+
+    LEAVE ("handler_id=%d", handler_id);
+    return handler_id;
+}
+
+static void
+purge_typed_handlers (void)
+{
+    for (auto iter = typed_tables.begin (); iter != typed_tables.end ();)
+    {
+        auto& table = iter->second;
+        table.erase (std::remove_if (table.begin (), table.end (),
+                                     [](auto hi) { return !hi->handler; }),
+                     table.end ());
+        iter = table.empty () ? typed_tables.erase (iter) : std::next (iter);
+    }
+    typed_handlers.erase (std::remove_if (typed_handlers.begin (),
+                                          typed_handlers.end (),
+                                          [](const auto& hi)
+                                          { return !hi->handler; }),
+                          typed_handlers.end ());
+}
+
+static bool
+unregister_typed_handler (gint handler_id)
+{
+    auto iter = std::find_if (typed_handlers.begin (), typed_handlers.end (),
+                              [handler_id](const auto& hi)
+                              { return hi->handler &&
+                                    hi->handler_id == handler_id; });
+    if (iter == typed_handlers.end ())
+        return false;
+
+    (*iter)->handler = nullptr;
+    update_batched_mask ();
+    if (handler_run_level == 0)
+        purge_typed_handlers ();
+    else
+        pending_deletes++;
+    return true;
+}
+
 void
 qof_event_unregister_handler (gint handler_id)
 {
@@ -138,6 +456,14 @@ qof_event_unregister_handler (gint handler_id)
         return;
     }
 
+    if (typed_ids.erase (handler_id) &&
+        (unregister_typed_handler (handler_id) ||
+         event_worker.remove (handler_id)))
+    {
+        LEAVE ("(handler_id=%d)", handler_id);
+        return;
+    }
+
     PERR ("no such handler: %d", handler_id);
 }
 
@@ -164,6 +490,108 @@ qof_event_resume (void)
     suspend_counter--;
 }
 
+/* Call the typed handlers in table that take event_id now. Handlers
+ * registered meanwhile wait for the next event, as plain ones do. */
+static void
+run_typed_table (const TypedHandlerVec& table, QofInstance *entity,
+                 QofEventId event_id, gpointer event_data, bool batched)
+{
+    for (size_t i = 0, n = table.size (); i < n; ++i)
+    {
+        auto hi = table[i];
+        if (!hi->handler || !(hi->mask & event_id))
+            continue;
+        if (batched != (hi->delivery == QOF_EVENT_DELIVER_BATCHED))
+            continue;
+        hi->handler (entity, event_id & hi->mask, hi->user_data, event_data);
+        QOF_TRACE_COUNT ("handler-calls", 1);
+    }
+}
+
+static void
+run_typed_handlers (QofInstance *entity, QofEventId event_id,
+                    gpointer event_data, bool batched)
+{
+    auto all = typed_tables.find ({});
+    if (all != typed_tables.end ())
+        run_typed_table (all->second, entity, event_id, event_data, batched);
+    auto typed = typed_tables.find (entity->e_type ? entity->e_type : "");
+    if (typed != typed_tables.end () && typed != all)
+        run_typed_table (typed->second, entity, event_id, event_data, batched);
+}
+
+static void
+queue_background_event (QofInstance *entity, QofEventId event_id)
+{
+    event_worker.push ({*qof_instance_get_guid (entity), entity->e_type,
+                        event_id});
+}
+
+static void
+purge_deleted_handlers (void)
+{
+    GList *node, *next_node;
+
+    for (node = handlers; node; node = next_node)
+    {
+        HandlerInfo *hi = static_cast<HandlerInfo*>(node->data);
+        next_node = node->next;
+        if (hi->handler == NULL)
+        {
+            /* remove this node from the list, then free this node */
+            handlers = g_list_remove_link (handlers, node);
+            g_list_free_1 (node);
+            g_free (hi);
+        }
+    }
+    purge_typed_handlers ();
+    pending_deletes = 0;
+}
+
+void
+qof_event_begin_batch (void)
+{
+    batch_level++;
+}
+
+void
+qof_event_end_batch (void)
+{
+    if (batch_level == 0)
+    {
+        PERR ("batch level underflow");
+        return;
+    }
+    if (--batch_level)
+        return;
+
+    /* Handlers may generate events of their own; those are delivered
+     * directly now that the batch is over. */
+    auto events = std::move (pending_events);
+    pending_events.clear ();
+    pending_index.clear ();
+
+    handler_run_level++;
+    for (const auto& pending : events)
+    {
+        if (pending.event_id & batched_mask)
+            run_typed_handlers (pending.entity, pending.event_id, nullptr, true);
+        if (pending.event_id & event_worker.mask ())
+            queue_background_event (pending.entity, pending.event_id);
+        g_object_unref (pending.entity);
+    }
+    handler_run_level--;
+
+    if (handler_run_level == 0 && pending_deletes)
+        purge_deleted_handlers ();
+}
+
+void
+qof_event_flush_background (void)
+{
+    event_worker.flush ();
+}
+
 static void
 qof_event_generate_internal (QofInstance *entity, QofEventId event_id,
                              gpointer event_data)
@@ -182,6 +610,7 @@ qof_event_generate_internal (QofInstance *entity, QofEventId event_id,
     }
     }
 
+    QOF_TRACE_BEGIN (dispatch_start);
     handler_run_level++;
     for (node = handlers; node; node = next_node)
     {
@@ -193,29 +622,43 @@ qof_event_generate_internal (QofInstance *entity, QofEventId event_id,
             PINFO("id=%d hi=%p han=%p data=%p", hi->handler_id, hi,
                   hi->handler, event_data);
             hi->handler (entity, event_id, hi->user_data, event_data);
+            QOF_TRACE_COUNT ("handler-calls", 1);
         }
     }
+
+    /* Entities are only looked at when typed handlers exist; plain
+     * handlers can be sent anything non-NULL. */
+    if (!typed_tables.empty ())
+        run_typed_handlers (entity, event_id, event_data, false);
+
+    auto deferred = event_id & (batched_mask | event_worker.mask ());
+    if (deferred && batch_level)
+    {
+        auto [iter, inserted] = pending_index.emplace (entity,
+                                                       pending_events.size ());
+        if (inserted)
+        {
+            g_object_ref (entity);
+            pending_events.push_back ({entity, deferred});
+        }
+        else
+            pending_events[iter->second].event_id |= deferred;
+    }
+    else if (deferred)
+    {
+        if (event_id & batched_mask)
+            run_typed_handlers (entity, event_id, event_data, true);
+        if (event_id & event_worker.mask ())
+            queue_background_event (entity, event_id);
+    }
     handler_run_level--;
+    QOF_TRACE_END (dispatch_start, "event-dispatch");
 
     /* If we're the outermost event runner and we have pending deletes
      * then go delete the handlers now.
      */
     if (handler_run_level == 0 && pending_deletes)
-    {
-        for (node = handlers; node; node = next_node)
-        {
-            HandlerInfo *hi = static_cast<HandlerInfo*>(node->data);
-            next_node = node->next;
-            if (hi->handler == NULL)
-            {
-                /* remove this node from the list, then free this node */
-                handlers = g_list_remove_link (handlers, node);
-                g_list_free_1 (node);
-                g_free (hi);
-            }
-        }
-        pending_deletes = 0;
-    }
+        purge_deleted_handlers ();
 }
 
 void
@@ -139,6 +139,100 @@ void qof_event_suspend (void);
 /** Resume engine event generation. */
 void qof_event_resume (void);
 
+/** @name Typed event subscriptions
+ *
+ * Handlers registered with qof_event_register_handler() see every
+ * event as soon as it is generated. Typed handlers instead subscribe to
+ * the events of one entity type and a mask of event ids, so the engine
+ * doesn't call them for anything else, and can ask for batched or
+ * background delivery.
+ *
+ * Between qof_event_begin_batch() and qof_event_end_batch() events for
+ * batched and background handlers are coalesced per entity: at the end
+ * of the outermost batch each handler is called once per entity, in
+ * the order the entities first generated an event, with the bitwise OR
+ * of the entity's event ids and NULL event data. Outside a batch they
+ * receive each event as it happens. Plain and QOF_EVENT_DELIVER_SYNC
+ * handlers are never delayed.
+ *
+ * All handler ids come from the same sequence and are released with
+ * qof_event_unregister_handler().
+ * @{
+ */
+
+/** How a typed handler receives its events. */
+typedef enum
+{
+    QOF_EVENT_DELIVER_SYNC,     /**< As each event is generated. */
+    QOF_EVENT_DELIVER_BATCHED,  /**< Coalesced at the end of a batch. */
+} QofEventDelivery;
+
+/** \brief Handler invoked on the event worker thread.
+ *
+ * Background handlers run concurrently with the rest of the program, so
+ * they get a copy of the entity's GUID and type instead of the entity
+ * itself and must not call into the engine. They suit listeners that
+ * keep their own state, like indexes and caches.
+ *
+ * @param guid:       GUID of the entity that generated the event.
+ * @param type:       Type of the entity that generated the event.
+ * @param event_type: The id of the event, or the OR of the coalesced ids.
+ * @param handler_data: data supplied when the handler was registered.
+ */
+typedef void (*QofEventBackgroundHandler) (const GncGUID *guid,
+                                           QofIdTypeConst type,
+                                           QofEventId event_type,
+                                           gpointer handler_data);
+
+/** \brief Register a handler for some events of one entity type.
+ *
+ * @param type:       Entity type to receive events for, or NULL for all.
+ * @param event_mask: Event ids to receive, e.g. QOF_EVENT_MODIFY |
+ * QOF_EVENT_DESTROY. The handler gets only the bits of the mask that
+ * were generated.
+ * @param delivery:   When to call the handler.
+ * @param handler:    handler to register
+ * @param handler_data: data provided when handler is invoked
+ *
+ * @return id identifying handler
+ */
+gint qof_event_register_typed_handler (QofIdTypeConst type,
+                                       QofEventId event_mask,
+                                       QofEventDelivery delivery,
+                                       QofEventHandler handler,
+                                       gpointer handler_data);
+
+/** \brief Register a handler called on the event worker thread.
+ *
+ * Events are queued for the worker in the order they're generated,
+ * coalesced like batched events inside a batch.
+ *
+ * @param type:       Entity type to receive events for, or NULL for all.
+ * @param event_mask: Event ids to receive.
+ * @param handler:    handler to register
+ * @param handler_data: data provided when handler is invoked
+ *
+ * @return id identifying handler
+ */
+gint qof_event_register_background_handler (QofIdTypeConst type,
+                                            QofEventId event_mask,
+                                            QofEventBackgroundHandler handler,
+                                            gpointer handler_data);
+
+/** Start coalescing events for batched and background handlers. Calls
+ * nest; delivery happens when the outermost batch ends. Entities with
+ * pending events are kept alive until then. */
+void qof_event_begin_batch (void);
+
+/** End a batch begun with qof_event_begin_batch(). */
+void qof_event_end_batch (void);
+
+/** Wait until the event worker thread has delivered every queued
+ * event. */
+void qof_event_flush_background (void);
+
+/** @} */
+
 #ifdef __cplusplus
 }
 #endif
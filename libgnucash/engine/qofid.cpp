@@ -31,26 +31,192 @@
 #include "qofid-p.h"
 #include "qofinstance-p.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
 static QofLogModule log_module = QOF_MOD_ENGINE;
 
+using EntityVec = std::vector<QofInstance*>;
+using EntityVecPtr = std::shared_ptr<const EntityVec>;
+
+/* Open addressing index from an entity's GUID to its slot in the
+ * collection's entity vector. Entries hold the slot plus one; zero marks
+ * an empty entry and UINT32_MAX a deleted one. The GUIDs are compared
+ * through the entities, so the index doesn't keep copies of them. */
+class GuidSlotIndex
+{
+public:
+    static constexpr uint32_t empty = 0;
+    static constexpr uint32_t deleted = UINT32_MAX;
+
+    /* Slot of the entity with guid, or -1 */
+    int64_t find (const EntityVec& entities, const GncGUID *guid) const
+    {
+        if (m_table.empty ())
+            return -1;
+        for (auto pos = start (guid); ; pos = (pos + 1) & mask ())
+        {
+            auto entry = m_table[pos];
+            if (entry == empty)
+                return -1;
+            if (entry != deleted &&
+                guid_equal (qof_instance_get_guid (entities[entry - 1]), guid))
+                return entry - 1;
+        }
+    }
+    void insert (const EntityVec& entities, const GncGUID *guid, uint32_t slot)
+    {
+        if ((m_used + 1) * 2 > m_table.size ())
+            rebuild (entities, std::max<size_t> (16, (m_live + 1) * 4));
+        auto pos = start (guid);
+        while (m_table[pos] != empty && m_table[pos] != deleted)
+            pos = (pos + 1) & mask ();
+        if (m_table[pos] == empty)
+            ++m_used;
+        m_table[pos] = slot + 1;
+        ++m_live;
+    }
+    void erase (const EntityVec& entities, const GncGUID *guid)
+    {
+        if (m_table.empty ())
+            return;
+        for (auto pos = start (guid); m_table[pos] != empty;
+             pos = (pos + 1) & mask ())
+        {
+            auto entry = m_table[pos];
+            if (entry != deleted &&
+                guid_equal (qof_instance_get_guid (entities[entry - 1]), guid))
+            {
+                m_table[pos] = deleted;
+                --m_live;
+                return;
+            }
+        }
+    }
+    /* Index every live entity again, e.g. after the slots moved. */
+    void rebuild (const EntityVec& entities, size_t min_size)
+    {
+        size_t size = 16;
+        while (size < min_size)
+            size *= 2;
+        m_table.assign (size, empty);
+        m_used = m_live = 0;
+        for (size_t slot = 0; slot < entities.size (); ++slot)
+        {
+            if (!entities[slot])
+                continue;
+            auto pos = start (qof_instance_get_guid (entities[slot]));
+            while (m_table[pos] != empty)
+                pos = (pos + 1) & mask ();
+            m_table[pos] = slot + 1;
+            ++m_used;
+            ++m_live;
+        }
+    }
+private:
+    size_t mask () const { return m_table.size () - 1; }
+    /* GUIDs are random, but mix the bits anyway so that hand-made ones
+     * don't all land in the same place. */
+    size_t start (const GncGUID *guid) const
+    {
+        uint64_t lo, hi;
+        memcpy (&lo, guid->reserved, sizeof lo);
+        memcpy (&hi, guid->reserved + sizeof lo, sizeof hi);
+        return ((lo ^ hi) * UINT64_C(0x9e3779b97f4a7c15) >> 32) & mask ();
+    }
+
+    std::vector<uint32_t> m_table;
+    size_t m_used = 0;          /* live and deleted entries */
+    size_t m_live = 0;
+};
+
+/* The entities are kept in the order they were added, with removed
+ * ones left as null slots until there are enough of them to compact.
+ * The vector is shared with snapshots and copied before it's changed
+ * while one exists. */
 struct QofCollection_s
 {
     QofIdType    e_type;
     gboolean     is_dirty;
 
-    GHashTable * hash_of_entities;
+    std::shared_ptr<EntityVec> entities;
+    GuidSlotIndex index;
+    guint        count;
+    guint        removed;
     gpointer     data;       /* place where object class can hang arbitrary data */
 };
 
+struct QofCollectionSnapshot_s
+{
+    EntityVecPtr entities;
+    guint count;
+};
+
+/* Minimum number of entities handed to a thread by
+ * qof_collection_foreach_parallel. */
+static const size_t parallel_chunk_size = 1024;
+
+static EntityVec&
+entities_for_write (QofCollection *col)
+{
+    if (col->entities.use_count () > 1)
+        col->entities = std::make_shared<EntityVec> (*col->entities);
+    return *col->entities;
+}
+
+static void
+collection_insert (QofCollection *col, QofInstance *ent)
+{
+    auto& entities = entities_for_write (col);
+    col->index.insert (entities, qof_instance_get_guid (ent), entities.size ());
+    entities.push_back (ent);
+    col->count++;
+}
+
+static void
+collection_compact (QofCollection *col)
+{
+    auto compacted = std::make_shared<EntityVec> ();
+    compacted->reserve (col->count);
+    std::copy_if (col->entities->begin (), col->entities->end (),
+                  std::back_inserter (*compacted),
+                  [](QofInstance *ent) { return ent != nullptr; });
+    col->entities = compacted;
+    col->index.rebuild (*compacted, compacted->size () * 4);
+    col->removed = 0;
+}
+
+static gboolean
+collection_remove (QofCollection *col, const GncGUID *guid)
+{
+    auto slot = col->index.find (*col->entities, guid);
+    if (slot < 0)
+        return FALSE;
+
+    auto& entities = entities_for_write (col);
+    col->index.erase (entities, guid);
+    entities[slot] = nullptr;
+    col->count--;
+    col->removed++;
+
+    if (col->removed > 32 && col->removed > col->count)
+        collection_compact (col);
+    return TRUE;
+}
+
 /* =============================================================== */
 
 QofCollection *
 qof_collection_new (QofIdType type)
 {
     QofCollection *col;
-    col = g_new0(QofCollection, 1);
+    col = new QofCollection_s{};
     col->e_type = static_cast<QofIdType>(CACHE_INSERT (type));
-    col->hash_of_entities = guid_hash_table_new();
+    col->entities = std::make_shared<EntityVec> ();
     col->data = NULL;
     return col;
 }
@@ -59,11 +225,9 @@ void
 qof_collection_destroy (QofCollection *col)
 {
     CACHE_REMOVE (col->e_type);
-    g_hash_table_destroy(col->hash_of_entities);
     col->e_type = NULL;
-    col->hash_of_entities = NULL;
     col->data = NULL;   /** XXX there should be a destroy notifier for this */
-    g_free (col);
+    delete col;
 }
 
 /* =============================================================== */
@@ -87,7 +251,7 @@ qof_collection_remove_entity (QofInstance *ent)
     col = qof_instance_get_collection(ent);
     if (!col) return;
     guid = qof_instance_get_guid(ent);
-    g_hash_table_remove (col->hash_of_entities, guid);
+    collection_remove (col, guid);
     qof_instance_set_collection(ent, NULL);
 }
 
@@ -101,7 +265,9 @@ qof_collection_insert_entity (QofCollection *col, QofInstance *ent)
     if (guid_equal(guid, guid_null())) return;
     g_return_if_fail (col->e_type == ent->e_type);
     qof_collection_remove_entity (ent);
-    g_hash_table_insert (col->hash_of_entities, (gpointer)guid, ent);
+    /* Replace an entity with the same guid, as the hash table did. */
+    collection_remove (col, guid);
+    collection_insert (col, ent);
     qof_instance_set_collection(ent, col);
 }
 
@@ -127,7 +293,7 @@ qof_collection_add_entity (QofCollection *coll, QofInstance *ent)
     {
         return FALSE;
     }
-    g_hash_table_insert (coll->hash_of_entities, (gpointer)guid, ent);
+    collection_insert (coll, ent);
     return TRUE;
 }
 
@@ -211,12 +377,10 @@ qof_collection_compare (QofCollection *target, QofCollection *merge)
 QofInstance *
 qof_collection_lookup_entity (const QofCollection *col, const GncGUID * guid)
 {
-    QofInstance *ent;
     g_return_val_if_fail (col, NULL);
     if (guid == NULL) return NULL;
-    ent = static_cast<QofInstance*>(g_hash_table_lookup (col->hash_of_entities,
-							 guid));
-    return ent;
+    auto slot = col->index.find (*col->entities, guid);
+    return slot < 0 ? NULL : (*col->entities)[slot];
 }
 
 QofCollection *
@@ -242,10 +406,7 @@ qof_collection_from_glist (QofIdType type, const GList *glist)
 guint
 qof_collection_count (const QofCollection *col)
 {
-    guint c;
-
-    c = g_hash_table_size(col->hash_of_entities);
-    return c;
+    return col->count;
 }
 
 /* =============================================================== */
@@ -301,40 +462,100 @@ qof_collection_set_data (QofCollection *col, gpointer user_data)
 
 /* =============================================================== */
 
-struct _qofid_iterate
-{
-    QofInstanceForeachCB      fcn;
-    gpointer                data;
-};
-
 static void
-foreach_cb (gpointer item, gpointer arg)
+foreach_entity (const EntityVec& entities, QofInstanceForeachCB cb_func,
+                gpointer user_data)
 {
-    struct _qofid_iterate *iter = static_cast<_qofid_iterate*>(arg);
-    QofInstance *ent = static_cast<QofInstance*>(item);
-
-    iter->fcn (ent, iter->data);
+    for (auto ent : entities)
+        if (ent)
+            cb_func (ent, user_data);
 }
 
 void
 qof_collection_foreach (const QofCollection *col, QofInstanceForeachCB cb_func,
                         gpointer user_data)
 {
-    struct _qofid_iterate iter;
-    GList *entries;
+    g_return_if_fail (col);
+    g_return_if_fail (cb_func);
 
+    PINFO("Collection size of %s before is %d", col->e_type, col->count);
+
+    /* Hold on to the current vector so that the callback can add and
+     * remove entities; the collection copies it the first time. */
+    EntityVecPtr entities = col->entities;
+    foreach_entity (*entities, cb_func, user_data);
+
+    PINFO("Collection size of %s after is %d", col->e_type, col->count);
+}
+
+void
+qof_collection_foreach_parallel (const QofCollection *col,
+                                 QofInstanceForeachCB cb_func,
+                                 gpointer user_data)
+{
     g_return_if_fail (col);
     g_return_if_fail (cb_func);
 
-    iter.fcn = cb_func;
-    iter.data = user_data;
+    EntityVecPtr entities = col->entities;
+    auto size = entities->size ();
+    auto num_chunks = (size + parallel_chunk_size - 1) / parallel_chunk_size;
+    size_t num_threads = std::min<size_t> (std::thread::hardware_concurrency (),
+                                           num_chunks);
+    if (num_threads < 2)
+    {
+        foreach_entity (*entities, cb_func, user_data);
+        return;
+    }
 
-    PINFO("Hash Table size of %s before is %d", col->e_type, g_hash_table_size(col->hash_of_entities));
+    std::atomic<size_t> next_chunk{0};
+    auto worker = [&]()
+    {
+        for (auto chunk = next_chunk++; chunk < num_chunks; chunk = next_chunk++)
+        {
+            auto end = std::min (size, (chunk + 1) * parallel_chunk_size);
+            for (auto slot = chunk * parallel_chunk_size; slot < end; ++slot)
+                if (auto ent = (*entities)[slot])
+                    cb_func (ent, user_data);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < num_threads; ++i)
+        threads.emplace_back (worker);
+    worker ();
+    for (auto& thread : threads)
+        thread.join ();
+}
+
+/* =============================================================== */
+
+QofCollectionSnapshot *
+qof_collection_snapshot (const QofCollection *col)
+{
+    g_return_val_if_fail (col, NULL);
+    return new QofCollectionSnapshot_s{col->entities, col->count};
+}
+
+guint
+qof_collection_snapshot_count (const QofCollectionSnapshot *snapshot)
+{
+    return snapshot ? snapshot->count : 0;
+}
+
+void
+qof_collection_snapshot_foreach (const QofCollectionSnapshot *snapshot,
+                                 QofInstanceForeachCB cb_func,
+                                 gpointer user_data)
+{
+    g_return_if_fail (snapshot);
+    g_return_if_fail (cb_func);
 
-    entries = g_hash_table_get_values (col->hash_of_entities);
-    g_list_foreach (entries, foreach_cb, &iter);
-    g_list_free (entries);
+    foreach_entity (*snapshot->entities, cb_func, user_data);
+}
 
-    PINFO("Hash Table size of %s after is %d", col->e_type, g_hash_table_size(col->hash_of_entities));
+void
+qof_collection_snapshot_free (QofCollectionSnapshot *snapshot)
+{
+    delete snapshot;
 }
 /* =============================================================== */
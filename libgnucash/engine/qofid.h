@@ -118,7 +118,8 @@ print error message if its bad  */
 
 @param e_type QofIdType
 @param is_dirty gboolean
-@param hash_of_entities GHashTable
+@param entities the entities in the order they were added
+@param index GncGUID to entity lookup
 @param data gpointer, place where object class can hang arbitrary data
 
 */
@@ -145,10 +146,41 @@ QofInstance * qof_collection_lookup_entity (const QofCollection *, const GncGUID
 /** Callback type for qof_collection_foreach */
 typedef void (*QofInstanceForeachCB) (QofInstance *, gpointer user_data);
 
-/** Call the callback for each entity in the collection. */
+/** Call the callback for each entity in the collection, in the order
+ * the entities were added. The callback may add and remove entities;
+ * the entities visited are those present when the call started. */
 void qof_collection_foreach (const QofCollection *, QofInstanceForeachCB,
                              gpointer user_data);
 
+/** Call the callback for each entity in the collection, handing chunks
+ * of entities to several threads. The callback runs concurrently with
+ * itself and with nothing else, so it may read the entities but must
+ * not change them or the collection. */
+void qof_collection_foreach_parallel (const QofCollection *,
+                                      QofInstanceForeachCB,
+                                      gpointer user_data);
+
+/* A snapshot is the list of a collection's entities at one moment.
+ * Taking one is cheap: the collection copies its list the next time it
+ * changes instead. Snapshots can be read from any thread, but they don't
+ * hold references on the entities, which must outlive the reads. */
+typedef struct QofCollectionSnapshot_s QofCollectionSnapshot;
+
+/** Take a snapshot of the collection's entities. */
+QofCollectionSnapshot * qof_collection_snapshot (const QofCollection *);
+
+/** Return the number of entities in the snapshot. */
+guint qof_collection_snapshot_count (const QofCollectionSnapshot *);
+
+/** Call the callback for each entity in the snapshot, in the order the
+ * entities were added to the collection. */
+void qof_collection_snapshot_foreach (const QofCollectionSnapshot *,
+                                      QofInstanceForeachCB,
+                                      gpointer user_data);
+
+/** Release a snapshot. */
+void qof_collection_snapshot_free (QofCollectionSnapshot *);
+
 /** Store and retrieve arbitrary object-defined data
  *
  * XXX We need to add a callback for when the collection is being
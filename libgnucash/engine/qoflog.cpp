@@ -55,6 +55,11 @@
 #include <vector>
 #include <memory>
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
 
 #define QOF_LOG_MAX_CHARS 50
 #define QOF_LOG_MAX_CHARS_WITH_ALLOWANCE 100
@@ -533,3 +538,245 @@ qof_log_level_from_string(const gchar *str)
     if (g_ascii_strncasecmp("debug", str, 5) == 0) return QOF_LOG_DEBUG;
     return QOF_LOG_DEBUG;
 }
+
+/* Timing traces ***************************************************/
+
+/* Spans are kept for the Chrome trace up to this many; the histograms
+ * see every span regardless. */
+static constexpr size_t trace_max_events = 1000000;
+static constexpr int trace_num_buckets = 64;
+
+struct TraceHistogram
+{
+    gint64 count = 0;
+    gint64 total = 0;
+    gint64 min = G_MAXINT64;
+    gint64 max = 0;
+    /* Bucket i holds spans of [2^i, 2^(i+1)) nanoseconds. */
+    std::array<gint64, trace_num_buckets> buckets{};
+
+    void add (gint64 duration)
+    {
+        ++count;
+        total += duration;
+        min = std::min (min, duration);
+        max = std::max (max, duration);
+        int bucket = 0;
+        while (bucket < trace_num_buckets - 1 && (duration >> (bucket + 1)))
+            ++bucket;
+        ++buckets[bucket];
+    }
+
+    /* The upper bound of the bucket holding the given percentile. */
+    gint64 percentile (double pct) const
+    {
+        gint64 rank = static_cast<gint64>(pct * count / 100.0), seen = 0;
+        for (int i = 0; i < trace_num_buckets; ++i)
+        {
+            seen += buckets[i];
+            if (seen > rank)
+                return i < 62 ? std::min<gint64> (max, G_GINT64_CONSTANT(1) << (i + 1)) : max;
+        }
+        return max;
+    }
+};
+
+struct TraceEvent
+{
+    const char *module;
+    const char *name;
+    gint64 start;
+    gint64 duration;
+    int thread;
+};
+
+using TraceKey = std::pair<std::string, std::string>;
+
+static std::atomic<bool> trace_enabled{false};
+static std::mutex trace_mutex;
+static std::string trace_output;
+static gint64 trace_epoch = 0;
+static std::map<TraceKey, TraceHistogram> trace_histograms;
+static std::map<TraceKey, gint64> trace_counters;
+static std::vector<TraceEvent> trace_events;
+static std::atomic<int> trace_next_thread{1};
+
+static gint64
+trace_now (void)
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static int
+trace_thread_id (void)
+{
+    thread_local int id = trace_next_thread++;
+    return id;
+}
+
+static void
+trace_atexit (void)
+{
+    qof_trace_shutdown ();
+}
+
+void
+qof_trace_init (const char *output)
+{
+    static bool atexit_registered = false;
+    std::lock_guard<std::mutex> lock (trace_mutex);
+    trace_output = output ? output : "";
+    if (!trace_epoch)
+        trace_epoch = trace_now ();
+    if (!atexit_registered)
+    {
+        atexit (trace_atexit);
+        atexit_registered = true;
+    }
+    trace_enabled = true;
+}
+
+gboolean
+qof_trace_is_enabled (void)
+{
+    return trace_enabled.load (std::memory_order_relaxed);
+}
+
+gint64
+qof_trace_begin (void)
+{
+    if (G_LIKELY (!trace_enabled.load (std::memory_order_relaxed)))
+        return 0;
+    return trace_now ();
+}
+
+void
+qof_trace_end (QofLogModule module, const char *name, gint64 start)
+{
+    if (!start || !trace_enabled.load (std::memory_order_relaxed))
+        return;
+    auto end = trace_now ();
+    auto thread = trace_thread_id ();
+    module = module ? module : "";
+
+    std::lock_guard<std::mutex> lock (trace_mutex);
+    trace_histograms[{module, name}].add (end - start);
+    if (trace_events.size () < trace_max_events)
+        trace_events.push_back ({module, name, start, end - start, thread});
+}
+
+void
+qof_trace_count (QofLogModule module, const char *name, gint64 delta)
+{
+    if (!trace_enabled.load (std::memory_order_relaxed))
+        return;
+    std::lock_guard<std::mutex> lock (trace_mutex);
+    trace_counters[{module ? module : "", name}] += delta;
+}
+
+static void
+trace_write_json_string (FILE *file, std::string_view str)
+{
+    fputc ('"', file);
+    for (auto c : str)
+    {
+        if (c == '"' || c == '\\')
+            fputc ('\\', file);
+        if (static_cast<unsigned char>(c) >= 0x20)
+            fputc (c, file);
+    }
+    fputc ('"', file);
+}
+
+static void
+trace_write_chrome (FILE *file)
+{
+    fputs ("{\"traceEvents\":[", file);
+    bool first = true;
+    for (const auto& event : trace_events)
+    {
+        fputs (first ? "\n" : ",\n", file);
+        first = false;
+        fputs ("{\"name\":", file);
+        trace_write_json_string (file, event.name);
+        fputs (",\"cat\":", file);
+        trace_write_json_string (file, event.module);
+        fprintf (file, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+                 "\"pid\":1,\"tid\":%d}",
+                 (event.start - trace_epoch) / 1000.0,
+                 event.duration / 1000.0, event.thread);
+    }
+    fputs ("\n],\"displayTimeUnit\":\"ms\",\"otherData\":{", file);
+    first = true;
+    for (const auto& [key, value] : trace_counters)
+    {
+        if (!first)
+            fputc (',', file);
+        first = false;
+        trace_write_json_string (file, key.first + "/" + key.second);
+        fprintf (file, ":%" G_GINT64_FORMAT, value);
+    }
+    if (trace_events.size () == trace_max_events)
+        fprintf (file, "%s\"truncated\":true", first ? "" : ",");
+    fputs ("}}\n", file);
+}
+
+static void
+trace_write_summary (FILE *file)
+{
+    fprintf (file, "%-24s %-28s %10s %12s %10s %10s %10s %10s\n",
+             "module", "name", "count", "total ms", "mean us",
+             "p50 us", "p95 us", "max us");
+    for (const auto& [key, hist] : trace_histograms)
+        fprintf (file, "%-24s %-28s %10" G_GINT64_FORMAT " %12.3f %10.1f"
+                 " %10.1f %10.1f %10.1f\n",
+                 key.first.c_str (), key.second.c_str (), hist.count,
+                 hist.total / 1e6, hist.total / 1e3 / hist.count,
+                 hist.percentile (50) / 1e3, hist.percentile (95) / 1e3,
+                 hist.max / 1e3);
+    if (trace_counters.empty ())
+        return;
+    fprintf (file, "\n%-24s %-28s %10s\n", "module", "counter", "total");
+    for (const auto& [key, value] : trace_counters)
+        fprintf (file, "%-24s %-28s %10" G_GINT64_FORMAT "\n",
+                 key.first.c_str (), key.second.c_str (), value);
+}
+
+void
+qof_trace_shutdown (void)
+{
+    if (!trace_enabled.exchange (false))
+        return;
+
+    std::lock_guard<std::mutex> lock (trace_mutex);
+    auto chrome = g_str_has_suffix (trace_output.c_str (), ".json");
+    FILE *file = nullptr;
+    if (trace_output.empty () ||
+        g_ascii_strcasecmp (trace_output.c_str (), "stderr") == 0)
+        file = stderr;
+    else if (g_ascii_strcasecmp (trace_output.c_str (), "stdout") == 0)
+        file = stdout;
+    else
+        file = g_fopen (trace_output.c_str (), "w");
+
+    if (!file)
+        g_warning ("Cannot open trace output file \"%s\".",
+                   trace_output.c_str ());
+    else
+    {
+        if (chrome)
+            trace_write_chrome (file);
+        else
+            trace_write_summary (file);
+        if (file == stderr || file == stdout)
+            fflush (file);
+        else
+            fclose (file);
+    }
+
+    trace_histograms.clear ();
+    trace_counters.clear ();
+    trace_events.clear ();
+    trace_events.shrink_to_fit ();
+}
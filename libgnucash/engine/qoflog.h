@@ -302,9 +302,102 @@ gboolean qof_log_check(QofLogModule log_module, QofLogLevel log_level);
   g_return_if_fail(test); \
 } while (0);
 
+/** @name Timing traces
+ *
+ * Scoped timers and counters for hot paths. Each timer records its
+ * duration into a histogram keyed by log module and name; counters
+ * accumulate a total. Nothing is recorded until qof_trace_init() is
+ * called, which qof_init() does when the @c GNC_TRACE environment
+ * variable is set and gnucash-cli does for its @c --trace option.
+ *
+ * When disabled a timer costs one function call and a counter one
+ * test. Defining @c QOF_TRACE_DISABLE before including this header
+ * removes the macros entirely.
+ * @{
+ */
+
+/** Start recording traces.
+ *
+ * @param output Where to write the traces when qof_trace_shutdown() is
+ * called or the program exits. A file name ending in ".json" receives
+ * Chrome trace-event JSON, viewable in chrome://tracing or Perfetto;
+ * "stderr", "stdout" or an empty string print a summary table of the
+ * histograms and counters to that stream, and any other file name
+ * receives the summary table.
+ */
+void qof_trace_init (const char *output);
+
+/** Write the recorded traces to the output given to qof_trace_init()
+ * and stop recording. Does nothing if tracing isn't enabled. */
+void qof_trace_shutdown (void);
+
+/** @return TRUE if traces are being recorded. */
+gboolean qof_trace_is_enabled (void);
+
+/** @return A start time for qof_trace_end(), or 0 if tracing is
+ * disabled. */
+gint64 qof_trace_begin (void);
+
+/** Record a span named @a name in @a module that started at @a start.
+ * Both strings must outlive tracing; string literals and log_module
+ * variables do. */
+void qof_trace_end (QofLogModule module, const char *name, gint64 start);
+
+/** Add @a delta to the counter named @a name in @a module. */
+void qof_trace_count (QofLogModule module, const char *name, gint64 delta);
+
+#ifdef QOF_TRACE_DISABLE
+#define QOF_TRACE_BEGIN(var) G_GNUC_UNUSED gint64 var = 0
+#define QOF_TRACE_END(var, name) do { } while (0)
+#define QOF_TRACE_COUNT(name, delta) do { } while (0)
+#else
+/** Declare @a var and start a span in it. */
+#define QOF_TRACE_BEGIN(var) gint64 var = qof_trace_begin ()
+/** End the span started by QOF_TRACE_BEGIN(@a var) and record it as
+ * @a name in the file's log_module. */
+#define QOF_TRACE_END(var, name) do {                   \
+    if (var) qof_trace_end (log_module, name, var);     \
+} while (0)
+/** Add @a delta to the counter @a name in the file's log_module. */
+#define QOF_TRACE_COUNT(name, delta) do {               \
+    if (qof_trace_is_enabled ())                        \
+        qof_trace_count (log_module, name, delta);      \
+} while (0)
+#endif
+
+/** @} */
 
 #ifdef __cplusplus
 }
+
+/** Records a span from its construction to the end of the enclosing
+ * scope. Use it through QOF_TRACE_SCOPE. */
+class QofTraceScope
+{
+public:
+    QofTraceScope (QofLogModule module, const char *name) :
+        m_module{module}, m_name{name}, m_start{qof_trace_begin ()} {}
+    ~QofTraceScope ()
+    {
+        if (m_start)
+            qof_trace_end (m_module, m_name, m_start);
+    }
+    QofTraceScope (const QofTraceScope&) = delete;
+    QofTraceScope& operator= (const QofTraceScope&) = delete;
+private:
+    QofLogModule m_module;
+    const char *m_name;
+    gint64 m_start;
+};
+
+#ifdef QOF_TRACE_DISABLE
+#define QOF_TRACE_SCOPE(name)
+#else
+/** Time the rest of the enclosing scope as @a name in the file's
+ * log_module. */
+#define QOF_TRACE_SCOPE(name) QofTraceScope qof_trace_scope_ {log_module, name}
+#endif
+
 #endif
 
 #endif /* _QOF_LOG_H */
@@ -845,6 +845,7 @@ static void qof_query_run_cb(QofQueryCB* qcb, gpointer cb_arg)
 
 GList * qof_query_run (QofQuery *q)
 {
+    QOF_TRACE_SCOPE ("query-run");
     /* Just a wrapper */
     return qof_query_run_internal(q, qof_query_run_cb, NULL);
 }
@@ -222,6 +222,7 @@ QofSessionImpl::load (QofPercentageFunc percentage_func) noexcept
      */
     if (m_backend)
     {
+        QOF_TRACE_SCOPE ("book-load");
         m_backend->set_percentage(percentage_func);
         m_backend->load (m_book, LOAD_TYPE_INITIAL_LOAD);
         push_error (m_backend->get_error(), {});
@@ -452,8 +453,11 @@ QofSessionImpl::save (QofPercentageFunc percentage_func) noexcept
         /* if invoked as SaveAs(), then backend not yet set */
         if (qof_book_get_backend (m_book) != m_backend)
             qof_book_set_backend (m_book, m_backend);
-        m_backend->set_percentage(percentage_func);
-        m_backend->sync(m_book);
+        {
+            QOF_TRACE_SCOPE ("book-save");
+            m_backend->set_percentage(percentage_func);
+            m_backend->sync(m_book);
+        }
         auto err = m_backend->get_error();
         if (err != ERR_BACKEND_NO_ERR)
         {
@@ -259,6 +259,8 @@ void
 qof_init (void)
 {
     qof_log_init();
+    if (!qof_trace_is_enabled () && g_getenv ("GNC_TRACE"))
+        qof_trace_init (g_getenv ("GNC_TRACE"));
     qof_string_cache_init();
     qof_object_initialize ();
     qof_query_init ();
@@ -272,6 +274,7 @@ qof_close(void)
     qof_object_shutdown ();
     QofBackend::release_backends();
     qof_string_cache_destroy ();
+    qof_trace_shutdown ();
     qof_log_shutdown();
 }
 
@@ -0,0 +1,176 @@
+/********************************************************************
+ * bench-backend.cpp: Load and save benchmarks shared by the        *
+ * backends.                                                        *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <config.h>
+#include <unistd.h>
+#include <benchmark/benchmark.h>
+
+#include <qof.h>
+#include <cashobjects.h>
+#include <TransLog.h>
+
+#include "bench-backend.hpp"
+#include "test-engine-stuff.h"
+
+#include <map>
+#include <set>
+#include <string>
+
+static const int bench_num_accounts = 50;
+static const int bench_min_splits = 1000;
+static const int bench_max_splits = 1000000;
+
+static std::string
+bench_path (const char *name, int num_splits)
+{
+    auto file = g_strdup_printf ("bench-backend-%s-%d-%d.gnucash", name,
+                                 static_cast<int>(getpid ()), num_splits);
+    auto path = g_build_filename (g_get_tmp_dir (), file, nullptr);
+    std::string retval{path};
+    g_free (path);
+    g_free (file);
+    return retval;
+}
+
+/* Write a book of num_splits splits to uri with a fresh session. The
+ * book is moved into the new session with qof_session_swap_data as
+ * QofSession::save_as does. */
+static void
+save_book (QofSession *source, const std::string& uri)
+{
+    auto session = qof_session_new (qof_book_new ());
+    qof_session_begin (session, uri.c_str (), SESSION_NEW_OVERWRITE);
+    qof_session_swap_data (source, session);
+    qof_book_mark_session_dirty (qof_session_get_book (session));
+    qof_session_save (session, nullptr);
+    qof_session_swap_data (session, source);
+    qof_session_end (session);
+    qof_session_destroy (session);
+}
+
+static QofSession*
+get_source_session (int num_splits)
+{
+    static std::map<int, QofSession*> sessions;
+    auto iter = sessions.find (num_splits);
+    if (iter != sessions.end ())
+        return iter->second;
+
+    auto book = qof_book_new ();
+    make_benchmark_book (book, bench_num_accounts, num_splits);
+    auto session = qof_session_new (book);
+    sessions.emplace (num_splits, session);
+    return session;
+}
+
+static void
+split_sizes (benchmark::internal::Benchmark *bench)
+{
+    bench->RangeMultiplier (10)->Range (bench_min_splits, bench_max_splits)
+        ->Unit (benchmark::kMillisecond);
+}
+
+static void
+BM_save (benchmark::State& state, const std::string& name,
+         const std::string& scheme)
+{
+    auto source = get_source_session (state.range (0));
+    auto uri = scheme + bench_path (name.c_str (), state.range (0));
+
+    for (auto _ : state)
+        save_book (source, uri);
+    state.SetItemsProcessed (state.iterations () * state.range (0));
+}
+
+static void
+BM_load (benchmark::State& state, const std::string& name,
+         const std::string& scheme)
+{
+    static std::set<int> saved;
+    auto uri = scheme + bench_path (name.c_str (), state.range (0));
+    if (saved.find (state.range (0)) == saved.end ())
+    {
+        save_book (get_source_session (state.range (0)), uri);
+        saved.insert (state.range (0));
+    }
+
+    for (auto _ : state)
+    {
+        auto session = qof_session_new (qof_book_new ());
+        qof_session_begin (session, uri.c_str (), SESSION_READ_ONLY);
+        qof_session_load (session, nullptr);
+
+        state.PauseTiming ();
+        if (qof_session_get_error (session) != ERR_BACKEND_NO_ERR)
+            state.SkipWithError ("Loading the benchmark book failed");
+        qof_session_end (session);
+        qof_session_destroy (session);
+        state.ResumeTiming ();
+    }
+    state.SetItemsProcessed (state.iterations () * state.range (0));
+}
+
+bool
+bench_backend_init (const char *lib_rel_path, const char *lib_name)
+{
+    g_setenv ("GNC_UNINSTALLED", "1", TRUE);
+    qof_init ();
+    cashobjects_register ();
+    if (!qof_load_backend_library (lib_rel_path, lib_name))
+    {
+        g_printerr ("Loading the backend module %s failed\n", lib_name);
+        return false;
+    }
+    xaccLogDisable ();
+    return true;
+}
+
+int
+bench_backend_run (int argc, char **argv, const char *name,
+                   const char *scheme)
+{
+    std::string bm_name{"BM_"};
+    bm_name += name;
+    benchmark::RegisterBenchmark ((bm_name + "_save").c_str (), BM_save,
+                                  std::string{name}, std::string{scheme})
+        ->Apply (split_sizes);
+    benchmark::RegisterBenchmark ((bm_name + "_load").c_str (), BM_load,
+                                  std::string{name}, std::string{scheme})
+        ->Apply (split_sizes);
+
+    benchmark::Initialize (&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments (argc, argv))
+        return 1;
+    benchmark::RunSpecifiedBenchmarks ();
+
+    for (int size = bench_min_splits; size <= bench_max_splits; size *= 10)
+    {
+        auto path = bench_path (name, size);
+        g_unlink (path.c_str ());
+        g_unlink ((path + ".LCK").c_str ());
+    }
+    qof_close ();
+    return 0;
+}
@@ -0,0 +1,41 @@
+/********************************************************************
+ * bench-backend.hpp: Load and save benchmarks shared by the        *
+ * backends.                                                        *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+#ifndef BENCH_BACKEND_HPP
+#define BENCH_BACKEND_HPP
+
+/** Initialize the engine and load the backend module lib_name from
+ *  lib_rel_path, with transaction logging off.
+ *
+ *  @return false if the module couldn't be loaded. */
+bool bench_backend_init (const char *lib_rel_path, const char *lib_name);
+
+/** Run the load and save benchmarks, named BM_<name>_load and
+ *  BM_<name>_save, on books of 1000 to 1000000 splits kept in temporary
+ *  files with URIs starting with scheme, e.g. "xml://". The files are
+ *  removed and the engine shut down afterwards.
+ *
+ *  @return The exit status for main(). */
+int bench_backend_run (int argc, char **argv, const char *name,
+                       const char *scheme);
+
+#endif
@@ -0,0 +1,665 @@
+/********************************************************************
+ * gnc-bookgen.cpp: Generate large synthetic books for load testing. *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+/* gnc-bookgen writes a synthetic book of realistic shape and arbitrary
+ * size to any URI a registered backend accepts, e.g.
+ *
+ *   gnc-bookgen --years 10 --txns-per-day 50 xml:///tmp/big.gnucash
+ *   gnc-bookgen --seed 7 sqlite3:///tmp/big.sqlite
+ *
+ * The book contains an account tree, N years of daily transactions,
+ * daily price histories for a set of securities, trades assigned to
+ * lots, scheduled transactions and posted customer invoices and vendor
+ * bills. The output depends only on the options: the same seed and
+ * sizes always produce the same book, apart from the GUIDs, so load,
+ * save, query and report timings can be reproduced at scale.
+ *
+ * Run it from the build tree with GNC_BUILDDIR set, or from an
+ * installed prefix, so the backend modules can be found.
+ */
+
+#include <config.h>
+
+#include <glib.h>
+
+#include <qof.h>
+#include <Account.h>
+#include <Recurrence.h>
+#include <SchedXaction.h>
+#include <SX-book.h>
+#include <SX-ttinfo.h>
+#include <Split.h>
+#include <Transaction.h>
+#include <TransLog.h>
+#include <cap-gains.h>
+#include <gnc-commodity.h>
+#include <gnc-date.h>
+#include <gnc-engine.h>
+#include <gnc-pricedb.h>
+#include <gncCustomer.h>
+#include <gncEntry.h>
+#include <gncInvoice.h>
+#include <gncOwner.h>
+#include <gncVendor.h>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace bpo = boost::program_options;
+
+struct BookGenOptions
+{
+    uint64_t seed = 1;
+    int start_year = 2000;
+    int years = 5;
+    int expense_accounts = 100;
+    int depth = 3;
+    int txns_per_day = 20;
+    int securities = 10;
+    int trades_per_month = 4;
+    int scheduled = 20;
+    int customers = 50;
+    int vendors = 20;
+    int invoices_per_month = 40;
+};
+
+class BookGenerator
+{
+public:
+    BookGenerator (QofBook *book, const BookGenOptions& opts) :
+        m_book{book}, m_opts{opts}, m_rng{opts.seed} {}
+    void generate ();
+
+private:
+    /* Derive everything from the raw engine output rather than from
+     * std::uniform_int_distribution, whose results differ between
+     * standard library implementations. */
+    int64_t rand_range (int64_t lo, int64_t hi)
+    {
+        return lo + static_cast<int64_t>(m_rng () %
+                                         static_cast<uint64_t>(hi - lo + 1));
+    }
+    bool chance (int percent) { return rand_range (0, 99) < percent; }
+    template <typename T> T pick (const std::vector<T>& vec)
+    {
+        return vec[rand_range (0, vec.size () - 1)];
+    }
+
+    Account* make_account (Account *parent, const std::string& name,
+                           GNCAccountType type, gnc_commodity *comm);
+    void make_expense_tree (Account *parent, int depth, int count);
+    void make_accounts ();
+    void make_securities ();
+    void make_transfer (time64 date, Account *from, Account *to,
+                        gnc_numeric amount, const char *desc);
+    void make_day (time64 date, int day);
+    void make_prices (time64 date);
+    void make_trade (time64 date);
+    void make_invoice (time64 date, bool bill);
+    void make_scheduled (time64 start);
+
+    QofBook *m_book;
+    BookGenOptions m_opts;
+    std::mt19937_64 m_rng;
+
+    gnc_commodity *m_currency = nullptr;
+    std::vector<Account*> m_banks;
+    std::vector<Account*> m_credit_cards;
+    std::vector<Account*> m_income;
+    std::vector<Account*> m_expenses;
+    Account *m_receivable = nullptr;
+    Account *m_payable = nullptr;
+
+    struct Security
+    {
+        gnc_commodity *commodity;
+        Account *account;
+        int64_t price;          /* in cents */
+        int64_t holding;        /* in whole shares */
+    };
+    std::vector<Security> m_securities;
+    std::vector<GncCustomer*> m_customers;
+    std::vector<GncVendor*> m_vendors;
+    int m_num_invoices = 0;
+    int m_num_bills = 0;
+};
+
+Account*
+BookGenerator::make_account (Account *parent, const std::string& name,
+                             GNCAccountType type, gnc_commodity *comm)
+{
+    auto acc = xaccMallocAccount (m_book);
+    xaccAccountBeginEdit (acc);
+    xaccAccountSetName (acc, name.c_str ());
+    xaccAccountSetType (acc, type);
+    xaccAccountSetCommodity (acc, comm);
+    gnc_account_append_child (parent, acc);
+    xaccAccountCommitEdit (acc);
+    return acc;
+}
+
+/* Spread count expense leaves over a tree of the requested depth with a
+ * random fan-out, the way a hand-built chart of accounts looks. */
+void
+BookGenerator::make_expense_tree (Account *parent, int depth, int count)
+{
+    auto parent_name = std::string{xaccAccountGetName (parent)};
+    if (depth <= 1 || count <= 1)
+    {
+        for (int i = 0; i < count; ++i)
+            m_expenses.push_back (make_account (parent, parent_name + " " +
+                                                std::to_string (i + 1),
+                                                ACCT_TYPE_EXPENSE,
+                                                m_currency));
+        return;
+    }
+
+    int children = std::min<int> (count, rand_range (2, 8));
+    for (int i = 0; i < children; ++i)
+    {
+        auto acc = make_account (parent, parent_name + " " +
+                                 std::to_string (i + 1), ACCT_TYPE_EXPENSE,
+                                 m_currency);
+        make_expense_tree (acc, depth - 1,
+                           count / children + (i < count % children));
+    }
+}
+
+void
+BookGenerator::make_accounts ()
+{
+    auto table = gnc_commodity_table_get_table (m_book);
+    m_currency = gnc_commodity_table_lookup (table, GNC_COMMODITY_NS_CURRENCY,
+                                             "USD");
+    if (!m_currency)
+    {
+        m_currency = gnc_commodity_new (m_book, "US Dollar",
+                                        GNC_COMMODITY_NS_CURRENCY, "USD",
+                                        "840", 100);
+        m_currency = gnc_commodity_table_insert (table, m_currency);
+    }
+
+    auto root = gnc_book_get_root_account (m_book);
+    auto assets = make_account (root, "Assets", ACCT_TYPE_ASSET, m_currency);
+    auto liabilities = make_account (root, "Liabilities",
+                                     ACCT_TYPE_LIABILITY, m_currency);
+    auto income = make_account (root, "Income", ACCT_TYPE_INCOME, m_currency);
+    auto expenses = make_account (root, "Expenses", ACCT_TYPE_EXPENSE,
+                                  m_currency);
+    make_account (root, "Equity", ACCT_TYPE_EQUITY, m_currency);
+
+    for (auto name : {"Checking", "Savings", "Business Checking"})
+        m_banks.push_back (make_account (assets, name, ACCT_TYPE_BANK,
+                                         m_currency));
+    for (auto name : {"Visa", "Mastercard"})
+        m_credit_cards.push_back (make_account (liabilities, name,
+                                                ACCT_TYPE_CREDIT, m_currency));
+    for (auto name : {"Salary", "Sales", "Interest", "Dividends"})
+        m_income.push_back (make_account (income, name, ACCT_TYPE_INCOME,
+                                          m_currency));
+    m_receivable = make_account (assets, "Accounts Receivable",
+                                 ACCT_TYPE_RECEIVABLE, m_currency);
+    m_payable = make_account (liabilities, "Accounts Payable",
+                              ACCT_TYPE_PAYABLE, m_currency);
+
+    make_expense_tree (expenses, m_opts.depth, std::max (m_opts.expense_accounts, 1));
+}
+
+void
+BookGenerator::make_securities ()
+{
+    if (m_opts.securities <= 0)
+        return;
+
+    auto table = gnc_commodity_table_get_table (m_book);
+    auto root = gnc_book_get_root_account (m_book);
+    auto assets = gnc_account_lookup_by_name (root, "Assets");
+    auto investments = make_account (assets, "Investments", ACCT_TYPE_ASSET,
+                                     m_currency);
+
+    for (int i = 0; i < m_opts.securities; ++i)
+    {
+        auto mnemonic = g_strdup_printf ("GEN%03d", i);
+        auto fullname = g_strdup_printf ("Generated Security %d", i);
+        auto comm = gnc_commodity_new (m_book, fullname, "BOOKGEN", mnemonic,
+                                       "", 10000);
+        comm = gnc_commodity_table_insert (table, comm);
+        auto acc = make_account (investments, mnemonic, ACCT_TYPE_STOCK, comm);
+        m_securities.push_back ({comm, acc, rand_range (1000, 20000), 0});
+        g_free (fullname);
+        g_free (mnemonic);
+    }
+}
+
+void
+BookGenerator::make_transfer (time64 date, Account *from, Account *to,
+                              gnc_numeric amount, const char *desc)
+{
+    auto trans = xaccMallocTransaction (m_book);
+    auto from_split = xaccMallocSplit (m_book);
+    auto to_split = xaccMallocSplit (m_book);
+
+    xaccTransBeginEdit (trans);
+    xaccTransSetCurrency (trans, m_currency);
+    xaccTransSetDatePostedSecsNormalized (trans, date);
+    xaccTransSetDateEnteredSecs (trans, date);
+    xaccTransSetDescription (trans, desc);
+
+    xaccSplitSetParent (from_split, trans);
+    xaccSplitSetAccount (from_split, from);
+    xaccSplitSetAmount (from_split, gnc_numeric_neg (amount));
+    xaccSplitSetValue (from_split, gnc_numeric_neg (amount));
+
+    xaccSplitSetParent (to_split, trans);
+    xaccSplitSetAccount (to_split, to);
+    xaccSplitSetAmount (to_split, amount);
+    xaccSplitSetValue (to_split, amount);
+    xaccSplitSetMemo (to_split, desc);
+
+    /* Most bank and card splits have been cleared or reconciled. */
+    if (chance (60))
+        xaccSplitSetReconcile (from_split, chance (80) ? YREC : CREC);
+    xaccTransCommitEdit (trans);
+}
+
+void
+BookGenerator::make_day (time64 date, int day)
+{
+    for (int i = 0; i < m_opts.txns_per_day; ++i)
+    {
+        auto roll = rand_range (0, 99);
+        auto payee = g_strdup_printf ("Payee %" PRId64, rand_range (0, 999));
+        if (roll < 70)
+        {
+            auto from = chance (60) ? pick (m_banks) : pick (m_credit_cards);
+            make_transfer (date, from, pick (m_expenses),
+                           gnc_numeric_create (rand_range (100, 50000), 100),
+                           payee);
+        }
+        else if (roll < 85)
+            make_transfer (date, pick (m_income), pick (m_banks),
+                           gnc_numeric_create (rand_range (1000, 500000), 100),
+                           payee);
+        else
+            make_transfer (date, pick (m_banks), pick (m_credit_cards),
+                           gnc_numeric_create (rand_range (1000, 200000), 100),
+                           "Card payment");
+        g_free (payee);
+    }
+
+    /* Salary on the 1st and 15th of the month. */
+    auto gdate = time64_to_gdate (date);
+    if (g_date_get_day (&gdate) == 1 || g_date_get_day (&gdate) == 15)
+        make_transfer (date, m_income[0], m_banks[0],
+                       gnc_numeric_create (350000 + day % 7 * 100, 100),
+                       "Salary");
+}
+
+/* Move every security's price by up to 2% a day. */
+void
+BookGenerator::make_prices (time64 date)
+{
+    auto pdb = gnc_pricedb_get_db (m_book);
+    for (auto& sec : m_securities)
+    {
+        sec.price = std::max<int64_t> (100, sec.price +
+                                       sec.price * rand_range (-200, 200) /
+                                       10000);
+        auto price = gnc_price_create (m_book);
+        gnc_price_begin_edit (price);
+        gnc_price_set_commodity (price, sec.commodity);
+        gnc_price_set_currency (price, m_currency);
+        gnc_price_set_time64 (price, date);
+        gnc_price_set_source (price, PRICE_SOURCE_FQ);
+        gnc_price_set_typestr (price, PRICE_TYPE_LAST);
+        gnc_price_set_value (price, gnc_numeric_create (sec.price, 100));
+        gnc_price_commit_edit (price);
+        gnc_pricedb_add_price (pdb, price);
+        gnc_price_unref (price);
+    }
+}
+
+/* Buy or sell a security and assign the stock split to lots with the
+ * account's lot policy. */
+void
+BookGenerator::make_trade (time64 date)
+{
+    auto& sec = m_securities[rand_range (0, m_securities.size () - 1)];
+    int64_t shares;
+    if (sec.holding > 0 && chance (30))
+        shares = -rand_range (1, sec.holding);
+    else
+        shares = rand_range (1, 100);
+    sec.holding += shares;
+
+    auto bank = m_banks[0];
+    auto value = gnc_numeric_create (shares * sec.price, 100);
+    auto trans = xaccMallocTransaction (m_book);
+    auto stock_split = xaccMallocSplit (m_book);
+    auto cash_split = xaccMallocSplit (m_book);
+
+    xaccTransBeginEdit (trans);
+    xaccTransSetCurrency (trans, m_currency);
+    xaccTransSetDatePostedSecsNormalized (trans, date);
+    xaccTransSetDateEnteredSecs (trans, date);
+    xaccTransSetDescription (trans, shares > 0 ? "Buy" : "Sell");
+
+    xaccSplitSetParent (stock_split, trans);
+    xaccSplitSetAccount (stock_split, sec.account);
+    xaccSplitSetAmount (stock_split, gnc_numeric_create (shares, 1));
+    xaccSplitSetValue (stock_split, value);
+
+    xaccSplitSetParent (cash_split, trans);
+    xaccSplitSetAccount (cash_split, bank);
+    xaccSplitSetAmount (cash_split, gnc_numeric_neg (value));
+    xaccSplitSetValue (cash_split, gnc_numeric_neg (value));
+    xaccTransCommitEdit (trans);
+
+    xaccSplitAssign (stock_split);
+}
+
+void
+BookGenerator::make_invoice (time64 date, bool bill)
+{
+    GncOwner owner;
+    auto invoice = gncInvoiceCreate (m_book);
+    auto id = bill ? g_strdup_printf ("B%06d", ++m_num_bills) :
+        g_strdup_printf ("I%06d", ++m_num_invoices);
+
+    if (bill)
+        gncOwnerInitVendor (&owner, pick (m_vendors));
+    else
+        gncOwnerInitCustomer (&owner, pick (m_customers));
+
+    gncInvoiceBeginEdit (invoice);
+    gncInvoiceSetID (invoice, id);
+    gncInvoiceSetOwner (invoice, &owner);
+    gncInvoiceSetCurrency (invoice, m_currency);
+    gncInvoiceSetDateOpened (invoice, date);
+
+    auto gdate = time64_to_gdate (date);
+    for (int i = rand_range (1, 4); i > 0; --i)
+    {
+        auto entry = gncEntryCreate (m_book);
+        auto quantity = gnc_numeric_create (rand_range (1, 20), 1);
+        auto price = gnc_numeric_create (rand_range (500, 100000), 100);
+        gncEntryBeginEdit (entry);
+        gncEntrySetDateGDate (entry, &gdate);
+        gncEntrySetDateEntered (entry, date);
+        gncEntrySetDescription (entry, bill ? "Supplies" : "Services");
+        gncEntrySetQuantity (entry, quantity);
+        if (bill)
+        {
+            gncEntrySetBillAccount (entry, pick (m_expenses));
+            gncEntrySetBillPrice (entry, price);
+        }
+        else
+        {
+            gncEntrySetInvAccount (entry, m_income[1]);
+            gncEntrySetInvPrice (entry, price);
+        }
+        gncEntryCommitEdit (entry);
+        gncInvoiceAddEntry (invoice, entry);
+    }
+    gncInvoiceCommitEdit (invoice);
+
+    gncInvoicePostToAccount (invoice, bill ? m_payable : m_receivable, date,
+                             date + 30 * 86400, id, TRUE, FALSE);
+    g_free (id);
+}
+
+void
+BookGenerator::make_scheduled (time64 start)
+{
+    auto sxes = gnc_book_get_schedxactions (m_book);
+    auto start_date = time64_to_gdate (start);
+
+    for (int i = 0; i < m_opts.scheduled; ++i)
+    {
+        auto sx = xaccSchedXactionMalloc (m_book);
+        auto name = g_strdup_printf ("Scheduled %d", i);
+        auto recurrence = g_new0 (Recurrence, 1);
+        auto expense = pick (m_expenses);
+
+        gnc_sx_begin_edit (sx);
+        xaccSchedXactionSetName (sx, name);
+        recurrenceSet (recurrence, rand_range (1, 3), PERIOD_MONTH,
+                       &start_date, WEEKEND_ADJ_NONE);
+        gnc_sx_set_schedule (sx, g_list_append (nullptr, recurrence));
+        xaccSchedXactionSetStartDate (sx, &start_date);
+
+        auto tti = gnc_ttinfo_malloc ();
+        auto amount = gnc_numeric_create (rand_range (1000, 200000), 100);
+        gnc_ttinfo_set_description (tti, name);
+        gnc_ttinfo_set_currency (tti, m_currency);
+
+        auto debit = gnc_ttsplitinfo_malloc ();
+        gnc_ttsplitinfo_set_account (debit, expense);
+        gnc_ttsplitinfo_set_debit_formula_numeric (debit, amount);
+        gnc_ttinfo_append_template_split (tti, debit);
+
+        auto credit = gnc_ttsplitinfo_malloc ();
+        gnc_ttsplitinfo_set_account (credit, pick (m_banks));
+        gnc_ttsplitinfo_set_credit_formula_numeric (credit, amount);
+        gnc_ttinfo_append_template_split (tti, credit);
+
+        auto tt_list = g_list_append (nullptr, tti);
+        xaccSchedXactionSetTemplateTrans (sx, tt_list, m_book);
+        g_list_free (tt_list);
+        gnc_ttinfo_free (tti);
+        gnc_sx_commit_edit (sx);
+
+        gnc_sxes_add_sx (sxes, sx);
+        g_free (name);
+    }
+}
+
+void
+BookGenerator::generate ()
+{
+    make_accounts ();
+    make_securities ();
+
+    for (int i = 0; i < m_opts.customers; ++i)
+    {
+        auto customer = gncCustomerCreate (m_book);
+        auto id = g_strdup_printf ("C%05d", i);
+        auto name = g_strdup_printf ("Customer %d", i);
+        gncCustomerBeginEdit (customer);
+        gncCustomerSetID (customer, id);
+        gncCustomerSetName (customer, name);
+        gncCustomerSetCurrency (customer, m_currency);
+        gncCustomerCommitEdit (customer);
+        m_customers.push_back (customer);
+        g_free (name);
+        g_free (id);
+    }
+    for (int i = 0; i < m_opts.vendors; ++i)
+    {
+        auto vendor = gncVendorCreate (m_book);
+        auto id = g_strdup_printf ("V%05d", i);
+        auto name = g_strdup_printf ("Vendor %d", i);
+        gncVendorBeginEdit (vendor);
+        gncVendorSetID (vendor, id);
+        gncVendorSetName (vendor, name);
+        gncVendorSetCurrency (vendor, m_currency);
+        gncVendorCommitEdit (vendor);
+        m_vendors.push_back (vendor);
+        g_free (name);
+        g_free (id);
+    }
+
+    auto start = gnc_dmy2time64_neutral (1, 1, m_opts.start_year);
+    auto end = gnc_dmy2time64_neutral (1, 1, m_opts.start_year + m_opts.years);
+    /* Start the scheduled transactions where the history ends so that
+     * opening the book doesn't create years of instances. */
+    make_scheduled (end);
+
+    /* Hold the accounts open so each account's splits are sorted once
+     * at the end rather than on every insertion. */
+    auto accounts = gnc_account_get_descendants (gnc_book_get_root_account (m_book));
+    for (auto node = accounts; node; node = g_list_next (node))
+        xaccAccountBeginEdit (static_cast<Account*>(node->data));
+
+    int day = 0;
+    for (auto date = start; date < end; date += 86400, ++day)
+    {
+        make_day (date, day);
+        make_prices (date);
+
+        auto gdate = time64_to_gdate (date);
+        auto mday = static_cast<int>(g_date_get_day (&gdate));
+        auto month_days = static_cast<int>(g_date_get_days_in_month
+                                           (g_date_get_month (&gdate),
+                                            g_date_get_year (&gdate)));
+        /* Spread the monthly counts evenly over the days of the month. */
+        auto due = [mday, month_days](int per_month)
+        {
+            return per_month * mday / month_days -
+                per_month * (mday - 1) / month_days;
+        };
+        if (!m_securities.empty ())
+            for (int i = due (m_opts.trades_per_month); i > 0; --i)
+                make_trade (date);
+        if (!m_customers.empty ())
+            for (int i = due (m_opts.invoices_per_month); i > 0; --i)
+                make_invoice (date, false);
+        if (!m_vendors.empty ())
+            for (int i = due (m_opts.invoices_per_month / 2); i > 0; --i)
+                make_invoice (date, true);
+    }
+
+    for (auto node = accounts; node; node = g_list_next (node))
+        xaccAccountCommitEdit (static_cast<Account*>(node->data));
+    g_list_free (accounts);
+}
+
+/* Write the generated book to uri. The book is moved into a fresh
+ * session with qof_session_swap_data as QofSession::save_as does, so
+ * backends that write through on every commit see it only once. */
+static bool
+save_book (QofBook *book, const std::string& uri)
+{
+    auto source = qof_session_new (book);
+    auto session = qof_session_new (qof_book_new ());
+    qof_session_begin (session, uri.c_str (), SESSION_NEW_OVERWRITE);
+    auto err = qof_session_get_error (session);
+    if (err == ERR_BACKEND_NO_ERR)
+    {
+        qof_session_swap_data (source, session);
+        qof_book_mark_session_dirty (qof_session_get_book (session));
+        qof_session_save (session, nullptr);
+        err = qof_session_get_error (session);
+        qof_session_swap_data (session, source);
+    }
+    if (err != ERR_BACKEND_NO_ERR)
+        std::cerr << "gnc-bookgen: failed to write " << uri << ": "
+                  << qof_session_get_error_message (session) << std::endl;
+    qof_session_end (session);
+    qof_session_destroy (session);
+    qof_session_destroy (source);
+    return err == ERR_BACKEND_NO_ERR;
+}
+
+int
+main (int argc, char** argv)
+{
+    BookGenOptions opts;
+    std::string uri;
+
+    bpo::options_description desc ("Usage: gnc-bookgen [options] URI\n\n"
+                                    "Options");
+    desc.add_options ()
+        ("help,h", "Show this help and exit.")
+        ("seed", bpo::value (&opts.seed)->default_value (opts.seed),
+         "Random seed; equal seeds and sizes give equal books.")
+        ("start-year", bpo::value (&opts.start_year)->default_value (opts.start_year),
+         "Year of the first transaction.")
+        ("years", bpo::value (&opts.years)->default_value (opts.years),
+         "Number of years of transactions and prices.")
+        ("accounts", bpo::value (&opts.expense_accounts)->default_value (opts.expense_accounts),
+         "Number of leaf expense accounts.")
+        ("depth", bpo::value (&opts.depth)->default_value (opts.depth),
+         "Depth of the expense account tree.")
+        ("txns-per-day", bpo::value (&opts.txns_per_day)->default_value (opts.txns_per_day),
+         "Number of everyday transactions per day.")
+        ("securities", bpo::value (&opts.securities)->default_value (opts.securities),
+         "Number of securities with daily prices.")
+        ("trades-per-month", bpo::value (&opts.trades_per_month)->default_value (opts.trades_per_month),
+         "Number of security trades per month, assigned to lots.")
+        ("scheduled", bpo::value (&opts.scheduled)->default_value (opts.scheduled),
+         "Number of scheduled transactions.")
+        ("customers", bpo::value (&opts.customers)->default_value (opts.customers),
+         "Number of customers.")
+        ("vendors", bpo::value (&opts.vendors)->default_value (opts.vendors),
+         "Number of vendors.")
+        ("invoices-per-month", bpo::value (&opts.invoices_per_month)->default_value (opts.invoices_per_month),
+         "Number of posted invoices per month; half as many bills are posted.");
+
+    bpo::options_description hidden;
+    hidden.add_options () ("uri", bpo::value (&uri));
+    bpo::options_description all;
+    all.add (desc).add (hidden);
+    bpo::positional_options_description positional;
+    positional.add ("uri", 1);
+
+    bpo::variables_map vm;
+    try
+    {
+        bpo::store (bpo::command_line_parser (argc, argv).options (all)
+                    .positional (positional).run (), vm);
+        bpo::notify (vm);
+    }
+    catch (const bpo::error& err)
+    {
+        std::cerr << "gnc-bookgen: " << err.what () << "\n\n" << desc;
+        return 1;
+    }
+
+    if (vm.count ("help") || uri.empty ())
+    {
+        std::cout << desc;
+        return vm.count ("help") ? 0 : 1;
+    }
+    if (opts.years <= 0 || opts.txns_per_day < 0)
+    {
+        std::cerr << "gnc-bookgen: --years must be positive and "
+                  << "--txns-per-day must not be negative.\n";
+        return 1;
+    }
+
+    gnc_engine_init (0, nullptr);
+    xaccLogDisable ();
+
+    auto book = qof_book_new ();
+    BookGenerator{book, opts}.generate ();
+    auto ok = save_book (book, uri);
+
+    gnc_engine_shutdown ();
+    return ok ? 0 : 1;
+}
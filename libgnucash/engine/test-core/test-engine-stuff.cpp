@@ -69,6 +69,8 @@
 #include "test-engine-strings.h"
 #include <qofinstance-p.h>
 
+#include <vector>
+
 static GHashTable *exclude_kvp_types = NULL;
 static gint kvp_max_depth = 5;
 static gint kvp_frame_max_elements = 10;
@@ -1860,6 +1862,118 @@ add_random_transactions_to_book (QofBook *book, gint num_transactions)
     g_list_free (accounts);
 }
 
+/* Deterministic books for benchmarks. Everything is derived from the
+ * loop counters so that runs with the same sizes are comparable. */
+static const time64 bench_start_time = 946684800; /* 2000-01-01 UTC */
+
+static Account*
+make_benchmark_account (QofBook *book, Account *parent, gint index,
+                        gnc_commodity *currency)
+{
+    auto acc = xaccMallocAccount (book);
+    auto name = g_strdup_printf ("Account %d", index);
+
+    xaccAccountBeginEdit (acc);
+    xaccAccountSetName (acc, name);
+    xaccAccountSetType (acc, index % 2 ? ACCT_TYPE_EXPENSE : ACCT_TYPE_BANK);
+    xaccAccountSetCommodity (acc, currency);
+    gnc_account_append_child (parent, acc);
+    xaccAccountCommitEdit (acc);
+    g_free (name);
+    return acc;
+}
+
+void
+make_benchmark_book (QofBook *book, gint num_accounts, gint num_splits)
+{
+    g_return_if_fail (book);
+    g_return_if_fail (num_accounts > 1);
+
+    auto table = gnc_commodity_table_get_table (book);
+    auto currency = gnc_commodity_table_lookup (table,
+                                                GNC_COMMODITY_NS_CURRENCY,
+                                                "USD");
+    if (!currency)
+    {
+        currency = gnc_commodity_new (book, "US Dollar",
+                                      GNC_COMMODITY_NS_CURRENCY, "USD",
+                                      "840", 100);
+        currency = gnc_commodity_table_insert (table, currency);
+    }
+    auto stock = gnc_commodity_new (book, "Benchmark Fund", "FUND", "BNCH",
+                                    "", 1000);
+    stock = gnc_commodity_table_insert (table, stock);
+
+    auto root = gnc_book_get_root_account (book);
+    std::vector<Account*> accounts;
+    accounts.reserve (num_accounts);
+    for (gint i = 0; i < num_accounts; ++i)
+        accounts.push_back (make_benchmark_account (book, root, i, currency));
+
+    /* Hold the accounts open so the splits are sorted once at the end
+     * rather than on every insertion. */
+    for (auto acc : accounts)
+        xaccAccountBeginEdit (acc);
+
+    for (gint i = 0; i < num_splits / 2; ++i)
+    {
+        auto trans = xaccMallocTransaction (book);
+        auto from = xaccMallocSplit (book);
+        auto to = xaccMallocSplit (book);
+        auto amount = gnc_numeric_create (100 + (i * INT64_C(7919)) % 100000,
+                                          100);
+        auto desc = g_strdup_printf ("Payee %d", i % 500);
+        auto posted = bench_start_time + static_cast<time64>(i) * 3600;
+        auto from_acc = accounts[i % num_accounts];
+        auto to_acc = accounts[(i % num_accounts + 1 + i % (num_accounts - 1))
+                               % num_accounts];
+
+        xaccTransBeginEdit (trans);
+        xaccTransSetCurrency (trans, currency);
+        xaccTransSetDatePostedSecsNormalized (trans, posted);
+        xaccTransSetDateEnteredSecs (trans, posted);
+        xaccTransSetDescription (trans, desc);
+
+        xaccSplitSetParent (from, trans);
+        xaccSplitSetAccount (from, from_acc);
+        xaccSplitSetAmount (from, gnc_numeric_neg (amount));
+        xaccSplitSetValue (from, gnc_numeric_neg (amount));
+        if (i % 3 == 0)
+            xaccSplitSetReconcile (from, CREC);
+
+        xaccSplitSetParent (to, trans);
+        xaccSplitSetAccount (to, to_acc);
+        xaccSplitSetAmount (to, amount);
+        xaccSplitSetValue (to, amount);
+        xaccSplitSetMemo (to, desc);
+
+        xaccTransCommitEdit (trans);
+        g_free (desc);
+    }
+
+    for (auto acc : accounts)
+        xaccAccountCommitEdit (acc);
+
+    auto pdb = gnc_pricedb_get_db (book);
+    for (gint i = 0; i < num_splits / 10; ++i)
+    {
+        auto price = gnc_price_create (book);
+        gnc_price_begin_edit (price);
+        gnc_price_set_commodity (price, stock);
+        gnc_price_set_currency (price, currency);
+        gnc_price_set_time64 (price, bench_start_time +
+                              static_cast<time64>(i) * 86400);
+        gnc_price_set_source (price, PRICE_SOURCE_USER_PRICE);
+        gnc_price_set_typestr (price, PRICE_TYPE_LAST);
+        gnc_price_set_value (price,
+                             gnc_numeric_create (10000 + (i * 31) % 5000,
+                                                 100));
+        gnc_price_commit_edit (price);
+        gnc_pricedb_add_price (pdb, price);
+        gnc_price_unref (price);
+    }
+}
+
 void
 make_random_changes_to_book (QofBook *book)
 {
@@ -103,6 +103,13 @@ QofSession * get_random_session (void);
 
 void add_random_transactions_to_book (QofBook *book, gint num_transactions);
 
+/** Populate book with num_accounts accounts in one currency holding
+ *  num_splits splits in two-split transactions an hour apart, plus one
+ *  price a day for a stock commodity for every ten splits. Unlike the
+ *  random functions the result depends only on the arguments, which
+ *  makes it suitable for benchmarks. */
+void make_benchmark_book (QofBook *book, gint num_accounts, gint num_splits);
+
 void make_random_changes_to_commodity (gnc_commodity *com);
 void make_random_changes_to_commodity_table (gnc_commodity_table *table);
 void make_random_changes_to_price (QofBook *book, GNCPrice *price);
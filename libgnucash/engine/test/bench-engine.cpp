@@ -0,0 +1,370 @@
+/********************************************************************
+ * bench-engine.cpp: Microbenchmarks for the engine's hot paths.     *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+/* Each benchmark is run against books of 1k to 1M splits built by
+ * make_benchmark_book(). Books are built once per size and shared
+ * between benchmarks. Run with --benchmark_out=<file>.json
+ * --benchmark_out_format=json to record results; the "benchmark"
+ * target does that for every benchmark program.
+ */
+
+#include <config.h>
+#include <benchmark/benchmark.h>
+
+#include <qof.h>
+#include <qofinstance-p.h>
+#include <Account.h>
+#include <Query.h>
+#include <Split.h>
+#include <Transaction.h>
+#include <TransLog.h>
+#include <cashobjects.h>
+#include <gnc-bulk-loader.hpp>
+#include <gnc-pricedb.h>
+#include <test-engine-stuff.h>
+
+#include <cinttypes>
+#include <map>
+#include <string>
+#include <vector>
+
+static const int bench_num_accounts = 50;
+static const time64 bench_start = 946684800; /* make_benchmark_book's */
+
+static QofBook*
+get_book (int num_splits)
+{
+    static std::map<int, QofBook*> books;
+    auto iter = books.find (num_splits);
+    if (iter != books.end())
+        return iter->second;
+
+    auto book = qof_book_new ();
+    make_benchmark_book (book, bench_num_accounts, num_splits);
+    books.emplace (num_splits, book);
+    return book;
+}
+
+static std::vector<Account*>
+get_accounts (QofBook *book)
+{
+    std::vector<Account*> accounts;
+    auto list = gnc_account_get_descendants (gnc_book_get_root_account (book));
+    for (auto node = list; node; node = g_list_next (node))
+        accounts.push_back (static_cast<Account*>(node->data));
+    g_list_free (list);
+    return accounts;
+}
+
+static gnc_commodity*
+get_currency (QofBook *book)
+{
+    return gnc_commodity_table_lookup (gnc_commodity_table_get_table (book),
+                                       GNC_COMMODITY_NS_CURRENCY, "USD");
+}
+
+static void
+split_sizes (benchmark::internal::Benchmark *bench)
+{
+    bench->RangeMultiplier (10)->Range (1000, 1000000)
+        ->Unit (benchmark::kMillisecond);
+}
+
+static void
+BM_gnc_numeric_add_fixed (benchmark::State& state)
+{
+    std::vector<gnc_numeric> values;
+    for (int64_t i = 0; i < state.range (0); ++i)
+        values.push_back (gnc_numeric_create (i * 7919 % 100000, 100));
+
+    for (auto _ : state)
+    {
+        auto sum = gnc_numeric_zero ();
+        for (auto val : values)
+            sum = gnc_numeric_add_fixed (sum, val);
+        benchmark::DoNotOptimize (sum);
+    }
+    state.SetItemsProcessed (state.iterations () * state.range (0));
+}
+BENCHMARK(BM_gnc_numeric_add_fixed)->Apply (split_sizes);
+
+static void
+BM_gnc_numeric_sum (benchmark::State& state)
+{
+    std::vector<gnc_numeric> values;
+    for (int64_t i = 0; i < state.range (0); ++i)
+        values.push_back (gnc_numeric_create (i * 7919 % 100000, 100));
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize (gnc_numeric_sum (values.data (),
+                                                   values.size ()));
+    state.SetItemsProcessed (state.iterations () * state.range (0));
+}
+BENCHMARK(BM_gnc_numeric_sum)->Apply (split_sizes);
+
+/* Insert one two-split transaction dated in the middle of a book of
+ * the given size, then remove it again untimed. */
+static void
+BM_split_insert (benchmark::State& state)
+{
+    auto book = get_book (state.range (0));
+    auto accounts = get_accounts (book);
+    auto currency = get_currency (book);
+    auto amount = gnc_numeric_create (12345, 100);
+    time64 posted = bench_start + state.range (0) / 2 * 1800;
+
+    for (auto _ : state)
+    {
+        auto trans = xaccMallocTransaction (book);
+        auto from = xaccMallocSplit (book);
+        auto to = xaccMallocSplit (book);
+
+        xaccTransBeginEdit (trans);
+        xaccTransSetCurrency (trans, currency);
+        xaccTransSetDatePostedSecsNormalized (trans, posted);
+        xaccSplitSetParent (from, trans);
+        xaccSplitSetAccount (from, accounts[0]);
+        xaccSplitSetAmount (from, gnc_numeric_neg (amount));
+        xaccSplitSetValue (from, gnc_numeric_neg (amount));
+        xaccSplitSetParent (to, trans);
+        xaccSplitSetAccount (to, accounts[1]);
+        xaccSplitSetAmount (to, amount);
+        xaccSplitSetValue (to, amount);
+        xaccTransCommitEdit (trans);
+
+        state.PauseTiming ();
+        xaccTransBeginEdit (trans);
+        xaccTransDestroy (trans);
+        xaccTransCommitEdit (trans);
+        state.ResumeTiming ();
+    }
+}
+BENCHMARK(BM_split_insert)->Apply (split_sizes);
+
+/* Load a thousand two-split transactions spread over the date range of
+ * a book of the given size through GncBulkLoader, then remove them
+ * again untimed. */
+static void
+BM_bulk_load (benchmark::State& state)
+{
+    auto book = get_book (state.range (0));
+    auto accounts = get_accounts (book);
+    auto currency = get_currency (book);
+    auto amount = gnc_numeric_create (12345, 100);
+    auto neg = gnc_numeric_neg (amount);
+    const int64_t num_trans = 1000;
+    auto spacing = state.range (0) * 1800 / num_trans;
+
+    for (auto _ : state)
+    {
+        GncBulkLoader loader {book};
+        for (int64_t i = 0; i < num_trans; ++i)
+            loader.add ({currency, bench_start + i * spacing, "", "Bulk", "",
+                         {{accounts[0], neg, neg, "", "", NREC},
+                          {accounts[1], amount, amount, "", "", NREC}}});
+        auto created = loader.commit ();
+
+        state.PauseTiming ();
+        for (auto trans : created)
+        {
+            xaccTransBeginEdit (trans);
+            xaccTransDestroy (trans);
+            xaccTransCommitEdit (trans);
+        }
+        state.ResumeTiming ();
+    }
+    state.SetItemsProcessed (state.iterations () * num_trans);
+}
+BENCHMARK(BM_bulk_load)->Apply (split_sizes);
+
+static void
+BM_balance_recompute (benchmark::State& state)
+{
+    auto accounts = get_accounts (get_book (state.range (0)));
+
+    for (auto _ : state)
+    {
+        for (auto acc : accounts)
+        {
+            g_object_set (acc, "balance-dirty", TRUE, nullptr);
+            xaccAccountRecomputeBalance (acc);
+        }
+    }
+    state.SetItemsProcessed (state.iterations () * state.range (0));
+}
+BENCHMARK(BM_balance_recompute)->Apply (split_sizes);
+
+static void
+BM_balance_as_of_date (benchmark::State& state)
+{
+    auto accounts = get_accounts (get_book (state.range (0)));
+    time64 date = bench_start + state.range (0) / 2 * 1800;
+
+    for (auto _ : state)
+        for (auto acc : accounts)
+            benchmark::DoNotOptimize (xaccAccountGetBalanceAsOfDate (acc,
+                                                                     date));
+    state.SetItemsProcessed (state.iterations () * accounts.size ());
+}
+BENCHMARK(BM_balance_as_of_date)->Apply (split_sizes);
+
+static void
+BM_price_lookup (benchmark::State& state)
+{
+    auto book = get_book (state.range (0));
+    auto pdb = gnc_pricedb_get_db (book);
+    auto currency = get_currency (book);
+    auto stock = gnc_commodity_table_lookup (gnc_commodity_table_get_table (book),
+                                             "FUND", "BNCH");
+    int64_t num_days = state.range (0) / 10;
+    int64_t day = 0;
+
+    for (auto _ : state)
+    {
+        day = (day + 7919) % num_days;
+        auto price = gnc_pricedb_lookup_nearest_in_time64 (pdb, stock, currency,
+                                                           bench_start + day * 86400 + 43200);
+        benchmark::DoNotOptimize (price);
+        gnc_price_unref (price);
+    }
+}
+BENCHMARK(BM_price_lookup)->Apply (split_sizes);
+
+/* Find the splits in one month of the book's date range. */
+static void
+BM_query_run (benchmark::State& state)
+{
+    auto book = get_book (state.range (0));
+    time64 start = bench_start + state.range (0) / 4 * 1800;
+
+    for (auto _ : state)
+    {
+        auto query = qof_query_create_for (GNC_ID_SPLIT);
+        qof_query_set_book (query, book);
+        xaccQueryAddDateMatchTT (query, TRUE, start, TRUE,
+                                 start + 30 * 86400, QOF_QUERY_AND);
+        auto results = qof_query_run (query);
+        benchmark::DoNotOptimize (results);
+        qof_query_destroy (query);
+    }
+    state.SetItemsProcessed (state.iterations () * state.range (0));
+}
+BENCHMARK(BM_query_run)->Apply (split_sizes);
+
+static void
+BM_kvp_access (benchmark::State& state)
+{
+    auto book = get_book (state.range (0));
+    auto accounts = get_accounts (book);
+    static std::map<int64_t, bool> tagged;
+    std::vector<std::string> path{"online_id"};
+
+    if (!tagged[state.range (0)])
+    {
+        GValue value = G_VALUE_INIT;
+        g_value_init (&value, G_TYPE_STRING);
+        for (auto acc : accounts)
+            for (auto node = xaccAccountGetSplitList (acc); node;
+                 node = g_list_next (node))
+            {
+                auto split = static_cast<Split*>(node->data);
+                auto id = guid_to_string (qof_instance_get_guid (split));
+                g_value_take_string (&value, id);
+                qof_instance_set_path_kvp (QOF_INSTANCE (split), &value, path);
+            }
+        g_value_unset (&value);
+        tagged[state.range (0)] = true;
+    }
+
+    for (auto _ : state)
+        for (auto acc : accounts)
+            for (auto node = xaccAccountGetSplitList (acc); node;
+                 node = g_list_next (node))
+            {
+                GValue value = G_VALUE_INIT;
+                qof_instance_get_path_kvp (QOF_INSTANCE (node->data), &value,
+                                           path);
+                benchmark::DoNotOptimize (g_value_get_string (&value));
+                g_value_unset (&value);
+            }
+    state.SetItemsProcessed (state.iterations () * state.range (0));
+}
+BENCHMARK(BM_kvp_access)->Apply (split_sizes);
+
+/* Train the Bayesian import map with one entry per imported split and
+ * time looking up a destination for a statement line. */
+static void
+BM_import_match_bayes (benchmark::State& state)
+{
+    auto book = qof_book_new ();
+    make_benchmark_book (book, bench_num_accounts, 0);
+    auto accounts = get_accounts (book);
+    auto source = accounts[0];
+
+    auto make_tokens = [](int64_t i)
+    {
+        GList *tokens = nullptr;
+        tokens = g_list_prepend (tokens, g_strdup_printf ("payee%" PRId64,
+                                                          i % 500));
+        tokens = g_list_prepend (tokens, g_strdup_printf ("ref%" PRId64,
+                                                          i % 97));
+        tokens = g_list_prepend (tokens, g_strdup ("card"));
+        return tokens;
+    };
+
+    for (int64_t i = 0; i < state.range (0); ++i)
+    {
+        auto tokens = make_tokens (i);
+        gnc_account_imap_add_account_bayes (source, tokens,
+                                            accounts[1 + i % (bench_num_accounts - 1)]);
+        g_list_free_full (tokens, g_free);
+    }
+
+    int64_t i = 0;
+    for (auto _ : state)
+    {
+        state.PauseTiming ();
+        auto tokens = make_tokens (i++);
+        state.ResumeTiming ();
+        benchmark::DoNotOptimize (gnc_account_imap_find_account_bayes (source,
+                                                                       tokens));
+        state.PauseTiming ();
+        g_list_free_full (tokens, g_free);
+        state.ResumeTiming ();
+    }
+    qof_book_destroy (book);
+}
+BENCHMARK(BM_import_match_bayes)->RangeMultiplier (10)->Range (1000, 100000)
+    ->Unit (benchmark::kMicrosecond);
+
+int
+main (int argc, char** argv)
+{
+    qof_init ();
+    cashobjects_register ();
+    xaccLogDisable ();
+    benchmark::Initialize (&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments (argc, argv))
+        return 1;
+    benchmark::RunSpecifiedBenchmarks ();
+    qof_close ();
+    return 0;
+}
@@ -0,0 +1,109 @@
+/********************************************************************
+ * bench-gnc-guid.cpp: Microbenchmarks for GUID hashing and parsing. *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+#include <config.h>
+#include <benchmark/benchmark.h>
+
+#include "../guid.hpp"
+
+#include <string>
+#include <vector>
+
+static const size_t bench_num_guids = 1024;
+
+static std::vector<GncGUID>
+make_guids ()
+{
+    std::vector<GncGUID> guids;
+    for (size_t i = 0; i < bench_num_guids; ++i)
+        guids.push_back (gnc::GUID::create_random ());
+    return guids;
+}
+
+static std::vector<std::string>
+make_strings ()
+{
+    std::vector<std::string> strings;
+    for (auto& guid : make_guids ())
+        strings.push_back (gnc::GUID {guid}.to_string ());
+    return strings;
+}
+
+static void
+BM_guid_hash (benchmark::State& state)
+{
+    auto guids = make_guids ();
+    for (auto _ : state)
+        for (auto& guid : guids)
+            benchmark::DoNotOptimize (guid_hash_to_guint (&guid));
+    state.SetItemsProcessed (state.iterations () * guids.size ());
+}
+BENCHMARK(BM_guid_hash);
+
+static void
+BM_guid_equal (benchmark::State& state)
+{
+    auto guids = make_guids ();
+    for (auto _ : state)
+        for (size_t i = 1; i < guids.size (); ++i)
+            benchmark::DoNotOptimize (guid_equal (&guids[i - 1], &guids[i]));
+    state.SetItemsProcessed (state.iterations () * (guids.size () - 1));
+}
+BENCHMARK(BM_guid_equal);
+
+static void
+BM_guid_to_string_buff (benchmark::State& state)
+{
+    auto guids = make_guids ();
+    char buff[GUID_ENCODING_LENGTH + 1];
+    for (auto _ : state)
+        for (auto& guid : guids)
+            benchmark::DoNotOptimize (guid_to_string_buff (&guid, buff));
+    state.SetItemsProcessed (state.iterations () * guids.size ());
+}
+BENCHMARK(BM_guid_to_string_buff);
+
+static void
+BM_string_to_guid (benchmark::State& state)
+{
+    auto strings = make_strings ();
+    GncGUID guid;
+    for (auto _ : state)
+        for (auto& str : strings)
+            benchmark::DoNotOptimize (string_to_guid (str.c_str (), &guid));
+    state.SetItemsProcessed (state.iterations () * strings.size ());
+}
+BENCHMARK(BM_string_to_guid);
+
+static void
+BM_GUID_from_string_view (benchmark::State& state)
+{
+    auto strings = make_strings ();
+    gnc::GUID guid;
+    for (auto _ : state)
+        for (auto& str : strings)
+            benchmark::DoNotOptimize (gnc::GUID::from_string (std::string_view {str},
+                                                              guid));
+    state.SetItemsProcessed (state.iterations () * strings.size ());
+}
+BENCHMARK(BM_GUID_from_string_view);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,187 @@
+/********************************************************************\
+ * gtest-gnc-book-snapshot.cpp -- Unit tests for GncBookSnapshot    *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+#include <config.h>
+#include "../gnc-book-snapshot.hpp"
+#include "../Transaction.h"
+#include "../Split.h"
+#include "../cashobjects.h"
+#include "../gnc-commodity.h"
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+class BookSnapshotTest : public testing::Test
+{
+protected:
+    void SetUp () override
+    {
+        static bool registered = false;
+        if (!registered)
+        {
+            qof_init ();
+            cashobjects_register ();
+            registered = true;
+        }
+        m_book = qof_book_new ();
+        auto table = gnc_commodity_table_get_table (m_book);
+        m_usd = gnc_commodity_table_lookup (table, GNC_COMMODITY_NS_CURRENCY,
+                                            "USD");
+        if (!m_usd)
+        {
+            m_usd = gnc_commodity_new (m_book, "US Dollar",
+                                       GNC_COMMODITY_NS_CURRENCY, "USD",
+                                       "840", 100);
+            gnc_commodity_table_insert (table, m_usd);
+        }
+        auto root = gnc_account_create_root (m_book);
+        m_bank = make_account (root, "Bank", ACCT_TYPE_BANK);
+        m_income = make_account (root, "Income", ACCT_TYPE_INCOME);
+    }
+    void TearDown () override
+    {
+        qof_book_destroy (m_book);
+    }
+    Account *make_account (Account *parent, const char *name,
+                           GNCAccountType type)
+    {
+        auto acc = xaccMallocAccount (m_book);
+        xaccAccountBeginEdit (acc);
+        xaccAccountSetName (acc, name);
+        xaccAccountSetType (acc, type);
+        xaccAccountSetCommodity (acc, m_usd);
+        xaccAccountCommitEdit (acc);
+        gnc_account_append_child (parent, acc);
+        return acc;
+    }
+    Transaction *add_transaction (time64 date, gint64 cents)
+    {
+        auto trans = xaccMallocTransaction (m_book);
+        auto amount = gnc_numeric_create (cents, 100);
+        xaccTransBeginEdit (trans);
+        xaccTransSetCurrency (trans, m_usd);
+        xaccTransSetDatePostedSecs (trans, date);
+        xaccTransSetDescription (trans, "Salary");
+        for (auto [acc, amt] : {std::pair {m_bank, amount},
+                                std::pair {m_income, gnc_numeric_neg (amount)}})
+        {
+            auto split = xaccMallocSplit (m_book);
+            xaccSplitSetParent (split, trans);
+            xaccSplitSetAccount (split, acc);
+            xaccSplitSetAmount (split, amt);
+            xaccSplitSetValue (split, amt);
+        }
+        xaccTransCommitEdit (trans);
+        return trans;
+    }
+    QofBook *m_book {};
+    gnc_commodity *m_usd {};
+    Account *m_bank {};
+    Account *m_income {};
+};
+
+TEST_F (BookSnapshotTest, copies_book)
+{
+    auto trans = add_transaction (1000, 12345);
+    auto snap = gnc_book_snapshot (m_book);
+
+    ASSERT_EQ (snap->accounts ().size (), 3u);
+    auto bank = snap->find_account (*xaccAccountGetGUID (m_bank));
+    ASSERT_NE (bank, nullptr);
+    EXPECT_EQ (bank->name, "Bank");
+    EXPECT_EQ (bank->type, ACCT_TYPE_BANK);
+    EXPECT_TRUE (gnc_numeric_equal (bank->balance,
+                                    gnc_numeric_create (12345, 100)));
+
+    auto strans = snap->find_transaction (*xaccTransGetGUID (trans));
+    ASSERT_NE (strans, nullptr);
+    EXPECT_EQ (strans->description, "Salary");
+    EXPECT_EQ (strans->date_posted, xaccTransGetDate (trans));
+    EXPECT_EQ (strans->splits.size (), 2u);
+}
+
+TEST_F (BookSnapshotTest, reused_until_changed)
+{
+    add_transaction (1000, 100);
+    auto snap1 = gnc_book_snapshot (m_book);
+    auto snap2 = gnc_book_snapshot (m_book);
+    EXPECT_EQ (snap1, snap2);
+
+    auto trans = add_transaction (2000, 200);
+    auto snap3 = gnc_book_snapshot (m_book);
+    EXPECT_NE (snap1, snap3);
+    EXPECT_EQ (snap1->transactions ().size (), 1u);
+    EXPECT_EQ (snap3->transactions ().size (), 2u);
+
+    xaccTransBeginEdit (trans);
+    xaccTransSetDescription (trans, "Bonus");
+    xaccTransCommitEdit (trans);
+    auto snap4 = gnc_book_snapshot (m_book);
+    EXPECT_EQ (snap3->find_transaction (*xaccTransGetGUID (trans))->description,
+               "Salary");
+    EXPECT_EQ (snap4->find_transaction (*xaccTransGetGUID (trans))->description,
+               "Bonus");
+
+    gnc_book_snapshot_invalidate (m_book);
+    EXPECT_NE (gnc_book_snapshot (m_book), snap4);
+}
+
+TEST_F (BookSnapshotTest, balance_as_of)
+{
+    auto t1 = add_transaction (3000, 300);
+    auto t2 = add_transaction (1000, 100);
+    auto t3 = add_transaction (2000, 200);
+    auto snap = gnc_book_snapshot (m_book);
+    auto bank = *xaccAccountGetGUID (m_bank);
+
+    EXPECT_TRUE (gnc_numeric_zero_p (snap->balance_as_of (bank,
+                                                          xaccTransGetDate (t2) - 1)));
+    EXPECT_TRUE (gnc_numeric_equal (snap->balance_as_of (bank, xaccTransGetDate (t3)),
+                                    gnc_numeric_create (300, 100)));
+    EXPECT_TRUE (gnc_numeric_equal (snap->balance_as_of (bank, xaccTransGetDate (t1)),
+                                    gnc_numeric_create (600, 100)));
+    EXPECT_TRUE (gnc_numeric_zero_p (snap->balance_as_of (*guid_null (), 5000)));
+}
+
+TEST_F (BookSnapshotTest, concurrent_readers)
+{
+    for (int i = 0; i < 100; ++i)
+        add_transaction (1000 + i * 86400, 100);
+    auto snap = gnc_book_snapshot (m_book);
+    auto bank = *xaccAccountGetGUID (m_bank);
+
+    std::vector<std::thread> readers;
+    std::vector<gnc_numeric> results (4);
+    for (size_t i = 0; i < results.size (); ++i)
+        readers.emplace_back ([&snap, &results, bank, i]()
+        {
+            results[i] = snap->balance_as_of (bank, G_MAXINT64);
+        });
+    /* Keep editing the book while the readers run. */
+    add_transaction (1000, 100);
+    for (auto& reader : readers)
+        reader.join ();
+
+    for (auto result : results)
+        EXPECT_TRUE (gnc_numeric_equal (result, gnc_numeric_create (10000, 100)));
+}
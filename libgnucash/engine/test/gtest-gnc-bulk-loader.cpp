@@ -0,0 +1,198 @@
+/********************************************************************\
+ * gtest-gnc-bulk-loader.cpp -- Unit tests for GncBulkLoader        *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+#include <config.h>
+#include "../gnc-bulk-loader.hpp"
+#include "../gnc-commodity.h"
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <utility>
+
+class BulkLoaderTest : public testing::Test
+{
+protected:
+    void SetUp () override
+    {
+        m_book = qof_book_new ();
+        m_usd = gnc_commodity_new (m_book, "US Dollar",
+                                   GNC_COMMODITY_NS_CURRENCY, "USD", "840",
+                                   100);
+        auto root = gnc_account_create_root (m_book);
+        m_bank = make_account (root, "Bank");
+        m_expense = make_account (root, "Expense");
+    }
+    void TearDown () override
+    {
+        qof_book_destroy (m_book);
+    }
+    Account *make_account (Account *parent, const char *name)
+    {
+        auto acc = xaccMallocAccount (m_book);
+        xaccAccountBeginEdit (acc);
+        xaccAccountSetName (acc, name);
+        xaccAccountSetCommodity (acc, m_usd);
+        xaccAccountCommitEdit (acc);
+        gnc_account_append_child (parent, acc);
+        return acc;
+    }
+    GncBulkTransaction make_trans (time64 date, gint64 cents)
+    {
+        auto amount = gnc_numeric_create (cents, 100);
+        auto neg = gnc_numeric_neg (amount);
+        return {m_usd, date, "", "Groceries", "",
+                {{m_expense, amount, amount, "", "", NREC},
+                 {m_bank, neg, neg, "", "", NREC}}};
+    }
+    QofBook *m_book {};
+    gnc_commodity *m_usd {};
+    Account *m_bank {};
+    Account *m_expense {};
+};
+
+TEST_F (BulkLoaderTest, creates_transactions)
+{
+    GncBulkLoader loader {m_book};
+    loader.add (make_trans (3 * 86400, 300));
+    loader.add (make_trans (1 * 86400, 100));
+    loader.add (make_trans (2 * 86400, 200));
+    EXPECT_EQ (loader.size (), 3u);
+
+    auto created = loader.commit ();
+    EXPECT_EQ (loader.size (), 0u);
+    ASSERT_EQ (created.size (), 3u);
+    EXPECT_STREQ (xaccTransGetDescription (created[0]), "Groceries");
+    EXPECT_EQ (xaccTransCountSplits (created[0]), 2);
+    EXPECT_TRUE (xaccTransIsBalanced (created[1]));
+
+    EXPECT_TRUE (gnc_numeric_equal (xaccAccountGetBalance (m_expense),
+                                    gnc_numeric_create (600, 100)));
+    EXPECT_TRUE (gnc_numeric_equal (xaccAccountGetBalance (m_bank),
+                                    gnc_numeric_create (-600, 100)));
+    EXPECT_FALSE (gnc_account_get_defer_bal_computation (m_bank));
+
+    time64 last = 0;
+    for (auto node = xaccAccountGetSplitList (m_expense); node;
+         node = g_list_next (node))
+    {
+        auto date = xaccTransGetDate (xaccSplitGetParent (GNC_SPLIT (node->data)));
+        EXPECT_LE (last, date);
+        last = date;
+    }
+}
+
+TEST_F (BulkLoaderTest, keeps_deferred_balances)
+{
+    gnc_account_set_defer_bal_computation (m_bank, TRUE);
+    GncBulkLoader loader {m_book};
+    loader.add (make_trans (86400, 100));
+    loader.commit ();
+
+    EXPECT_TRUE (gnc_account_get_defer_bal_computation (m_bank));
+    EXPECT_FALSE (gnc_account_get_defer_bal_computation (m_expense));
+    EXPECT_TRUE (gnc_numeric_equal (xaccAccountGetBalance (m_expense),
+                                    gnc_numeric_create (100, 100)));
+
+    // The caller recomputes the balance when it stops deferring it.
+    gnc_account_set_defer_bal_computation (m_bank, FALSE);
+    xaccAccountRecomputeBalance (m_bank);
+    EXPECT_TRUE (gnc_numeric_equal (xaccAccountGetBalance (m_bank),
+                                    gnc_numeric_create (-100, 100)));
+}
+
+TEST_F (BulkLoaderTest, rejects_invalid)
+{
+    GncBulkLoader loader {m_book};
+    auto no_currency = make_trans (86400, 100);
+    no_currency.currency = nullptr;
+    EXPECT_THROW (loader.add (std::move (no_currency)), std::invalid_argument);
+
+    auto no_splits = make_trans (86400, 100);
+    no_splits.splits.clear ();
+    EXPECT_THROW (loader.add (std::move (no_splits)), std::invalid_argument);
+
+    auto no_account = make_trans (86400, 100);
+    no_account.splits[0].account = nullptr;
+    EXPECT_THROW (loader.add (std::move (no_account)), std::invalid_argument);
+
+    EXPECT_EQ (loader.size (), 0u);
+    EXPECT_TRUE (loader.commit ().empty ());
+}
+
+TEST_F (BulkLoaderTest, holds_accounts)
+{
+    auto other_book = qof_book_new ();
+    auto other_acc = xaccMallocAccount (other_book);
+    {
+        GncBulkLoader loader {m_book};
+        loader.hold (m_bank);
+        loader.hold (nullptr);
+        EXPECT_THROW (loader.hold (other_acc), std::invalid_argument);
+        EXPECT_EQ (qof_instance_get_editlevel (m_bank), 1);
+        EXPECT_TRUE (gnc_account_get_defer_bal_computation (m_bank));
+
+        // Transactions committed meanwhile by other code
+        for (auto day : {3, 1, 2})
+        {
+            auto trans = xaccMallocTransaction (m_book);
+            auto amount = gnc_numeric_create (day * 100, 100);
+            xaccTransBeginEdit (trans);
+            xaccTransSetCurrency (trans, m_usd);
+            xaccTransSetDatePostedSecsNormalized (trans, day * 86400);
+            for (auto [acc, amt] : {std::pair {m_bank, amount},
+                                    std::pair {m_expense, gnc_numeric_neg (amount)}})
+            {
+                auto split = xaccMallocSplit (m_book);
+                xaccSplitSetParent (split, trans);
+                xaccSplitSetAccount (split, acc);
+                xaccSplitSetAmount (split, amt);
+                xaccSplitSetValue (split, amt);
+            }
+            xaccTransCommitEdit (trans);
+        }
+        loader.add (make_trans (4 * 86400, 100));
+        EXPECT_EQ (loader.commit ().size (), 1u);
+        EXPECT_EQ (qof_instance_get_editlevel (m_bank), 0);
+        EXPECT_FALSE (gnc_account_get_defer_bal_computation (m_bank));
+        EXPECT_TRUE (gnc_numeric_equal (xaccAccountGetBalance (m_bank),
+                                        gnc_numeric_create (500, 100)));
+
+        time64 last = 0;
+        for (auto node = xaccAccountGetSplitList (m_bank); node;
+             node = g_list_next (node))
+        {
+            auto date = xaccTransGetDate (xaccSplitGetParent (GNC_SPLIT (node->data)));
+            EXPECT_LE (last, date);
+            last = date;
+        }
+
+        // An account still held when the loader goes is released.
+        loader.hold (m_expense);
+        EXPECT_EQ (qof_instance_get_editlevel (m_expense), 1);
+    }
+    EXPECT_EQ (qof_instance_get_editlevel (m_expense), 0);
+    EXPECT_FALSE (gnc_account_get_defer_bal_computation (m_expense));
+
+    xaccAccountBeginEdit (other_acc);
+    xaccAccountDestroy (other_acc);
+    qof_book_destroy (other_book);
+}
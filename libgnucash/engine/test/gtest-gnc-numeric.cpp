@@ -21,6 +21,7 @@
 \********************************************************************/
 
 #include <gtest/gtest.h>
+#include <vector>
 #include "../gnc-numeric.hpp"
 #include "../gnc-rational.hpp"
 
@@ -561,3 +562,66 @@ TEST(gnc_numeric_functions, test_conversion_to_decimal)
     EXPECT_EQ(100, r.num());
     EXPECT_EQ(1, r.denom());
 }
+
+TEST(gnc_numeric_functions, test_add_fixed)
+{
+    auto a = gnc_numeric_create(12345, 100), b = gnc_numeric_create(-678, 100);
+    auto r = gnc_numeric_add_fixed(a, b);
+    EXPECT_EQ(11667, r.num);
+    EXPECT_EQ(100, r.denom);
+    EXPECT_TRUE(gnc_numeric_eq(r, gnc_numeric_add(a, b, GNC_DENOM_AUTO,
+                                                  GNC_HOW_DENOM_FIXED |
+                                                  GNC_HOW_RND_NEVER)));
+    r = gnc_numeric_sub_fixed(a, b);
+    EXPECT_EQ(13023, r.num);
+    EXPECT_EQ(100, r.denom);
+    EXPECT_TRUE(gnc_numeric_eq(r, gnc_numeric_sub(a, b, GNC_DENOM_AUTO,
+                                                  GNC_HOW_DENOM_FIXED |
+                                                  GNC_HOW_RND_NEVER)));
+    auto c = gnc_numeric_create(1, 3);
+    r = gnc_numeric_add_fixed(a, c);
+    EXPECT_TRUE(gnc_numeric_eq(r, gnc_numeric_add(a, c, GNC_DENOM_AUTO,
+                                                  GNC_HOW_DENOM_FIXED |
+                                                  GNC_HOW_RND_NEVER)));
+    auto big = gnc_numeric_create(INT64_MAX - 10, 100);
+    r = gnc_numeric_add_fixed(big, a);
+    EXPECT_TRUE(gnc_numeric_eq(r, gnc_numeric_add(big, a, GNC_DENOM_AUTO,
+                                                  GNC_HOW_DENOM_FIXED |
+                                                  GNC_HOW_RND_NEVER)));
+    r = gnc_numeric_add_fixed(a, gnc_numeric_error(GNC_ERROR_OVERFLOW));
+    EXPECT_EQ(GNC_ERROR_ARG, gnc_numeric_check(r));
+}
+
+TEST(gnc_numeric_functions, test_sum)
+{
+    EXPECT_TRUE(gnc_numeric_zero_p(gnc_numeric_sum(nullptr, 0)));
+
+    std::vector<gnc_numeric> values;
+    auto expected = gnc_numeric_zero();
+    for (int i = 0; i < 1000; ++i)
+    {
+        values.push_back(gnc_numeric_create(i * 37 - 5000, 100));
+        expected = gnc_numeric_add_fixed(expected, values.back());
+    }
+    auto r = gnc_numeric_sum(values.data(), values.size());
+    EXPECT_TRUE(gnc_numeric_eq(expected, r));
+    EXPECT_EQ(100, r.denom);
+
+    values.push_back(gnc_numeric_create(1, 3));
+    expected = gnc_numeric_add_fixed(expected, values.back());
+    r = gnc_numeric_sum(values.data(), values.size());
+    EXPECT_TRUE(gnc_numeric_eq(expected, r));
+
+    std::vector<gnc_numeric> overflow{gnc_numeric_create(INT64_MAX - 1, 100),
+                                      gnc_numeric_create(INT64_MAX - 1, 100),
+                                      gnc_numeric_create(-INT64_MAX, 100)};
+    expected = gnc_numeric_zero();
+    for (auto val : overflow)
+        expected = gnc_numeric_add_fixed(expected, val);
+    r = gnc_numeric_sum(overflow.data(), overflow.size());
+    EXPECT_TRUE(gnc_numeric_eq(expected, r));
+
+    values.push_back(gnc_numeric_error(GNC_ERROR_ARG));
+    r = gnc_numeric_sum(values.data(), values.size());
+    EXPECT_NE(GNC_ERROR_OK, gnc_numeric_check(r));
+}
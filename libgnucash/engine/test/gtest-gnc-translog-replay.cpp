@@ -0,0 +1,230 @@
+/********************************************************************\
+ * gtest-gnc-translog-replay.cpp -- Unit tests for log replay       *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+#include <config.h>
+#include "../gnc-translog-replay.hpp"
+#include "../gnc-commodity.h"
+#include "../TransLog.h"
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+static const char *log_header =
+    "mod\ttrans_guid\tsplit_guid\ttime_now\tdate_entered\tdate_posted\t"
+    "acc_guid\tacc_name\tnum\tdescription\tnotes\tmemo\taction\treconciled\t"
+    "amount\tvalue\tdate_reconciled\n-----------------\n";
+
+/* Known GUIDs, so that the records can be written out by hand. */
+static const char *trans_a = "0000000000000000000000000000000a";
+static const char *trans_b = "0000000000000000000000000000000b";
+static const char *split_1 = "00000000000000000000000000000001";
+static const char *split_2 = "00000000000000000000000000000002";
+static const char *split_3 = "00000000000000000000000000000003";
+static const char *split_4 = "00000000000000000000000000000004";
+
+class TransLogReplayTest : public testing::Test
+{
+protected:
+    void SetUp () override
+    {
+        m_book = qof_book_new ();
+        m_usd = gnc_commodity_new (m_book, "US Dollar",
+                                   GNC_COMMODITY_NS_CURRENCY, "USD", "840",
+                                   100);
+        auto root = gnc_account_create_root (m_book);
+        m_bank = make_account (root, "Bank");
+        m_expense = make_account (root, "Expense");
+        m_fees = make_account (root, "Fees");
+        xaccLogDisable ();
+    }
+    void TearDown () override
+    {
+        qof_book_destroy (m_book);
+        xaccLogEnable ();
+    }
+    Account *make_account (Account *parent, const char *name)
+    {
+        auto acc = xaccMallocAccount (m_book);
+        xaccAccountBeginEdit (acc);
+        xaccAccountSetName (acc, name);
+        xaccAccountSetCommodity (acc, m_usd);
+        xaccAccountCommitEdit (acc);
+        gnc_account_append_child (parent, acc);
+        return acc;
+    }
+    static std::string guid (Account *acc)
+    {
+        char buff[GUID_ENCODING_LENGTH + 1];
+        guid_to_string_buff (xaccAccountGetGUID (acc), buff);
+        return buff;
+    }
+    /* A record line, as xaccTransWriteLog() writes it. */
+    static std::string line (char flag, const char *trans, const char *split,
+                             Account *acc, const std::string& description,
+                             const std::string& amount,
+                             const std::string& notes = "")
+    {
+        return std::string {flag} + "\t" + trans + "\t" + split +
+            "\t2024-03-01 10:00:00\t2024-02-29 12:00:00\t2024-02-28 10:59:00\t" +
+            guid (acc) + "\t" + xaccAccountGetName (acc) + "\t\t" +
+            description + "\t" + notes + "\t\t\tn\t" + amount + "\t" + amount +
+            "\t1970-01-01 00:00:00\n";
+    }
+    static std::string record (const std::string& lines)
+    {
+        return "===== START\n" + lines + "===== END\n";
+    }
+    Transaction *lookup (const char *str)
+    {
+        GncGUID guid;
+        string_to_guid (str, &guid);
+        return xaccTransLookup (&guid, m_book);
+    }
+    void replay (const std::string& log)
+    {
+        std::istringstream stream {log_header + log};
+        GncTransLogReplay replay {m_book};
+        replay.read (stream);
+        m_records = replay.records ();
+        m_incomplete = replay.incomplete ();
+        m_counts = replay.apply ();
+    }
+
+    QofBook *m_book {};
+    gnc_commodity *m_usd {};
+    Account *m_bank {};
+    Account *m_expense {};
+    Account *m_fees {};
+    size_t m_records {};
+    size_t m_incomplete {};
+    GncTransLogReplayCounts m_counts {};
+};
+
+TEST_F (TransLogReplayTest, creates_transactions)
+{
+    replay (record (line ('B', trans_a, split_1, m_expense, "", "0/1")) +
+            record (line ('C', trans_a, split_1, m_expense, "Groceries", "1234/100") +
+                    line ('C', trans_a, split_2, m_bank, "Groceries", "-1234/100")));
+    EXPECT_EQ (m_records, 2u);
+    EXPECT_EQ (m_counts.created, 1u);
+    EXPECT_EQ (m_counts.changed, 0u);
+
+    auto trans = lookup (trans_a);
+    ASSERT_NE (trans, nullptr);
+    EXPECT_STREQ (xaccTransGetDescription (trans), "Groceries");
+    EXPECT_EQ (xaccTransGetCurrency (trans), m_usd);
+    /* 2024-02-28 10:59:00 UTC */
+    EXPECT_EQ (xaccTransGetDate (trans), 1709117940);
+    EXPECT_EQ (xaccTransCountSplits (trans), 2);
+    auto split = xaccTransGetSplit (trans, 0);
+    EXPECT_EQ (xaccSplitGetAccount (split), m_expense);
+    EXPECT_TRUE (gnc_numeric_equal (xaccSplitGetAmount (split),
+                                    gnc_numeric_create (1234, 100)));
+    EXPECT_EQ (xaccSplitGetReconcile (split), NREC);
+    EXPECT_TRUE (gnc_numeric_equal (xaccAccountGetBalance (m_bank),
+                                    gnc_numeric_create (-1234, 100)));
+}
+
+TEST_F (TransLogReplayTest, applies_the_last_state)
+{
+    replay (record (line ('C', trans_a, split_1, m_expense, "First", "100/100") +
+                    line ('C', trans_a, split_2, m_bank, "First", "-100/100")) +
+            record (line ('C', trans_b, split_3, m_fees, "Other", "0/100")) +
+            record (line ('C', trans_a, split_1, m_expense, "Second", "200/100") +
+                    line ('C', trans_a, split_3, m_bank, "Second", "-200/100")));
+    EXPECT_EQ (m_counts.created, 1u);
+
+    auto trans = lookup (trans_a);
+    ASSERT_NE (trans, nullptr);
+    EXPECT_STREQ (xaccTransGetDescription (trans), "Second");
+    EXPECT_EQ (xaccTransCountSplits (trans), 2);
+    /* The split moved to trans_a after trans_b was last committed. */
+    auto other = lookup (trans_b);
+    EXPECT_EQ (other ? xaccTransCountSplits (other) : 0, 0);
+    EXPECT_TRUE (gnc_numeric_equal (xaccAccountGetBalance (m_expense),
+                                    gnc_numeric_create (200, 100)));
+}
+
+TEST_F (TransLogReplayTest, updates_and_deletes_existing)
+{
+    replay (record (line ('C', trans_a, split_1, m_expense, "Old", "100/100") +
+                    line ('C', trans_a, split_2, m_bank, "Old", "-100/100")) +
+            record (line ('C', trans_b, split_3, m_expense, "Gone", "0/100")));
+    ASSERT_EQ (m_counts.created, 2u);
+
+    replay (record (line ('B', trans_a, split_1, m_expense, "Old", "100/100") +
+                    line ('B', trans_a, split_2, m_bank, "Old", "-100/100")) +
+            record (line ('C', trans_a, split_1, m_expense, "New", "100/100") +
+                    line ('C', trans_a, split_4, m_fees, "New", "-100/100")) +
+            record (line ('D', trans_b, split_3, m_expense, "Gone", "0/100")));
+    EXPECT_EQ (m_counts.changed, 1u);
+    EXPECT_EQ (m_counts.deleted, 1u);
+    EXPECT_EQ (lookup (trans_b), nullptr);
+
+    auto trans = lookup (trans_a);
+    ASSERT_NE (trans, nullptr);
+    EXPECT_STREQ (xaccTransGetDescription (trans), "New");
+    EXPECT_EQ (xaccTransCountSplits (trans), 2);
+    EXPECT_TRUE (gnc_numeric_zero_p (xaccAccountGetBalance (m_bank)));
+    EXPECT_TRUE (gnc_numeric_equal (xaccAccountGetBalance (m_fees),
+                                    gnc_numeric_create (-100, 100)));
+
+    replay (record (line ('D', trans_b, split_3, m_expense, "Gone", "0/100")));
+    EXPECT_EQ (m_counts.not_found, 1u);
+}
+
+TEST_F (TransLogReplayTest, skips_rollbacks_and_cut_records)
+{
+    replay (record (line ('R', trans_a, split_1, m_expense, "Rolled back", "100/100")) +
+            "===== START\n" +
+            line ('C', trans_b, split_2, m_expense, "Cut", "100/100"));
+    EXPECT_EQ (m_records, 1u);
+    EXPECT_EQ (m_incomplete, 1u);
+    EXPECT_EQ (m_counts.created, 0u);
+    EXPECT_EQ (lookup (trans_a), nullptr);
+    EXPECT_EQ (lookup (trans_b), nullptr);
+}
+
+TEST_F (TransLogReplayTest, reads_notes_with_newlines)
+{
+    replay (record (line ('C', trans_a, split_1, m_expense, "Notes", "100/100",
+                          "two\nlines") +
+                    line ('C', trans_a, split_2, m_bank, "Notes", "-100/100",
+                          "two\nlines")));
+    auto trans = lookup (trans_a);
+    ASSERT_NE (trans, nullptr);
+    EXPECT_STREQ (xaccTransGetNotes (trans), "two\nlines");
+    EXPECT_EQ (xaccTransCountSplits (trans), 2);
+}
+
+TEST_F (TransLogReplayTest, rejects_other_files)
+{
+    GncTransLogReplay replay {m_book};
+    std::istringstream empty {""};
+    EXPECT_THROW (replay.read (empty), std::runtime_error);
+    std::istringstream csv {"Date,Description,Amount\n"};
+    EXPECT_THROW (replay.read (csv), std::runtime_error);
+    EXPECT_THROW (replay.read ("/nonexistent/translog.log"), std::runtime_error);
+    EXPECT_THROW (GncTransLogReplay {nullptr}, std::invalid_argument);
+}
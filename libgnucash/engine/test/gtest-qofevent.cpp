@@ -27,6 +27,8 @@
 #include "../test-core/test-engine-stuff.h"
 #include "../qofevent.h"
 #include "../qofevent-p.h"
+#include "../Account.h"
+#include "../gnc-pricedb.h"
 #include <gtest/gtest.h>
 
 static void
@@ -134,3 +136,149 @@ TEST (qofevent, compound_events)
     qof_event_unregister_handler (id5);
 }
 
+
+struct TypedCounts
+{
+    int calls = 0;
+    QofEventId events = 0;
+};
+
+static void
+typed_handler (QofInstance *ent, QofEventId event_type,
+               gpointer handler_data, gpointer event_data)
+{
+    auto counts = static_cast<TypedCounts*>(handler_data);
+    ++counts->calls;
+    counts->events |= event_type;
+}
+
+static void
+background_handler (const GncGUID *guid, QofIdTypeConst type,
+                    QofEventId event_type, gpointer handler_data)
+{
+    auto counts = static_cast<TypedCounts*>(handler_data);
+    if (g_strcmp0 (type, GNC_ID_ACCOUNT) == 0)
+    {
+        ++counts->calls;
+        counts->events |= event_type;
+    }
+}
+
+class QofEventTypedTest : public ::testing::Test
+{
+protected:
+    void SetUp () override
+    {
+        m_book = qof_book_new ();
+        m_account = xaccMallocAccount (m_book);
+        m_price = gnc_price_create (m_book);
+    }
+    void TearDown () override
+    {
+        gnc_price_unref (m_price);
+        xaccAccountBeginEdit (m_account);
+        xaccAccountDestroy (m_account);
+        qof_book_destroy (m_book);
+    }
+    QofInstance *account () { return QOF_INSTANCE (m_account); }
+    QofInstance *price () { return QOF_INSTANCE (m_price); }
+
+    QofBook *m_book;
+    Account *m_account;
+    GNCPrice *m_price;
+};
+
+TEST_F (QofEventTypedTest, sync_filters_type_and_mask)
+{
+    TypedCounts counts;
+    auto id = qof_event_register_typed_handler (GNC_ID_ACCOUNT,
+                                                QOF_EVENT_MODIFY,
+                                                QOF_EVENT_DELIVER_SYNC,
+                                                typed_handler, &counts);
+
+    qof_event_gen (account (), QOF_EVENT_MODIFY, nullptr);
+    EXPECT_EQ (counts.calls, 1);
+    qof_event_gen (account (), QOF_EVENT_ADD, nullptr);
+    qof_event_gen (price (), QOF_EVENT_MODIFY, nullptr);
+    EXPECT_EQ (counts.calls, 1);
+
+    // Batches don't delay synchronous handlers.
+    qof_event_begin_batch ();
+    qof_event_gen (account (), QOF_EVENT_MODIFY | QOF_EVENT_ADD, nullptr);
+    EXPECT_EQ (counts.calls, 2);
+    EXPECT_EQ (counts.events, QOF_EVENT_MODIFY);
+    qof_event_end_batch ();
+
+    qof_event_unregister_handler (id);
+    qof_event_gen (account (), QOF_EVENT_MODIFY, nullptr);
+    EXPECT_EQ (counts.calls, 2);
+}
+
+TEST_F (QofEventTypedTest, batched_coalesces_per_entity)
+{
+    TypedCounts account_counts, all_counts;
+    auto id1 = qof_event_register_typed_handler (GNC_ID_ACCOUNT,
+                                                 QOF_EVENT_ALL,
+                                                 QOF_EVENT_DELIVER_BATCHED,
+                                                 typed_handler,
+                                                 &account_counts);
+    auto id2 = qof_event_register_typed_handler (nullptr,
+                                                 QOF_EVENT_MODIFY,
+                                                 QOF_EVENT_DELIVER_BATCHED,
+                                                 typed_handler, &all_counts);
+
+    // Outside a batch every event is delivered.
+    qof_event_gen (account (), QOF_EVENT_MODIFY, nullptr);
+    EXPECT_EQ (account_counts.calls, 1);
+    EXPECT_EQ (all_counts.calls, 1);
+
+    qof_event_begin_batch ();
+    qof_event_begin_batch ();
+    for (int i = 0; i < 100; ++i)
+    {
+        qof_event_gen (account (), QOF_EVENT_MODIFY, nullptr);
+        qof_event_gen (price (), QOF_EVENT_MODIFY, nullptr);
+    }
+    qof_event_gen (account (), QOF_EVENT_ADD, nullptr);
+    qof_event_end_batch ();
+    EXPECT_EQ (account_counts.calls, 1);
+    EXPECT_EQ (all_counts.calls, 1);
+    qof_event_end_batch ();
+
+    EXPECT_EQ (account_counts.calls, 2);
+    EXPECT_EQ (account_counts.events, QOF_EVENT_MODIFY | QOF_EVENT_ADD);
+    EXPECT_EQ (all_counts.calls, 3);
+    EXPECT_EQ (all_counts.events, QOF_EVENT_MODIFY);
+
+    qof_event_unregister_handler (id2);
+    qof_event_unregister_handler (id1);
+}
+
+TEST_F (QofEventTypedTest, background)
+{
+    TypedCounts counts;
+    auto id = qof_event_register_background_handler (GNC_ID_ACCOUNT,
+                                                     QOF_EVENT_MODIFY |
+                                                     QOF_EVENT_DESTROY,
+                                                     background_handler,
+                                                     &counts);
+
+    qof_event_gen (account (), QOF_EVENT_MODIFY, nullptr);
+    qof_event_gen (price (), QOF_EVENT_MODIFY, nullptr);
+    qof_event_flush_background ();
+    EXPECT_EQ (counts.calls, 1);
+
+    qof_event_begin_batch ();
+    for (int i = 0; i < 100; ++i)
+        qof_event_gen (account (), QOF_EVENT_MODIFY, nullptr);
+    qof_event_gen (account (), QOF_EVENT_DESTROY, nullptr);
+    qof_event_end_batch ();
+    qof_event_flush_background ();
+    EXPECT_EQ (counts.calls, 2);
+    EXPECT_EQ (counts.events, QOF_EVENT_MODIFY | QOF_EVENT_DESTROY);
+
+    qof_event_unregister_handler (id);
+    qof_event_gen (account (), QOF_EVENT_MODIFY, nullptr);
+    qof_event_flush_background ();
+    EXPECT_EQ (counts.calls, 2);
+}
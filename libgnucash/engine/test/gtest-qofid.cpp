@@ -0,0 +1,165 @@
+/********************************************************************\
+ * gtest-qofid.cpp -- Unit tests for QofCollection                  *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+#include <config.h>
+#include <glib.h>
+#include "../qof.h"
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+static const char *test_type = "test-qofid";
+
+class QofCollectionTest : public testing::Test
+{
+public:
+    void SetUp () override
+    {
+        m_book = qof_book_new ();
+        m_col = qof_book_get_collection (m_book, test_type);
+    }
+    void TearDown () override
+    {
+        for (auto inst : m_insts)
+            if (inst)
+                g_object_unref (inst);
+        qof_book_destroy (m_book);
+    }
+    QofInstance *add ()
+    {
+        auto inst = static_cast<QofInstance*>(g_object_new (QOF_TYPE_INSTANCE,
+                                                             nullptr));
+        qof_instance_init_data (inst, test_type, m_book);
+        m_insts.push_back (inst);
+        return inst;
+    }
+    void remove (size_t i)
+    {
+        g_object_unref (m_insts[i]);
+        m_insts[i] = nullptr;
+    }
+    std::vector<QofInstance*> visit ()
+    {
+        std::vector<QofInstance*> seen;
+        qof_collection_foreach (m_col, [](QofInstance *inst, gpointer data)
+        {
+            static_cast<std::vector<QofInstance*>*>(data)->push_back (inst);
+        }, &seen);
+        return seen;
+    }
+    QofBook *m_book {};
+    QofCollection *m_col {};
+    std::vector<QofInstance*> m_insts;
+};
+
+TEST_F (QofCollectionTest, foreach_in_insertion_order)
+{
+    for (int i = 0; i < 100; ++i)
+        add ();
+    EXPECT_EQ (visit (), m_insts);
+}
+
+TEST_F (QofCollectionTest, lookup_after_removals)
+{
+    for (int i = 0; i < 5000; ++i)
+        add ();
+    for (size_t i = 0; i < m_insts.size (); i += 3)
+        remove (i);
+
+    std::vector<QofInstance*> expected;
+    for (auto inst : m_insts)
+        if (inst)
+        {
+            expected.push_back (inst);
+            EXPECT_EQ (qof_collection_lookup_entity (m_col,
+                                                     qof_instance_get_guid (inst)),
+                       inst);
+        }
+    EXPECT_EQ (qof_collection_count (m_col), expected.size ());
+    EXPECT_EQ (visit (), expected);
+
+    auto guid = guid_new ();
+    EXPECT_EQ (qof_collection_lookup_entity (m_col, guid), nullptr);
+    guid_free (guid);
+}
+
+struct ForeachData
+{
+    QofCollectionTest *test;
+    int visited;
+};
+
+TEST_F (QofCollectionTest, change_during_foreach)
+{
+    for (int i = 0; i < 10; ++i)
+        add ();
+    ForeachData data { this, 0 };
+    qof_collection_foreach (m_col, [](QofInstance *inst, gpointer user_data)
+    {
+        auto data = static_cast<ForeachData*>(user_data);
+        auto test = data->test;
+        auto idx = std::find (test->m_insts.begin (), test->m_insts.end (),
+                              inst) - test->m_insts.begin ();
+        if (idx % 2 == 0)
+            test->remove (idx);
+        else
+            test->add ();
+        ++data->visited;
+    }, &data);
+    EXPECT_EQ (data.visited, 10);
+    EXPECT_EQ (qof_collection_count (m_col), 10u);
+}
+
+TEST_F (QofCollectionTest, snapshot_is_isolated)
+{
+    for (int i = 0; i < 10; ++i)
+        add ();
+    auto snap = qof_collection_snapshot (m_col);
+    remove (0);
+    add ();
+    add ();
+    EXPECT_EQ (qof_collection_count (m_col), 11u);
+    EXPECT_EQ (qof_collection_snapshot_count (snap), 10u);
+
+    int visited = 0;
+    qof_collection_snapshot_foreach (snap, [](QofInstance*, gpointer data)
+    {
+        ++*static_cast<int*>(data);
+    }, &visited);
+    EXPECT_EQ (visited, 10);
+    qof_collection_snapshot_free (snap);
+}
+
+TEST_F (QofCollectionTest, foreach_parallel_visits_each_once)
+{
+    for (int i = 0; i < 10000; ++i)
+        add ();
+    remove (17);
+    std::atomic<int> visited {0};
+    qof_collection_foreach_parallel (m_col, [](QofInstance*, gpointer data)
+    {
+        ++*static_cast<std::atomic<int>*>(data);
+    }, &visited);
+    EXPECT_EQ (visited.load (), 9999);
+}
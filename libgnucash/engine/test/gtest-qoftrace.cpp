@@ -0,0 +1,122 @@
+/********************************************************************\
+ * gtest-qoftrace.cpp -- Unit tests for the qoflog timing traces    *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+ \ *********************************************************************/
+
+#include <config.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include "../qoflog.h"
+#include <gtest/gtest.h>
+#include <string>
+
+static QofLogModule log_module = "qof.test";
+
+class QofTraceTest : public ::testing::Test
+{
+protected:
+    void SetUp () override
+    {
+        m_dir = g_dir_make_tmp ("gtest-qoftrace-XXXXXX", nullptr);
+        ASSERT_NE (m_dir, nullptr);
+    }
+    void TearDown () override
+    {
+        qof_trace_shutdown ();
+        g_remove (path ("summary.txt").c_str ());
+        g_remove (path ("trace.json").c_str ());
+        g_rmdir (m_dir);
+        g_free (m_dir);
+    }
+    std::string path (const char *name)
+    {
+        auto path = g_build_filename (m_dir, name, nullptr);
+        std::string rv{path};
+        g_free (path);
+        return rv;
+    }
+    std::string contents (const std::string& filename)
+    {
+        gchar *text = nullptr;
+        if (!g_file_get_contents (filename.c_str (), &text, nullptr, nullptr))
+            return {};
+        std::string rv{text};
+        g_free (text);
+        return rv;
+    }
+    void traced_work ()
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            QOF_TRACE_SCOPE ("scoped");
+            QOF_TRACE_COUNT ("items", 2);
+        }
+        QOF_TRACE_BEGIN (start);
+        QOF_TRACE_END (start, "paired");
+    }
+    gchar *m_dir = nullptr;
+};
+
+TEST_F (QofTraceTest, disabled_by_default)
+{
+    EXPECT_FALSE (qof_trace_is_enabled ());
+    EXPECT_EQ (qof_trace_begin (), 0);
+    traced_work ();
+    qof_trace_shutdown ();
+}
+
+TEST_F (QofTraceTest, summary)
+{
+    auto filename = path ("summary.txt");
+    qof_trace_init (filename.c_str ());
+    EXPECT_TRUE (qof_trace_is_enabled ());
+    traced_work ();
+    qof_trace_shutdown ();
+    EXPECT_FALSE (qof_trace_is_enabled ());
+
+    auto text = contents (filename);
+    EXPECT_NE (text.find ("qof.test"), std::string::npos);
+    auto scoped = text.find ("scoped");
+    ASSERT_NE (scoped, std::string::npos);
+    EXPECT_EQ (std::stoi (text.substr (text.find_first_not_of (' ', scoped + 6))), 3);
+    auto items = text.find ("items");
+    ASSERT_NE (items, std::string::npos);
+    EXPECT_EQ (std::stoi (text.substr (text.find_first_not_of (' ', items + 5))), 6);
+    EXPECT_NE (text.find ("paired"), std::string::npos);
+}
+
+TEST_F (QofTraceTest, chrome_json)
+{
+    auto filename = path ("trace.json");
+    qof_trace_init (filename.c_str ());
+    traced_work ();
+    qof_trace_shutdown ();
+
+    auto text = contents (filename);
+    EXPECT_EQ (text.rfind ("{\"traceEvents\":[", 0), 0u);
+    EXPECT_NE (text.find ("{\"name\":\"scoped\",\"cat\":\"qof.test\",\"ph\":\"X\""),
+               std::string::npos);
+    EXPECT_NE (text.find ("\"qof.test/items\":6"), std::string::npos);
+
+    /* Shutting down again writes nothing. */
+    g_remove (filename.c_str ());
+    qof_trace_shutdown ();
+    EXPECT_FALSE (g_file_test (filename.c_str (), G_FILE_TEST_EXISTS));
+}
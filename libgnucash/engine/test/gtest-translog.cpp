@@ -0,0 +1,238 @@
+/********************************************************************\
+ * gtest-translog.cpp -- Unit tests for the transaction logger      *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+#include <config.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include "../TransLog.h"
+#include "../gnc-commodity.h"
+#include "../gnc-date.h"
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+class TransLogTest : public testing::Test
+{
+protected:
+    void SetUp () override
+    {
+        m_dir = g_dir_make_tmp ("gtest-translog-XXXXXX", nullptr);
+        auto base = g_build_filename (m_dir, "translog", nullptr);
+        xaccLogSetBaseName (base);
+        g_free (base);
+        xaccLogEnable ();
+
+        m_book = qof_book_new ();
+        m_usd = gnc_commodity_new (m_book, "US Dollar",
+                                   GNC_COMMODITY_NS_CURRENCY, "USD", "840",
+                                   100);
+        auto root = gnc_account_create_root (m_book);
+        m_bank = make_account (root, "Bank");
+        m_expense = make_account (root, "Expense");
+    }
+    void TearDown () override
+    {
+        xaccLogDisable ();
+        qof_book_destroy (m_book);
+        xaccCloseLog ();
+        xaccLogSetSyncPolicy (XACC_LOG_SYNC_NONE);
+        auto dir = g_dir_open (m_dir, 0, nullptr);
+        while (auto name = g_dir_read_name (dir))
+        {
+            auto path = g_build_filename (m_dir, name, nullptr);
+            g_remove (path);
+            g_free (path);
+        }
+        g_dir_close (dir);
+        g_rmdir (m_dir);
+        g_free (m_dir);
+    }
+    Account *make_account (Account *parent, const char *name)
+    {
+        auto acc = xaccMallocAccount (m_book);
+        xaccAccountBeginEdit (acc);
+        xaccAccountSetName (acc, name);
+        xaccAccountSetCommodity (acc, m_usd);
+        xaccAccountCommitEdit (acc);
+        gnc_account_append_child (parent, acc);
+        return acc;
+    }
+    Transaction *make_trans (time64 date, gint64 cents, const char *desc)
+    {
+        auto trans = xaccMallocTransaction (m_book);
+        xaccTransBeginEdit (trans);
+        xaccTransSetCurrency (trans, m_usd);
+        xaccTransSetDatePostedSecs (trans, date);
+        xaccTransSetDescription (trans, desc);
+        auto amount = gnc_numeric_create (cents, 100);
+        for (auto [acc, amt] : {std::pair {m_expense, amount},
+                                std::pair {m_bank, gnc_numeric_neg (amount)}})
+        {
+            auto split = xaccMallocSplit (m_book);
+            xaccSplitSetParent (split, trans);
+            xaccSplitSetAccount (split, acc);
+            xaccSplitSetAmount (split, amt);
+            xaccSplitSetValue (split, amt);
+        }
+        xaccTransCommitEdit (trans);
+        return trans;
+    }
+    /* The lines of the only log file in the directory. */
+    std::vector<std::string> read_log ()
+    {
+        std::vector<std::string> lines;
+        auto dir = g_dir_open (m_dir, 0, nullptr);
+        auto name = g_dir_read_name (dir);
+        EXPECT_TRUE (name && xaccFileIsCurrentLog (name));
+        auto path = g_build_filename (m_dir, name, nullptr);
+        std::ifstream log {path};
+        for (std::string line; std::getline (log, line);)
+            lines.push_back (line);
+        g_free (path);
+        g_dir_close (dir);
+        return lines;
+    }
+    static std::vector<std::string> fields (const std::string& line)
+    {
+        std::vector<std::string> ret;
+        std::istringstream stream {line};
+        for (std::string field; std::getline (stream, field, '\t');)
+            ret.push_back (field);
+        if (!line.empty () && line.back () == '\t')
+            ret.push_back ("");
+        return ret;
+    }
+    static std::string iso8601 (time64 time)
+    {
+        char buff[MAX_DATE_LENGTH + 1] {};
+        gnc_time64_to_iso8601_buff (time, buff);
+        return buff;
+    }
+    static std::string guid (const GncGUID *guid)
+    {
+        char buff[GUID_ENCODING_LENGTH + 1];
+        guid_to_string_buff (guid, buff);
+        return buff;
+    }
+
+    char *m_dir {};
+    QofBook *m_book {};
+    gnc_commodity *m_usd {};
+    Account *m_bank {};
+    Account *m_expense {};
+};
+
+TEST_F (TransLogTest, writes_records)
+{
+    auto date = gnc_dmy2time64_neutral (29, 2, 2024);
+    auto trans = make_trans (date, -1234, "Groceries");
+    xaccLogFlush ();
+
+    auto lines = read_log ();
+    ASSERT_EQ (lines.size (), 10u);
+    EXPECT_EQ (lines[0].substr (0, 15), "mod\ttrans_guid\t");
+    EXPECT_EQ (lines[1], "-----------------");
+    /* The begin edit record has no splits yet. */
+    EXPECT_EQ (lines[2], "===== START");
+    EXPECT_EQ (lines[3], "===== END");
+    EXPECT_EQ (lines[4], "===== START");
+    EXPECT_EQ (lines[7], "===== END");
+
+    for (auto i : {5, 6})
+    {
+        auto split = xaccTransGetSplit (trans, i - 5);
+        auto acc = xaccSplitGetAccount (split);
+        auto amt = xaccSplitGetAmount (split);
+        auto record = fields (lines[i]);
+        ASSERT_EQ (record.size (), 17u);
+        EXPECT_EQ (record[0], "C");
+        EXPECT_EQ (record[1], guid (xaccTransGetGUID (trans)));
+        EXPECT_EQ (record[2], guid (xaccSplitGetGUID (split)));
+        EXPECT_EQ (record[4], iso8601 (xaccTransGetDateEntered (trans)));
+        EXPECT_EQ (record[5], iso8601 (date));
+        EXPECT_EQ (record[6], guid (xaccAccountGetGUID (acc)));
+        EXPECT_EQ (record[7], xaccAccountGetName (acc));
+        EXPECT_EQ (record[8], "");
+        EXPECT_EQ (record[9], "Groceries");
+        EXPECT_EQ (record[13], "n");
+        EXPECT_EQ (record[14], std::to_string (gnc_numeric_num (amt)) + "/100");
+        EXPECT_EQ (record[15], record[14]);
+        EXPECT_EQ (record[16], iso8601 (0));
+    }
+}
+
+TEST_F (TransLogTest, formats_dates_like_gnc_date)
+{
+    for (auto date : {gnc_dmy2time64 (1, 1, 1400), gnc_dmy2time64_end (31, 12, 1969),
+                      gnc_dmy2time64_neutral (29, 2, 2000),
+                      gnc_dmy2time64_end (28, 2, 2100), gnc_dmy2time64 (30, 12, 9999)})
+    {
+        auto trans = make_trans (date, 100, "");
+        xaccLogFlush ();
+        auto lines = read_log ();
+        /* The last split of the last record. */
+        auto record = fields (lines[lines.size () - 2]);
+        ASSERT_EQ (record.size (), 17u);
+        EXPECT_EQ (record[5], iso8601 (xaccTransGetDate (trans)));
+    }
+}
+
+TEST_F (TransLogTest, close_writes_everything)
+{
+    xaccLogSetSyncPolicy (XACC_LOG_SYNC_BATCH);
+    for (auto i = 0; i < 1000; ++i)
+        make_trans (gnc_time (nullptr), i, "Lots");
+    xaccCloseLog ();
+
+    auto lines = read_log ();
+    /* Header, then a begin edit record of two lines and a commit record
+     * of four for each transaction. */
+    ASSERT_EQ (lines.size (), 2u + 1000 * 6);
+    EXPECT_EQ (lines.back (), "===== END");
+    EXPECT_EQ (fields (lines[lines.size () - 2])[14], "-999/100");
+}
+
+TEST_F (TransLogTest, commit_policy)
+{
+    xaccLogSetSyncPolicy (XACC_LOG_SYNC_COMMIT);
+    EXPECT_EQ (xaccLogGetSyncPolicy (), XACC_LOG_SYNC_COMMIT);
+    make_trans (gnc_time (nullptr), 100, "Synced");
+    /* Nothing to wait for. */
+    auto lines = read_log ();
+    ASSERT_EQ (lines.size (), 8u);
+    EXPECT_EQ (fields (lines[5])[9], "Synced");
+}
+
+TEST_F (TransLogTest, unknown_policy)
+{
+    xaccLogSetSyncPolicy (XACC_LOG_SYNC_COMMIT);
+    xaccLogSetSyncPolicy (static_cast<XaccLogSyncPolicy>(42));
+    EXPECT_EQ (xaccLogGetSyncPolicy (), XACC_LOG_SYNC_NONE);
+    make_trans (gnc_time (nullptr), 100, "Unsynced");
+    xaccLogFlush ();
+    auto lines = read_log ();
+    ASSERT_EQ (lines.size (), 8u);
+    EXPECT_EQ (fields (lines[5])[9], "Unsynced");
+}
@@ -90,3 +90,27 @@ TEST (GncGUID, round_trip)
     EXPECT_EQ (guid1, guid2);
 }
 
+
+TEST (GncGUID, from_string_view)
+{
+    auto guid1 = gnc::GUID::create_random ();
+    auto str = "<" + guid1.to_string () + ">";
+    std::string_view view {str};
+    auto guid2 = gnc::GUID::from_string (view.substr (1, 32));
+    EXPECT_EQ (guid1, guid2);
+
+    gnc::GUID guid3;
+    EXPECT_TRUE (gnc::GUID::from_string (view.substr (1, 32), guid3));
+    EXPECT_EQ (guid1, guid3);
+    EXPECT_FALSE (gnc::GUID::from_string (view.substr (0, 32), guid3));
+    EXPECT_FALSE (gnc::GUID::from_string (view.substr (1, 31), guid3));
+}
+
+TEST (GncGUID, from_string_other_forms)
+{
+    std::string lower {"0123456789abcdef0123456789abcdef"};
+    auto guid = gnc::GUID::from_string (lower);
+    EXPECT_EQ (guid, gnc::GUID::from_string ("0123456789ABCDEF0123456789ABCDEF"));
+    EXPECT_EQ (guid, gnc::GUID::from_string ("01234567-89ab-cdef-0123-456789abcdef"));
+    EXPECT_EQ (guid.to_string (), lower);
+}
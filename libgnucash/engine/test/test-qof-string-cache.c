@@ -77,8 +77,48 @@ test_qof_string_cache( void )
     g_assert(str1_1 != str1_4);
 }
 
+static gpointer
+string_cache_thread( gpointer data )
+{
+    gchar str[16];
+    gint i;
+
+    for (i = 0; i < 10000; ++i)
+    {
+        const gchar* cached;
+        g_snprintf(str, sizeof(str), "str%d", i % 50);
+        cached = qof_string_cache_insert(str);
+        if (g_strcmp0(cached, str) != 0)
+            return GINT_TO_POINTER(FALSE);
+        qof_string_cache_remove(cached);
+    }
+    return GINT_TO_POINTER(TRUE);
+}
+
+static void
+test_qof_string_cache_threads( void )
+{
+    /* Threads inserting and removing the same strings must always get
+     * back an equal string, and must leave the refcounts balanced. */
+    GThread* threads[8];
+    const gchar* str1_1;
+    const gchar* str1_2;
+    guint i;
+
+    str1_1 = qof_string_cache_insert("str1");
+    for (i = 0; i < G_N_ELEMENTS(threads); ++i)
+        threads[i] = g_thread_new("string-cache", string_cache_thread, NULL);
+    for (i = 0; i < G_N_ELEMENTS(threads); ++i)
+        g_assert(GPOINTER_TO_INT(g_thread_join(threads[i])));
+    str1_2 = qof_string_cache_insert("str1");
+    g_assert(str1_1 == str1_2);
+    qof_string_cache_remove(str1_1);
+    qof_string_cache_remove(str1_2);
+}
+
 void
 test_suite_qof_string_cache ( void )
 {
     GNC_TEST_ADD_FUNC( suitename, "string-cache", test_qof_string_cache);
+    GNC_TEST_ADD_FUNC( suitename, "string-cache-threads", test_qof_string_cache_threads);
 }
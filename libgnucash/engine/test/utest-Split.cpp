@@ -88,9 +88,10 @@ setup (Fixture *fixture, gconstpointer pData)
     fixture->split->gains = GAINS_STATUS_VALU_DIRTY;
     fixture->split->gains_split = gains_split;
 
-    fixture->split->balance = amount;
-    fixture->split->cleared_balance = amount;
-    fixture->split->reconciled_balance = amount;
+    xaccSplitSetRunningBalance (fixture->split, SPLIT_BALANCE, amount);
+    xaccSplitSetRunningBalance (fixture->split, SPLIT_CLEARED_BALANCE, amount);
+    xaccSplitSetRunningBalance (fixture->split, SPLIT_RECONCILED_BALANCE,
+                                amount);
     qof_instance_mark_clean (QOF_INSTANCE (fixture->split));
     qof_instance_mark_clean (QOF_INSTANCE (acc));
     qof_instance_mark_clean (QOF_INSTANCE (txn));
@@ -133,9 +134,12 @@ test_gnc_split_init ()
     g_assert_cmpint (split->reconciled, ==, NREC);
     g_assert (gnc_numeric_zero_p (split->amount));
     g_assert (gnc_numeric_zero_p (split->value));
-    g_assert (gnc_numeric_zero_p (split->balance));
-    g_assert (gnc_numeric_zero_p (split->cleared_balance));
-    g_assert (gnc_numeric_zero_p (split->reconciled_balance));
+    g_assert (gnc_numeric_zero_p (xaccSplitGetBalance (split)));
+    g_assert (gnc_numeric_zero_p (xaccSplitGetClearedBalance (split)));
+    g_assert (gnc_numeric_zero_p (xaccSplitGetReconciledBalance (split)));
+    g_assert (gnc_numeric_zero_p (xaccSplitGetNoclosingBalance (split)));
+    g_assert_cmpint (xaccSplitGetBalance (split).denom, ==, 1);
+    g_assert (split->wide_balance == NULL);
     g_assert_cmpint (split->gains, ==, GAINS_STATUS_UNKNOWN);
     g_assert (split->gains_split == NULL);
     /* Make sure that the parent's init has been run */
@@ -305,9 +309,9 @@ test_xaccDupeSplit (Fixture *fixture, gconstpointer pData)
     g_assert (gnc_numeric_equal (split->value, f_split->value));
     g_assert (gnc_numeric_equal (split->amount, f_split->amount));
     /* xaccDupeSplit intentionally doesn't copy the balances */
-    g_assert (gnc_numeric_zero_p (split->balance));
-    g_assert (gnc_numeric_zero_p (split->cleared_balance));
-    g_assert (gnc_numeric_zero_p (split->reconciled_balance));
+    g_assert (gnc_numeric_zero_p (xaccSplitGetBalance (split)));
+    g_assert (gnc_numeric_zero_p (xaccSplitGetClearedBalance (split)));
+    g_assert (gnc_numeric_zero_p (xaccSplitGetReconciledBalance (split)));
     /* FIXME: gains and gains_split are not copied */
     g_assert_cmpint (split->gains, !=, f_split->gains);
     g_assert (split->gains_split != f_split->gains_split);
@@ -339,9 +343,12 @@ test_xaccSplitCloneNoKvp (Fixture *fixture, gconstpointer pData)
     g_assert_cmpint (split->date_reconciled, == , f_split->date_reconciled);
     g_assert (gnc_numeric_equal (split->value, f_split->value));
     g_assert (gnc_numeric_equal (split->amount, f_split->amount));
-    g_assert (gnc_numeric_equal (split->balance, f_split->balance));
-    g_assert (gnc_numeric_equal (split->cleared_balance, f_split->cleared_balance));
-    g_assert (gnc_numeric_equal (split->reconciled_balance, f_split->reconciled_balance));
+    g_assert (gnc_numeric_equal (xaccSplitGetBalance (split),
+                                 xaccSplitGetBalance (f_split)));
+    g_assert (gnc_numeric_equal (xaccSplitGetClearedBalance (split),
+                                 xaccSplitGetClearedBalance (f_split)));
+    g_assert (gnc_numeric_equal (xaccSplitGetReconciledBalance (split),
+                                 xaccSplitGetReconciledBalance (f_split)));
     g_assert_cmpint (split->gains, ==, GAINS_STATUS_UNKNOWN);
     g_assert (split->gains_split == NULL);
 }
@@ -505,14 +512,16 @@ test_xaccSplitEqual (Fixture *fixture, gconstpointer pData)
     g_assert_cmpint (checkC.hits, ==, 1);
     g_assert_cmpint (checkD.hits, ==, 0);
 
-    split2->balance = fixture->split->balance;
+    xaccSplitSetRunningBalance (split2, SPLIT_BALANCE,
+                                xaccSplitGetBalance (fixture->split));
     g_assert (xaccSplitEqual (fixture->split, split2, TRUE, TRUE, TRUE) == FALSE);
     g_assert_cmpint (checkA.hits, ==, 6);
     g_assert_cmpint (checkB.hits, ==, 2);
     g_assert_cmpint (checkC.hits, ==, 2);
     g_assert_cmpint (checkD.hits, ==, 0);
 
-    split2->cleared_balance = fixture->split->cleared_balance;
+    xaccSplitSetRunningBalance (split2, SPLIT_CLEARED_BALANCE,
+                                xaccSplitGetClearedBalance (fixture->split));
     g_assert (xaccSplitEqual (fixture->split, split2, TRUE, TRUE, TRUE) == FALSE);
     g_assert_cmpint (checkA.hits, ==, 6);
     g_assert_cmpint (checkB.hits, ==, 2);
@@ -867,6 +876,69 @@ test_xaccSplitSetValue (Fixture *fixture, gconstpointer pData)
  * xaccSplitGetReconciledBalance // Not Used
  Simple getters. No test.
 */
+/* xaccSplitSetRunningBalance
+void
+xaccSplitSetRunningBalance (Split *s, SplitBalanceType which, gnc_numeric val)
+xaccSplitSetRunningBalances (Split *s, gnc_numeric balance,...
+*/
+static void
+test_xaccSplitSetRunningBalance (Fixture *fixture, gconstpointer pData)
+{
+    Split *split = fixture->split;
+    gnc_numeric cents = gnc_numeric_create (12345, 100);
+    gnc_numeric thirds = gnc_numeric_create (2, 3);
+    gnc_numeric mils = gnc_numeric_create (-4567, 1000);
+
+    /* The fixture's balances share the amount's denominator. */
+    g_assert_cmpint (split->balance_denom, ==, 1000);
+    g_assert (split->wide_balance == NULL);
+
+    /* A different denominator is kept exactly, unpacked. */
+    xaccSplitSetRunningBalance (split, SPLIT_CLEARED_BALANCE, thirds);
+    g_assert (split->wide_balance != NULL);
+    g_assert (gnc_numeric_eq (xaccSplitGetClearedBalance (split), thirds));
+    g_assert (gnc_numeric_eq (xaccSplitGetReconciledBalance (split),
+                              gnc_numeric_create (321, 1000)));
+
+    /* And packed again once the balances agree. */
+    xaccSplitSetRunningBalances (split, cents, cents, cents, cents);
+    g_assert (split->wide_balance == NULL);
+    g_assert_cmpint (split->balance_denom, ==, 100);
+    g_assert (gnc_numeric_eq (xaccSplitGetBalance (split), cents));
+    g_assert (gnc_numeric_eq (xaccSplitGetNoclosingBalance (split), cents));
+
+    xaccSplitSetRunningBalances (split, mils, cents, thirds, mils);
+    g_assert (split->wide_balance != NULL);
+    g_assert (gnc_numeric_eq (xaccSplitGetBalance (split), mils));
+    g_assert (gnc_numeric_eq (xaccSplitGetNoclosingBalance (split), cents));
+    g_assert (gnc_numeric_eq (xaccSplitGetClearedBalance (split), thirds));
+    g_assert (gnc_numeric_eq (xaccSplitGetReconciledBalance (split), mils));
+
+    xaccSplitSetRunningBalance (split, SPLIT_NOCLOSING_BALANCE, mils);
+    xaccSplitSetRunningBalance (split, SPLIT_CLEARED_BALANCE, mils);
+    g_assert (split->wide_balance == NULL);
+    g_assert_cmpint (split->balance_denom, ==, 1000);
+    g_assert (gnc_numeric_eq (xaccSplitGetClearedBalance (split), mils));
+
+    /* Zero from gnc_numeric_zero() keeps its denominator of 1, other
+     * zeros theirs. */
+    xaccSplitSetRunningBalances (split, gnc_numeric_zero (), cents,
+                                 gnc_numeric_create (0, 100), cents);
+    g_assert (split->wide_balance == NULL);
+    g_assert_cmpint (xaccSplitGetBalance (split).denom, ==, 1);
+    g_assert_cmpint (xaccSplitGetClearedBalance (split).denom, ==, 100);
+    xaccSplitSetRunningBalance (split, SPLIT_NOCLOSING_BALANCE,
+                                gnc_numeric_zero ());
+    g_assert (split->wide_balance == NULL);
+    g_assert_cmpint (xaccSplitGetNoclosingBalance (split).denom, ==, 1);
+    g_assert (gnc_numeric_eq (xaccSplitGetReconciledBalance (split), cents));
+
+    /* Error values can't be packed but are preserved. */
+    xaccSplitSetRunningBalance (split, SPLIT_BALANCE,
+                                gnc_numeric_error (GNC_ERROR_OVERFLOW));
+    g_assert_cmpint (gnc_numeric_check (xaccSplitGetBalance (split)), ==,
+                     GNC_ERROR_OVERFLOW);
+}
 /* xaccSplitSetBaseValue
 void
 xaccSplitSetBaseValue (Split *s, gnc_numeric value,// C: 19 in 7
@@ -1914,6 +1986,7 @@ test_suite_split (void)
     GNC_TEST_ADD (suitename, "xaccSplitSetSharePrice", Fixture, NULL, setup, test_xaccSplitSetSharePrice, teardown);
     GNC_TEST_ADD (suitename, "xaccSplitSetAmount", Fixture, NULL, setup, test_xaccSplitSetAmount, teardown);
     GNC_TEST_ADD (suitename, "xaccSplitSetValue", Fixture, NULL, setup, test_xaccSplitSetValue, teardown);
+    GNC_TEST_ADD (suitename, "xaccSplitSetRunningBalance", Fixture, NULL, setup, test_xaccSplitSetRunningBalance, teardown);
     GNC_TEST_ADD (suitename, "xaccSplitSetBaseValue", Fixture, NULL, setup, test_xaccSplitSetBaseValue, teardown);
     GNC_TEST_ADD_FUNC (suitename, "xaccSplitConvertAmount", test_xaccSplitConvertAmount);
     GNC_TEST_ADD_FUNC (suitename, "xaccSplitDestroy", test_xaccSplitDestroy);
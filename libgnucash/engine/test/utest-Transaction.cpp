@@ -912,10 +912,10 @@ test_xaccTransEqual (Fixture *fixture, gconstpointer pData)
         Split* split01 = xaccTransGetSplit (txn0, 1);
         Split* split10 = xaccTransGetSplit (txn1, 0);
         Split* split11 = xaccTransGetSplit (txn1, 1);
-        auto bal00 = gnc_numeric_to_string (split00->balance);
-        auto bal01 = gnc_numeric_to_string (split01->balance);
-        auto bal10 = gnc_numeric_to_string (split10->balance);
-        auto bal11 = gnc_numeric_to_string (split11->balance);
+        auto bal00 = gnc_numeric_to_string (xaccSplitGetBalance (split00));
+        auto bal01 = gnc_numeric_to_string (xaccSplitGetBalance (split01));
+        auto bal10 = gnc_numeric_to_string (xaccSplitGetBalance (split10));
+        auto bal11 = gnc_numeric_to_string (xaccSplitGetBalance (split11));
         g_free (check->msg);
         check->msg = g_strdup_printf("[xaccSplitEqualCheckBal] balances differ: %s vs %s", bal10, bal00);
         check3->msg = g_strdup_printf("[xaccSplitEqualCheckBal] balances differ: %s vs %s", bal11, bal01);
@@ -927,10 +927,14 @@ test_xaccTransEqual (Fixture *fixture, gconstpointer pData)
         g_assert_cmpint (check2->hits, ==, 3);
         g_assert_cmpint (check3->hits, ==, 0);
 
-        split10->balance = split00->balance;
-        split11->balance = split01->balance;
-        split10->noclosing_balance = split00->noclosing_balance;
-        split11->noclosing_balance = split01->noclosing_balance;
+        xaccSplitSetRunningBalance (split10, SPLIT_BALANCE,
+                                    xaccSplitGetBalance (split00));
+        xaccSplitSetRunningBalance (split11, SPLIT_BALANCE,
+                                    xaccSplitGetBalance (split01));
+        xaccSplitSetRunningBalance (split10, SPLIT_NOCLOSING_BALANCE,
+                                    xaccSplitGetNoclosingBalance (split00));
+        xaccSplitSetRunningBalance (split11, SPLIT_NOCLOSING_BALANCE,
+                                    xaccSplitGetNoclosingBalance (split01));
         g_assert (xaccTransEqual (txn1, txn0, TRUE, TRUE, TRUE, TRUE));
     }
     g_free (check3->msg);